@@ -0,0 +1,44 @@
+# Simple CMake script to build performance benchmarks.
+# Each benchmark is a standalone executable using the timing harness
+# available in the file 'benchmark/benchmark.h'.
+
+GET_FILENAME_COMPONENT(OPENMA_BENCHMARK_ROOT ${CMAKE_CURRENT_LIST_FILE} PATH)
+
+SET(OPENMA_BENCHMARK_INCLUDES "${OPENMA_BENCHMARK_ROOT}/benchmark")
+
+# ADD_CXX_BENCHMARK(name sources libraries [BASELINE file])
+# Create the executable 'name' and the custom target 'name_check' comparing
+# the timings with the given baseline (if any).
+FUNCTION(ADD_CXX_BENCHMARK)
+  SET(options )
+  SET(oneValueArgs NAME BASELINE)
+  SET(multiValueArgs SOURCES LIBRARIES)
+  CMAKE_PARSE_ARGUMENTS(_BENCH "${options}" "${oneValueArgs}" "${multiValueArgs}" ${ARGN})
+  LIST(LENGTH _BENCH_UNPARSED_ARGUMENTS _BENCH_NUM_UNPARSED_ARGUMENTS)
+  IF (${_BENCH_NUM_UNPARSED_ARGUMENTS} GREATER 0)
+    IF (NOT _BENCH_NAME)
+      LIST(GET _BENCH_UNPARSED_ARGUMENTS 0 _BENCH_NAME)
+    ENDIF()
+  ENDIF()
+  IF (${_BENCH_NUM_UNPARSED_ARGUMENTS} GREATER 1)
+    IF (NOT _BENCH_SOURCES)
+      LIST(GET _BENCH_UNPARSED_ARGUMENTS 1 _BENCH_SOURCES)
+    ENDIF()
+  ENDIF()
+  IF (${_BENCH_NUM_UNPARSED_ARGUMENTS} GREATER 2)
+    IF (NOT _BENCH_LIBRARIES)
+      LIST(GET _BENCH_UNPARSED_ARGUMENTS 2 _BENCH_LIBRARIES)
+    ENDIF()
+  ENDIF ()
+  ADD_EXECUTABLE(${_BENCH_NAME} ${_BENCH_SOURCES})
+  TARGET_INCLUDE_DIRECTORIES(${_BENCH_NAME} PRIVATE ${OPENMA_BENCHMARK_INCLUDES})
+  IF(_BENCH_LIBRARIES)
+    TARGET_LINK_LIBRARIES(${_BENCH_NAME} ${_BENCH_LIBRARIES})
+  ENDIF()
+  IF(_BENCH_BASELINE)
+    ADD_CUSTOM_TARGET(${_BENCH_NAME}_check
+      COMMAND ${_BENCH_NAME} --baseline "${_BENCH_BASELINE}"
+      DEPENDS ${_BENCH_NAME}
+      COMMENT "Comparing ${_BENCH_NAME} with its baseline")
+  ENDIF()
+ENDFUNCTION()
@@ -0,0 +1,380 @@
+/* 
+ * Open Source Movement Analysis Library
+ * Copyright (C) 2016, Moveck Solution Inc., all rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 
+ *     * Redistributions of source code must retain the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer.
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials
+ *       provided with the distribution.
+ *     * Neither the name(s) of the copyright holders nor the names
+ *       of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written
+ *       permission.
+ *  
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef __openma_benchmark_h
+#define __openma_benchmark_h
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace ma
+{
+namespace bench
+{
+  /**
+   * Prevent the compiler to remove the computation of @a value.
+   */
+  template <typename T>
+  inline void do_not_optimize(const T& value)
+  {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "g"(&value) : "memory");
+#else
+    static volatile const void* sink;
+    sink = &value;
+#endif
+  };
+  
+  /**
+   * Statistics (in microseconds) computed for one benchmark case.
+   */
+  struct Result
+  {
+    std::string Name;
+    unsigned Rows;
+    unsigned Repetitions;
+    double Min;
+    double Mean;
+    double P50;
+    double P90;
+    double P99;
+    double Max;
+  };
+  
+  /**
+   * Self-contained timing harness.
+   * Each case is run a few times without measurement (warmup) before to be timed repeatedly. The percentiles of the timings are reported on the standard output and can be written in a JSON file.
+   * The options available on the command line are:
+   *  - --warmup N: number of untimed runs (default: 3)
+   *  - --repetitions N: number of timed runs (default: 15)
+   *  - --filter STR: only the cases with a name containing STR are run
+   *  - --max-rows N: the cases with more than N rows are skipped
+   *  - --output FILE: write the results in the given JSON file
+   *  - --baseline FILE: compare the median of each case with the one stored in the given JSON file (generated with --output)
+   *  - --tolerance X: relative slowdown accepted before to report a regression (default: 0.25)
+   *  - --help: print the available options
+   * A missing value or an unknown option prints the usage and terminates the program.
+   *
+   * The timings are machine dependent. When the results are written or compared, a fixed calibration kernel is timed too. Its median is stored with a description of the machine (CPU, compiler) in the output file.
+   * The comparison with a baseline is then relative: the medians of the baseline are scaled by the ratio between the current calibration and the one stored in the baseline.
+   * The method finish() returns a non null value if a regression was detected.
+   */
+  class Harness
+  {
+  public:
+    /**
+     * Constructor. Parse the command line options. The text @a extraUsage (if any) is appended to the usage printed for the option --help or for an invalid option.
+     */
+    Harness(int argc, char* argv[], const char* extraUsage = nullptr)
+    : m_Warmup(3), m_Repetitions(15), m_MaxRows(0), m_Tolerance(0.25), m_Calibration(0.0), m_Filter(), m_Output(), m_Baseline(), m_Results()
+    {
+      for (int i = 1 ; i < argc ; ++i)
+      {
+        const std::string arg = argv[i];
+        if ((arg == "--help") || (arg == "-h"))
+        {
+          usage(argv[0], extraUsage);
+          std::exit(EXIT_SUCCESS);
+        }
+        const char* value = (i + 1 < argc) ? argv[i+1] : nullptr;
+        if (value == nullptr)
+        {
+          std::fprintf(stderr, "Missing value for the option '%s'\n", arg.c_str());
+          usage(argv[0], extraUsage);
+          std::exit(EXIT_FAILURE);
+        }
+        if (arg == "--warmup")
+          m_Warmup = static_cast<unsigned>(std::strtoul(value, nullptr, 10));
+        else if (arg == "--repetitions")
+          m_Repetitions = std::max(1u, static_cast<unsigned>(std::strtoul(value, nullptr, 10)));
+        else if (arg == "--max-rows")
+          m_MaxRows = static_cast<unsigned>(std::strtoul(value, nullptr, 10));
+        else if (arg == "--tolerance")
+          m_Tolerance = std::strtod(value, nullptr);
+        else if (arg == "--filter")
+          m_Filter = value;
+        else if (arg == "--output")
+          m_Output = value;
+        else if (arg == "--baseline")
+          m_Baseline = value;
+        else
+        {
+          std::fprintf(stderr, "Unknown option '%s'\n", arg.c_str());
+          usage(argv[0], extraUsage);
+          std::exit(EXIT_FAILURE);
+        }
+        ++i;
+      }
+      if (!m_Output.empty() || !m_Baseline.empty())
+        m_Calibration = calibrate();
+      std::printf("%-32s %10s %12s %12s %12s\n", "Benchmark", "Rows", "p50 (us)", "p90 (us)", "min (us)");
+    };
+    
+    /**
+     * Time the function @a fn for the case @a name.
+     * The statistics of the case are returned. If the case was skipped, the number of repetitions and the timings of the returned statistics are set to 0.
+     */
+    Result run(const std::string& name, unsigned rows, const std::function<void()>& fn)
+    {
+      if ((!m_Filter.empty() && (name.find(m_Filter) == std::string::npos)) || ((m_MaxRows != 0) && (rows > m_MaxRows)))
+        return Result{name, rows, 0u, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+      for (unsigned i = 0 ; i < m_Warmup ; ++i)
+        fn();
+      std::vector<double> timings(m_Repetitions);
+      for (unsigned i = 0 ; i < m_Repetitions ; ++i)
+      {
+        const auto start = std::chrono::steady_clock::now();
+        fn();
+        const auto stop = std::chrono::steady_clock::now();
+        timings[i] = std::chrono::duration<double, std::micro>(stop - start).count();
+      }
+      std::sort(timings.begin(), timings.end());
+      Result result;
+      result.Name = name;
+      result.Rows = rows;
+      result.Repetitions = m_Repetitions;
+      result.Min = timings.front();
+      result.Max = timings.back();
+      double sum = 0.0;
+      for (const auto& t : timings)
+        sum += t;
+      result.Mean = sum / static_cast<double>(timings.size());
+      result.P50 = percentile(timings, 50.0);
+      result.P90 = percentile(timings, 90.0);
+      result.P99 = percentile(timings, 99.0);
+      std::printf("%-32s %10u %12.2f %12.2f %12.2f\n", name.c_str(), rows, result.P50, result.P90, result.Min);
+      std::fflush(stdout);
+      m_Results.push_back(result);
+      return result;
+    };
+    
+    /**
+     * Write the results (if requested) and compare them with the baseline (if any).
+     * Returns EXIT_FAILURE if a regression was found or if a file cannot be opened, EXIT_SUCCESS otherwise.
+     */
+    int finish() const
+    {
+      int status = EXIT_SUCCESS;
+      if (!m_Output.empty())
+      {
+        std::ofstream ofs(m_Output);
+        if (!ofs)
+        {
+          std::fprintf(stderr, "Impossible to write the file '%s'\n", m_Output.c_str());
+          status = EXIT_FAILURE;
+        }
+        char machine[512];
+        std::snprintf(machine, sizeof(machine), "  \"machine\": {\"cpu\": \"%s\", \"compiler\": \"%s\", \"calibration\": %.3f},\n", cpu().c_str(), compiler().c_str(), m_Calibration);
+        ofs << "{\n" << machine << "  \"benchmarks\": [\n";
+        for (size_t i = 0 ; i < m_Results.size() ; ++i)
+        {
+          const auto& r = m_Results[i];
+          char line[512];
+          std::snprintf(line, sizeof(line), "    {\"name\": \"%s\", \"rows\": %u, \"repetitions\": %u, \"min\": %.3f, \"mean\": %.3f, \"p50\": %.3f, \"p90\": %.3f, \"p99\": %.3f, \"max\": %.3f}%s\n",
+                        r.Name.c_str(), r.Rows, r.Repetitions, r.Min, r.Mean, r.P50, r.P90, r.P99, r.Max, (i + 1 < m_Results.size()) ? "," : "");
+          ofs << line;
+        }
+        ofs << "  ]\n}\n";
+      }
+      if (!m_Baseline.empty())
+      {
+        std::ifstream ifs(m_Baseline);
+        if (!ifs)
+        {
+          std::fprintf(stderr, "Impossible to read the file '%s'\n", m_Baseline.c_str());
+          return EXIT_FAILURE;
+        }
+        // NOTE: The baseline is expected to be generated by this harness (machine description and one case per line).
+        std::string line;
+        unsigned regressions = 0;
+        double scale = 1.0;
+        while (std::getline(ifs, line))
+        {
+          std::string cpuName;
+          double calibration = 0.0;
+          if (extract(line, "cpu", &cpuName, nullptr) && extract(line, "calibration", nullptr, &calibration))
+          {
+            if (calibration > 0.0)
+            {
+              scale = m_Calibration / calibration;
+              std::printf("Baseline recorded on '%s' (calibration %.2f us, current %.2f us): timings scaled by %.2f\n", cpuName.c_str(), calibration, m_Calibration, scale);
+            }
+            continue;
+          }
+          std::string name;
+          double rows = 0.0, p50 = 0.0;
+          if (!extract(line, "name", &name, nullptr) || !extract(line, "rows", nullptr, &rows) || !extract(line, "p50", nullptr, &p50))
+            continue;
+          p50 *= scale;
+          for (const auto& r : m_Results)
+          {
+            if ((r.Name != name) || (r.Rows != static_cast<unsigned>(rows)))
+              continue;
+            if (r.P50 > p50 * (1.0 + m_Tolerance))
+            {
+              std::printf("REGRESSION: %s (%u rows) p50 %.2f us > baseline %.2f us (+%.0f%%)\n", name.c_str(), r.Rows, r.P50, p50, 100.0 * (r.P50 / p50 - 1.0));
+              ++regressions;
+            }
+          }
+        }
+        if (regressions != 0)
+          status = EXIT_FAILURE;
+        else
+          std::printf("No regression found compared to the baseline.\n");
+      }
+      return status;
+    };
+    
+  private:
+    static void usage(const char* program, const char* extraUsage)
+    {
+      std::fprintf(stderr, "Usage: %s [options]\n"
+                           "  --warmup N       number of untimed runs (default: 3)\n"
+                           "  --repetitions N  number of timed runs (default: 15)\n"
+                           "  --filter STR     only run the cases with a name containing STR\n"
+                           "  --max-rows N     skip the cases with more than N rows\n"
+                           "  --output FILE    write the results in the given JSON file\n"
+                           "  --baseline FILE  compare the medians with the given JSON file\n"
+                           "  --tolerance X    relative slowdown accepted before to report a regression (default: 0.25)\n"
+                           "  --help           print this message\n", program);
+      if (extraUsage != nullptr)
+        std::fprintf(stderr, "%s", extraUsage);
+    };
+    
+    /**
+     * Median time of a fixed scalar and memory bound kernel. Used to compare timings measured on different machines.
+     */
+    double calibrate() const
+    {
+      std::vector<double> data(1 << 16);
+      for (size_t i = 0 ; i < data.size() ; ++i)
+        data[i] = static_cast<double>(i % 97) * 0.5;
+      std::vector<double> timings(std::max(m_Repetitions, 5u));
+      for (auto& t : timings)
+      {
+        const auto start = std::chrono::steady_clock::now();
+        double acc = 0.0;
+        for (unsigned k = 0 ; k < 8 ; ++k)
+        {
+          for (const auto& d : data)
+            acc += std::sqrt(d + static_cast<double>(k));
+        }
+        do_not_optimize(acc);
+        const auto stop = std::chrono::steady_clock::now();
+        t = std::chrono::duration<double, std::micro>(stop - start).count();
+      }
+      std::sort(timings.begin(), timings.end());
+      return percentile(timings, 50.0);
+    };
+    
+    static std::string cpu()
+    {
+      std::string model = "unknown";
+      std::ifstream ifs("/proc/cpuinfo");
+      std::string line;
+      while (std::getline(ifs, line))
+      {
+        if (line.compare(0, 10, "model name") != 0)
+          continue;
+        const size_t pos = line.find(':');
+        if ((pos != std::string::npos) && (pos + 2 <= line.size()))
+          model = line.substr(pos + 2);
+        break;
+      }
+      std::replace(model.begin(), model.end(), '"', '\'');
+      return model;
+    };
+    
+    static std::string compiler()
+    {
+#if defined(__clang__)
+      return std::string("clang ") + __clang_version__;
+#elif defined(__GNUC__)
+      return std::string("gcc ") + __VERSION__;
+#elif defined(_MSC_VER)
+      return "msvc " + std::to_string(_MSC_VER);
+#else
+      return "unknown";
+#endif
+    };
+    
+    static double percentile(const std::vector<double>& sorted, double p)
+    {
+      // Nearest-rank method
+      const size_t rank = static_cast<size_t>(std::ceil(p / 100.0 * static_cast<double>(sorted.size())));
+      return sorted[std::min(sorted.size(), std::max<size_t>(rank, 1)) - 1];
+    };
+    
+    static bool extract(const std::string& line, const char* key, std::string* text, double* number)
+    {
+      const std::string pattern = std::string("\"") + key + "\": ";
+      const size_t pos = line.find(pattern);
+      if (pos == std::string::npos)
+        return false;
+      const size_t start = pos + pattern.size();
+      if (text != nullptr)
+      {
+        if ((start >= line.size()) || (line[start] != '"'))
+          return false;
+        const size_t end = line.find('"', start + 1);
+        if (end == std::string::npos)
+          return false;
+        *text = line.substr(start + 1, end - start - 1);
+      }
+      if (number != nullptr)
+        *number = std::strtod(line.c_str() + start, nullptr);
+      return true;
+    };
+    
+    unsigned m_Warmup;
+    unsigned m_Repetitions;
+    unsigned m_MaxRows;
+    double m_Tolerance;
+    double m_Calibration;
+    std::string m_Filter;
+    std::string m_Output;
+    std::string m_Baseline;
+    std::vector<Result> m_Results;
+  };
+};
+};
+
+#endif // __openma_benchmark_h
@@ -46,6 +46,7 @@
 #include <string>
 #include <regex>
 #include <atomic>
+#include <functional>
 
 namespace ma
 {
@@ -75,7 +76,9 @@ namespace ma
     Any property(const std::string& key) const _OPENMA_NOEXCEPT;
     void setProperty(const std::string& key, const Any& value);
     
-    const std::unordered_map<std::string, Any>& dynamicProperties() const _OPENMA_NOEXCEPT;
+    const std::unordered_map<std::string, Any>& dynamicProperties(bool loadDeferred = true) const _OPENMA_NOEXCEPT;
+    const std::unordered_map<std::string, std::function<Any()>>& deferredProperties() const _OPENMA_NOEXCEPT;
+    void setDeferredProperty(const std::string& key, const std::function<Any()>& loader);
     
     template <typename U = Node*> U child(unsigned index) const _OPENMA_NOEXCEPT;
     const std::vector<Node*>& children() const _OPENMA_NOEXCEPT;
@@ -50,6 +50,8 @@
 #include <unordered_map>
 #include <vector>
 #include <atomic>
+#include <functional>
+#include <mutex>
 
 namespace ma
 {
@@ -82,7 +84,11 @@ namespace ma
     
     std::string Name;
     std::string Description;
-    std::unordered_map<std::string,Any> DynamicProperties;
+    mutable std::unordered_map<std::string,Any> DynamicProperties;
+    mutable std::unordered_map<std::string,std::function<Any()>> DeferredProperties;
+    mutable std::mutex PropertiesMutex; // Serializes the loading of the deferred properties done by the const accessors
+    void loadDeferredProperties() const _OPENMA_NOEXCEPT;
+    Any loadDeferredProperty(std::unordered_map<std::string,std::function<Any()>>::iterator it) const _OPENMA_NOEXCEPT;
     std::vector<Node*> Parents;
     std::vector<Node*> Children;
 #if defined(USE_REFCOUNT_MECHANISM)
@@ -38,12 +38,14 @@
 #include <cstdio> // vsnprintf
 #include <cstring> // strlen
 #include <cstdarg> // va_start, va_end
+#include <mutex>
+#include <atomic>
 
 namespace ma
 {
   struct Logger::Private
   {
-    Private() _OPENMA_NOEXCEPT : Output(nullptr), Quiet(false) {};
+    Private() _OPENMA_NOEXCEPT : Output(nullptr), Quiet(false), Mutex() {};
     ~Private() _OPENMA_NOEXCEPT = default;
     
     Private(const Private& ) = delete;
@@ -52,7 +54,8 @@ namespace ma
     Private& operator=(Private&& ) _OPENMA_NOEXCEPT = delete;
     
     Device* Output;
-    bool Quiet;
+    std::atomic<bool> Quiet;
+    std::mutex Mutex; // Messages can be sent concurrently by several threads
   };
   
   // ----------------------------------------------------------------------- //
@@ -180,6 +183,8 @@ namespace ma
    *
    * To disable the logger, you can use the method logger::mute().
    *
+   * The messages can be sent concurrently from several threads. They are written one at a time into the device.
+   *
    * @ingroup openma_base
    */
 
@@ -194,6 +199,7 @@ namespace ma
   
   /**
    * Returns the device which will write the log message
+   * @warning The returned device is not protected against concurrent accesses. It is deleted by the next call to setDevice() and must not be used while messages are sent by other threads.
    */
   Logger::Device* Logger::device() _OPENMA_NOEXCEPT
   {
@@ -206,6 +212,7 @@ namespace ma
    */
   void Logger::setDevice(Device* output) _OPENMA_NOEXCEPT
   {
+    std::lock_guard<std::mutex> lock(Logger::instance().mp_Pimpl->Mutex);
     delete Logger::instance().mp_Pimpl->Output;
     Logger::instance().mp_Pimpl->Output = output;
   };
@@ -248,8 +255,6 @@ namespace ma
   {
     if (this->mp_Pimpl->Quiet)
       return;
-    if (this->mp_Pimpl->Output == nullptr)
-      this->mp_Pimpl->Output = new __details::Console;
     int n = strlen(msg)*2;
     char* str = new char[n];
     while (1)
@@ -283,7 +288,7 @@ namespace ma
         break;
 #endif
     }
-    this->mp_Pimpl->Output->write(category,str);
+    this->sendMessage(category,str);
     delete[] str;
   };
 
@@ -296,6 +301,7 @@ namespace ma
   {
     if (this->mp_Pimpl->Quiet)
       return;
+    std::lock_guard<std::mutex> lock(this->mp_Pimpl->Mutex);
     if (this->mp_Pimpl->Output == nullptr)
       this->mp_Pimpl->Output = new __details::Console;
     this->mp_Pimpl->Output->write(category,msg);
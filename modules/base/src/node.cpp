@@ -46,7 +46,7 @@ namespace ma
 {
   NodePrivate::NodePrivate(Node* pint, const std::string& name)
   : ObjectPrivate(),
-    Name(name), Description(), DynamicProperties(), Parents(), Children(),
+    Name(name), Description(), DynamicProperties(), DeferredProperties(), Parents(), Children(),
 #if defined(USE_REFCOUNT_MECHANISM)
     ReferenceCounter(0),
 #endif
@@ -163,6 +163,41 @@ namespace ma
     }
     return false;
   };
+  
+  /**
+   * Loads the deferred property pointed by @a it, removes it from the deferred properties, and stores its value (if valid) in the dynamic properties.
+   * Any exception thrown by the loader is caught and reported. The mutex PropertiesMutex must be locked by the caller.
+   */
+  Any NodePrivate::loadDeferredProperty(std::unordered_map<std::string,std::function<Any()>>::iterator it) const _OPENMA_NOEXCEPT
+  {
+    Any value;
+    try
+    {
+      value = it->second();
+    }
+    catch (std::exception& e)
+    {
+      error("Node '%s': the deferred property '%s' cannot be loaded: %s", this->Name.c_str(), it->first.c_str(), e.what());
+    }
+    catch (...)
+    {
+      error("Node '%s': the deferred property '%s' cannot be loaded: unknown error", this->Name.c_str(), it->first.c_str());
+    }
+    if (value.isValid())
+      this->DynamicProperties[it->first] = value;
+    this->DeferredProperties.erase(it);
+    return value;
+  };
+  
+  /**
+   * Loads all the deferred properties and moves them into the dynamic properties.
+   * The mutex PropertiesMutex must be locked by the caller.
+   */
+  void NodePrivate::loadDeferredProperties() const _OPENMA_NOEXCEPT
+  {
+    while (!this->DeferredProperties.empty())
+      this->loadDeferredProperty(this->DeferredProperties.begin());
+  };
 };
 
 #endif
@@ -384,9 +419,17 @@ namespace ma
     bool caught = optr->staticProperty(key.c_str(),&value);
     if (!caught)
     {
+      // The dynamic properties can be modified by the loading of a deferred one, even in this const method.
+      std::lock_guard<std::mutex> lock(optr->PropertiesMutex);
       std::unordered_map<std::string,Any>::const_iterator it = optr->DynamicProperties.find(key);
       if (it != optr->DynamicProperties.end())
         value = it->second;
+      else
+      {
+        auto itD = optr->DeferredProperties.find(key);
+        if (itD != optr->DeferredProperties.end())
+          value = optr->loadDeferredProperty(itD);
+      }
     }
     return value;
   };
@@ -402,6 +445,14 @@ namespace ma
     bool caught = optr->setStaticProperty(key.c_str(),&value);
     if (!caught)
     {
+      // A deferred value is replaced without being loaded
+      if (optr->DeferredProperties.erase(key) != 0)
+      {
+        if (value.isValid())
+          optr->DynamicProperties[key] = value;
+        this->modified();
+        return;
+      }
       auto it = optr->DynamicProperties.find(key);
       // Existing property
       if (it != optr->DynamicProperties.end())
@@ -432,14 +483,50 @@ namespace ma
   };
   
   /**
-   * Returns the dynamic properties
+   * Returns the dynamic properties.
+   * By default, the deferred properties (see setDeferredProperty()) are loaded before. Set @a loadDeferred to false to only get the properties already loaded. In this case, the pending ones are available using deferredProperties().
+   * @note Even if this method is const, the loading of the deferred properties modifies the internal state of the node (see setDeferredProperty()).
    */
-  const std::unordered_map<std::string, Any>& Node::dynamicProperties() const _OPENMA_NOEXCEPT
+  const std::unordered_map<std::string, Any>& Node::dynamicProperties(bool loadDeferred) const _OPENMA_NOEXCEPT
   {
     auto optr = this->pimpl();
+    if (loadDeferred)
+    {
+      std::lock_guard<std::mutex> lock(optr->PropertiesMutex);
+      optr->loadDeferredProperties();
+    }
     return optr->DynamicProperties;
   };
   
+  /**
+   * Returns the deferred properties not yet loaded.
+   * Each entry associates the key of a property to the function used to load its value.
+   */
+  const std::unordered_map<std::string, std::function<Any()>>& Node::deferredProperties() const _OPENMA_NOEXCEPT
+  {
+    auto optr = this->pimpl();
+    return optr->DeferredProperties;
+  };
+  
+  /**
+   * Sets a property which value is loaded only when it is accessed for the first time.
+   * The function @a loader is called once by property() (or dynamicProperties()) and the returned value is then stored as a regular dynamic property. This is useful for readers which can index a large set of properties without decoding them.
+   * If a dynamic property with the same @a key already exists, it is replaced. Setting a null @a loader removes the deferred property.
+   * The loader can throw an exception. In this case, an error is reported and the property is removed.
+   * @note The loading of a deferred property modifies the internal state of the node even if the accessor is const (property(), dynamicProperties()). These const accessors can be called concurrently from several threads: the loading is serialized by an internal mutex and each loader is called only once.
+   * A loader must not access the properties of its node. However, like for any other non-const method, the modification of the properties (e.g. setProperty(), setDeferredProperty()) must not be done concurrently with their access.
+   */
+  void Node::setDeferredProperty(const std::string& key, const std::function<Any()>& loader)
+  {
+    auto optr = this->pimpl();
+    optr->DynamicProperties.erase(key);
+    if (loader)
+      optr->DeferredProperties[key] = loader;
+    else
+      optr->DeferredProperties.erase(key);
+    this->modified();
+  };
+  
   /**
    * @fn template <typename U = Node*> U Node::child(unsigned index) const _OPENMA_NOEXCEPT
    * Returns the node associated with the given @a index or null if out of range.
@@ -534,9 +621,10 @@ namespace ma
   void Node::clear() _OPENMA_NOEXCEPT
   {
     auto optr = this->pimpl();
-    if (optr->Parents.empty() && optr->Children.empty() && optr->DynamicProperties.empty())
+    if (optr->Parents.empty() && optr->Children.empty() && optr->DynamicProperties.empty() && optr->DeferredProperties.empty())
       return;
     optr->DynamicProperties.clear();
+    optr->DeferredProperties.clear();
     for (auto it = optr->Children.begin() ; it != optr->Children.end() ; ++it)
     {
       (*it)->pimpl()->detachParent(this);
@@ -707,6 +795,7 @@ namespace ma
     optr->Name = optr_src->Name;
     optr->Description = optr_src->Description;
     optr->DynamicProperties = optr_src->DynamicProperties;
+    optr->DeferredProperties = optr_src->DeferredProperties;
   };
   
   /**
@@ -2,6 +2,9 @@
 
 #include "nodeTest_def.h"
 
+#include <atomic>
+#include <thread>
+
 CXXTEST_SUITE(NodeTest)
 {
   CXXTEST_TEST(modified)
@@ -87,6 +90,81 @@ CXXTEST_SUITE(NodeTest)
     TS_ASSERT_EQUALS(node.property("my_unknown_dynamic_property").isValid(),false);
   };
   
+  CXXTEST_TEST(deferredProperty)
+  {
+    ma::Node node("foo");
+    int loaded = 0;
+    unsigned long ts = node.timestamp();
+    node.setDeferredProperty("bar",[&loaded](){++loaded; return ma::Any(45);});
+    node.setDeferredProperty("toto",[&loaded](){++loaded; return ma::Any(std::string("hello"));});
+    node.setDeferredProperty("titi",[&loaded](){++loaded; return ma::Any(1.5);});
+    TS_ASSERT_DIFFERS(node.timestamp(),ts);
+    TS_ASSERT_EQUALS(node.deferredProperties().size(),3ul);
+    TS_ASSERT_EQUALS(node.dynamicProperties(false).empty(),true);
+    TS_ASSERT_EQUALS(loaded,0);
+    // Loaded only once
+    ts = node.timestamp();
+    TS_ASSERT_EQUALS(node.property("bar"),45);
+    TS_ASSERT_EQUALS(node.property("bar"),45);
+    TS_ASSERT_EQUALS(loaded,1);
+    TS_ASSERT_EQUALS(node.timestamp(),ts);
+    TS_ASSERT_EQUALS(node.deferredProperties().size(),2ul);
+    TS_ASSERT_EQUALS(node.dynamicProperties(false).size(),1ul);
+    // Replaced without being loaded
+    node.setProperty("toto",std::string("world"));
+    TS_ASSERT_DIFFERS(node.timestamp(),ts);
+    TS_ASSERT_EQUALS(loaded,1);
+    TS_ASSERT_EQUALS(node.property("toto").cast<std::string>(),"world");
+    // Copied without being loaded
+    ma::Node* copy = node.clone();
+    TS_ASSERT_EQUALS(copy->deferredProperties().size(),1ul);
+    TS_ASSERT_EQUALS(loaded,1);
+    TS_ASSERT_EQUALS(copy->dynamicProperties().size(),3ul);
+    TS_ASSERT_EQUALS(copy->deferredProperties().empty(),true);
+    TS_ASSERT_EQUALS(loaded,2);
+    delete copy;
+    TS_ASSERT_EQUALS(node.dynamicProperties().size(),3ul);
+    TS_ASSERT_EQUALS(node.property("titi"),1.5);
+    TS_ASSERT_EQUALS(loaded,3);
+    // Removed
+    node.setDeferredProperty("bar",[&loaded](){++loaded; return ma::Any();});
+    TS_ASSERT_EQUALS(node.property("bar").isValid(),false);
+    TS_ASSERT_EQUALS(node.dynamicProperties().size(),2ul);
+    node.setDeferredProperty("titi",[&loaded](){++loaded; return ma::Any();});
+    node.clear();
+    TS_ASSERT_EQUALS(node.deferredProperties().empty(),true);
+    TS_ASSERT_EQUALS(node.dynamicProperties().empty(),true);
+  };
+  
+  CXXTEST_TEST(deferredPropertyConcurrent)
+  {
+    ma::Node node("foo");
+    std::atomic<int> loaded(0);
+    for (int i = 0 ; i < 100 ; ++i)
+      node.setDeferredProperty("p" + std::to_string(i),[&loaded,i](){++loaded; return ma::Any(i);});
+    // Loader throwing something else than a std::exception
+    node.setDeferredProperty("bad",[]() -> ma::Any {throw 1;});
+    std::atomic<int> mismatches(0);
+    std::vector<std::thread> threads;
+    for (int t = 0 ; t < 4 ; ++t)
+    {
+      threads.emplace_back([&node,&mismatches](){
+        for (int i = 0 ; i < 100 ; ++i)
+        {
+          if (node.property("p" + std::to_string(i)).cast<int>() != i)
+            ++mismatches;
+        }
+      });
+    }
+    for (auto& thread : threads)
+      thread.join();
+    TS_ASSERT_EQUALS(mismatches.load(),0);
+    TS_ASSERT_EQUALS(loaded.load(),100);
+    TS_ASSERT_EQUALS(node.property("bad").isValid(),false);
+    TS_ASSERT_EQUALS(node.deferredProperties().empty(),true);
+    TS_ASSERT_EQUALS(node.dynamicProperties().size(),100ul);
+  };
+  
   CXXTEST_TEST(inheritingClassWithStaticProperty)
   {
     TestNode node("foo");
@@ -576,6 +654,8 @@ CXXTEST_SUITE_REGISTRATION(NodeTest)
 CXXTEST_TEST_REGISTRATION(NodeTest, modified)
 CXXTEST_TEST_REGISTRATION(NodeTest, staticProperty)
 CXXTEST_TEST_REGISTRATION(NodeTest, dynamicProperty)
+CXXTEST_TEST_REGISTRATION(NodeTest, deferredProperty)
+CXXTEST_TEST_REGISTRATION(NodeTest, deferredPropertyConcurrent)
 CXXTEST_TEST_REGISTRATION(NodeTest, inheritingClassWithStaticProperty)
 CXXTEST_TEST_REGISTRATION(NodeTest, childrenStack)
 CXXTEST_TEST_REGISTRATION(NodeTest, childrenHeap)
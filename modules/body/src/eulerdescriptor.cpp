@@ -390,6 +390,8 @@ namespace body
    * To modify this behaviour, you can use the options:
    *  - enableDegreeConversion: boolean value
    *  - adaptForInterpretation: boolean value
+   *  - enableFastComputation: boolean value (use the vectorized approximation of the Euler angles, see math::EulerAnglesMode)
+   *  - enableUnwrapping: boolean value (remove the jumps of 2*pi between consecutive samples)
    */
   bool EulerDescriptor::process(const std::unordered_map<std::string, Any>& options)
   {
@@ -421,8 +423,14 @@ namespace body
       scale[1] *= optr->Scale[1];
       scale[2] *= optr->Scale[2];
     }
+    // Option enableFastComputation activated?
+    auto mode = math::EulerAnglesMode::Exact;
+    if (((it = options.find("enableFastComputation")) != options.cend()) && (it->second.cast<bool>()))
+      mode = math::EulerAnglesMode::Approximate;
+    // Option enableUnwrapping activated?
+    const bool unwrap = ((it = options.find("enableUnwrapping")) != options.cend()) && (it->second.cast<bool>());
     // Let's compute the output
-    optr->OutputData = optr->BufferData.eulerAngles(optr->Sequence[0], optr->Sequence[1], optr->Sequence[2]);
+    optr->OutputData = optr->BufferData.eulerAngles(optr->Sequence[0], optr->Sequence[1], optr->Sequence[2], mode, unwrap);
     optr->OutputData.values().col(0) *= scale[0];
     optr->OutputData.values().col(0) += offset[0];
     optr->OutputData.values().col(1) *= scale[1];
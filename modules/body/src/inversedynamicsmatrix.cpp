@@ -233,10 +233,16 @@ namespace body
           math::Vector Fdyn = m * a / 1000.0;
           auto Mdyn = (I.transform(alpha) + omega.cross(I.transform(omega))) / 1000.0 + c.cross(Fdyn);
           // - Proximal joint (result)
-          math::Vector Fp = Fdyn - Fwei - Fext;
-          math::Vector Mp = Mdyn - Mwei - Mext;
-          math::to_timesequence(Fp, jnt->name() + ".Force", rate, start, TimeSequence::Force, "N", jnt);
-          math::to_timesequence(Mp, jnt->name() + ".Moment", rate, start, TimeSequence::Moment, "Nmm" , jnt);
+          // NOTE: The expressions are directly evaluated in the output time sequences (reused if they already exist).
+          auto Fts = math::to_timesequence(Fdyn - Fwei - Fext, jnt->name() + ".Force", rate, start, TimeSequence::Force, "N", jnt);
+          auto Mts = math::to_timesequence(Mdyn - Mwei - Mext, jnt->name() + ".Moment", rate, start, TimeSequence::Moment, "Nmm" , jnt);
+          if ((Fts == nullptr) || (Mts == nullptr))
+          {
+            error("Impossible to export the force and moment of the joint '%s'. Inverse dynamics for the chain '%s' aborted.", jnt->name().c_str(), chain->name().c_str());
+            break;
+          }
+          auto Fp = math::to_vector(Fts);
+          auto Mp = math::to_vector(Mts);
           math::to_timesequence(omega, spts->name() + ".Omega", rate, start, TimeSequence::Angle | TimeSequence::Velocity | TimeSequence::Reconstructed, "rad/s" , seg);
           
           // Set the next (reaction) distal joint variables
@@ -0,0 +1,431 @@
+/* 
+ * Open Source Movement Analysis Library
+ * Copyright (C) 2016, Moveck Solution Inc., all rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 
+ *     * Redistributions of source code must retain the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer.
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials
+ *       provided with the distribution.
+ *     * Neither the name(s) of the copyright holders nor the names
+ *       of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written
+ *       permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <benchmark.h>
+
+#include <openma/base.h>
+#include <openma/io.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Configuration of the generated files (see the options listed in main())
+struct Configuration
+{
+  unsigned Markers = 50;
+  unsigned Analogs = 32;
+  unsigned Frames = 2000;
+  unsigned Parameters = 100;
+  std::string Directory = ".";
+};
+
+// Samples per channel in the analog only formats (HPF, BSF) and per point frame in the C3D format
+static const unsigned analog_ratio = 10;
+static const double point_rate = 100.0;
+
+// Little endian binary content written independently of the host architecture
+class Bytes
+{
+public:
+  template <typename T>
+  void put(T value)
+  {
+    uint64_t word = 0;
+    std::memcpy(&word, &value, sizeof(T));
+    for (size_t i = 0 ; i < sizeof(T) ; ++i)
+      m_Data.push_back(static_cast<char>((word >> (8 * i)) & 0xFF));
+  };
+  
+  template <typename T>
+  void put(size_t n, T value)
+  {
+    for (size_t i = 0 ; i < n ; ++i)
+      this->put(value);
+  };
+  
+  void text(const std::string& value, size_t width)
+  {
+    std::string field(value);
+    field.resize(width, ' ');
+    m_Data.insert(m_Data.end(), field.begin(), field.end());
+  };
+  
+  void fill(size_t n)
+  {
+    m_Data.insert(m_Data.end(), n, 0);
+  };
+  
+  size_t size() const {return m_Data.size();};
+  
+  template <typename T>
+  void set(size_t position, T value)
+  {
+    uint64_t word = 0;
+    std::memcpy(&word, &value, sizeof(T));
+    for (size_t i = 0 ; i < sizeof(T) ; ++i)
+      m_Data[position + i] = static_cast<char>((word >> (8 * i)) & 0xFF);
+  };
+  
+  bool save(const std::string& filepath) const
+  {
+    std::ofstream ofs(filepath, std::ios::binary | std::ios::trunc);
+    ofs.write(m_Data.data(), static_cast<std::streamsize>(m_Data.size()));
+    return ofs.good();
+  };
+  
+private:
+  std::vector<char> m_Data;
+};
+
+// Deterministic signal with a different phase for each channel
+static inline double generate_sample(unsigned channel, unsigned sample, double amplitude)
+{
+  return amplitude * std::sin(0.01 * static_cast<double>(sample) + 0.7 * static_cast<double>(channel));
+};
+
+static bool write_trial(const ma::Node* root, const std::string& filepath, const std::string& format, const std::unordered_map<std::string,ma::Any>& options)
+{
+  ma::io::File file;
+  file.open(filepath.c_str(), ma::io::Mode::Out);
+  ma::io::HandlerWriter writer(&file, format);
+  writer.setOptions(options);
+  const bool result = writer.write(root);
+  file.close();
+  if (!result)
+    std::fprintf(stderr, "Impossible to write the file '%s': %s\n", filepath.c_str(), writer.errorMessage().c_str());
+  return result;
+};
+
+// Trial with markers, analog channels (sampled 10 times faster) and extra parameters
+static bool generate_c3d(const Configuration& cfg, const std::string& filepath, const std::unordered_map<std::string,ma::Any>& options)
+{
+  ma::Node root("root");
+  ma::Trial trial("bench", &root);
+  for (unsigned i = 0 ; i < cfg.Markers ; ++i)
+  {
+    auto ts = new ma::TimeSequence("M" + std::to_string(i), 4, cfg.Frames, point_rate, 0.0, ma::TimeSequence::Position, "mm", trial.timeSequences());
+    for (unsigned j = 0 ; j < cfg.Frames ; ++j)
+    {
+      for (unsigned k = 0 ; k < 3 ; ++k)
+        ts->data()[j + k * cfg.Frames] = generate_sample(i * 3 + k, j, 1000.0);
+      ts->data()[j + 3 * cfg.Frames] = (j % 97 == 0) ? -1.0 : 0.0; // Some occluded samples
+    }
+  }
+  const unsigned samples = cfg.Frames * analog_ratio;
+  for (unsigned i = 0 ; i < cfg.Analogs ; ++i)
+  {
+    auto ts = new ma::TimeSequence("A" + std::to_string(i), 1, samples, point_rate * analog_ratio, 0.0, ma::TimeSequence::Analog, "V", 1.0, 0.0, std::array<double,2>{{-10.0, 10.0}}, trial.timeSequences());
+    for (unsigned j = 0 ; j < samples ; ++j)
+      ts->data()[j] = generate_sample(i, j, 5.0);
+  }
+  for (unsigned i = 0 ; i < cfg.Parameters ; ++i)
+    trial.setProperty("BENCH:PARAMETER" + std::to_string(i), std::vector<float>(8, static_cast<float>(i)));
+  return write_trial(&root, filepath, "org.c3d", options);
+};
+
+// Compressed columnar file (lossless mode) with the content of the C3D trial (i.e. samples coming from single precision values)
+static bool generate_cta(const Configuration& cfg, const std::string& filepath)
+{
+  const std::string source = filepath + ".c3d";
+  ma::Node root("root");
+  const bool result = generate_c3d(cfg, source, {}) && ma::io::read(&root, source) && write_trial(&root, filepath, "openma.cta", {});
+  std::remove(source.c_str());
+  return result;
+};
+
+// HPF file with one channel information chunk and data chunks of 4096 samples per channel
+static bool generate_hpf(const Configuration& cfg, const std::string& filepath)
+{
+  const unsigned samples = cfg.Frames * analog_ratio;
+  const unsigned blockSamples = 4096;
+  Bytes bytes;
+  // Header chunk
+  bytes.put<int64_t>(0x1000);
+  bytes.put<int64_t>(28);
+  bytes.text("datx", 4);
+  bytes.put<int64_t>(0x10001);
+  // Channel information chunk
+  std::string xml = "<ChannelInformationData>";
+  for (unsigned i = 0 ; i < cfg.Analogs ; ++i)
+  {
+    xml += "<ChannelInformation><Name>A" + std::to_string(i) + "</Name><Unit>Volts</Unit>"
+           "<RequestedPerChannelSampleRate>" + std::to_string(point_rate * analog_ratio) + "</RequestedPerChannelSampleRate>"
+           "<DataType>Float</DataType><DataIndex>" + std::to_string(i) + "</DataIndex>"
+           "<RangeMin>-10</RangeMin><RangeMax>10</RangeMax></ChannelInformation>";
+  }
+  xml += "</ChannelInformationData>";
+  bytes.put<int64_t>(0x2000);
+  bytes.put<int64_t>(24 + xml.size());
+  bytes.put<int32_t>(0);
+  bytes.put<int32_t>(cfg.Analogs);
+  bytes.text(xml, xml.size());
+  // Data chunks
+  for (unsigned first = 0 ; first < samples ; first += blockSamples)
+  {
+    const unsigned num = std::min(blockSamples, samples - first);
+    const size_t headerSize = 32 + 8 * cfg.Analogs;
+    bytes.put<int64_t>(0x3000);
+    bytes.put<int64_t>(headerSize + 4 * num * cfg.Analogs);
+    bytes.put<int32_t>(0);
+    bytes.put<int64_t>(first);
+    bytes.put<int32_t>(cfg.Analogs);
+    for (unsigned i = 0 ; i < cfg.Analogs ; ++i)
+    {
+      bytes.put<uint32_t>(headerSize + 4 * num * i);
+      bytes.put<uint32_t>(4 * num);
+    }
+    for (unsigned i = 0 ; i < cfg.Analogs ; ++i)
+    {
+      for (unsigned j = 0 ; j < num ; ++j)
+        bytes.put(static_cast<float>(generate_sample(i, first + j, 5.0)));
+    }
+  }
+  return bytes.save(filepath);
+};
+
+// BSF file with one force platform (6 channels) for each group of 6 analog channels
+static bool generate_bsf(const Configuration& cfg, const std::string& filepath)
+{
+  const unsigned samples = cfg.Frames * analog_ratio;
+  const int32_t rate = static_cast<int32_t>(point_rate * analog_ratio);
+  const unsigned platforms = std::max(1u, cfg.Analogs / 6);
+  Bytes bytes;
+  // Main header
+  bytes.put<int32_t>(100);
+  const size_t headerSize = bytes.size();
+  bytes.put<int32_t>(0); // Updated below
+  bytes.put<int32_t>(platforms);
+  bytes.put<int32_t>(0); // Instruments
+  bytes.text("Bench", 100);
+  bytes.text("", 12); // Test date
+  bytes.text("", 12); // Date of birth
+  bytes.put(70.0); // Weight
+  bytes.put(1.75); // Height
+  bytes.text("M", 1);
+  bytes.fill(3);
+  bytes.put<int32_t>(1); // Trials
+  bytes.put((static_cast<double>(samples) + 0.5) / static_cast<double>(rate)); // Total time
+  bytes.put<int32_t>(7, 0); // Zero, weight, delay, trigger methods and values
+  bytes.put(0.0); // Trigger value
+  bytes.fill(4);
+  bytes.put<int32_t>(rate);
+  bytes.text("", 150); // Protocol
+  bytes.text("", 200); // Test type
+  bytes.text("", 150); // Comment file
+  bytes.text("", 150); // Trial description file
+  bytes.text("", 100); // Examiner name
+  bytes.fill(2);
+  bytes.put<int32_t>(1); // Metric units
+  bytes.set<int32_t>(headerSize, static_cast<int32_t>(bytes.size()));
+  // Instrument headers
+  for (unsigned i = 0 ; i < platforms ; ++i)
+  {
+    bytes.put<int32_t>(0); // Header size (not used)
+    bytes.put<int32_t>(i);
+    bytes.put<int32_t>(i);
+    bytes.text("FP" + std::to_string(i + 1), 20);
+    bytes.put<int32_t>(6);
+    bytes.put<int32_t>(4, 0); // Hardware and software channels
+    bytes.put(20.0f); // Length (inch)
+    bytes.put(18.0f); // Width (inch)
+    bytes.put<float>(3, 0.0f); // Offset
+    bytes.put<float>(32, 1.0f); // Sensitivity
+    for (int16_t j = 0 ; j < 32 ; ++j)
+    {
+      bytes.put<int16_t>(j < 6 ? j : 0);
+      bytes.fill(2);
+    }
+    bytes.put<float>(16, 0.0f); // Transformation
+    bytes.put(0.0f); // Inter distance
+    bytes.put(i == 0 ? 0.0f : 20.0f);
+    bytes.put(0.0f);
+    bytes.put<float>(32, 1000.0f); // Amplifier gain
+    bytes.put<float>(32, 10.0f); // Excitation voltage
+    bytes.put<float>(32, 3276.8f); // Acquisition card range
+    bytes.put<float>(5, 0.0f); // Zero, latency, trigger, end and post trigger times
+    bytes.put<int32_t>(32, 0); // Zero
+    bytes.put<int32_t>(rate);
+    bytes.put<float>(2, 0.0f); // Trigger and end values
+  }
+  // Interleaved samples
+  const unsigned channels = platforms * 6;
+  for (unsigned j = 0 ; j < samples ; ++j)
+  {
+    for (unsigned i = 0 ; i < channels ; ++i)
+      bytes.put(static_cast<int16_t>(generate_sample(i, j, 30000.0)));
+  }
+  return bytes.save(filepath);
+};
+
+static size_t file_size(const std::string& filepath)
+{
+  std::ifstream ifs(filepath, std::ios::binary | std::ios::ate);
+  return ifs ? static_cast<size_t>(ifs.tellg()) : 0;
+};
+
+// Throughput computed from the median time
+static void report(const ma::bench::Result& result, size_t bytes, unsigned frames)
+{
+  if ((result.Repetitions == 0) || (result.P50 <= 0.0))
+    return;
+  std::printf("%-32s %10s %9.1f MB/s %9.0f frames/s\n", "", "", static_cast<double>(bytes) / result.P50, static_cast<double>(frames) * 1.0e6 / result.P50);
+};
+
+struct Format
+{
+  std::string Name;
+  std::string Extension;
+  std::unordered_map<std::string,ma::Any> Options; // Used to generate and write C3D files
+};
+
+int main(int argc, char* argv[])
+{
+  // The options describing the generated files are extracted and the others are given to the harness:
+  //  - --markers N: number of markers (default: 50)
+  //  - --analogs N: number of analog channels (default: 32, rounded to a multiple of 6 for the BSF format)
+  //  - --frames N: number of point frames (default: 2000). The analog channels are sampled 10 times faster.
+  //  - --parameters N: number of extra parameters stored in the C3D files (default: 100)
+  //  - --directory DIR: directory where the files are generated (default: current directory)
+  Configuration cfg;
+  std::vector<char*> args{argv[0]};
+  for (int i = 1 ; i < argc ; ++i)
+  {
+    const std::string arg = argv[i];
+    const bool hasValue = (i + 1 < argc);
+    if (hasValue && (arg == "--markers"))
+      cfg.Markers = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+    else if (hasValue && (arg == "--analogs"))
+      cfg.Analogs = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+    else if (hasValue && (arg == "--frames"))
+      cfg.Frames = std::max(1u, static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10)));
+    else if (hasValue && (arg == "--parameters"))
+      cfg.Parameters = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+    else if (hasValue && (arg == "--directory"))
+      cfg.Directory = argv[++i];
+    else
+      args.push_back(argv[i]);
+  }
+  const char* extraUsage = "  --markers N      number of markers (default: 50)\n"
+                           "  --analogs N      number of analog channels (default: 32)\n"
+                           "  --frames N       number of point frames (default: 2000)\n"
+                           "  --parameters N   number of extra parameters stored in the C3D files (default: 100)\n"
+                           "  --directory DIR  directory where the files are generated (default: current directory)\n";
+  ma::bench::Harness harness(static_cast<int>(args.size()), args.data(), extraUsage);
+  
+  const std::vector<Format> formats{
+    {"c3d.float.le", "c3d", {{"byteOrder", std::string("IEEELittleEndian")}}},
+    {"c3d.float.be", "c3d", {{"byteOrder", std::string("IEEEBigEndian")}}},
+    {"c3d.float.vax", "c3d", {{"byteOrder", std::string("VAXLittleEndian")}}},
+    {"c3d.int.le", "c3d", {{"byteOrder", std::string("IEEELittleEndian")}, {"integerFormat", true}}},
+    {"c3d.int.be", "c3d", {{"byteOrder", std::string("IEEEBigEndian")}, {"integerFormat", true}}},
+    {"c3d.int.vax", "c3d", {{"byteOrder", std::string("VAXLittleEndian")}, {"integerFormat", true}}},
+    {"hpf", "hpf", {}},
+    {"bsf", "bsf", {}},
+    {"cta", "cta", {}},
+  };
+  int status = EXIT_SUCCESS;
+  std::vector<std::string> generated;
+  ma::bench::Result reference{"", 0u, 0u, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0}; // Timing of the C3D reader compared with the columnar format
+  for (const auto& format : formats)
+  {
+    const std::string input = cfg.Directory + "/io_bench_" + format.Name + "." + format.Extension;
+    const std::string output = cfg.Directory + "/io_bench_" + format.Name + ".out." + format.Extension;
+    bool ok = false;
+    if (format.Extension == "c3d")
+      ok = generate_c3d(cfg, input, format.Options);
+    else if (format.Extension == "hpf")
+      ok = generate_hpf(cfg, input);
+    else if (format.Extension == "cta")
+      ok = generate_cta(cfg, input);
+    else
+      ok = generate_bsf(cfg, input);
+    generated.push_back(input);
+    if (!ok)
+    {
+      std::fprintf(stderr, "Impossible to generate the file '%s'\n", input.c_str());
+      status = EXIT_FAILURE;
+      continue;
+    }
+    // The generated file must be readable before to be timed
+    ma::Node source("source");
+    if (!ma::io::read(&source, input))
+    {
+      std::fprintf(stderr, "Impossible to read the generated file '%s'\n", input.c_str());
+      status = EXIT_FAILURE;
+      continue;
+    }
+    const size_t bytes = file_size(input);
+    const unsigned frames = ((format.Extension == "c3d") || (format.Extension == "cta")) ? cfg.Frames : cfg.Frames * analog_ratio;
+    const auto read = harness.run(format.Name + ".read", frames, [&](){
+      ma::Node root("root");
+      ma::bench::do_not_optimize(ma::io::read(&root, input));
+    });
+    report(read, bytes, frames);
+    // The decoding of the lossless blocks is expected to stay in the same range than the C3D reader
+    if ((format.Extension == "cta") && (reference.P50 > 0.0) && (read.P50 > 0.0))
+      std::printf("%-32s %10s %9.2fx c3d.float.le.read\n", "", "", read.P50 / reference.P50);
+    else if (format.Name == "c3d.float.le")
+      reference = read;
+    report(harness.run(format.Name + ".metadata", frames, [&](){
+      ma::Node root("root");
+      ma::bench::do_not_optimize(ma::io::read_metadata(&root, input));
+    }), bytes, frames);
+    // Only the C3D writer is timed
+    if (format.Extension != "c3d")
+      continue;
+    generated.push_back(output);
+    report(harness.run(format.Name + ".write", frames, [&](){
+      ma::bench::do_not_optimize(write_trial(&source, output, "org.c3d", format.Options));
+    }), bytes, frames);
+    report(harness.run(format.Name + ".roundtrip", frames, [&](){
+      ma::Node first("first"), second("second");
+      ma::io::read(&first, input);
+      write_trial(&first, output, "org.c3d", format.Options);
+      ma::bench::do_not_optimize(ma::io::read(&second, output));
+    }), bytes, frames);
+  }
+  for (const auto& filepath : generated)
+    std::remove(filepath.c_str());
+  const int regression = harness.finish();
+  return (status != EXIT_SUCCESS) ? status : regression;
+};
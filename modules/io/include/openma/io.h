@@ -38,6 +38,7 @@
 #include "openma/io_export.h"
 #include "openma/io/binarystream.h"
 #include "openma/io/buffer.h"
+#include "openma/io/c3dstreamwriter.h"
 #include "openma/io/device.h"
 #include "openma/io/enums.h"
 #include "openma/io/file.h"
@@ -45,15 +46,46 @@
 #include "openma/io/handlerplugin.h"
 #include "openma/io/handlerreader.h"
 #include "openma/io/handlerwriter.h"
+#include "openma/io/prefetcher.h"
+#include "openma/io/snapshot.h"
+#include "openma/io/trialcache.h"
+#include "openma/base/any.h"
 
 #include <string>
+#include <unordered_map>
+#include <vector>
+#include <functional>
 
 namespace ma
 {
 namespace io
 {
+  struct OPENMA_IO_EXPORT ReadResult
+  {
+    std::string Path;
+    bool Success = false;
+    Error ErrorCode = Error::None;
+    std::string ErrorMessage;
+    std::vector<Node*> Nodes;
+  };
+  
+  struct OPENMA_IO_EXPORT ReadOptions
+  {
+    std::string Format;
+    std::unordered_map<std::string, Any> Options;
+    unsigned Threads = 0;
+    size_t MemoryBudget = 0;
+    std::function<bool(ReadResult&)> Completed;
+  };
+  
   OPENMA_IO_EXPORT bool read(Node* root, const std::string& filepath, const std::string& format = std::string{});
+  OPENMA_IO_EXPORT bool read(Node* root, const std::string& filepath, const std::string& format, const std::unordered_map<std::string, Any>& options);
+  OPENMA_IO_EXPORT bool read(Node* root, const std::string& filepath, const std::string& format, const std::unordered_map<std::string, Any>& options, Prefetcher* prefetcher);
   OPENMA_IO_EXPORT Node* read(const std::string& filepath, const std::string& format = std::string{});
+  OPENMA_IO_EXPORT bool read_metadata(Node* root, const std::string& filepath, const std::string& format = std::string{});
+  OPENMA_IO_EXPORT Node* read_metadata(const std::string& filepath, const std::string& format = std::string{});
+  OPENMA_IO_EXPORT std::vector<ReadResult> read_many(const std::vector<std::string>& paths, Node* root, const ReadOptions& options = ReadOptions{});
+  OPENMA_IO_EXPORT std::vector<std::string> detect_format(const std::vector<std::string>& paths);
   OPENMA_IO_EXPORT bool write(const Node* const root, const std::string& filepath, const std::string& format = std::string{});
 };
 };
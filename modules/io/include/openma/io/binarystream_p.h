@@ -80,6 +80,8 @@ namespace io
     ByteOrderConverter& operator=(const ByteOrderConverter& ) = delete;
     ByteOrderConverter& operator=(ByteOrderConverter&& ) _OPENMA_NOEXCEPT = delete;
     
+    static ByteOrderConverter* create(ByteOrder order);
+    
     virtual ByteOrder byteOrder() const _OPENMA_NOEXCEPT = 0;
     
     char readChar(Device* src) const;
@@ -95,6 +97,15 @@ namespace io
     virtual double readDouble(Device* src) const = 0;
     std::string readString(size_t len, Device* src) const;
     
+    void readI16(size_t n, int16_t* values, Device* src) const;
+    void readU16(size_t n, uint16_t* values, Device* src) const;
+    void readI32(size_t n, int32_t* values, Device* src) const;
+    void readU32(size_t n, uint32_t* values, Device* src) const;
+    void readI64(size_t n, int64_t* values, Device* src) const;
+    void readU64(size_t n, uint64_t* values, Device* src) const;
+    void readFloat(size_t n, float* values, Device* src) const;
+    void readDouble(size_t n, double* values, Device* src) const;
+    
     void writeChar(char val, Device* dest) const;
     void writeI8(int8_t val, Device* dest) const;
     void writeU8(uint8_t val, Device* dest) const;
@@ -110,6 +121,13 @@ namespace io
     virtual void writeDouble(double val, Device* dest) const = 0;
      */
     
+    // Conversion of raw blocks of data from this byte order to the one of the host (only valid when the host architecture is IEEE little endian). The source and the destination can be the same (in place conversion).
+    virtual void convert16(size_t n, const char* src, char* dst) const = 0;
+    virtual void convert32(size_t n, const char* src, char* dst) const = 0;
+    virtual void convert64(size_t n, const char* src, char* dst) const = 0;
+    virtual void convertFloat(size_t n, const char* src, char* dst) const = 0;
+    virtual void convertDouble(size_t n, const char* src, char* dst) const = 0;
+    
   protected:
     ByteOrderConverter();
   };
@@ -141,6 +159,12 @@ namespace io
     virtual void writeI32(int32_t val, Device* dest) const final;
     virtual void writeU32(uint32_t val, Device* dest) const final;
     virtual void writeFloat(float val, Device* dest) const final;
+    
+    virtual void convert16(size_t n, const char* src, char* dst) const final;
+    virtual void convert32(size_t n, const char* src, char* dst) const final;
+    virtual void convert64(size_t n, const char* src, char* dst) const final;
+    virtual void convertFloat(size_t n, const char* src, char* dst) const final;
+    virtual void convertDouble(size_t n, const char* src, char* dst) const final;
   };
 
   class IEEELittleEndianConverter : public ByteOrderConverter
@@ -170,6 +194,12 @@ namespace io
     virtual void writeI32(int32_t val, Device* dest) const final;
     virtual void writeU32(uint32_t val, Device* dest) const final;
     virtual void writeFloat(float val, Device* dest) const final;
+    
+    virtual void convert16(size_t n, const char* src, char* dst) const final;
+    virtual void convert32(size_t n, const char* src, char* dst) const final;
+    virtual void convert64(size_t n, const char* src, char* dst) const final;
+    virtual void convertFloat(size_t n, const char* src, char* dst) const final;
+    virtual void convertDouble(size_t n, const char* src, char* dst) const final;
   };
 
   class IEEEBigEndianConverter : public ByteOrderConverter
@@ -199,6 +229,12 @@ namespace io
     virtual void writeI32(int32_t val, Device* dest) const final;
     virtual void writeU32(uint32_t val, Device* dest) const final;
     virtual void writeFloat(float val, Device* dest) const final;
+    
+    virtual void convert16(size_t n, const char* src, char* dst) const final;
+    virtual void convert32(size_t n, const char* src, char* dst) const final;
+    virtual void convert64(size_t n, const char* src, char* dst) const final;
+    virtual void convertFloat(size_t n, const char* src, char* dst) const final;
+    virtual void convertDouble(size_t n, const char* src, char* dst) const final;
   };
 };
 };
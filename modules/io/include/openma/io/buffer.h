@@ -62,6 +62,7 @@ namespace io
     void open(const char* data, size_t dataSize, bool owned = false);
     void open(char* data, size_t dataSize, Mode mode = Mode::In, bool owned = false);
     void open(char* data, size_t dataSize, const std::vector<size_t>& chunkIds, size_t chunkSize, Mode mode = Mode::In, bool owned = false);
+    void open(Mode mode = Mode::Out, size_t capacity = 0);
     virtual bool isOpen() const _OPENMA_NOEXCEPT override;
     virtual void close() override;
     virtual Size peek(char* s, Size n) const override;
@@ -72,6 +73,10 @@ namespace io
     virtual bool isSequential() const _OPENMA_NOEXCEPT override;
     virtual const char* data() const _OPENMA_NOEXCEPT override;
     virtual Size size() const _OPENMA_NOEXCEPT override;
+    virtual const char* consume(Size n) override;
+    
+    Size capacity() const _OPENMA_NOEXCEPT;
+    char* release(Size* size = nullptr);
     
     using Device::setName;
     
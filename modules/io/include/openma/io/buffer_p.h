@@ -74,6 +74,7 @@ namespace io
     ~ChunkBuffer() _OPENMA_NOEXCEPT {this->close();};
     
     ChunkBuffer* open(char* data, size_t dataSize, const std::vector<size_t>& chunkIds, size_t chunkSize, Mode mode, bool owned) _OPENMA_NOEXCEPT;
+    ChunkBuffer* open(size_t capacity, Mode mode) _OPENMA_NOEXCEPT;
     bool isOpen() const _OPENMA_NOEXCEPT {return this->mp_Data != 0;};
     ChunkBuffer* close() _OPENMA_NOEXCEPT;
 
@@ -81,10 +82,14 @@ namespace io
     
     Size dataSize() const _OPENMA_NOEXCEPT {return this->m_DataSize;};
     const char* data() const _OPENMA_NOEXCEPT {return this->mp_Data;};
+    Size capacity() const _OPENMA_NOEXCEPT {return this->m_Capacity;};
+    bool isGrowable() const _OPENMA_NOEXCEPT {return this->m_Growable;};
+    char* release() _OPENMA_NOEXCEPT;
     
     Size peek(char* s, Size n) const _OPENMA_NOEXCEPT;
     Size read(char* s, Size n) _OPENMA_NOEXCEPT;
     Size write(const char* s, Size n) _OPENMA_NOEXCEPT;
+    const char* consume(Size n) _OPENMA_NOEXCEPT;
     
     Position seek(Offset off, Origin whence) _OPENMA_NOEXCEPT;
     
@@ -95,9 +100,17 @@ namespace io
     bool updateChunkOffset(Offset* dataOffset, Offset* chunkOffset) const;
     
   private:
+    Size copy(char* s, Offset dataOffset, Size n) const _OPENMA_NOEXCEPT;
+    bool reserve(Size size) _OPENMA_NOEXCEPT;
+    void updateLayout() _OPENMA_NOEXCEPT;
+    
+
     char* mp_Data;
     bool m_DataOwned;
     Size m_DataSize;
+    Size m_Capacity;
+    bool m_Contiguous;
+    bool m_Growable;
     std::vector<size_t> m_ChunkIds;
     Size m_ChunkSize;
     Offset m_ChunkOffset;
@@ -0,0 +1,92 @@
+/* 
+ * Open Source Movement Analysis Library
+ * Copyright (C) 2016, Moveck Solution Inc., all rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 
+ *     * Redistributions of source code must retain the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer.
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials
+ *       provided with the distribution.
+ *     * Neither the name(s) of the copyright holders nor the names
+ *       of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written
+ *       permission.
+ *  
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __openma_io_c3dstreamwriter_h
+#define __openma_io_c3dstreamwriter_h
+
+#include "openma/io_export.h"
+#include "openma/base/opaque.h"
+#include "openma/base/macros.h" // _OPENMA_NOEXCEPT
+
+#include <memory> // std::unique_ptr
+#include <string>
+#include <vector>
+
+namespace ma
+{
+  class Trial;
+  
+namespace io
+{
+  class Device;
+  enum class Error;
+  
+  class C3DStreamWriterPrivate;
+  
+  class OPENMA_IO_EXPORT C3DStreamWriter
+  {
+    OPENMA_DECLARE_PIMPL_ACCESSOR(C3DStreamWriter)
+    
+  public:
+    C3DStreamWriter(Device* device = nullptr);
+    ~C3DStreamWriter();
+    
+    C3DStreamWriter(const C3DStreamWriter& ) = delete;
+    C3DStreamWriter(C3DStreamWriter&& ) _OPENMA_NOEXCEPT = delete;
+    C3DStreamWriter& operator=(const C3DStreamWriter& ) = delete;
+    C3DStreamWriter& operator=(const C3DStreamWriter&& ) _OPENMA_NOEXCEPT = delete;
+    
+    void setDevice(Device* device);
+    
+    bool open(const Trial* schema);
+    bool append(const Trial* schema);
+    bool appendFrames(size_t num, const double* points, const double* analogs);
+    bool close();
+    bool isOpen() const _OPENMA_NOEXCEPT;
+    
+    size_t frames() const _OPENMA_NOEXCEPT;
+    const std::vector<std::string>& pointLabels() const _OPENMA_NOEXCEPT;
+    const std::vector<std::string>& analogLabels() const _OPENMA_NOEXCEPT;
+    unsigned analogSamplesPerFrame() const _OPENMA_NOEXCEPT;
+    
+    Error errorCode() const _OPENMA_NOEXCEPT;
+    const std::string& errorMessage() const _OPENMA_NOEXCEPT;
+    
+  private:
+    std::unique_ptr<C3DStreamWriterPrivate> mp_Pimpl;
+  };
+};
+};
+
+#endif // __openma_io_c3dstreamwriter_h
@@ -100,6 +100,8 @@ namespace io
     virtual Position tell() const _OPENMA_NOEXCEPT = 0;
     virtual const char* data() const _OPENMA_NOEXCEPT = 0;
     virtual Size size() const _OPENMA_NOEXCEPT = 0;
+    virtual const char* consume(Size n);
+    virtual void advise(Advice advice, Offset offset, Size n);
     
     // Sequential IO only
     virtual bool isSequential() const _OPENMA_NOEXCEPT = 0;
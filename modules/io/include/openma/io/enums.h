@@ -168,6 +168,34 @@ namespace io
     return static_cast<State>(static_cast<int>(lhs) | static_cast<int>(rhs));
   };
   
+  enum class Advice : int {Normal, Sequential, Random, WillNeed, DontNeed};
+  
+  /**
+   * @enum Advice
+   * Access pattern expected on a region of a random access device (see Device::advise()).
+   * @ingroup openma_io
+   */
+  /**
+   * @var Advice Advice::Normal
+   * No specific access pattern. This is the default behaviour of the device.
+   */
+  /**
+   * @var Advice Advice::Sequential
+   * The region will be read from its begining to its end. Pages can be read ahead aggressively and released once read.
+   */
+  /**
+   * @var Advice Advice::Random
+   * The region will be accessed in random order. Read ahead is not useful.
+   */
+  /**
+   * @var Advice Advice::WillNeed
+   * The region will be accessed soon. The pages can be loaded in advance.
+   */
+  /**
+   * @var Advice Advice::DontNeed
+   * The region will not be accessed anymore in the near future.
+   */
+  
   // ----------------------------------------------------------------------- //
   
   enum class ByteOrder : int
@@ -50,6 +50,7 @@ namespace io
     
   public:
     static bool exists(const char* filepath);
+    static bool prefetch(const char* filepath, Offset offset = 0, Size n = -1);
     
     File();
     ~File() _OPENMA_NOEXCEPT;
@@ -70,6 +71,8 @@ namespace io
     virtual bool isSequential() const _OPENMA_NOEXCEPT override;
     virtual const char* data() const _OPENMA_NOEXCEPT override;
     virtual Size size() const _OPENMA_NOEXCEPT override;
+    virtual const char* consume(Size n) override;
+    virtual void advise(Advice advice, Offset offset, Size n) override;
   };
 };
 };
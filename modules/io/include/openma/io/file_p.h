@@ -103,11 +103,13 @@ namespace io
     Size peek(char* s, Size n) const _OPENMA_NOEXCEPT;
     Size read(char* s, Size n) _OPENMA_NOEXCEPT;
     Size write(const char* s, Size n) _OPENMA_NOEXCEPT;
+    const char* consume(Size n) _OPENMA_NOEXCEPT;
+    bool advise(Advice advice, Offset off, Size n) _OPENMA_NOEXCEPT;
     
     Position seek(Offset off, Origin whence) _OPENMA_NOEXCEPT;
     
     MemoryMappedBuffer* map() _OPENMA_NOEXCEPT;
-    MemoryMappedBuffer* resizeMap() _OPENMA_NOEXCEPT;
+    MemoryMappedBuffer* resizeMap(Size minimum = 0) _OPENMA_NOEXCEPT;
     
     static int granularity() _OPENMA_NOEXCEPT;
     
@@ -39,9 +39,11 @@
 #include "openma/base/opaque.h"
 #include "openma/base/macros.h" // _OPENMA_CONSTEXPR, _OPENMA_NOEXCEPT
 #include "openma/base/exception.h"
+#include "openma/base/any.h"
 
 #include <string>
 #include <memory> // std::unique_ptr
+#include <unordered_map>
 
 namespace ma
 {
@@ -80,6 +82,9 @@ namespace io
     Device* device() const _OPENMA_NOEXCEPT;
     void setDevice(Device* device) _OPENMA_NOEXCEPT;
     
+    const std::unordered_map<std::string, Any>& options() const _OPENMA_NOEXCEPT;
+    void setOptions(const std::unordered_map<std::string, Any>& options);
+    
     Error errorCode() const _OPENMA_NOEXCEPT;
     const std::string& errorMessage() const _OPENMA_NOEXCEPT;
   
@@ -42,15 +42,21 @@
 
 #include "openma/io/handler.h"
 #include "openma/base/macros.h" // _OPENMA_NOEXCEPT
+#include "openma/base/any.h"
 
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 namespace ma
 {
+  class Node;
+  
 namespace io
 {
   class Device;
   enum class Error;
+  enum class ByteOrder;
   
   class HandlerPrivate
   {
@@ -66,6 +72,33 @@ namespace io
     Device* Source;
     Error ErrorCode;
     std::string ErrorMessage;
+    std::unordered_map<std::string, Any> Options;
+    
+    static size_t decodingThreads(const std::unordered_map<std::string,Any>& options, size_t items, size_t itemSize);
+    static void decodeInterleavedI16(const char* data, ByteOrder order, size_t frames, size_t channels, double* const* planes, const double* scales);
+  };
+  
+  class ReadSelection
+  {
+  public:
+    using StoredSamples = unsigned;
+    
+    static void setStoredSamples(Node* ts, size_t samples);
+    
+    ReadSelection(const std::unordered_map<std::string, Any>& options);
+    
+    bool isSelected(const std::string& name, int type) const _OPENMA_NOEXCEPT;
+    bool selectsAll() const _OPENMA_NOEXCEPT;
+    bool metadataOnly() const _OPENMA_NOEXCEPT;
+    void frames(size_t num, size_t* first, size_t* count) const _OPENMA_NOEXCEPT;
+    
+  private:
+    std::vector<std::string> Channels;
+    bool HasChannels;
+    int Types;
+    int FirstFrame;
+    int LastFrame;
+    bool Metadata;
   };
 };
 };
@@ -38,10 +38,12 @@
 #include "openma/io_export.h"
 #include "openma/base/opaque.h"
 #include "openma/base/macros.h"
+#include "openma/base/any.h"
 
 #include <memory> // std::unique_ptr
 #include <string>
 #include <vector>
+#include <unordered_map>
 
 namespace ma
 {
@@ -67,6 +69,9 @@ namespace io
     void setFormat(const std::string& format);
     const std::string& format() const _OPENMA_NOEXCEPT;
     
+    const std::unordered_map<std::string, Any>& options() const _OPENMA_NOEXCEPT;
+    void setOptions(const std::unordered_map<std::string, Any>& options);
+    
     bool canRead();
     bool read(Node* root);
     
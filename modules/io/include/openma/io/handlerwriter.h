@@ -38,9 +38,11 @@
 #include "openma/io_export.h"
 #include "openma/base/opaque.h"
 #include "openma/base/macros.h"
+#include "openma/base/any.h"
 
 #include <memory> // std::unique_ptr
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 namespace ma
@@ -66,6 +68,8 @@ namespace io
     void setDevice(Device* device);
     void setFormat(const std::string& format);
     const std::string& format() const _OPENMA_NOEXCEPT;
+    const std::unordered_map<std::string, Any>& options() const _OPENMA_NOEXCEPT;
+    void setOptions(const std::unordered_map<std::string, Any>& options);
     
     bool canWrite();
     bool write(const Node* const root);
@@ -0,0 +1,83 @@
+/* 
+ * Open Source Movement Analysis Library
+ * Copyright (C) 2016, Moveck Solution Inc., all rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 
+ *     * Redistributions of source code must retain the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer.
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials
+ *       provided with the distribution.
+ *     * Neither the name(s) of the copyright holders nor the names
+ *       of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written
+ *       permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __openma_io_prefetcher_h
+#define __openma_io_prefetcher_h
+
+#include "openma/io_export.h"
+#include "openma/base/opaque.h"
+#include "openma/base/macros.h" // _OPENMA_NOEXCEPT
+
+#include <memory> // std::unique_ptr
+#include <string>
+#include <vector>
+
+namespace ma
+{
+namespace io
+{
+  class PrefetcherPrivate;
+  
+  class OPENMA_IO_EXPORT Prefetcher
+  {
+    OPENMA_DECLARE_PIMPL_ACCESSOR(Prefetcher)
+    
+  public:
+    Prefetcher(size_t depth = 2);
+    ~Prefetcher() _OPENMA_NOEXCEPT;
+    
+    Prefetcher(const Prefetcher& ) = delete;
+    Prefetcher(Prefetcher&& ) _OPENMA_NOEXCEPT = delete;
+    Prefetcher& operator=(const Prefetcher& ) = delete;
+    Prefetcher& operator=(const Prefetcher&& ) _OPENMA_NOEXCEPT = delete;
+    
+    size_t depth() const _OPENMA_NOEXCEPT;
+    void setDepth(size_t depth);
+    
+    void enqueue(const std::string& filepath);
+    void enqueue(const std::vector<std::string>& filepaths);
+    void advance(const std::string& filepath);
+    void clear();
+    void wait();
+    
+    size_t pending() const;
+    size_t prefetched() const;
+    
+  private:
+    std::unique_ptr<PrefetcherPrivate> mp_Pimpl;
+  };
+};
+};
+
+#endif // __openma_io_prefetcher_h
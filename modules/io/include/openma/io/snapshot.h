@@ -0,0 +1,81 @@
+/* 
+ * Open Source Movement Analysis Library
+ * Copyright (C) 2016, Moveck Solution Inc., all rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 
+ *     * Redistributions of source code must retain the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer.
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials
+ *       provided with the distribution.
+ *     * Neither the name(s) of the copyright holders nor the names
+ *       of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written
+ *       permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __openma_io_snapshot_h
+#define __openma_io_snapshot_h
+
+#include "openma/io_export.h"
+#include "openma/base/typeid.h"
+
+#include <string>
+#include <typeinfo>
+#include <type_traits>
+
+namespace ma
+{
+  class Node;
+  
+namespace io
+{
+  struct SnapshotEncoder;
+  struct SnapshotDecoder;
+  
+  using SnapshotCreateFunction = Node* (*)(const std::string& name, SnapshotDecoder* decoder);
+  using SnapshotEncodeFunction = void (*)(const Node* node, SnapshotEncoder* encoder);
+  
+  OPENMA_IO_EXPORT bool register_snapshot_node_type(const char* tag, typeid_t id, const std::type_info& type, SnapshotCreateFunction create, SnapshotEncodeFunction encode = nullptr);
+  
+  template <typename T> bool register_snapshot_node_type(const char* tag, SnapshotCreateFunction create, SnapshotEncodeFunction encode = nullptr);
+};
+};
+
+namespace ma
+{
+namespace io
+{
+  /**
+   * Convenient function to register the type @a T in the snapshot format. The identifier and the type information are deduced from @a T.
+   * @relates SnapshotHandler
+   * @ingroup openma_io
+   */
+  template <typename T>
+  inline bool register_snapshot_node_type(const char* tag, SnapshotCreateFunction create, SnapshotEncodeFunction encode)
+  {
+    static_assert(std::is_base_of<Node,T>::value, "The registered type must derive from ma::Node.");
+    return register_snapshot_node_type(tag, static_typeid<T>(), typeid(T), create, encode);
+  };
+};
+};
+
+#endif // __openma_io_snapshot_h
@@ -0,0 +1,86 @@
+/* 
+ * Open Source Movement Analysis Library
+ * Copyright (C) 2016, Moveck Solution Inc., all rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 
+ *     * Redistributions of source code must retain the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer.
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials
+ *       provided with the distribution.
+ *     * Neither the name(s) of the copyright holders nor the names
+ *       of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written
+ *       permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __openma_io_trialcache_h
+#define __openma_io_trialcache_h
+
+#include "openma/io_export.h"
+#include "openma/base/any.h"
+#include "openma/base/opaque.h"
+#include "openma/base/macros.h" // _OPENMA_NOEXCEPT
+
+#include <memory> // std::unique_ptr
+#include <string>
+#include <unordered_map>
+#include <functional>
+
+namespace ma
+{
+  class Node;
+  
+namespace io
+{
+  class TrialCachePrivate;
+  
+  class OPENMA_IO_EXPORT TrialCache
+  {
+    OPENMA_DECLARE_PIMPL_ACCESSOR(TrialCache)
+    
+  public:
+    TrialCache(const std::string& directory);
+    ~TrialCache() _OPENMA_NOEXCEPT;
+    
+    TrialCache(const TrialCache& ) = delete;
+    TrialCache(TrialCache&& ) _OPENMA_NOEXCEPT = delete;
+    TrialCache& operator=(const TrialCache& ) = delete;
+    TrialCache& operator=(const TrialCache&& ) _OPENMA_NOEXCEPT = delete;
+    
+    const std::string& directory() const _OPENMA_NOEXCEPT;
+    
+    bool read(Node* root, const std::string& filepath, const std::string& format = std::string{}, const std::unordered_map<std::string, Any>& options = std::unordered_map<std::string, Any>{});
+    bool process(Node* root, const std::string& step, const std::unordered_map<std::string, Any>& parameters, const std::function<bool(Node*)>& fn);
+    
+    bool isTracked(const Node* root) const;
+    void forget(const Node* root);
+    
+    size_t hits() const;
+    size_t misses() const;
+    
+  private:
+    std::unique_ptr<TrialCachePrivate> mp_Pimpl;
+  };
+};
+};
+
+#endif // __openma_io_trialcache_h
@@ -55,6 +55,7 @@
 #include <array>
 #include <memory> // std::unique_ptr
 #include <functional> // std::function
+#include <algorithm> // std::min, std::max
 #include <cassert>
 
 // -------------------------------------------------------------------------- //
@@ -269,7 +270,11 @@ namespace io
     }
     Trial* trial = new Trial(strip_path(this->device()->name()),output);
     unsigned samples = static_cast<unsigned>(totalTimeTrial * static_cast<double>(rate));
-    auto tss = make_nodes<TimeSequence*>(totalNumberOfChannels, 1, samples, static_cast<double>(rate), 0.0, TimeSequence::Analog, "V", trial->timeSequences());
+    // Selection of the frames and channels to extract (see HandlerReader::setOptions()). The samples are allocated only once the channels are known.
+    const ReadSelection selection(this->options());
+    size_t firstFrame = 0, frames = 0;
+    selection.frames(samples, &firstFrame, &frames);
+    auto tss = make_nodes<TimeSequence*>(totalNumberOfChannels, 1, 0, static_cast<double>(rate), 0.0, TimeSequence::Analog, "V", trial->timeSequences());
     std::string forceUnit, momentUnit;
 //     if (units == 0) // english
 //     {
@@ -363,7 +368,8 @@ namespace io
       for (unsigned j = 0 ; j < fp->channelsNumberRequired() ; ++j)
       {
         assert((channelIndices[j] >= 0) && (static_cast<unsigned>(channelIndices[j]) < tss.size()));
-        fp->setChannel(j, tss[channelIndices[j]]);
+        auto ts = tss[channelIndices[j]];
+        fp->setChannel(j, selection.isSelected(ts->name(), ts->type()) ? ts : nullptr);
       }
       fp->setGeometry(std::array<double,3>{{origin[0],origin[1],origin[2]}},
                       std::array<double,3>{{corners[0],corners[1],corners[2]}},
@@ -374,11 +380,48 @@ namespace io
     }
     // Data
     // Note: We want the reaction of the measure, so all the data are multiplied by -1.
-    for (unsigned i = 0 ; i < samples ; ++i)
+    // Unselected channels are removed and their samples are not decoded. The frames before the selected range are skipped.
+    std::vector<double*> values(tss.size(), nullptr);
+    for (size_t i = 0 ; i < tss.size() ; ++i)
     {
-      int inc = 0;
-      for (auto ts : tss)
-        ts->data()[i] = -1.0 * static_cast<double>(stream.readI16()) * scale[inc++];
+      if (!selection.isSelected(tss[i]->name(), tss[i]->type()))
+      {
+        delete tss[i];
+        continue;
+      }
+      tss[i]->resize(frames);
+      tss[i]->setStartTime(static_cast<double>(firstFrame) / tss[i]->sampleRate());
+      if (selection.metadataOnly())
+        ReadSelection::setStoredSamples(tss[i], samples);
+      values[i] = tss[i]->data();
+    }
+    if (frames == 0)
+      return;
+    this->device()->seek(firstFrame * totalNumberOfChannels * 2, Origin::Current);
+    this->device()->advise(Advice::Sequential, this->device()->tell(), -1);
+    // The interleaved samples are decoded in bulk and de-interleaved directly into each time sequence.
+    std::vector<double> scales(values.size());
+    for (size_t j = 0 ; j < values.size() ; ++j)
+      scales[j] = -1.0 * scale[j];
+    const size_t frameSize = values.size() * 2;
+    // Zero-copy when the device gives a direct access to its content (e.g. memory mapped file)
+    const char* data = this->device()->consume(frames * frameSize);
+    if (data != nullptr)
+      HandlerPrivate::decodeInterleavedI16(data, ByteOrder::IEEELittleEndian, frames, values.size(), values.data(), scales.data());
+    else
+    {
+      // Otherwise the data are read by blocks of about 1 MB
+      const size_t blockFrames = std::max<size_t>(1, (1 << 20) / frameSize);
+      std::vector<char> block(std::min(blockFrames, frames) * frameSize);
+      std::vector<double*> planes(values.size(), nullptr);
+      for (size_t first = 0 ; first < frames ; first += blockFrames)
+      {
+        const size_t num = std::min(blockFrames, frames - first);
+        this->device()->read(block.data(), num * frameSize);
+        for (size_t j = 0 ; j < values.size() ; ++j)
+          planes[j] = (values[j] != nullptr) ? values[j] + first : nullptr;
+        HandlerPrivate::decodeInterleavedI16(block.data(), ByteOrder::IEEELittleEndian, num, values.size(), planes.data(), scales.data());
+      }
     }
   };
 };
@@ -34,150 +34,421 @@
 
 #include "c3ddatastream.h"
 #include "openma/config.h" // _OPENMA_ARCH, _OPENMA_IEEE_BE
-#include "openma/io/binarystream.h"
+#include "openma/io/enums.h"
 
+#include <algorithm> // std::min, std::max
 #include <cmath> // fabs
+#include <cstdint>
 #include <cstring> // memcpy
+#include <limits>
 
-namespace ma
-{
-namespace io
+// NOTE: The next functions decode one word of the data section. The byte order is known at compile time, so the tests on it are removed by the compiler. The conversions are the same than the ones realized by the byte order converters used by the class BinaryStream.
+
+template <ma::io::ByteOrder O>
+inline uint16_t _ma_io_c3d_decode_u16(const char* word)
 {
-  // ------------------------------------------------------------------------ //
-  
-  C3DDataStream::C3DDataStream(BinaryStream* raw)
-  : Raw(raw)
-  {};
-  
-  C3DDataStream::~C3DDataStream() = default;
-  
-  // ------------------------------------------------------------------------ //
-  
-  C3DDataStreamSignedInteger::C3DDataStreamSignedInteger(BinaryStream* raw)
-  : C3DDataStream(raw)
-  {};
-  
-  C3DDataStreamSignedInteger::~C3DDataStreamSignedInteger() = default;
-  
-  void C3DDataStreamSignedInteger::readPoint(double* x, double* y, double* z, double* residual, double pointScaleFactor)
-  {
-    int8_t byteptr[2];
-    int16_t residualAndMask;
-    *x = this->Raw->readI16() * pointScaleFactor;
-    *y = this->Raw->readI16() * pointScaleFactor;
-    *z = this->Raw->readI16() * pointScaleFactor;
-    residualAndMask = this->Raw->readI16();
-    memcpy(&byteptr, &residualAndMask, sizeof(byteptr));
+  uint16_t value;
+  memcpy(&value, word, 2);
 #if _OPENMA_ARCH == _OPENMA_IEEE_BE
-    *residual = (byteptr[0] >= 0) ? static_cast<double>(byteptr[1]) * pointScaleFactor : -1;
+  const bool swap = (O != ma::io::ByteOrder::IEEEBigEndian);
 #else
-    *residual = (byteptr[1] >= 0) ? static_cast<double>(byteptr[0]) * pointScaleFactor : -1;
+  const bool swap = (O == ma::io::ByteOrder::IEEEBigEndian);
 #endif
-  };
-  
-  double C3DDataStreamSignedInteger::readAnalog()
+  return swap ? static_cast<uint16_t>((value >> 8) | (value << 8)) : value;
+};
+
+template <ma::io::ByteOrder O>
+inline int16_t _ma_io_c3d_decode_i16(const char* word)
+{
+  const uint16_t value = _ma_io_c3d_decode_u16<O>(word);
+  int16_t result;
+  memcpy(&result, &value, 2);
+  return result;
+};
+
+template <ma::io::ByteOrder O>
+inline float _ma_io_c3d_decode_float(const char* word)
+{
+  char temp[4];
+  if (O == ma::io::ByteOrder::Native)
+    memcpy(temp, word, 4);
+#if _OPENMA_ARCH == _OPENMA_IEEE_BE
+  else if (O == ma::io::ByteOrder::VAXLittleEndian)
   {
-    return static_cast<double>(this->Raw->readI16());
-  };
-  
-  void C3DDataStreamSignedInteger::writePoint(double x, double y, double z, double residual, double pointScaleFactor)
-  {
-    int8_t byteptr[2];
-    int16_t residualAndMask; 
-#if defined(_MSC_VER)
-    this->Raw->writeI16(static_cast<int16_t>(floor(x / pointScaleFactor + 0.5)));
-    this->Raw->writeI16(static_cast<int16_t>(floor(y / pointScaleFactor + 0.5)));
-    this->Raw->writeI16(static_cast<int16_t>(floor(z / pointScaleFactor + 0.5)));
+    temp[0] = static_cast<char>(word[1] - 1 * (word[1] == 0 ? 0 : 1)); temp[1] = word[0]; temp[2] = word[3]; temp[3] = word[2];
+  }
+  else // IEEE LE
+  {
+    temp[0] = word[3]; temp[1] = word[2]; temp[2] = word[1]; temp[3] = word[0];
+  }
+#elif _OPENMA_ARCH == _OPENMA_VAX_LE
+  else if (O == ma::io::ByteOrder::IEEEBigEndian)
+  {
+    temp[0] = word[1]; temp[1] = static_cast<char>(word[0] + 1 * (word[0] == 0 ? 0 : 1)); temp[2] = word[3]; temp[3] = word[2];
+  }
+  else // IEEE LE
+  {
+    temp[0] = word[2]; temp[1] = static_cast<char>(word[3] + 1 * (word[3] == 0 ? 0 : 1)); temp[2] = word[0]; temp[3] = word[1];
+  }
 #else
-    this->Raw->writeI16(static_cast<int16_t>(static_cast<float>(x / pointScaleFactor)));
-    this->Raw->writeI16(static_cast<int16_t>(static_cast<float>(y / pointScaleFactor)));
-    this->Raw->writeI16(static_cast<int16_t>(static_cast<float>(z / pointScaleFactor)));
+  else if (O == ma::io::ByteOrder::VAXLittleEndian)
+  {
+    temp[0] = word[2]; temp[1] = word[3]; temp[2] = word[0]; temp[3] = static_cast<char>(word[1] - 1 * (word[1] == 0 ? 0 : 1));
+  }
+  else // IEEE BE
+  {
+    temp[0] = word[3]; temp[1] = word[2]; temp[2] = word[1]; temp[3] = word[0];
+  }
 #endif
+  float result;
+  memcpy(&result, temp, 4);
+  return result;
+};
+
+// NOTE: The next functions encode one word of the data section. They are the inverse of the decoding functions.
+
+template <ma::io::ByteOrder O>
+inline void _ma_io_c3d_encode_u16(uint16_t value, char* word)
+{
+#if _OPENMA_ARCH == _OPENMA_IEEE_BE
+  const bool swap = (O != ma::io::ByteOrder::IEEEBigEndian);
+#else
+  const bool swap = (O == ma::io::ByteOrder::IEEEBigEndian);
+#endif
+  if (swap)
+    value = static_cast<uint16_t>((value >> 8) | (value << 8));
+  memcpy(word, &value, 2);
+};
+
+template <ma::io::ByteOrder O>
+inline void _ma_io_c3d_encode_i16(int16_t value, char* word)
+{
+  uint16_t temp;
+  memcpy(&temp, &value, 2);
+  _ma_io_c3d_encode_u16<O>(temp, word);
+};
+
+template <ma::io::ByteOrder O>
+inline void _ma_io_c3d_encode_float(float value, char* word)
+{
+  char temp[4];
+  memcpy(temp, &value, 4);
+  if (O == ma::io::ByteOrder::Native)
+    memcpy(word, temp, 4);
 #if _OPENMA_ARCH == _OPENMA_IEEE_BE
-    if (residual >= 0.0) {byteptr[0] = 0; byteptr[1] = static_cast<int8_t>(residual / pointScaleFactor);}
-    else {byteptr[0] = -1; byteptr[1] = -1;}
+  else if (O == ma::io::ByteOrder::VAXLittleEndian)
+  {
+    word[0] = temp[1]; word[1] = static_cast<char>(temp[0] + 1 * (temp[0] == 0 ? 0 : 1)); word[2] = temp[3]; word[3] = temp[2];
+  }
+  else // IEEE LE
+  {
+    word[0] = temp[3]; word[1] = temp[2]; word[2] = temp[1]; word[3] = temp[0];
+  }
+#elif _OPENMA_ARCH == _OPENMA_VAX_LE
+  else if (O == ma::io::ByteOrder::IEEEBigEndian)
+  {
+    word[0] = static_cast<char>(temp[1] - 1 * (temp[1] == 0 ? 0 : 1)); word[1] = temp[0]; word[2] = temp[3]; word[3] = temp[2];
+  }
+  else // IEEE LE
+  {
+    word[0] = temp[2]; word[1] = temp[3]; word[2] = temp[0]; word[3] = static_cast<char>(temp[1] - 1 * (temp[1] == 0 ? 0 : 1));
+  }
 #else
-    if (residual >= 0.0) {byteptr[1] = 0; byteptr[0] = static_cast<int8_t>(residual / pointScaleFactor);}
-    else {byteptr[1] = -1; byteptr[0] = -1;}
+  else if (O == ma::io::ByteOrder::VAXLittleEndian)
+  {
+    word[0] = temp[2]; word[1] = static_cast<char>(temp[3] + 1 * (temp[3] == 0 ? 0 : 1)); word[2] = temp[0]; word[3] = temp[1];
+  }
+  else // IEEE BE
+  {
+    word[0] = temp[3]; word[1] = temp[2]; word[2] = temp[1]; word[3] = temp[0];
+  }
 #endif
-    memcpy(&residualAndMask, &byteptr, sizeof(residualAndMask));
-    this->Raw->writeI16(residualAndMask);
+};
+
+// Saturate to the range of a 16-bit signed integer and round to the nearest integer (std::lrint, i.e. current rounding mode).
+// NOTE: The encoding loops write the words of each frame with a stride (interleaved frames). They are not vectorized.
+inline int16_t _ma_io_c3d_quantize_i16(double value)
+{
+  return static_cast<int16_t>(std::lrint(std::min(32767.0, std::max(-32768.0, value))));
+};
+
+// Point's coordinates: integer format (scaled values) or float format
+template <typename T, ma::io::ByteOrder O> struct _ma_io_c3d_point_word;
+
+template <ma::io::ByteOrder O>
+struct _ma_io_c3d_point_word<int16_t,O>
+{
+  static inline double coordinate(const char* word, double scale) {return _ma_io_c3d_decode_i16<O>(word) * scale;};
+  static inline int16_t residualAndMask(const char* word) {return _ma_io_c3d_decode_i16<O>(word);};
+  static inline double residual(int8_t value, double scale) {return static_cast<double>(value) * scale;};
+  static inline void encodeCoordinate(double value, double scale, char* word) {_ma_io_c3d_encode_i16<O>(_ma_io_c3d_quantize_i16(value / scale), word);};
+  static inline void encodeResidualAndMask(int16_t value, char* word) {_ma_io_c3d_encode_i16<O>(value, word);};
+};
+
+template <ma::io::ByteOrder O>
+struct _ma_io_c3d_point_word<float,O>
+{
+  static inline double coordinate(const char* word, double ) {return _ma_io_c3d_decode_float<O>(word);};
+  static inline int16_t residualAndMask(const char* word) {return static_cast<int16_t>(_ma_io_c3d_decode_float<O>(word));};
+  // FIX: It seems that for UNSGINED 16 bits in float format, the residual is negative.
+  static inline double residual(int8_t value, double scale) {return fabs(static_cast<double>(value) * scale);};
+  static inline void encodeCoordinate(double value, double , char* word) {_ma_io_c3d_encode_float<O>(static_cast<float>(value), word);};
+  static inline void encodeResidualAndMask(int16_t value, char* word) {_ma_io_c3d_encode_float<O>(static_cast<float>(value), word);};
+};
+
+// Analog samples: signed integer, unsigned integer, or float format
+template <typename T, ma::io::ByteOrder O, bool S> struct _ma_io_c3d_analog_word;
+
+template <ma::io::ByteOrder O>
+struct _ma_io_c3d_analog_word<int16_t,O,true>
+{
+  static inline double value(const char* word) {return static_cast<double>(_ma_io_c3d_decode_i16<O>(word));};
+  static inline void encode(double value, char* word) {_ma_io_c3d_encode_i16<O>(_ma_io_c3d_quantize_i16(value), word);};
+};
+
+template <ma::io::ByteOrder O>
+struct _ma_io_c3d_analog_word<int16_t,O,false>
+{
+  static inline double value(const char* word) {return static_cast<double>(_ma_io_c3d_decode_u16<O>(word));};
+};
+
+template <ma::io::ByteOrder O, bool S>
+struct _ma_io_c3d_analog_word<float,O,S>
+{
+  static inline double value(const char* word) {return _ma_io_c3d_decode_float<O>(word);};
+  static inline void encode(double value, char* word) {_ma_io_c3d_encode_float<O>(static_cast<float>(value), word);};
+};
+
+namespace ma
+{
+namespace io
+{
+  // Decoder specialized for the format of the words (T), their byte order (O), and the format of the analog samples (S: signed or not)
+  template <typename T, ByteOrder O, bool S>
+  class C3DFrameDecoderImpl : public C3DFrameDecoder
+  {
+  public:
+    C3DFrameDecoderImpl() : C3DFrameDecoder(sizeof(T)) {};
+    ~C3DFrameDecoderImpl() = default;
+    
+    virtual void decode(const char* data, size_t first, size_t num) const final;
   };
   
-  void C3DDataStreamSignedInteger::writeAnalog(double v)
+  template <typename T, ByteOrder O, bool S>
+  void C3DFrameDecoderImpl<T,O,S>::decode(const char* data, size_t first, size_t num) const
   {
-    this->Raw->writeI16(static_cast<int16_t>(v));
+    using Point = _ma_io_c3d_point_word<T,O>;
+    using Analog = _ma_io_c3d_analog_word<T,O,S>;
+    const size_t frameSize = this->frameSize();
+    if (frameSize == 0)
+      return;
+    const size_t numPoints = this->Points.size();
+    const size_t numAnalogs = this->Analogs.size();
+    const size_t numSubsamples = this->AnalogSamplesPerFrame;
+    const double occluded = 9999999.0, eps = std::numeric_limits<float>::epsilon();
+    // The frames are decoded by block small enough to stay in the cache while they are transposed into the planes of each time sequence.
+    const size_t blockFrames = std::max<size_t>(1, 65536 / frameSize);
+    for (size_t block = 0 ; block < num ; block += blockFrames)
+    {
+      const size_t frames = std::min(blockFrames, num - block);
+      const char* raw = data + block * frameSize;
+      // Points
+      for (size_t i = 0 ; i < numPoints ; ++i)
+      {
+        if (this->Points[i] == nullptr)
+          continue;
+        double* x = this->Points[i] + first + block;
+        double* y = x + this->PointSamples;
+        double* z = y + this->PointSamples;
+        double* r = z + this->PointSamples;
+        const char* word = raw + 4 * i * sizeof(T);
+        for (size_t j = 0 ; j < frames ; ++j, word += frameSize)
+        {
+          x[j] = Point::coordinate(word, this->PointScale);
+          y[j] = Point::coordinate(word + sizeof(T), this->PointScale);
+          z[j] = Point::coordinate(word + 2 * sizeof(T), this->PointScale);
+          // The residual is stored in the first byte, while the second is the mask of the cameras.
+          const int16_t residualAndMask = Point::residualAndMask(word + 3 * sizeof(T));
+          r[j] = (residualAndMask >= 0) ? Point::residual(static_cast<int8_t>(residualAndMask & 0xFF), this->PointScale) : -1.0;
+          // Check only the value on coordinate X to speed up this part
+          if (this->OcclusionCheck && (fabs(x[j] - occluded) < eps))
+          {
+            x[j] = 0.0; y[j] = 0.0; z[j] = 0.0; r[j] = -1.0;
+          }
+        }
+      }
+      // Analogs
+      const char* analogRaw = raw + 4 * numPoints * sizeof(T);
+      for (size_t i = 0 ; i < numAnalogs ; ++i)
+      {
+        if (this->Analogs[i] == nullptr)
+          continue;
+        const double offset = this->AnalogZeroOffset[i], scale = this->AnalogChannelScale[i];
+        double* values = this->Analogs[i] + (first + block) * numSubsamples;
+        const char* word = analogRaw + i * sizeof(T);
+        for (size_t j = 0 ; j < frames ; ++j, word += frameSize)
+        {
+          for (size_t k = 0 ; k < numSubsamples ; ++k)
+            *values++ = (Analog::value(word + k * numAnalogs * sizeof(T)) - offset) * scale * this->AnalogUniversalScale;
+        }
+      }
+    }
   };
   
   // ------------------------------------------------------------------------ //
-
-  C3DDataStreamUnsignedInteger::C3DDataStreamUnsignedInteger(BinaryStream* raw)
-  : C3DDataStreamSignedInteger(raw)
-  {};
-  
-  C3DDataStreamUnsignedInteger::~C3DDataStreamUnsignedInteger() = default;
   
-  double C3DDataStreamUnsignedInteger::readAnalog()
+  /**
+   * Create the decoder adapted to the given byte @a order, format of the data (@a floatFormat), and analog format (@a signedAnalog).
+   * The analog format is only used with the integer format.
+   */
+  C3DFrameDecoder* C3DFrameDecoder::create(ByteOrder order, bool floatFormat, bool signedAnalog)
   {
-    return static_cast<double>(this->Raw->readU16());
+    switch (order)
+    {
+    case ByteOrder::IEEELittleEndian:
+      if (floatFormat)
+        return new C3DFrameDecoderImpl<float,ByteOrder::IEEELittleEndian,true>;
+      else if (signedAnalog)
+        return new C3DFrameDecoderImpl<int16_t,ByteOrder::IEEELittleEndian,true>;
+      return new C3DFrameDecoderImpl<int16_t,ByteOrder::IEEELittleEndian,false>;
+    case ByteOrder::IEEEBigEndian:
+      if (floatFormat)
+        return new C3DFrameDecoderImpl<float,ByteOrder::IEEEBigEndian,true>;
+      else if (signedAnalog)
+        return new C3DFrameDecoderImpl<int16_t,ByteOrder::IEEEBigEndian,true>;
+      return new C3DFrameDecoderImpl<int16_t,ByteOrder::IEEEBigEndian,false>;
+    case ByteOrder::VAXLittleEndian:
+      if (floatFormat)
+        return new C3DFrameDecoderImpl<float,ByteOrder::VAXLittleEndian,true>;
+      else if (signedAnalog)
+        return new C3DFrameDecoderImpl<int16_t,ByteOrder::VAXLittleEndian,true>;
+      return new C3DFrameDecoderImpl<int16_t,ByteOrder::VAXLittleEndian,false>;
+    default:
+      return nullptr;
+    }
   };
-  void C3DDataStreamUnsignedInteger::writeAnalog(double v)
-  {
-    this->Raw->writeI16(static_cast<uint16_t>(v));
-  };
-
-  // ------------------------------------------------------------------------ //
-
-  C3DDataStreamFloat::C3DDataStreamFloat(BinaryStream* raw)
-  : C3DDataStream(raw)
+  
+  C3DFrameDecoder::C3DFrameDecoder(size_t wordSize)
+  : Points(), PointSamples(0), PointScale(1.0), OcclusionCheck(false),
+    Analogs(), AnalogSamplesPerFrame(1), AnalogZeroOffset(), AnalogChannelScale(), AnalogUniversalScale(1.0),
+    WordSize(wordSize)
   {};
   
-  C3DDataStreamFloat::~C3DDataStreamFloat() = default;
+  C3DFrameDecoder::~C3DFrameDecoder() = default;
   
-  void C3DDataStreamFloat::readPoint(double* x, double* y, double* z, double* residual, double pointScaleFactor)
-  {
-    int8_t byteptr[2];
-    int16_t residualAndMask;
-    *x = this->Raw->readFloat();
-    *y = this->Raw->readFloat();
-    *z = this->Raw->readFloat();
-    residualAndMask = static_cast<int16_t>(this->Raw->readFloat());
-    memcpy(&byteptr, &residualAndMask, sizeof(byteptr));
-    // FIX: It seems that for UNSGINED 16 bits in float format, the residual is negative.
-    //      The residual is now calculated as the fabs(byteptr[1] * scaleFactor3d).
-#if _OPENMA_ARCH == _OPENMA_IEEE_BE
-    *residual = (byteptr[0] >= 0) ? fabs(static_cast<double>(byteptr[1]) * pointScaleFactor) : -1.0;
-#else
-    *residual = (byteptr[1] >= 0) ? fabs(static_cast<double>(byteptr[0]) * pointScaleFactor) : -1.0;
-#endif
+  /**
+   * Returns the number of bytes used by one frame (i.e. the 4 words of each point and the words of each analog sample).
+   */
+  size_t C3DFrameDecoder::frameSize() const _OPENMA_NOEXCEPT
+  {
+    return (4 * this->Points.size() + this->Analogs.size() * this->AnalogSamplesPerFrame) * this->WordSize;
   };
+  
+  // ------------------------------------------------------------------------ //
+  
+  // Encoder specialized for the format of the words (T) and their byte order (O). The analog samples are always signed.
+  template <typename T, ByteOrder O>
+  class C3DFrameEncoderImpl : public C3DFrameEncoder
+  {
+  public:
+    C3DFrameEncoderImpl() : C3DFrameEncoder(sizeof(T)) {};
+    ~C3DFrameEncoderImpl() = default;
     
-  double C3DDataStreamFloat::readAnalog()
+    virtual void encode(char* data, size_t first, size_t num) const final;
+  };
+  
+  template <typename T, ByteOrder O>
+  void C3DFrameEncoderImpl<T,O>::encode(char* data, size_t first, size_t num) const
   {
-    return this->Raw->readFloat();
+    using Point = _ma_io_c3d_point_word<T,O>;
+    using Analog = _ma_io_c3d_analog_word<T,O,true>;
+    const size_t frameSize = this->frameSize();
+    if (frameSize == 0)
+      return;
+    const size_t numPoints = this->Points.size();
+    const size_t numAnalogs = this->Analogs.size();
+    const size_t numSubsamples = this->AnalogSamplesPerFrame;
+    // Same blocking than the decoder: the planes of each time sequence are transposed into frames small enough to stay in the cache.
+    const size_t blockFrames = std::max<size_t>(1, 65536 / frameSize);
+    for (size_t block = 0 ; block < num ; block += blockFrames)
+    {
+      const size_t frames = std::min(blockFrames, num - block);
+      char* raw = data + block * frameSize;
+      // Points
+      for (size_t i = 0 ; i < numPoints ; ++i)
+      {
+        const double* x = this->Points[i] + first + block;
+        const double* y = x + this->PointSamples;
+        const double* z = y + this->PointSamples;
+        const double* r = z + this->PointSamples;
+        char* word = raw + 4 * i * sizeof(T);
+        for (size_t j = 0 ; j < frames ; ++j, word += frameSize)
+        {
+          Point::encodeCoordinate(x[j], this->PointScale, word);
+          Point::encodeCoordinate(y[j], this->PointScale, word + sizeof(T));
+          Point::encodeCoordinate(z[j], this->PointScale, word + 2 * sizeof(T));
+          // The residual is stored in the first byte, while the second is the mask of the cameras (not stored, so set to 0).
+          const int16_t residualAndMask = (r[j] >= 0.0) ? static_cast<int16_t>(static_cast<uint8_t>(static_cast<int8_t>(std::min(r[j] / this->PointScale, 127.0)))) : -1;
+          Point::encodeResidualAndMask(residualAndMask, word + 3 * sizeof(T));
+        }
+      }
+      // Analogs
+      char* analogRaw = raw + 4 * numPoints * sizeof(T);
+      for (size_t i = 0 ; i < numAnalogs ; ++i)
+      {
+        const double offset = this->AnalogZeroOffset[i], scale = this->AnalogChannelScale[i];
+        const double* values = this->Analogs[i] + (first + block) * numSubsamples;
+        char* word = analogRaw + i * sizeof(T);
+        for (size_t j = 0 ; j < frames ; ++j, word += frameSize)
+        {
+          for (size_t k = 0 ; k < numSubsamples ; ++k)
+            Analog::encode(*values++ / scale / this->AnalogUniversalScale + offset, word + k * numAnalogs * sizeof(T));
+        }
+      }
+    }
   };
-    
-  void C3DDataStreamFloat::writePoint(double x, double y, double z, double residual, double pointScaleFactor)
+  
+  // ------------------------------------------------------------------------ //
+  
+  /**
+   * Create the encoder adapted to the given byte @a order and format of the data (@a floatFormat).
+   * With the integer format, the coordinates are divided by the point scale and the analog samples are stored as signed integers. The values are rounded and saturated.
+   */
+  C3DFrameEncoder* C3DFrameEncoder::create(ByteOrder order, bool floatFormat)
   {
-    int8_t byteptr[2];
-    int16_t residualAndMask;
-    this->Raw->writeFloat(static_cast<float>(x));
-    this->Raw->writeFloat(static_cast<float>(y));
-    this->Raw->writeFloat(static_cast<float>(z));
-#if _OPENMA_ARCH == _OPENMA_IEEE_BE
-    if (residual >= 0.0) {byteptr[0] = 0; byteptr[1] = static_cast<int8_t>(residual / pointScaleFactor);}
-    else {byteptr[0] = -1; byteptr[1] = -1;}
-#else
-    if (residual >= 0.0) {byteptr[1] = 0; byteptr[0] = static_cast<int8_t>(residual / pointScaleFactor);}
-    else {byteptr[1] = -1; byteptr[0] = -1;}
-#endif
-    memcpy(&residualAndMask, &byteptr, sizeof(residualAndMask));
-    this->Raw->writeFloat(static_cast<float>(residualAndMask));
+    switch (order)
+    {
+    case ByteOrder::IEEELittleEndian:
+      if (floatFormat)
+        return new C3DFrameEncoderImpl<float,ByteOrder::IEEELittleEndian>;
+      return new C3DFrameEncoderImpl<int16_t,ByteOrder::IEEELittleEndian>;
+    case ByteOrder::IEEEBigEndian:
+      if (floatFormat)
+        return new C3DFrameEncoderImpl<float,ByteOrder::IEEEBigEndian>;
+      return new C3DFrameEncoderImpl<int16_t,ByteOrder::IEEEBigEndian>;
+    case ByteOrder::VAXLittleEndian:
+      if (floatFormat)
+        return new C3DFrameEncoderImpl<float,ByteOrder::VAXLittleEndian>;
+      return new C3DFrameEncoderImpl<int16_t,ByteOrder::VAXLittleEndian>;
+    default:
+      return nullptr;
+    }
   };
   
-  void C3DDataStreamFloat::writeAnalog(double v)
+  C3DFrameEncoder::C3DFrameEncoder(size_t wordSize)
+  : Points(), PointSamples(0), PointScale(1.0),
+    Analogs(), AnalogSamplesPerFrame(1), AnalogZeroOffset(), AnalogChannelScale(), AnalogUniversalScale(1.0),
+    WordSize(wordSize)
+  {};
+  
+  C3DFrameEncoder::~C3DFrameEncoder() = default;
+  
+  /**
+   * Returns the number of bytes used by one frame (i.e. the 4 words of each point and the words of each analog sample).
+   */
+  size_t C3DFrameEncoder::frameSize() const _OPENMA_NOEXCEPT
   {
-    this->Raw->writeFloat(static_cast<float>(v));
+    return (4 * this->Points.size() + this->Analogs.size() * this->AnalogSamplesPerFrame) * this->WordSize;
   };
 };
 };
\ No newline at end of file
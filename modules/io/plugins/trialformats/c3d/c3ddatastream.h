@@ -44,68 +44,73 @@
 
 #include <type_traits>
 #include <vector>
+#include <cstddef> // size_t
 
 namespace ma
 {
 namespace io
 {
-  class BinaryStream;
+  enum class ByteOrder;
   
-  class C3DDataStream
+  // Decoder of complete frames stored in the data section
+  class C3DFrameDecoder
   {
   public:
-    C3DDataStream(BinaryStream* raw);
-    virtual ~C3DDataStream();
+    static C3DFrameDecoder* create(ByteOrder order, bool floatFormat, bool signedAnalog);
     
-    virtual void readPoint(double* x, double* y, double* z, double* residual, double pointScaleFactor) = 0;
-    virtual double readAnalog() = 0;
-    virtual void writePoint(double x, double y, double z, double residual, double pointScaleFactor) = 0;
-    virtual void writeAnalog(double v) = 0;
+    C3DFrameDecoder(size_t wordSize);
+    virtual ~C3DFrameDecoder();
     
-    C3DDataStream(const C3DDataStream& ) = delete;
-    C3DDataStream(C3DDataStream&& ) _OPENMA_NOEXCEPT = delete;
-    C3DDataStream& operator=(const C3DDataStream& ) = delete;
-    C3DDataStream& operator=(const C3DDataStream&& ) _OPENMA_NOEXCEPT = delete;
+    size_t frameSize() const _OPENMA_NOEXCEPT;
+    virtual void decode(const char* data, size_t first, size_t num) const = 0;
+    
+    C3DFrameDecoder(const C3DFrameDecoder& ) = delete;
+    C3DFrameDecoder(C3DFrameDecoder&& ) _OPENMA_NOEXCEPT = delete;
+    C3DFrameDecoder& operator=(const C3DFrameDecoder& ) = delete;
+    C3DFrameDecoder& operator=(const C3DFrameDecoder&& ) _OPENMA_NOEXCEPT = delete;
+    
+    std::vector<double*> Points; // X, Y, Z, and residual planes of each point (null: the point is not decoded)
+    size_t PointSamples;
+    double PointScale;
+    bool OcclusionCheck; // Coordinates set to 9999999 are considered as occluded
+    std::vector<double*> Analogs; // Samples of each analog channel (null: the channel is not decoded)
+    size_t AnalogSamplesPerFrame;
+    std::vector<double> AnalogZeroOffset;
+    std::vector<double> AnalogChannelScale;
+    double AnalogUniversalScale;
     
   protected:
-    BinaryStream* Raw;
+    size_t WordSize;
   };
   
-  // Integer format + signed analog data
-  class C3DDataStreamSignedInteger : public C3DDataStream
+  // Encoder of complete frames to store in the data section
+  class C3DFrameEncoder
   {
   public:
-    C3DDataStreamSignedInteger(BinaryStream* raw);
-    ~C3DDataStreamSignedInteger();
+    static C3DFrameEncoder* create(ByteOrder order, bool floatFormat);
     
-    virtual void readPoint(double* x, double* y, double* z, double* residual, double pointScaleFactor) final;
-    virtual double readAnalog() override;
-    virtual void writePoint(double x, double y, double z, double residual, double pointScaleFactor) final;
-    virtual void writeAnalog(double v) override;
-  };
-  
-  // Integer format + unsigned analog data
-  class C3DDataStreamUnsignedInteger : public C3DDataStreamSignedInteger
-  {
-  public:
-    C3DDataStreamUnsignedInteger(BinaryStream* raw);
-    ~C3DDataStreamUnsignedInteger();
+    C3DFrameEncoder(size_t wordSize);
+    virtual ~C3DFrameEncoder();
     
-    virtual double readAnalog() final;
-    virtual void writeAnalog(double v) final;
-  };
-  
-  // Float format + signed/unsigned analog data
-  class C3DDataStreamFloat : public C3DDataStream
-  {
-  public:
-    C3DDataStreamFloat(BinaryStream* raw);
-    ~C3DDataStreamFloat();
+    size_t frameSize() const _OPENMA_NOEXCEPT;
+    virtual void encode(char* data, size_t first, size_t num) const = 0;
     
-    virtual void readPoint(double* x, double* y, double* z, double* residual, double pointScaleFactor) final;
-    virtual double readAnalog() final;
-    virtual void writePoint(double x, double y, double z, double residual, double pointScaleFactor) final;
-    virtual void writeAnalog(double v) final;
+    C3DFrameEncoder(const C3DFrameEncoder& ) = delete;
+    C3DFrameEncoder(C3DFrameEncoder&& ) _OPENMA_NOEXCEPT = delete;
+    C3DFrameEncoder& operator=(const C3DFrameEncoder& ) = delete;
+    C3DFrameEncoder& operator=(const C3DFrameEncoder&& ) _OPENMA_NOEXCEPT = delete;
+    
+    std::vector<const double*> Points; // X, Y, Z, and residual planes of each point
+    size_t PointSamples;
+    double PointScale;
+    std::vector<const double*> Analogs; // Samples of each analog channel
+    size_t AnalogSamplesPerFrame;
+    std::vector<double> AnalogZeroOffset;
+    std::vector<double> AnalogChannelScale;
+    double AnalogUniversalScale;
+    
+  protected:
+    size_t WordSize;
   };
 };
 };
@@ -33,10 +33,11 @@
  */
 
 #include "c3dhandler.h"
+#include "c3dhandler_p.h"
 #include "c3ddatastream.h"
 
-#include "openma/io/handler_p.h"
 #include "openma/io/device.h"
+#include "openma/io/buffer.h"
 #include "openma/io/binarystream.h"
 #include "openma/io/enums.h"
 #include "openma/io/utils.h"
@@ -60,6 +61,8 @@
 #include <array>
 #include <memory> // std::unique_ptr
 #include <functional> // std::function
+#include <algorithm> // std::min, std::max
+#include <thread>
 #include <cassert>
 #include <cmath>
 
@@ -71,53 +74,6 @@ namespace ma
 {
 namespace io
 {
-  class C3DHandlerPrivate : public HandlerPrivate
-  {
-  public:
-    C3DHandlerPrivate();
-    ~C3DHandlerPrivate() _OPENMA_NOEXCEPT;
-
-    C3DHandlerPrivate(const C3DHandlerPrivate& ) = delete;
-    C3DHandlerPrivate(C3DHandlerPrivate&& ) _OPENMA_NOEXCEPT = delete;
-    C3DHandlerPrivate& operator=(const C3DHandlerPrivate& ) = delete;
-    C3DHandlerPrivate& operator=(const C3DHandlerPrivate&& ) _OPENMA_NOEXCEPT = delete;
-    
-    double PointScale;
-    int PointMaximumInterpolationGap;
-    int AnalogResolution;
-    std::vector<double> AnalogChannelScale;
-    std::vector<double> AnalogZeroOffset;
-    double AnalogUniversalScale;
-    bool AnalogSignedIntegerFormat;
-    
-    template <typename T>
-    static inline typename std::enable_if<!std::is_same<T,std::string>::value,T>::type generateDefaultValue(T&& blank, int idx)
-    {
-      OPENMA_UNUSED(idx);
-      return blank;
-    };
-  
-    template <typename T>
-    static inline typename std::enable_if<std::is_same<T,std::string>::value,T>::type generateDefaultValue(T&& blank, int idx)
-    {
-      return (blank.empty() ? blank : blank + std::to_string(idx));
-    };
-    
-    template <typename T>
-    static void mergeProperties(std::vector<T>* target, Trial* trial, const std::string& base, int finalSize = -1, T&& defaultValue = T());
-    
-    template <typename T>
-    static void createProperties(std::unordered_map<std::string,Any>& props, const std::string& name, const T& value);
-    
-    template <typename T>
-    static void createProperties(std::unordered_map<std::string,Any>& props, const std::string& name, const std::vector<T>& values, size_t inc = 1);
-    
-    template <typename T>
-    static void createProperties(std::unordered_map<std::string,Any>& props, const std::string& name, const std::vector<T>& values, const std::vector<unsigned>& dims, size_t inc = 1);
-    
-    static void extractForcePlatformData(instrument::ForcePlate* fp, const std::vector<TimeSequence*>& analogs, double* origin, double* corners, int* channelIndices, size_t channelStep, double* calMatrix = nullptr, const unsigned* calMatrixSize = nullptr);
-  };
-  
   C3DHandlerPrivate::C3DHandlerPrivate()
   : HandlerPrivate(),
     PointScale(1.0), PointMaximumInterpolationGap(0),
@@ -213,6 +169,179 @@ namespace io
     }
   };
   
+  /**
+   * Decode the value of a parameter stored in the parameter section.
+   * The @a stream must point to the begining of the value. In case the value is @a truncated, only the strings with one dimension are read, while the other values are empty.
+   */
+  Any C3DHandlerPrivate::readParameterValue(BinaryStream* stream, int8_t type, std::vector<uint8_t> dims, bool truncated)
+  {
+    Any value;
+    int prod = 1;
+    for (const auto& dim : dims)
+      prod *= dim;
+    switch (type)
+    {
+    case -1: // Char (transformed into strings)
+      {
+      if (dims.size() >= 2)
+      {
+        int rows = 1;
+        for (size_t i = 1 ; i < dims.size() ; ++i)
+          rows *= dims[i];
+        prod = dims[0]; // reused
+        std::vector<uint8_t>(dims.begin()+1, dims.end()).swap(dims); // Remove the first element
+        std::vector<std::string> p(truncated ? 0 : rows);
+        stream->readString(prod, p.size(), p.data());
+        value = Any(p, dims);
+      }
+      else
+      {
+        value = Any(stream->readString(prod));
+      }
+      break;
+      }
+    case 1: // Byte
+      {
+      std::vector<int8_t> p(truncated ? 0 : prod);
+      stream->readI8(p.size(), p.data());
+      value = Any(p, dims);
+      break;
+      }
+    case 2: // Integer
+      {
+      std::vector<int16_t> p(truncated ? 0 : prod);
+      stream->readI16(p.size(), p.data());
+      value = Any(p, dims);
+      break;
+      }
+    case 4: // Real
+      {
+      std::vector<float> p(truncated ? 0 : prod);
+      stream->readFloat(p.size(), p.data());
+      value = Any(p, dims);
+      break;
+      }
+    default :
+      throw(FormatError("Data parameter type unknown"));
+      break;
+    }
+    return value;
+  };
+  
+  /**
+   * Extract from the header and the parameter sections stored in the @a source the content describing its data section: byte order, number of points and analog samples, frames, scale, rate, channels (POINT and ANALOG parameters), and the position of the number of frames.
+   * The device is read from its beginning. Only the parameters POINT:USED, POINT:LABELS, POINT:SCALE, POINT:RATE, ANALOG:USED, ANALOG:LABELS, ANALOG:RATE, ANALOG:SCALE, ANALOG:GEN_SCALE, ANALOG:OFFSET, ANALOG:FORMAT and TRIAL:ACTUAL_END_FIELD are decoded.
+   */
+  C3DSchema C3DHandlerPrivate::readSchema(Device* source)
+  {
+    static const std::array<const char*,12> names{{"POINT:USED", "POINT:LABELS", "POINT:SCALE", "POINT:RATE", "ANALOG:USED", "ANALOG:LABELS", "ANALOG:RATE", "ANALOG:SCALE", "ANALOG:GEN_SCALE", "ANALOG:OFFSET", "ANALOG:FORMAT", "TRIAL:ACTUAL_END_FIELD"}};
+    C3DSchema schema;
+    const State exceptions = source->exceptions();
+    source->setExceptions(State::End | State::Fail | State::Error);
+    try
+    {
+      BinaryStream stream(source);
+      source->seek(0, Origin::Begin);
+      const int8_t parameterFirstBlock = stream.readI8();
+      if ((parameterFirstBlock <= 1) || (stream.readI8() != 80))
+        throw(FormatError("ORG.C3D - The device does not contain a C3D file to append frames."));
+      const size_t sectionStart = 512 * (parameterFirstBlock - 1);
+      source->seek(static_cast<Device::Offset>(sectionStart + 2), Origin::Begin);
+      const size_t sectionEnd = sectionStart + 512 * stream.readU8();
+      const int processorType = stream.readI8();
+      if ((processorType < 84) || (processorType > 86))
+        throw(FormatError("ORG.C3D - Invalid processor type in the C3D file to append frames."));
+      schema.Order = static_cast<ByteOrder>(processorType - 83);
+      stream.setByteOrder(schema.Order);
+      // Header
+      source->seek(2, Origin::Begin);
+      schema.Points = stream.readU16();
+      schema.AnalogSamples = stream.readU16();
+      schema.FirstFrame = stream.readU16();
+      schema.LastFrame = stream.readU16();
+      source->seek(2, Origin::Current); // Maximum interpolation gap
+      schema.PointScale = stream.readFloat();
+      schema.DataStartBlock = stream.readU16();
+      source->seek(2, Origin::Current); // Number of analog samples per channel and per frame
+      schema.PointRate = stream.readFloat();
+      // Parameters (the groups can be stored after their parameters)
+      using parameter_t = std::tuple<int,std::string,int8_t,std::vector<uint8_t>,Device::Position>; // group id, label, type, dimensions, position of the value
+      std::unordered_map<int,std::string> groups;
+      std::vector<parameter_t> parameters;
+      Device::Position position = static_cast<Device::Position>(sectionStart + 4);
+      while (static_cast<size_t>(position) < sectionEnd)
+      {
+        source->seek(position, Origin::Begin);
+        const int8_t numCharLabel = stream.readI8();
+        if (numCharLabel == 0)
+          break;
+        const int8_t id = stream.readI8();
+        const std::string label = stream.readString(std::abs(numCharLabel));
+        const Device::Position offsetPosition = source->tell();
+        const uint16_t offset = stream.readU16();
+        if (id < 0)
+          groups.emplace(-id, label);
+        else if (id > 0)
+        {
+          const int8_t type = stream.readI8();
+          std::vector<uint8_t> dims(static_cast<uint8_t>(stream.readI8()));
+          stream.readU8(dims.size(), dims.data());
+          parameters.emplace_back(id, label, type, dims, source->tell());
+        }
+        if (offset == 0)
+          break;
+        position = offsetPosition + static_cast<Device::Offset>(offset);
+      }
+      for (const auto& parameter : parameters)
+      {
+        auto group = groups.find(std::get<0>(parameter));
+        if (group == groups.cend())
+          continue;
+        const std::string name = group->second + ":" + std::get<1>(parameter);
+        if (name == "POINT:FRAMES")
+        {
+          schema.PointFramesPosition = std::get<4>(parameter);
+          schema.PointFramesFormat = std::get<2>(parameter);
+        }
+        else if (name == "TRIAL:ACTUAL_END_FIELD")
+          schema.ActualEndFieldPosition = std::get<4>(parameter);
+        if (std::find_if(names.cbegin(), names.cend(), [&name](const char* n){return name == n;}) == names.cend())
+          continue;
+        source->seek(std::get<4>(parameter), Origin::Begin);
+        schema.Parameters[name] = C3DHandlerPrivate::readParameterValue(&stream, std::get<2>(parameter), std::get<3>(parameter), false);
+      }
+      // The header stores the last frame on 16 bits
+      auto actualEndField = schema.Parameters.find("TRIAL:ACTUAL_END_FIELD");
+      if (actualEndField != schema.Parameters.cend())
+      {
+        const auto field = actualEndField->second.cast<std::vector<int>>();
+        if (field.size() == 2)
+          schema.LastFrame = static_cast<int>(static_cast<uint16_t>(field[0])) + (field[1] << 16);
+        else
+          schema.ActualEndFieldPosition = -1;
+      }
+    }
+    catch (...)
+    {
+      source->setExceptions(exceptions);
+      throw;
+    }
+    source->setExceptions(exceptions);
+    return schema;
+  };
+  
+  /**
+   * Decode the value of the parameter from the raw content of the parameter section.
+   */
+  Any C3DDeferredParameter::operator()() const
+  {
+    Buffer buffer;
+    buffer.open(this->Section->data() + this->Offset, this->Size);
+    buffer.setExceptions(State::End | State::Fail | State::Error);
+    BinaryStream stream(&buffer, this->Order);
+    return C3DHandlerPrivate::readParameterValue(&stream, this->Type, this->Dimensions, this->Truncated);
+  };
+  
   void C3DHandlerPrivate::extractForcePlatformData(instrument::ForcePlate* fp, const std::vector<TimeSequence*>& analogs, double* origin, double* corners, int* channelIndices, size_t channelStep, double* calMatrix, const unsigned* calMatrixSize)
   {
     if (fp == nullptr)
@@ -391,8 +520,10 @@ namespace io
       size_t totalBytesRead = 4; // the four bytes read previously.
       using group_t = std::tuple<int,std::string>;  // id, label
       std::list<group_t> groups;
-      using parameter_t = std::tuple<int,std::string,Any>;  // id, label, value(s)
+      using parameter_t = std::tuple<int,std::string,C3DDeferredParameter>;  // id, label, value(s)
       std::list<parameter_t> parameters;
+      const size_t sectionStart = 512 * (parameterFirstBlock - 1);
+      size_t sectionEnd = 0;
       // std::list<MetaData::Pointer> parameters;
       // MetaData::Pointer root = output->GetMetaData();
       bool alreadyDisplayParameterOverflowMessage = false;
@@ -430,53 +561,15 @@ namespace io
           bool dataSizeExceeded = (dataSize > offset) && (!lastEntry);
           if (dataSizeExceeded)
             warning("ORG.C3D - %s - The size of the data for the parameter '%s' exceeds the space available before the next entry. Trying to continue...", optr->Source->name(), label.c_str());
-          Any value;
-          switch (type)
-          {
-          case -1: // Char (transformed into strings)
-            {
-            int rows = 1;
-            if (dims.size() >= 2)
-            {
-              int8_t inc2 = 1 ; while (inc2 < numDims) rows *= dims[inc2++];
-              prod = dims[0]; // reused
-              std::vector<uint8_t>(dims.begin()+1, dims.end()).swap(dims); // Remove the first element
-              std::vector<std::string> p(dataSizeExceeded ? 0 : rows);
-              stream.readString(prod, p.size(), p.data());
-              value = Any(p, dims);
-            }
-            else
-            {
-              value = Any(stream.readString(dims[0]));
-            }
-            break;
-            }
-          case 1: // Byte
-            {
-            std::vector<int8_t> p(dataSizeExceeded ? 0 : prod);
-            stream.readI8(p.size(), p.data());
-            value = Any(p, dims);
-            break;
-            }
-          case 2: // Integer
-            {
-            std::vector<int16_t> p(dataSizeExceeded ? 0 : prod);
-            stream.readI16(p.size(), p.data());
-            value = Any(p, dims);
-            break;
-            }
-          case 4: // Real
-            {
-            std::vector<float> p(dataSizeExceeded ? 0 : prod);
-            stream.readFloat(p.size(), p.data());
-            value = Any(p, dims);
-            break;
-            }
-          default :
+          if ((type != -1) && (type != 1) && (type != 2) && (type != 4))
             throw(FormatError("Data parameter type unknown for the entry: '" + label + "'"));
-            break;
-          }
-          parameters.emplace_back(id,label,value);
+          // The value is not decoded now but only when the property is accessed (see C3DDeferredParameter)
+          // Note: Strings with one dimension are always fully read (even if their size is exceeded)
+          size_t consumed = (dataSizeExceeded && !((type == -1) && (numDims < 2))) ? 0 : static_cast<size_t>(dataSize);
+          size_t position = static_cast<size_t>(optr->Source->tell()) - sectionStart;
+          optr->Source->seek(consumed, Origin::Current);
+          sectionEnd = std::max(sectionEnd, position + consumed);
+          parameters.emplace_back(id,label,C3DDeferredParameter{nullptr,stream.byteOrder(),type,dims,position,consumed,dataSizeExceeded});
           offset -= dataSize;
           if (offset != 0)
           {
@@ -515,6 +608,17 @@ namespace io
           break; // Parameter section end
         optr->Source->seek(offset, Origin::Current);
       }
+      // Raw content of the parameter section shared by the deferred values
+      if (!parameters.empty())
+      {
+        auto current = optr->Source->tell();
+        auto section = std::make_shared<std::vector<char>>(sectionEnd);
+        optr->Source->seek(sectionStart, Origin::Begin);
+        optr->Source->read(section->data(), sectionEnd);
+        optr->Source->seek(current, Origin::Begin);
+        for (auto& parameter : parameters)
+          std::get<2>(parameter).Section = section;
+      }
       // Assemble groups and parameters
       auto itG = groups.begin();
       auto itP = parameters.begin();
@@ -531,7 +635,7 @@ namespace io
           }
           if (std::get<0>(*itG) == -std::get<0>(*itP))
           {
-            trial->setProperty(std::get<1>(*itG)+":"+std::get<1>(*itP),std::move(std::get<2>(*itP)));
+            trial->setDeferredProperty(std::get<1>(*itG)+":"+std::get<1>(*itP),std::move(std::get<2>(*itP)));
             itP = parameters.erase(itP); 
           }
           else
@@ -649,6 +753,8 @@ namespace io
         if (dataFirstBlock < (parameterFirstBlock + blockNumber))
           throw(FormatError("Bad data first block"));
         optr->Source->seek((512 * (dataFirstBlock - 1)), Origin::Begin);
+        // The data section is read only once, from its begining to its end
+        optr->Source->advise(Advice::Sequential, (512 * (dataFirstBlock - 1)), -1);
         if (numberSamplesPerAnalogChannel == 0)
           numberSamplesPerAnalogChannel = 1;
         uint16_t numAnalogs = totalAnalogSamplesPer3dFrame / numberSamplesPerAnalogChannel;
@@ -719,99 +825,36 @@ namespace io
         // POINT:SCALE
         if (fabs(trial->property("POINT:SCALE").cast<double>() - optr->PointScale) > std::numeric_limits<float>::epsilon())
           warning("ORG.C3D - %s - The point scaling factor written in the header and in the parameter POINT:SCALE are not the same. The first value is kept", optr->Source->name());
-        std::unique_ptr<C3DDataStream> dataStream; 
-        if (optr->PointScale > 0) // integer
-        {
-          if (!optr->AnalogSignedIntegerFormat)
-            dataStream.reset(new C3DDataStreamUnsignedInteger(&stream));
-          else
-            dataStream.reset(new C3DDataStreamSignedInteger(&stream));
-        }
-        else // float
-        {
-          dataStream.reset(new C3DDataStreamFloat(&stream));
-        }
-        size_t pointSamples = lastSampleIndex - firstSampleIndex + 1;
-        double startTime = static_cast<double>(firstSampleIndex-1) / pointSampleRate;
-        auto points = make_nodes<TimeSequence*>(pointNumber,4,pointSamples,pointSampleRate,startTime,TimeSequence::Position,pointUnits[0],trial->timeSequences());
-        auto analogs = make_nodes<TimeSequence*>(numAnalogs,1,pointSamples*numberSamplesPerAnalogChannel,pointSampleRate*numberSamplesPerAnalogChannel,startTime,TimeSequence::Analog,"V",trial->timeSequences());
-        try
-        {
-          for (size_t sample = 0 ; sample < pointSamples ; ++sample)
-          {
-            for (auto& pt: points)
-            {
-              dataStream->readPoint(
-                &(pt->data()[sample]),
-                &(pt->data()[sample + pointSamples]),
-                &(pt->data()[sample + 2*pointSamples]),
-                &(pt->data()[sample + 3*pointSamples]),
-                optr->PointScale);
-            }
-            size_t analogSample = numberSamplesPerAnalogChannel * sample;
-            for (int subsample = 0 ; subsample < numberSamplesPerAnalogChannel ; ++subsample)
-            {
-              size_t incChannel = 0;
-              for (auto& an: analogs)
-              {
-                an->data()[analogSample+subsample] = (dataStream->readAnalog() - optr->AnalogZeroOffset[incChannel]) * optr->AnalogChannelScale[incChannel] * optr->AnalogUniversalScale;
-                ++incChannel;
-              }
-            }
-          }
-        }
-        catch (FormatError& )
-        {
-          // Let's try to continue even if the file is corrupted
-          if (optr->Source->atEnd())
-            warning("ORG.C3D - %s - Some points and/or analog data cannot be extracted and are set as invalid", optr->Source->name());
-          else
-            throw;
-        }
-        // Label, description, unit and type
-        size_t inc = 0; 
-        bool c3dFromMotion = (trial->property("MANUFACTURER:Company") == "Motion Analysis Corp");
-        std::vector<std::string> labels, descriptions;
-        // POINT Label, description, unit
         // NOTE: C3D files exported from "Motion Analysis Corp." softwares (EvaRT, Cortex) seem to use POINT:LABELS and POINTS:DESCRIPTIONS as a short and long version of the points' label respectively. Point's Label used in EvaRT and Cortex correspond to values stored in POINTS:DESCRIPTIONS. To distinguish C3D files exported from "Motion Analysis Corp." softwares, it is possible to check the value in the parameter MANUFACTURER:Company.
         // NOTE #2: Moreover, With (at least) Cortex 2.1.1 the occlusion of markers are not set by a mask and residuals equals to -1 but by coordinates set by 9999999 ...
+        bool c3dFromMotion = (trial->property("MANUFACTURER:Company") == "Motion Analysis Corp");
+        size_t pointSamples = lastSampleIndex - firstSampleIndex + 1;
+        // Selection of the frames and time sequences to extract (see HandlerReader::setOptions())
+        const ReadSelection selection(this->options());
+        size_t firstFrame = 0, frames = 0;
+        selection.frames(pointSamples, &firstFrame, &frames);
+        double startTime = static_cast<double>(firstSampleIndex-1+firstFrame) / pointSampleRate;
+        // Label and type of the points and analogs are known before the creation of the time sequences. Only the selected ones are created.
+        std::vector<std::string> pointLabels, pointDescriptions;
+        // POINT Label, description, unit
         if (!c3dFromMotion)
         {
           // POINT:LABELS & POINT:DESCRIPTIONS
-          C3DHandlerPrivate::mergeProperties<std::string>(&labels, trial, "POINT:LABELS", pointNumber, "uname*");
-          C3DHandlerPrivate::mergeProperties<std::string>(&descriptions, trial, "POINT:DESCRIPTIONS", pointNumber);
+          C3DHandlerPrivate::mergeProperties<std::string>(&pointLabels, trial, "POINT:LABELS", pointNumber, "uname*");
+          C3DHandlerPrivate::mergeProperties<std::string>(&pointDescriptions, trial, "POINT:DESCRIPTIONS", pointNumber);
         }
         else
         {
           // POINT:DESCRIPTIONS (which is in fact the exact label)
-          C3DHandlerPrivate::mergeProperties<std::string>(&labels, trial, "POINT:DESCRIPTIONS", pointNumber, "uname*");
-          descriptions.resize(pointNumber);
-          // Set the timesqeunces' but also adapt coordinates and residuals for occluded markers
-          inc = 0;
-          for (auto& pt: points)
-          {
-            for (size_t sample = 0 ; sample < pointSamples ; ++sample)
-            {
-              // Check only the value on coordinate X to speed up this part
-              if (fabs(pt->data()[sample] - 9999999.0) < std::numeric_limits<float>::epsilon())
-              {
-                pt->data()[sample] = 0.0;
-                pt->data()[sample + pointSamples] = 0.0;
-                pt->data()[sample + 2*pointSamples] = 0.0;
-                pt->data()[sample + 3*pointSamples] = -1.0; // residual
-              }
-            }
-          }
-        }
-        inc = 0;
-        for (auto& pt: points)
-        {
-          pt->setName(trim_string(labels[inc]));
-          pt->setDescription(trim_string(descriptions[inc]));
-          pt->setScale(fabs(pointScaleFactor));
-          ++inc;
+          C3DHandlerPrivate::mergeProperties<std::string>(&pointLabels, trial, "POINT:DESCRIPTIONS", pointNumber, "uname*");
+          pointDescriptions.resize(pointNumber);
+          // NOTE: The coordinates and residuals of the occluded markers are adapted during the decoding of the frames
         }
+        for (auto& label : pointLabels)
+          label = trim_string(label);
         // Point's type and unit
+        std::vector<int> pointTypes(pointNumber, TimeSequence::Position);
+        std::vector<std::string> pointTypeUnits(pointNumber, pointUnits[0]);
         const std::array<std::string,5> pointTypeNames{{"POINT:ANGLES","POINT:FORCES","POINT:MOMENTS","POINT:POWERS","POINT:SCALARS"}};
         const std::array<int,5> pointTypeTypes{{TimeSequence::Angle,TimeSequence::Force,TimeSequence::Moment,TimeSequence::Power,TimeSequence::Scalar}};
         for(size_t i = 0 ; i < pointTypeNames.size() ; ++i)
@@ -820,39 +863,141 @@ namespace io
           C3DHandlerPrivate::mergeProperties<std::string>(&labels, trial, pointTypeNames[i]);
           for (size_t j = 0 ; j < labels.size() ; ++j)
           {
-            auto pt = trial->timeSequences()->findChild<TimeSequence*>(trim_string(labels[j]),{},false);
-            if (pt != nullptr)
+            auto it = std::find(pointLabels.cbegin(), pointLabels.cend(), trim_string(labels[j]));
+            if (it != pointLabels.cend())
             {
-              pt->setUnit(trim_string(pointUnits[i+1])); // +1: because the first element in pointUnits stores markers' unit.
-              pt->setType(pointTypeTypes[i]);
+              const size_t idx = std::distance(pointLabels.cbegin(), it);
+              pointTypeUnits[idx] = trim_string(pointUnits[i+1]); // +1: because the first element in pointUnits stores markers' unit.
+              pointTypes[idx] = pointTypeTypes[i];
             }
           }
         }
-        // ANALOG Label, description, unit
+        std::vector<std::string> analogLabels, analogDescriptions;
         if (analogUsed.isValid())
         {
-          std::vector<std::string> labels, descriptions, units;
-          std::vector<int16_t> gains;
-          std::vector<float> ranges;
           if (!c3dFromMotion)
           {
-            // POINT:LABELS & POINT:DESCRIPTIONS
-            C3DHandlerPrivate::mergeProperties<std::string>(&labels, trial, "ANALOG:LABELS", numAnalogs, "uname*");
-            C3DHandlerPrivate::mergeProperties<std::string>(&descriptions, trial, "ANALOG:DESCRIPTIONS", numAnalogs);
+            // ANALOG:LABELS & ANALOG:DESCRIPTIONS
+            C3DHandlerPrivate::mergeProperties<std::string>(&analogLabels, trial, "ANALOG:LABELS", numAnalogs, "uname*");
+            C3DHandlerPrivate::mergeProperties<std::string>(&analogDescriptions, trial, "ANALOG:DESCRIPTIONS", numAnalogs);
           }
           else
           {
             // A for the points, Motion Analysis Corp. uses the parameter to store the exact analogs' label
-            C3DHandlerPrivate::mergeProperties<std::string>(&labels, trial, "ANALOG:DESCRIPTIONS", numAnalogs, "uname*");
+            C3DHandlerPrivate::mergeProperties<std::string>(&analogLabels, trial, "ANALOG:DESCRIPTIONS", numAnalogs, "uname*");
+            analogDescriptions.resize(numAnalogs);
           }
+        }
+        else
+        {
+          for (size_t i = 0 ; i < numAnalogs ; ++i)
+            analogLabels.push_back("uname*" + std::to_string(i+1));
+          analogDescriptions.resize(numAnalogs);
+        }
+        for (auto& label : analogLabels)
+          label = trim_string(label);
+        std::vector<TimeSequence*> points(pointNumber, nullptr), analogs(numAnalogs, nullptr);
+        bool selected = false;
+        for (size_t i = 0 ; i < points.size() ; ++i)
+        {
+          if (!selection.isSelected(pointLabels[i], pointTypes[i]))
+            continue;
+          points[i] = new TimeSequence(pointLabels[i],4,frames,pointSampleRate,startTime,pointTypes[i],pointTypeUnits[i],trial->timeSequences());
+          points[i]->setDescription(trim_string(pointDescriptions[i]));
+          points[i]->setScale(fabs(pointScaleFactor));
+          if (selection.metadataOnly())
+            ReadSelection::setStoredSamples(points[i], pointSamples);
+          selected = true;
+        }
+        for (size_t i = 0 ; i < analogs.size() ; ++i)
+        {
+          if (!selection.isSelected(analogLabels[i], TimeSequence::Analog))
+            continue;
+          analogs[i] = new TimeSequence(analogLabels[i],1,frames*numberSamplesPerAnalogChannel,pointSampleRate*numberSamplesPerAnalogChannel,startTime,TimeSequence::Analog,"V",trial->timeSequences());
+          if (selection.metadataOnly())
+            ReadSelection::setStoredSamples(analogs[i], pointSamples*numberSamplesPerAnalogChannel);
+          selected = true;
+        }
+        // Nothing to decode (e.g. metadata only)
+        if (frames == 0)
+          selected = false;
+        // The frames are decoded by a decoder specialized for the byte order and the format of the data. The coordinates, residuals, and analog samples are directly stored in their time sequence. Unselected points and analogs are skipped.
+        std::unique_ptr<C3DFrameDecoder> decoder(C3DFrameDecoder::create(stream.byteOrder(), optr->PointScale <= 0, optr->AnalogSignedIntegerFormat));
+        for (auto& pt: points)
+          decoder->Points.push_back((pt != nullptr) ? pt->data() : nullptr);
+        decoder->PointSamples = frames;
+        decoder->PointScale = optr->PointScale;
+        decoder->OcclusionCheck = c3dFromMotion;
+        for (auto& an: analogs)
+          decoder->Analogs.push_back((an != nullptr) ? an->data() : nullptr);
+        decoder->AnalogSamplesPerFrame = numberSamplesPerAnalogChannel;
+        decoder->AnalogZeroOffset = optr->AnalogZeroOffset;
+        decoder->AnalogChannelScale = optr->AnalogChannelScale;
+        decoder->AnalogUniversalScale = optr->AnalogUniversalScale;
+        const size_t frameSize = decoder->frameSize();
+        try
+        {
+          // Frames before the selected range are skipped. Those after are not read.
+          if (selected && (frameSize != 0) && (firstFrame != 0))
+            optr->Source->seek(firstFrame * frameSize, Origin::Current);
+          // Zero-copy when the device gives a direct access to its content (e.g. memory mapped file)
+          const char* data = (selected && (frameSize != 0)) ? optr->Source->consume(frames * frameSize) : nullptr;
+          if (data != nullptr)
+          {
+            // The frames have a fixed size. Ranges of frames are then decoded in parallel. Each thread writes in disjoint samples of the time sequences.
+            const size_t threads = C3DHandlerPrivate::decodingThreads(this->options(), frames, frameSize);
+            const size_t range = (frames + threads - 1) / threads;
+            std::vector<std::thread> workers;
+            try
+            {
+              for (size_t first = range ; first < frames ; first += range)
+                workers.emplace_back(&C3DFrameDecoder::decode, decoder.get(), data + first * frameSize, first, std::min(range, frames - first));
+            }
+            catch (...)
+            {
+              for (auto& worker : workers)
+                worker.join();
+              throw;
+            }
+            decoder->decode(data, 0, std::min(range, frames));
+            for (auto& worker : workers)
+              worker.join();
+          }
+          else if (selected && (frameSize != 0))
+          {
+            const size_t chunkFrames = std::max<size_t>(1, (1 << 20) / frameSize);
+            std::vector<char> buffer(std::min(chunkFrames, frames) * frameSize);
+            for (size_t sample = 0 ; sample < frames ; sample += chunkFrames)
+            {
+              const size_t num = std::min(chunkFrames, frames - sample);
+              optr->Source->read(buffer.data(), num * frameSize);
+              decoder->decode(buffer.data(), sample, num);
+            }
+          }
+        }
+        catch (FormatError& )
+        {
+          // Let's try to continue even if the file is corrupted
+          if (optr->Source->atEnd())
+            warning("ORG.C3D - %s - Some points and/or analog data cannot be extracted and are set as invalid", optr->Source->name());
+          else
+            throw;
+        }
+        // ANALOG unit, scale, offset, and range
+        if (analogUsed.isValid())
+        {
+          std::vector<std::string> units;
+          std::vector<int16_t> gains;
+          std::vector<float> ranges;
           C3DHandlerPrivate::mergeProperties(&units, trial, "ANALOG:UNITS", numAnalogs);
           C3DHandlerPrivate::mergeProperties(&gains, trial, "ANALOG:GAIN", numAnalogs);
           C3DHandlerPrivate::mergeProperties(&ranges, trial, "ANALOG:RANGE");
-          inc = 0;
-          for (auto& an: analogs)
+          for (size_t inc = 0 ; inc < analogs.size() ; ++inc)
           {
-            an->setName(trim_string(labels[inc]));
-            an->setDescription(trim_string(descriptions[inc]));
+            auto an = analogs[inc];
+            if (an == nullptr)
+              continue;
+            an->setDescription(trim_string(analogDescriptions[inc]));
             an->setUnit(trim_string(units[inc]));
             an->setScale(optr->AnalogChannelScale[inc] * optr->AnalogUniversalScale);
             an->setOffset(optr->AnalogZeroOffset[inc]);
@@ -887,7 +1032,6 @@ namespace io
               }
               break;
             }
-            ++inc;
           }
         }
         // Finally, try to generate instrument nodes from trial's parameters
@@ -991,20 +1135,97 @@ namespace io
   };
   
   /**
-   * Use the native byte order format to write data
+   * Use the native byte order format to write data, except if the option "byteOrder" is set (see HandlerWriter::setOptions()).
+   * The data are stored in the float format, except if the option "integerFormat" is set (see HandlerWriter::setOptions()).
+   * With the option "append", the frames of the trial are added at the end of the C3D file already stored in the device (see C3DHandlerPrivate::resumeHeaderAndParameters()). Only the data section and the number of frames are written.
    */
   void C3DHandler::writeDevice(const Node* const input)
   {
     auto optr = this->pimpl();
-    // Any valid data?
+    const Trial* trial = C3DHandlerPrivate::findTrial(input);
+    C3DDataLayout layout;
+    size_t storedFrames = 0;
+    auto itAppend = optr->Options.find("append");
+    const bool append = (itAppend != optr->Options.end()) && itAppend->second.cast<bool>();
+    if (append)
+    {
+      optr->resumeHeaderAndParameters(trial, &layout, &storedFrames);
+      // The frames to append are all the samples of the time sequences
+      layout.Frames = !layout.Points.empty() ? layout.Points[0]->samples() : layout.Analogs[0]->samples() / layout.AnalogSamplesPerFrame;
+      for (const auto& point : layout.Points)
+        if (point->samples() != layout.Frames) throw(FormatError("ORG.C3D - Points with a different number of frames cannot be appended."));
+      for (const auto& analog : layout.Analogs)
+        if (analog->samples() != layout.Frames * layout.AnalogSamplesPerFrame) throw(FormatError("ORG.C3D - The number of analog samples does not correspond to the number of frames to append."));
+    }
+    else
+      optr->writeHeaderAndParameters(trial, false, &layout);
+    // ==== //
+    // DATA //
+    // ==== //
+    if (layout.DataStartBlock == 0)
+      return;
+    if (!append)
+      optr->Source->seek(512 * (layout.DataStartBlock - 1), Origin::Begin);
+    std::unique_ptr<C3DFrameEncoder> encoder(optr->createEncoder(layout));
+    for (size_t i = 0, len = layout.Points.size() ; i < len ; ++i)
+      encoder->Points[i] = layout.Points[i]->data();
+    for (size_t i = 0, len = layout.Analogs.size() ; i < len ; ++i)
+      encoder->Analogs[i] = layout.Analogs[i]->data();
+    encoder->PointSamples = layout.Frames;
+    const size_t frameSize = encoder->frameSize();
+    if (frameSize == 0)
+      return;
+    // The frames are encoded by block and written in bulk. The memory used does not depend on the number of frames.
+    const size_t blockFrames = std::max<size_t>(1, 1048576 / frameSize);
+    std::vector<char> buffer(std::min(blockFrames, layout.Frames) * frameSize);
+    for (size_t frame = 0 ; frame < layout.Frames ; frame += blockFrames)
+    {
+      const size_t num = std::min(blockFrames, layout.Frames - frame);
+      encoder->encode(buffer.data(), frame, num);
+      optr->Source->write(buffer.data(), static_cast<Device::Size>(num * frameSize));
+    }
+    if (append)
+      optr->writeFrameCount(layout, storedFrames + layout.Frames);
+  };
+  
+  /**
+   * Returns the only trial found in the children of the given @a input.
+   * An exception is thrown if there is no trial or more than one.
+   */
+  const Trial* C3DHandlerPrivate::findTrial(const Node* const input)
+  {
     auto trials = input->findChildren<const Trial*>({},{},false);
     if (trials.empty())
       throw(FormatError("ORG.C3D - No Trial object found in the children of the given node."));
     else if (trials.size() > 1)
       throw(FormatError("ORG.C3D - More than one Trial object was found in the children of the given node."));
-    auto trial = trials[0];
-    // Create a native binary stream
-    BinaryStream stream(optr->Source);
+    return trials[0];
+  };
+  
+  /**
+   * Write the header and the parameter sections generated from the content of the @a trial.
+   * The @a layout of the data section is returned to let the caller write the frames. The device is not moved to the data section.
+   * In @a schema mode, the number of samples of the time sequences is not used. They only declare the content of the data section (labels, types, units, rates, scales) and the number of frames is set to 0. 
+   * The positions of the parameters POINT:FRAMES and TRIAL:ACTUAL_END_FIELD are then given by the @a layout to update them once the frames are written.
+   */
+  void C3DHandlerPrivate::writeHeaderAndParameters(const Trial* trial, bool schema, C3DDataLayout* layout)
+  {
+    // Create a binary stream in the byte order requested (native by default, see HandlerWriter::setOptions())
+    ByteOrder order = ByteOrder::Native;
+    auto itByteOrder = this->Options.find("byteOrder");
+    if (itByteOrder != this->Options.end())
+    {
+      const std::string value = itByteOrder->second.cast<std::string>();
+      if (value.compare("IEEELittleEndian") == 0)
+        order = ByteOrder::IEEELittleEndian;
+      else if (value.compare("IEEEBigEndian") == 0)
+        order = ByteOrder::IEEEBigEndian;
+      else if (value.compare("VAXLittleEndian") == 0)
+        order = ByteOrder::VAXLittleEndian;
+      else if (!value.empty() && (value.compare("Native") != 0))
+        throw(FormatError("ORG.C3D - Unknown byte order: " + value));
+    }
+    BinaryStream stream(this->Source, order);
     size_t writtenBytes = 0;
     double sampleRate = 0.0;
     double startTime = 0.0;
@@ -1029,6 +1250,10 @@ namespace io
       {ma::TimeSequence::Scalar,""}
     };
     double analogMinAbsoluteScale = std::numeric_limits<double>::infinity(), analogUniversalScale = 1.;
+    // Integer format: the scale factors are adapted to the range of the data (see HandlerWriter::setOptions()). In schema mode, the scales of the time sequences are used.
+    auto itIntegerFormat = this->Options.find("integerFormat");
+    const bool integerFormat = (itIntegerFormat != this->Options.end()) && itIntegerFormat->second.cast<bool>();
+    const bool automaticScales = integerFormat && !schema;
     // Prepare the content of the Trial
     //  - Any timesequence? If yes, then this is not a template file
     auto timeSequencesNode = trial->findChild("TimeSequences",{},false);
@@ -1063,7 +1288,7 @@ namespace io
         {
           sampleRate = point->sampleRate();
           startTime = point->startTime();
-          frames = point->samples();
+          frames = schema ? 0 : point->samples();
           pointScaleFactor = point->scale();
           first = false;
         }
@@ -1074,7 +1299,7 @@ namespace io
           throw(FormatError("ORG.C3D - The TimeSequence '" + point->name() + "' marked as 'Reconstructed' with 4 components does not have the same sample frequency than the others."));
         if (fabs(point->startTime() - startTime) > std::numeric_limits<float>::epsilon())
           throw(FormatError("ORG.C3D - The TimeSequence '" + point->name() + "' marked as 'Reconstructed' with 4 components does not have the same start time than the others."));
-        if (point->samples() != frames)
+        if (!schema && (point->samples() != frames))
           throw(FormatError("ORG.C3D - The TimeSequence '" + point->name() + "' marked as 'Reconstructed' with 4 components does not have the same number of samples than the others."));
         if (!itUnit->second.empty() && (itUnit->second.compare(point->unit()) != 0))
           throw(FormatError("ORG.C3D - The TimeSequence '" + point->name() + "' marked as 'Reconstructed' with 4 components does not have the same unit than the others of the same type."));
@@ -1093,8 +1318,24 @@ namespace io
         else if (point->type() == TimeSequence::Scalar)
           scalarLabels.push_back(point->name());
       }
-      if (!points.empty() && (frames == 0))
+      if (!schema && !points.empty() && (frames == 0))
         throw(FormatError("Points data has no samples!"));
+      if (automaticScales && !points.empty())
+      {
+        // The occluded samples are not used
+        double maxAbsoluteCoordinate = 0.0;
+        for (const auto& point: points)
+        {
+          const double* values = point->data();
+          for (size_t i = 0 ; i < frames ; ++i)
+          {
+            if (values[i + 3 * frames] >= 0.0)
+              maxAbsoluteCoordinate = std::max({maxAbsoluteCoordinate, fabs(values[i]), fabs(values[i + frames]), fabs(values[i + 2 * frames])});
+          }
+        }
+        if (maxAbsoluteCoordinate > 0.0)
+          pointScaleFactor = maxAbsoluteCoordinate / 32767.0;
+      }
       if (pointScaleFactor == 0)
         throw(FormatError("Null 3D scale factor found! The current implementation does not regenerate this factor. Please, contact the developers."));
       // And then the analog channels
@@ -1106,11 +1347,11 @@ namespace io
       analogGains.resize(numAnalogs);
       analogOffsets.resize(numAnalogs);
       analogScales.resize(numAnalogs);
-      optr->AnalogChannelScale.resize(numAnalogs);
-      optr->AnalogZeroOffset.resize(numAnalogs);
+      this->AnalogChannelScale.resize(numAnalogs);
+      this->AnalogZeroOffset.resize(numAnalogs);
       if (points.empty() && !analogs.empty())
       {
-        frames = analogs[0]->samples();
+        frames = schema ? 0 : analogs[0]->samples();
         sampleRate = analogs[0]->sampleRate();
         startTime = analogs[0]->startTime();
       }
@@ -1118,15 +1359,30 @@ namespace io
       size_t inc = 0;
       for (const auto& analog: analogs)
       {
-        if (first)
+        if (schema)
         {
-          numberAnalogSamplesPerPointSample = analog->samples() / frames;
-          first = false;
+          // Without samples, the number of analog samples per frame is deduced from the sample rates
+          const double ratio = analog->sampleRate() / sampleRate;
+          if (first)
+          {
+            numberAnalogSamplesPerPointSample = static_cast<uint16_t>(ratio + 0.5);
+            first = false;
+          }
+          if ((numberAnalogSamplesPerPointSample == 0) || (fabs(ratio - numberAnalogSamplesPerPointSample) > 1.0e-5))
+            throw(FormatError("ORG.C3D - The TimeSequence '" + analog->name() + "' marked as 'Analog' with 1 component does not have the same sample rate than the others."));
+        }
+        else
+        {
+          if (first)
+          {
+            numberAnalogSamplesPerPointSample = analog->samples() / frames;
+            first = false;
+          }
+          if ((analog->samples() / frames) != numberAnalogSamplesPerPointSample)
+            throw(FormatError("ORG.C3D - The TimeSequence '" + analog->name() + "' marked as 'Analog' with 1 component does not have the same number of samples than the others."));
+          if ((analog->samples() % frames) != 0)
+            throw(FormatError("ORG.C3D - The TimeSequence '" + analog->name() + "' marked as 'Analog' with 1 component does not have the same sample rate than the others."));
         }
-        if ((analog->samples() / frames) != numberAnalogSamplesPerPointSample)
-          throw(FormatError("ORG.C3D - The TimeSequence '" + analog->name() + "' marked as 'Analog' with 1 component does not have the same number of samples than the others."));
-        if ((analog->samples() % frames) != 0)
-          throw(FormatError("ORG.C3D - The TimeSequence '" + analog->name() + "' marked as 'Analog' with 1 component does not have the same sample rate than the others."));
         // double intpart = 0.0;
         // if (fabs(std::modf(analog->offset(), &intpart)) > 1e-5)
         //   throw(FormatError("ORG.C3D - The TimeSequence '" + analog->name() + "' marked as 'Analog' with 1 component does not have an integer offset but a real one. This is not supported by the C3D file format."));
@@ -1157,8 +1413,17 @@ namespace io
         analogUnits[inc] = analog->unit();
         analogOffsets[inc] = 0.0;//analog->offset();
         analogScales[inc] = analog->scale();
-        optr->AnalogZeroOffset[inc] = analogOffsets[inc];
-        optr->AnalogChannelScale[inc] = analogScales[inc];
+        if (automaticScales)
+        {
+          double maxAbsoluteValue = 0.0;
+          const double* values = analog->data();
+          for (size_t i = 0, len = analog->samples() ; i < len ; ++i)
+            maxAbsoluteValue = std::max(maxAbsoluteValue, fabs(values[i]));
+          if (maxAbsoluteValue > 0.0)
+            analogScales[inc] = maxAbsoluteValue / 32767.0;
+        }
+        this->AnalogZeroOffset[inc] = analogOffsets[inc];
+        this->AnalogChannelScale[inc] = analogScales[inc];
         analogMinAbsoluteScale = std::min(analogMinAbsoluteScale, fabs(analogScales[inc]));
         ++inc;
       }
@@ -1247,8 +1512,8 @@ namespace io
       writtenBytes += stream.writeU16(static_cast<uint16_t>(lastFrame > 65535 ? 65535 : lastFrame));
       // Maximum interpolation gap in 3D frames
       writtenBytes += stream.writeU16(static_cast<uint16_t>(pointMaximumInterpolationGap));
-      // The 3D scale factor
-      writtenBytes += stream.writeFloat(-static_cast<float>(pointScaleFactor));
+      // The 3D scale factor (negative for the float format)
+      writtenBytes += stream.writeFloat(integerFormat ? static_cast<float>(pointScaleFactor) : -static_cast<float>(pointScaleFactor));
       // The (false) number of the first block of the Data section
       writtenBytes += stream.writeU16(static_cast<uint16_t>(0));
       // The number of analog samples per analog channel
@@ -1301,11 +1566,13 @@ namespace io
     // The processor type
     writtenBytes += stream.writeI8(static_cast<int8_t>(static_cast<int>(stream.byteOrder()) + 83));
     // (Re)generate the properties used a group and parameters in the C3D format
-    auto props = trial->dynamicProperties();
+    // Note: The parameters read but not yet accessed are kept apart and are written back without being decoded.
+    auto props = trial->dynamicProperties(false);
+    auto deferred = trial->deferredProperties();
     // - POINT:* (USED, LABELS, DESCRIPTIONS, ...)
     std::vector<std::string> typegroups;
     typegroups.reserve(10);
-    auto generate_point_type_groups = [](std::unordered_map<std::string,Any>& props, std::vector<std::string>& typegroups, const std::string& type, const std::vector<std::string>& labels)
+    auto generate_point_type_groups = [&deferred](std::unordered_map<std::string,Any>& props, std::vector<std::string>& typegroups, const std::string& type, const std::vector<std::string>& labels)
     {
       if (!labels.empty())
       {
@@ -1314,10 +1581,13 @@ namespace io
         typegroups.push_back(type);
       }
       else
+      {
         props.erase("POINT:"+type+"S");
+        deferred.erase("POINT:"+type+"S");
+      }
     };
     C3DHandlerPrivate::createProperties(props, "POINT:USED", static_cast<int16_t>(numPoints));
-    C3DHandlerPrivate::createProperties(props, "POINT:SCALE", -static_cast<float>(pointScaleFactor));
+    C3DHandlerPrivate::createProperties(props, "POINT:SCALE", integerFormat ? static_cast<float>(pointScaleFactor) : -static_cast<float>(pointScaleFactor));
     C3DHandlerPrivate::createProperties(props, "POINT:RATE", static_cast<float>(sampleRate));
     C3DHandlerPrivate::createProperties(props, "POINT:FRAMES", static_cast<float>(static_cast<int16_t>(frames > 65535 ? 65535 : frames)));
     C3DHandlerPrivate::createProperties(props, "POINT:LABELS", pointLabels);
@@ -1336,7 +1606,10 @@ namespace io
     if (!typegroups.empty())
       C3DHandlerPrivate::createProperties(props, "POINT:TYPE_GROUPS", typegroups, {{2,static_cast<unsigned>(typegroups.size()/2)}});
     else
+    {
       props.erase("POINT:TYPE_GROUPS");
+      deferred.erase("POINT:TYPE_GROUPS");
+    }
     // - ANALOG:* (USED, LABELS, DESCRIPTIONS, ...)
     if (analogMinAbsoluteScale < 1.0e-5)
     {
@@ -1357,8 +1630,18 @@ namespace io
     C3DHandlerPrivate::createProperties(props, "ANALOG:OFFSET", analogOffsets);
     C3DHandlerPrivate::createProperties(props, "ANALOG:GEN_SCALE", analogUniversalScale);
     C3DHandlerPrivate::createProperties(props, "ANALOG:RATE", static_cast<float>(sampleRate * static_cast<double>(numberAnalogSamplesPerPointSample)));
-    props.erase("ANALOG:BITS");
-    props.erase("ANALOG:FORMAT");
+    if (integerFormat)
+    {
+      C3DHandlerPrivate::createProperties(props, "ANALOG:BITS", static_cast<int16_t>(16));
+      C3DHandlerPrivate::createProperties(props, "ANALOG:FORMAT", std::string("SIGNED"));
+    }
+    else
+    {
+      props.erase("ANALOG:BITS");
+      props.erase("ANALOG:FORMAT");
+      deferred.erase("ANALOG:BITS");
+      deferred.erase("ANALOG:FORMAT");
+    }
     // TODO: FORCE PLATFORM
     // TRIAL (ACTUAL_START_FIELD, ACTUAL_END_FIELD)
     std::array<int16_t,2> actualField;
@@ -1387,32 +1670,49 @@ namespace io
     }
     else
     {
-      auto it = props.begin();
-      while (it != props.end())
+      auto is_event = [](const std::string& key){return (key.compare(0,7,"EVENT:") == 0) || (key.compare(0,15,"EVENT_CONTEXT:") == 0);};
+      for (auto it = props.begin() ; it != props.end() ; )
+        it = is_event(it->first) ? props.erase(it) : std::next(it);
+      for (auto it = deferred.begin() ; it != deferred.end() ; )
+        it = is_event(it->first) ? deferred.erase(it) : std::next(it);
+    }
+    // The deferred parameters not regenerated are copied as is when their encoding is the same than the one used to write the file. Otherwise they are decoded.
+    std::unordered_map<std::string,const C3DDeferredParameter*> raws;
+    for (const auto& p : deferred)
+    {
+      if (props.find(p.first) != props.end())
+        continue;
+      const auto raw = p.second.target<C3DDeferredParameter>();
+      if ((raw != nullptr) && !raw->Truncated && (raw->Order == stream.byteOrder()))
+        raws.emplace(p.first, raw);
+      else
       {
-        if ((it->first.compare(0,7,"EVENT:") == 0) || (it->first.compare(0,15,"EVENT_CONTEXT:") == 0))
-          it = props.erase(it);
-        else
-          ++it;
+        Any value = p.second();
+        if (value.isValid())
+          props.emplace(p.first, value);
       }
     }
     // Transfrom the trial's dynamic properties into group and parameters
     std::vector<const char*> properties;
-    properties.reserve(props.size());
-    for (auto it = props.cbegin() ; it != props.cend() ; ++it)
+    properties.reserve(props.size() + raws.size());
+    auto list_properties = [&properties](const std::string& key)
     {
       // Remove properties that do not find the required format: 'GROUP:PARAMETER'.
-      if (it->first.find(':') == std::string::npos)
-        continue;
+      if (key.find(':') == std::string::npos)
+        return;
       // Special parameter updated during the writing 
-      if (it->first.compare("POINT:DATA_START") == 0)
-        continue;
-      properties.push_back(it->first.c_str());
-    }
+      if (key.compare("POINT:DATA_START") == 0)
+        return;
+      properties.push_back(key.c_str());
+    };
+    for (auto it = props.cbegin() ; it != props.cend() ; ++it)
+      list_properties(it->first);
+    for (auto it = raws.cbegin() ; it != raws.cend() ; ++it)
+      list_properties(it->first);
     std::sort(properties.begin(), properties.end(), [](const char* lhs, const char* rhs){return strcmp(lhs,rhs) < 0;});
     using group_t = std::tuple<const char*,uint8_t,int8_t>; // label (chars & len), id
     std::vector<group_t> groups;
-    using parameter_t = std::tuple<const char*,uint8_t,const Any&,int8_t>; // label (chars & len), value, id
+    using parameter_t = std::tuple<const char*,uint8_t,const Any*,int8_t,const C3DDeferredParameter*>; // label (chars & len), value, id, raw value
     std::vector<parameter_t> parameters;
     const char* cur = nullptr;
     int id = 0;
@@ -1436,10 +1736,16 @@ namespace io
       size_t len = strlen(*it) - idx;
       if ((len == 0) || (len > 127))
         throw(FormatError("ORG.C3D - The name of the parameter must be between 1 and 127 characters: '" + std::string(ch,idx+1) + "'."));
-      const auto& value = props.find(*it)->second;
+      auto itV = props.find(*it);
+      if (itV == props.end())
+      {
+        parameters.emplace_back(ch, static_cast<uint8_t>(len), nullptr, id, raws.find(*it)->second);
+        continue;
+      }
+      const auto& value = itV->second;
       if (!value.isArithmetic() && !value.isString())
         throw(FormatError("ORG.C3D - The value stored in the ma::Any object '" + std::string(*it) + "' is not compatible with the C3D format."));
-      parameters.emplace_back(ch, static_cast<uint8_t>(len), value, id);
+      parameters.emplace_back(ch, static_cast<uint8_t>(len), &value, id, nullptr);
     }
     for (const auto& group: groups)
     {
@@ -1456,17 +1762,26 @@ namespace io
       // The description
       // writtenBytes += stream.writeString(???);
     }
-    for (const auto& parameter: parameters)
+    for (size_t i = 0, len = parameters.size() ; i < len ; ++i)
     {
+      const auto& parameter = parameters[i];
       // Verify the compatibility of the property (format, dimensions, etc.)
-      const auto& data = std::get<2>(parameter);
+      static const Any none;
+      const auto raw = std::get<4>(parameter);
+      const auto& data = (raw == nullptr) ? *std::get<2>(parameter) : none;
       const auto& type = data.type();
       auto dimensions = data.dimensions();
       bool single = (data.size() == 1) && dimensions.empty();
       int8_t format = 0;
       std::vector<std::string> temp;
       std::function<size_t()> writeValue;
-      if ((type == static_typeid<const char*>()) || (type == static_typeid<std::string>()))
+      if (raw != nullptr)
+      {
+        format = raw->Type;
+        dimensions.assign(raw->Dimensions.cbegin(), raw->Dimensions.cend());
+        writeValue = [&]()->size_t{this->Source->write(raw->Section->data() + raw->Offset, raw->Size); return raw->Size;};
+      }
+      else if ((type == static_typeid<const char*>()) || (type == static_typeid<std::string>()))
       {
         format = -1;
         temp = data.cast<std::vector<std::string>>();
@@ -1547,7 +1862,11 @@ namespace io
       // Dimension(s)
       writtenBytes += stream.writeU8(static_cast<uint8_t>(dims.size()));
       writtenBytes += stream.writeU8(dims.size(), dims.data());
-      // Values
+      // Values (the position of the ones updated at the end of a streamed writing is kept)
+      if (strcmp(properties[i], "POINT:FRAMES") == 0)
+        layout->PointFramesPosition = this->Source->tell();
+      else if (strcmp(properties[i], "TRIAL:ACTUAL_END_FIELD") == 0)
+        layout->ActualEndFieldPosition = this->Source->tell();
       writtenBytes += writeValue();
       // Number of characters in the description
       writtenBytes += stream.writeU8(static_cast<uint8_t>(0));
@@ -1581,10 +1900,10 @@ namespace io
 
       writtenBytes += stream.fill(512 - (writtenBytes % 512));
       // Back to the parameter: number of blocks
-      optr->Source->seek(512 * (2 - 1) + 2, Origin::Begin);
+      this->Source->seek(512 * (2 - 1) + 2, Origin::Begin);
       stream.writeU8(pNB);
       // Back to the header: data first block
-      optr->Source->seek(16, Origin::Begin);
+      this->Source->seek(16, Origin::Begin);
       stream.writeU16(dataStartBlock);
     }
     else
@@ -1592,49 +1911,157 @@ namespace io
       writtenBytes += stream.fill(512 - (writtenBytes % 512));
       uint8_t pNB = static_cast<uint8_t>(writtenBytes / 512);
       // Back to the parameter: number of blocks
-      optr->Source->seek(2, Origin::Begin);
+      this->Source->seek(2, Origin::Begin);
       stream.writeU8(pNB);
     }
     if (writtenBytes > (255 * 512)) // 255 * 512 = max size
       throw(FormatError("ORG.C3D - Total size reserved for the parameters was exceeded."));
-    
-    // ==== //
-    // DATA //
-    // ==== //
-    if (!templateContent)
+    // Layout of the data section
+    layout->Points = points;
+    layout->Analogs = analogs;
+    layout->Frames = frames;
+    layout->FirstFrame = firstFrame;
+    layout->PointScale = pointScaleFactor;
+    layout->FloatFormat = !integerFormat;
+    layout->Order = order;
+    layout->AnalogSamplesPerFrame = numberAnalogSamplesPerPointSample;
+    layout->DataStartBlock = dataStartBlock;
+  };
+  
+  /**
+   * Prepare the device to append frames to the C3D file it stores.
+   * The header and parameter sections generated from the @a trial (in schema mode) are compared with the ones stored in the device. Only the content describing the data section is compared (see C3DHandlerPrivate::readSchema()): byte order, format and scale, point rate, number of analog samples per frame, first frame, and the parameters listing the channels (labels, rates, scales, offsets, format, used counts).
+   * The other parameters (e.g. descriptions, vendor parameters) can differ and the stored sections can have another size. Nothing is written in the device.
+   * The number of frames already stored is set in @a frames and the device is moved after them. The @a layout is the one used to encode the new frames, with the positions of the data section and of the number of frames found in the device.
+   */
+  void C3DHandlerPrivate::resumeHeaderAndParameters(const Trial* trial, C3DDataLayout* layout, size_t* frames)
+  {
+    // The expected sections are generated in memory
+    Device* target = this->Source;
+    Buffer expected;
+    expected.open(Mode::Out);
+    this->Source = &expected;
+    try
+    {
+      this->writeHeaderAndParameters(trial, true, layout);
+    }
+    catch (...)
     {
-      optr->Source->seek(512 * (dataStartBlock - 1), Origin::Begin);
-      C3DDataStreamFloat dataStream(&stream);
-      for (size_t frame = 0 ; frame < frames ; ++frame)
+      this->Source = target;
+      throw;
+    }
+    this->Source = target;
+    if (layout->DataStartBlock == 0)
+      throw(FormatError("ORG.C3D - The trial does not declare any point or analog channel to append."));
+    if (target->size() < 512)
+      throw(FormatError("ORG.C3D - The device does not contain a C3D file to append frames."));
+    Buffer generated;
+    generated.open(expected.data(), expected.size());
+    const C3DSchema reference = C3DHandlerPrivate::readSchema(&generated);
+    const C3DSchema stored = C3DHandlerPrivate::readSchema(target);
+    // Comparison of the schemas
+    std::string difference;
+    if (stored.Order != reference.Order)
+      difference = "byte order";
+    else if ((stored.PointScale != reference.PointScale) || (stored.PointRate != reference.PointRate))
+      difference = "point scale, format, or rate";
+    else if ((stored.Points != reference.Points) || (stored.AnalogSamples != reference.AnalogSamples))
+      difference = "number of points or analog samples";
+    else if (stored.FirstFrame != reference.FirstFrame)
+      difference = "first frame";
+    else
+    {
+      // Parameters compared as strings (true) or as numbers (false)
+      static const std::array<std::pair<const char*,bool>,11> parameters{{
+        {"POINT:USED", false}, {"POINT:LABELS", true}, {"POINT:SCALE", false}, {"POINT:RATE", false},
+        {"ANALOG:USED", false}, {"ANALOG:LABELS", true}, {"ANALOG:RATE", false}, {"ANALOG:SCALE", false}, {"ANALOG:GEN_SCALE", false}, {"ANALOG:OFFSET", false}, {"ANALOG:FORMAT", true}
+      }};
+      for (const auto& parameter : parameters)
       {
-        for (const auto& point : points)
-        {
-          dataStream.writePoint(
-            point->data()[frame],
-            point->data()[frame + frames],
-            point->data()[frame + 2*frames],
-            point->data()[frame + 3*frames],
-            pointScaleFactor);
-        }
-        size_t inc = 0, incChannel = 0, analogFrame = numberAnalogSamplesPerPointSample * frame;
-        auto itA = analogs.cbegin();
-        while (itA != analogs.cend())
+        auto lhs = reference.Parameters.find(parameter.first), rhs = stored.Parameters.find(parameter.first);
+        bool same = (lhs == reference.Parameters.cend()) && (rhs == stored.Parameters.cend());
+        if ((lhs != reference.Parameters.cend()) && (rhs != stored.Parameters.cend()))
         {
-          dataStream.writeAnalog(
-            (*itA)->data()[analogFrame]
-            / optr->AnalogChannelScale[incChannel]
-            / optr->AnalogUniversalScale
-            + optr->AnalogZeroOffset[incChannel]);
-          ++itA; ++incChannel;
-          if ((itA == analogs.cend()) && (inc < static_cast<size_t>(numberAnalogSamplesPerPointSample - 1)))
+          if (parameter.second)
           {
-            itA = analogs.cbegin();
-            incChannel = 0;
-            ++inc; ++analogFrame;
+            auto lhsValues = lhs->second.cast<std::vector<std::string>>(), rhsValues = rhs->second.cast<std::vector<std::string>>();
+            for (auto values : {&lhsValues, &rhsValues})
+              for (auto& value : *values) trim_string(&value);
+            same = (lhsValues == rhsValues);
           }
+          else
+            same = (lhs->second.cast<std::vector<double>>() == rhs->second.cast<std::vector<double>>());
+        }
+        if (!same)
+        {
+          difference = parameter.first;
+          break;
         }
       }
     }
+    if (!difference.empty())
+      throw(FormatError("ORG.C3D - The content of the device does not correspond to the given trial (" + difference + "). Frames can only be appended to a C3D file with the same channels, rates, scales, and format."));
+    if ((stored.DataStartBlock < 2) || ((stored.PointFramesPosition >= 0) && (stored.PointFramesFormat != 2) && (stored.PointFramesFormat != 4)))
+      throw(FormatError("ORG.C3D - Invalid position of the data section or of the number of frames in the stored C3D file."));
+    // The new frames are written after the stored ones, and the number of frames is updated where it is stored in the device
+    layout->DataStartBlock = stored.DataStartBlock;
+    layout->PointFramesPosition = stored.PointFramesPosition;
+    layout->PointFramesFormat = stored.PointFramesFormat;
+    layout->ActualEndFieldPosition = stored.ActualEndFieldPosition;
+    *frames = (stored.LastFrame >= layout->FirstFrame) ? static_cast<size_t>(stored.LastFrame - layout->FirstFrame + 1) : 0;
+    std::unique_ptr<C3DFrameEncoder> encoder(this->createEncoder(*layout));
+    const size_t dataEnd = 512 * (layout->DataStartBlock - 1) + *frames * encoder->frameSize();
+    if (target->size() < static_cast<Device::Size>(dataEnd))
+      throw(FormatError("ORG.C3D - The data section of the device is shorter than the number of frames declared."));
+    target->seek(static_cast<Device::Offset>(dataEnd), Origin::Begin);
   };
+  
+  /**
+   * Update the number of @a frames stored in the header and parameter sections (last frame, POINT:FRAMES, TRIAL:ACTUAL_END_FIELD).
+   * The positions of these values are given by the @a layout. The device is then moved to its end.
+   */
+  void C3DHandlerPrivate::writeFrameCount(const C3DDataLayout& layout, size_t frames)
+  {
+    BinaryStream stream(this->Source, layout.Order);
+    const int lastFrame = layout.FirstFrame + static_cast<int>(frames) - 1;
+    // Header: last frame
+    this->Source->seek(8, Origin::Begin);
+    stream.writeU16(static_cast<uint16_t>(lastFrame > 65535 ? 65535 : lastFrame));
+    // Parameters: POINT:FRAMES and TRIAL:ACTUAL_END_FIELD
+    if (layout.PointFramesPosition >= 0)
+    {
+      this->Source->seek(layout.PointFramesPosition, Origin::Begin);
+      if (layout.PointFramesFormat == 2)
+        stream.writeI16(static_cast<int16_t>(frames > 65535 ? 65535 : frames));
+      else
+        stream.writeFloat(static_cast<float>(static_cast<int16_t>(frames > 65535 ? 65535 : frames)));
+    }
+    if (layout.ActualEndFieldPosition >= 0)
+    {
+      int16_t actualField[2];
+      actualField[1] = static_cast<int16_t>(lastFrame >> 16); // HSB
+      actualField[0] = static_cast<int16_t>(lastFrame - (actualField[1] << 16)); // LSB
+      this->Source->seek(layout.ActualEndFieldPosition, Origin::Begin);
+      stream.writeI16(2, actualField);
+    }
+    this->Source->seek(0, Origin::End);
+  };
+  
+  /**
+   * Create the encoder of the frames described by the @a layout.
+   * The scales and offsets of the analog channels are set, while the pointers to the samples are left null. 
+   */
+  C3DFrameEncoder* C3DHandlerPrivate::createEncoder(const C3DDataLayout& layout) const
+  {
+    auto encoder = C3DFrameEncoder::create(layout.Order, layout.FloatFormat);
+    encoder->Points.resize(layout.Points.size(), nullptr);
+    encoder->PointScale = layout.PointScale;
+    encoder->Analogs.resize(layout.Analogs.size(), nullptr);
+    encoder->AnalogSamplesPerFrame = layout.AnalogSamplesPerFrame;
+    encoder->AnalogZeroOffset = this->AnalogZeroOffset;
+    encoder->AnalogChannelScale = this->AnalogChannelScale;
+    encoder->AnalogUniversalScale = this->AnalogUniversalScale;
+    return encoder;
+  };
+};
 };
-};
\ No newline at end of file
@@ -0,0 +1,178 @@
+/* 
+ * Open Source Movement Analysis Library
+ * Copyright (C) 2016, Moveck Solution Inc., all rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 
+ *     * Redistributions of source code must retain the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer.
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials
+ *       provided with the distribution.
+ *     * Neither the name(s) of the copyright holders nor the names
+ *       of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written
+ *       permission.
+ *  
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __openma_io_c3dhandler_p_h
+#define __openma_io_c3dhandler_p_h
+
+/*
+ * WARNING: This file and its content are not included in the public API and 
+ * can change drastically from one release to another.
+ */
+
+#include "openma/io/handler_p.h"
+#include "openma/io/device.h"
+#include "openma/io/enums.h"
+#include "openma/base/macros.h" // _OPENMA_NOEXCEPT, OPENMA_UNUSED
+#include "openma/base/any.h"
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <memory> // std::shared_ptr
+#include <type_traits>
+#include <cstdint>
+
+namespace ma
+{
+  class Node;
+  class Trial;
+  class TimeSequence;
+  
+namespace instrument
+{
+  class ForcePlate;
+};
+
+namespace io
+{
+  class C3DFrameEncoder;
+  class BinaryStream;
+  
+  // Value of a parameter kept encoded until it is accessed for the first time
+  struct C3DDeferredParameter
+  {
+    std::shared_ptr<const std::vector<char>> Section; // Raw content of the parameter section
+    ByteOrder Order;
+    int8_t Type;
+    std::vector<uint8_t> Dimensions;
+    size_t Offset; // Position of the value in the section
+    size_t Size; // Number of bytes used by the value
+    bool Truncated; // The value exceeds the space available in the parameter section
+    
+    Any operator()() const;
+  };
+  
+  // Layout of the data section generated from the content of a trial
+  struct C3DDataLayout
+  {
+    std::vector<const TimeSequence*> Points;
+    std::vector<const TimeSequence*> Analogs;
+    size_t Frames = 0;
+    int FirstFrame = 1;
+    double PointScale = 1.0;
+    bool FloatFormat = true;
+    ByteOrder Order = ByteOrder::Native;
+    size_t AnalogSamplesPerFrame = 1;
+    uint16_t DataStartBlock = 0; // 0: Template content without data section
+    Device::Position PointFramesPosition = -1; // Position of the value of the parameter POINT:FRAMES
+    int8_t PointFramesFormat = 4; // Type of the value of the parameter POINT:FRAMES (2: integer, 4: real)
+    Device::Position ActualEndFieldPosition = -1; // Position of the value of the parameter TRIAL:ACTUAL_END_FIELD
+  };
+  
+  // Content of the header and of the parameters describing the data section of a C3D file
+  struct C3DSchema
+  {
+    ByteOrder Order = ByteOrder::Native;
+    uint16_t Points = 0;
+    uint16_t AnalogSamples = 0; // Number of analog samples per point frame (all channels)
+    int FirstFrame = 1;
+    int LastFrame = 0;
+    double PointScale = 1.0;
+    double PointRate = 0.0;
+    uint16_t DataStartBlock = 0;
+    std::unordered_map<std::string,Any> Parameters; // Only the ones used to describe the data section (e.g. POINT:LABELS, ANALOG:SCALE)
+    Device::Position PointFramesPosition = -1;
+    int8_t PointFramesFormat = 0;
+    Device::Position ActualEndFieldPosition = -1;
+  };
+  
+  class C3DHandlerPrivate : public HandlerPrivate
+  {
+  public:
+    C3DHandlerPrivate();
+    ~C3DHandlerPrivate() _OPENMA_NOEXCEPT;
+
+    C3DHandlerPrivate(const C3DHandlerPrivate& ) = delete;
+    C3DHandlerPrivate(C3DHandlerPrivate&& ) _OPENMA_NOEXCEPT = delete;
+    C3DHandlerPrivate& operator=(const C3DHandlerPrivate& ) = delete;
+    C3DHandlerPrivate& operator=(const C3DHandlerPrivate&& ) _OPENMA_NOEXCEPT = delete;
+    
+    double PointScale;
+    int PointMaximumInterpolationGap;
+    int AnalogResolution;
+    std::vector<double> AnalogChannelScale;
+    std::vector<double> AnalogZeroOffset;
+    double AnalogUniversalScale;
+    bool AnalogSignedIntegerFormat;
+    
+    template <typename T>
+    static inline typename std::enable_if<!std::is_same<T,std::string>::value,T>::type generateDefaultValue(T&& blank, int idx)
+    {
+      OPENMA_UNUSED(idx);
+      return blank;
+    };
+  
+    template <typename T>
+    static inline typename std::enable_if<std::is_same<T,std::string>::value,T>::type generateDefaultValue(T&& blank, int idx)
+    {
+      return (blank.empty() ? blank : blank + std::to_string(idx));
+    };
+    
+    template <typename T>
+    static void mergeProperties(std::vector<T>* target, Trial* trial, const std::string& base, int finalSize = -1, T&& defaultValue = T());
+    
+    template <typename T>
+    static void createProperties(std::unordered_map<std::string,Any>& props, const std::string& name, const T& value);
+    
+    template <typename T>
+    static void createProperties(std::unordered_map<std::string,Any>& props, const std::string& name, const std::vector<T>& values, size_t inc = 1);
+    
+    template <typename T>
+    static void createProperties(std::unordered_map<std::string,Any>& props, const std::string& name, const std::vector<T>& values, const std::vector<unsigned>& dims, size_t inc = 1);
+    
+    static void extractForcePlatformData(instrument::ForcePlate* fp, const std::vector<TimeSequence*>& analogs, double* origin, double* corners, int* channelIndices, size_t channelStep, double* calMatrix = nullptr, const unsigned* calMatrixSize = nullptr);
+    
+    static Any readParameterValue(BinaryStream* stream, int8_t type, std::vector<uint8_t> dims, bool truncated);
+    static C3DSchema readSchema(Device* source);
+    
+    static const Trial* findTrial(const Node* const input);
+    void writeHeaderAndParameters(const Trial* trial, bool schema, C3DDataLayout* layout);
+    void resumeHeaderAndParameters(const Trial* trial, C3DDataLayout* layout, size_t* frames);
+    void writeFrameCount(const C3DDataLayout& layout, size_t frames);
+    C3DFrameEncoder* createEncoder(const C3DDataLayout& layout) const;
+  };
+};
+};
+
+#endif // __openma_io_c3dhandler_p_h
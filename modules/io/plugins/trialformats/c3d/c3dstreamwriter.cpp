@@ -0,0 +1,385 @@
+/* 
+ * Open Source Movement Analysis Library
+ * Copyright (C) 2016, Moveck Solution Inc., all rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 
+ *     * Redistributions of source code must retain the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer.
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials
+ *       provided with the distribution.
+ *     * Neither the name(s) of the copyright holders nor the names
+ *       of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written
+ *       permission.
+ *  
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "openma/io/c3dstreamwriter.h"
+#include "c3dhandler_p.h"
+#include "c3ddatastream.h"
+
+#include "openma/io/device.h"
+#include "openma/io/binarystream.h"
+#include "openma/io/enums.h"
+#include "openma/base/trial.h"
+#include "openma/base/timesequence.h"
+
+#include <algorithm> // std::min, std::max
+#include <functional> // std::function
+
+// -------------------------------------------------------------------------- //
+//                                 PRIVATE API                                //
+// -------------------------------------------------------------------------- //
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+
+namespace ma
+{
+namespace io
+{
+  class C3DStreamWriterPrivate
+  {
+  public:
+    C3DStreamWriterPrivate(Device* device);
+    ~C3DStreamWriterPrivate() _OPENMA_NOEXCEPT;
+    
+    bool process(const std::function<void()>& fn);
+    void prepare(const Trial* schema);
+    void start();
+    
+    C3DHandlerPrivate Writer; // Device, error, and analog scales used to write the header and parameter sections
+    C3DDataLayout Layout;
+    std::unique_ptr<C3DFrameEncoder> Encoder;
+    std::vector<char> Buffer;
+    size_t Frames;
+    bool Opened;
+    std::vector<std::string> PointLabels;
+    std::vector<std::string> AnalogLabels;
+  };
+  
+  C3DStreamWriterPrivate::C3DStreamWriterPrivate(Device* device)
+  : Writer(), Layout(), Encoder(), Buffer(), Frames(0), Opened(false), PointLabels(), AnalogLabels()
+  {
+    this->Writer.Source = device;
+  };
+  
+  C3DStreamWriterPrivate::~C3DStreamWriterPrivate() _OPENMA_NOEXCEPT = default; // Cannot be inlined
+  
+  /**
+   * Run the given function and convert any thrown exception into an error code and message.
+   */
+  bool C3DStreamWriterPrivate::process(const std::function<void()>& fn)
+  {
+    this->Writer.ErrorCode = Error::None;
+    this->Writer.ErrorMessage.clear();
+    if ((this->Writer.Source == nullptr) || !this->Writer.Source->isOpen())
+    {
+      this->Writer.ErrorCode = Error::Device;
+      this->Writer.ErrorMessage = "No valid device assigned.";
+      return false;
+    }
+    try
+    {
+      fn();
+    }
+    catch (Device::Failure& )
+    {
+      this->Writer.ErrorCode = Error::Device;
+      this->Writer.ErrorMessage = "Loss of integrity in the device";
+    }
+    catch (FormatError& e)
+    {
+      this->Writer.ErrorCode = Error::InvalidData;
+      this->Writer.ErrorMessage = e.what();
+    }
+    catch (std::exception& e)
+    {
+      this->Writer.ErrorCode = Error::Unexpected;
+      this->Writer.ErrorMessage = "Unexpected exception during the writing of a device. Please report this to the support: " + std::string(e.what());
+    }
+    catch(...)
+    {
+      this->Writer.ErrorCode = Error::Unknown;
+      this->Writer.ErrorMessage = "Unknown exception during the writing of a device. Please report this to the support";
+    }
+    return (this->Writer.ErrorCode == Error::None);
+  };
+  
+  /**
+   * Verify that a new stream can be open with the given @a schema.
+   */
+  void C3DStreamWriterPrivate::prepare(const Trial* schema)
+  {
+    if (this->Opened)
+      throw(FormatError("ORG.C3D - The stream writer is already open."));
+    if (schema == nullptr)
+      throw(FormatError("ORG.C3D - Impossible to write the content of a null schema."));
+    this->Writer.Source->setExceptions(State::End | State::Fail | State::Error);
+    this->Layout = C3DDataLayout{};
+  };
+  
+  /**
+   * Create the encoder from the layout of the data section. The labels of the channels are kept.
+   */
+  void C3DStreamWriterPrivate::start()
+  {
+    if (this->Layout.Points.empty() && this->Layout.Analogs.empty())
+      throw(FormatError("ORG.C3D - The schema does not declare any point or analog channel."));
+    this->PointLabels.clear();
+    for (const auto& point : this->Layout.Points)
+      this->PointLabels.push_back(point->name());
+    this->AnalogLabels.clear();
+    for (const auto& analog : this->Layout.Analogs)
+      this->AnalogLabels.push_back(analog->name());
+    // The schema is not used anymore
+    this->Layout.Points.assign(this->Layout.Points.size(), nullptr);
+    this->Layout.Analogs.assign(this->Layout.Analogs.size(), nullptr);
+    this->Encoder.reset(this->Writer.createEncoder(this->Layout));
+    this->Opened = true;
+  };
+};
+};
+
+#endif
+
+// ------------------------------------------------------------------------- //
+//                                 PUBLIC API                                //
+// ------------------------------------------------------------------------- //
+
+namespace ma
+{
+namespace io
+{
+  /**
+   * @class C3DStreamWriter openma/io/c3dstreamwriter.h
+   * @brief Incremental writer of C3D files
+   *
+   * Contrary to the HandlerWriter which needs all the samples of a trial in memory, this writer stores the frames as soon as they are given.
+   * The header and parameter sections are generated from a schema (i.e. a trial where the time sequences only declare the content: labels, types, units, rates, scales). The number of samples of these time sequences is not used.
+   * Blocks of frames are then appended using appendFrames(). Finally, the method close() updates the number of frames stored in the header and parameter sections (last frame, POINT:FRAMES, TRIAL:ACTUAL_END_FIELD).
+   * The memory used by this writer is bounded and does not depend on the number of frames.
+   *
+   * A file previously written can also be extended using the method append() instead of open(). Only the new frames are written, followed by the update of the number of frames. Checkpointing a long acquisition does not require to rewrite the whole file.
+   *
+   * @code{.unparsed}
+   * // The schema has time sequences with the wanted labels, types, rates, etc. (number of samples not used)
+   * ma::io::File file;
+   * file.open(filename, ma::io::Mode::Out);
+   * ma::io::C3DStreamWriter writer(&file);
+   * writer.open(&schema);
+   * while (acquisition.isRunning())
+   *   writer.appendFrames(num, points, analogs);
+   * writer.close();
+   * @endcode
+   *
+   * The data are written in the float format with the native byte order, like the C3D handler used by the HandlerWriter.
+   *
+   * @ingroup openma_io
+   */
+  
+  /**
+   * Constructor.
+   * The given @a device must be open in write mode and supports random access (see Device::seek()).
+   */
+  C3DStreamWriter::C3DStreamWriter(Device* device)
+  : mp_Pimpl(new C3DStreamWriterPrivate(device))
+  {};
+  
+  /**
+   * Destructor.
+   * If the writer is still open, the method close() is called.
+   */
+  C3DStreamWriter::~C3DStreamWriter()
+  {
+    if (this->isOpen())
+      this->close();
+  };
+  
+  /**
+   * Sets the device used to write the data.
+   * This has no effect if the writer is open.
+   */
+  void C3DStreamWriter::setDevice(Device* device)
+  {
+    auto optr = this->pimpl();
+    if (!optr->Opened)
+      optr->Writer.Source = device;
+  };
+  
+  /**
+   * Write the header and parameter sections generated from the given @a schema.
+   * The points are the time sequences with 4 components marked as Reconstructed, while the analog channels are the time sequences with 1 component of type Analog. All of them must have the same start time. The number of analog samples per frame is deduced from the sample rates.
+   * The order of the labels returned by pointLabels() and analogLabels() is the order expected by appendFrames().
+   * If an error occurs, false is returned. You can use the methods errorCode() and errorMessage() to retrieve it.
+   */
+  bool C3DStreamWriter::open(const Trial* schema)
+  {
+    auto optr = this->pimpl();
+    return optr->process([&]{
+      optr->prepare(schema);
+      optr->Writer.writeHeaderAndParameters(schema, true, &optr->Layout);
+      optr->start();
+      optr->Frames = 0;
+      optr->Writer.Source->seek(512 * (optr->Layout.DataStartBlock - 1), Origin::Begin);
+    });
+  };
+  
+  /**
+   * Reopen the C3D file stored in the device to append new frames after the ones already stored.
+   * The device must be open in read and write mode (i.e. Mode::In | Mode::Out) and supports random access.
+   * The content of the @a schema describing the data section (byte order, format, scales, rates, and the labels of the channels in the same order) must correspond to the one stored in the file (see C3DHandlerPrivate::resumeHeaderAndParameters()). The other parameters are not compared. Otherwise, the file is not modified and false is returned.
+   * The method frames() returns the total number of frames, including the stored ones. Only the appended frames are written and the method close() updates the number of frames.
+   */
+  bool C3DStreamWriter::append(const Trial* schema)
+  {
+    auto optr = this->pimpl();
+    return optr->process([&]{
+      optr->prepare(schema);
+      if ((optr->Writer.Source->openMode() & Mode::In) != Mode::In)
+        throw(FormatError("ORG.C3D - The device must be open in read and write mode to append frames."));
+      size_t frames = 0;
+      optr->Writer.resumeHeaderAndParameters(schema, &optr->Layout, &frames);
+      optr->start();
+      optr->Frames = frames;
+    });
+  };
+  
+  /**
+   * Encode and write @a num frames.
+   * The samples of the @a points are stored plane by plane, like in a TimeSequence: for each point (see pointLabels()), the @a num coordinates X, then Y, Z and the residuals.
+   * The samples of the @a analogs are stored channel by channel (see analogLabels()): @a num times analogSamplesPerFrame() samples for each one.
+   * The frames are encoded by block to bound the memory used by the writer.
+   */
+  bool C3DStreamWriter::appendFrames(size_t num, const double* points, const double* analogs)
+  {
+    auto optr = this->pimpl();
+    return optr->process([&]{
+      if (!optr->Opened)
+        throw(FormatError("ORG.C3D - The stream writer is not open."));
+      auto encoder = optr->Encoder.get();
+      const size_t numPoints = encoder->Points.size(), numAnalogs = encoder->Analogs.size();
+      if ((num == 0) || (encoder->frameSize() == 0))
+        return;
+      if (((numPoints != 0) && (points == nullptr)) || ((numAnalogs != 0) && (analogs == nullptr)))
+        throw(FormatError("ORG.C3D - Missing samples to append frames."));
+      for (size_t i = 0 ; i < numPoints ; ++i)
+        encoder->Points[i] = points + i * 4 * num;
+      encoder->PointSamples = num;
+      for (size_t i = 0 ; i < numAnalogs ; ++i)
+        encoder->Analogs[i] = analogs + i * num * encoder->AnalogSamplesPerFrame;
+      const size_t frameSize = encoder->frameSize();
+      const size_t blockFrames = std::max<size_t>(1, 1048576 / frameSize);
+      optr->Buffer.resize(std::max(optr->Buffer.size(), std::min(blockFrames, num) * frameSize));
+      for (size_t frame = 0 ; frame < num ; frame += blockFrames)
+      {
+        const size_t len = std::min(blockFrames, num - frame);
+        encoder->encode(optr->Buffer.data(), frame, len);
+        optr->Writer.Source->write(optr->Buffer.data(), static_cast<Device::Size>(len * frameSize));
+      }
+      optr->Frames += num;
+    });
+  };
+  
+  /**
+   * Update the number of frames in the header and parameter sections (last frame, POINT:FRAMES, TRIAL:ACTUAL_END_FIELD).
+   * The device is not closed.
+   * If the update fails, false is returned (see errorCode() and errorMessage()) and the writer stays opened.
+   */
+  bool C3DStreamWriter::close()
+  {
+    auto optr = this->pimpl();
+    return optr->process([&]{
+      if (!optr->Opened)
+        return;
+      // The writer stays opened if the header cannot be patched (an exception is thrown), so that close() can be called again
+      optr->Writer.writeFrameCount(optr->Layout, optr->Frames);
+      if (optr->Writer.Source->hasFailure())
+        throw(Device::Failure("ma::io::C3DStreamWriter::close"));
+      optr->Opened = false;
+      optr->Encoder.reset();
+      optr->Buffer = std::vector<char>{};
+    });
+  };
+  
+  /**
+   * Returns true if the header and parameter sections were written and the frames can be appended.
+   */
+  bool C3DStreamWriter::isOpen() const _OPENMA_NOEXCEPT
+  {
+    auto optr = this->pimpl();
+    return optr->Opened;
+  };
+  
+  /**
+   * Returns the number of frames stored in the device, including the ones already stored when the method append() was used.
+   */
+  size_t C3DStreamWriter::frames() const _OPENMA_NOEXCEPT
+  {
+    auto optr = this->pimpl();
+    return optr->Frames;
+  };
+  
+  /**
+   * Returns the labels of the points in the order expected by appendFrames().
+   */
+  const std::vector<std::string>& C3DStreamWriter::pointLabels() const _OPENMA_NOEXCEPT
+  {
+    auto optr = this->pimpl();
+    return optr->PointLabels;
+  };
+  
+  /**
+   * Returns the labels of the analog channels in the order expected by appendFrames().
+   */
+  const std::vector<std::string>& C3DStreamWriter::analogLabels() const _OPENMA_NOEXCEPT
+  {
+    auto optr = this->pimpl();
+    return optr->AnalogLabels;
+  };
+  
+  /**
+   * Returns the number of analog samples stored in each frame for each analog channel.
+   */
+  unsigned C3DStreamWriter::analogSamplesPerFrame() const _OPENMA_NOEXCEPT
+  {
+    auto optr = this->pimpl();
+    return static_cast<unsigned>(optr->Layout.AnalogSamplesPerFrame);
+  };
+  
+  /**
+   * Returns the error code of the last operation.
+   */
+  Error C3DStreamWriter::errorCode() const _OPENMA_NOEXCEPT
+  {
+    auto optr = this->pimpl();
+    return optr->Writer.ErrorCode;
+  };
+  
+  /**
+   * Returns the error message of the last operation.
+   */
+  const std::string& C3DStreamWriter::errorMessage() const _OPENMA_NOEXCEPT
+  {
+    auto optr = this->pimpl();
+    return optr->Writer.ErrorMessage;
+  };
+};
+};
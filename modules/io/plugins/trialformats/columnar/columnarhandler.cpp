@@ -0,0 +1,643 @@
+/* 
+ * Open Source Movement Analysis Library
+ * Copyright (C) 2016, Moveck Solution Inc., all rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 
+ *     * Redistributions of source code must retain the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer.
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials
+ *       provided with the distribution.
+ *     * Neither the name(s) of the copyright holders nor the names
+ *       of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written
+ *       permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "columnarhandler.h"
+#include "trialformats/snapshot/snapshothandler_p.h"
+
+#include "openma/io/handler_p.h"
+#include "openma/io/device.h"
+#include "openma/io/enums.h"
+#include "openma/base/any.h"
+#include "openma/base/node.h"
+#include "openma/base/timesequence.h"
+
+#include <vector>
+#include <algorithm> // std::min, std::max
+#include <limits>
+#include <cmath>
+#include <cstring> // memcpy, memcmp
+
+// -------------------------------------------------------------------------- //
+//                                 PRIVATE API                                //
+// -------------------------------------------------------------------------- //
+
+namespace ma
+{
+namespace io
+{
+  static const char _columnar_signature[8] = {'O','M','A','C','T','A','\0','\0'};
+  _OPENMA_CONSTEXPR uint32_t _columnar_version = 1;
+  _OPENMA_CONSTEXPR uint32_t _columnar_byte_order_mark = 0x01020304;
+  _OPENMA_CONSTEXPR uint64_t _columnar_header_size = 32;
+  _OPENMA_CONSTEXPR size_t _columnar_block_samples = 4096;
+  _OPENMA_CONSTEXPR size_t _columnar_partition_samples = 256;
+  _OPENMA_CONSTEXPR unsigned _columnar_max_width = 56;
+  _OPENMA_CONSTEXPR size_t _columnar_max_exceptions = 255;
+  
+  enum class ColumnarBlock : uint8_t {Raw, Predicted, Constant, Exact};
+  
+  static inline uint64_t _ma_io_columnar_zigzag(uint64_t value)
+  {
+    return (value << 1) ^ (0 - (value >> 63));
+  };
+  
+  static inline uint64_t _ma_io_columnar_unzigzag(uint64_t value)
+  {
+    return (value >> 1) ^ (0 - (value & 1));
+  };
+  
+  static inline unsigned _ma_io_columnar_width(uint64_t value)
+  {
+    unsigned width = 0;
+    while (value != 0)
+    {
+      value >>= 1;
+      ++width;
+    }
+    return width;
+  };
+  
+  // Load 8 bytes without reading past the end of the stream (missing bytes are set to zero).
+  static inline uint64_t _ma_io_columnar_load(const char* data, const char* end)
+  {
+    uint64_t word = 0;
+    if ((end - data) >= 8)
+      memcpy(&word, data, sizeof(word));
+    else
+      memcpy(&word, data, static_cast<size_t>(end - data));
+    return word;
+  };
+  
+  /*
+   * Pack a partition of residuals with the same number of bits (least significant bits first).
+   * The width is chosen to minimize the size of the partition. The residuals too large for it are stored afterwards as exceptions (index and value).
+   * Return false if the residuals cannot be packed.
+   */
+  static bool _ma_io_columnar_pack(const uint64_t* residuals, size_t num, std::vector<char>* bytes)
+  {
+    size_t histogram[65] = {0};
+    for (size_t i = 0 ; i < num ; ++i)
+      ++histogram[_ma_io_columnar_width(residuals[i])];
+    unsigned width = 0;
+    size_t exceptions = num, bestCost = std::numeric_limits<size_t>::max();
+    for (unsigned w = 0 ; w <= _columnar_max_width ; ++w)
+    {
+      exceptions -= histogram[w];
+      const size_t cost = num * w + exceptions * 72;
+      if ((exceptions <= _columnar_max_exceptions) && (cost < bestCost))
+      {
+        width = w;
+        bestCost = cost;
+      }
+    }
+    if (bestCost == std::numeric_limits<size_t>::max())
+      return false;
+    const uint64_t mask = (width == 0) ? 0 : (~uint64_t(0) >> (64 - width));
+    exceptions = 0;
+    for (size_t i = 0 ; i < num ; ++i)
+      exceptions += (residuals[i] > mask) ? 1 : 0;
+    bytes->push_back(static_cast<char>(width));
+    bytes->push_back(static_cast<char>(exceptions));
+    // An extra word is allocated to write each value with a single store
+    const size_t start = bytes->size(), size = (num * width + 7) / 8;
+    bytes->resize(start + size + 8, 0);
+    char* data = bytes->data() + start;
+    for (size_t i = 0 ; i < num ; ++i)
+    {
+      const size_t offset = i * width;
+      uint64_t word;
+      memcpy(&word, data + offset / 8, sizeof(word));
+      word |= (residuals[i] & mask) << (offset % 8);
+      memcpy(data + offset / 8, &word, sizeof(word));
+    }
+    bytes->resize(start + size);
+    for (size_t i = 0 ; i < num ; ++i)
+    {
+      if (residuals[i] <= mask)
+        continue;
+      bytes->push_back(static_cast<char>(i));
+      const char* value = reinterpret_cast<const char*>(residuals + i);
+      bytes->insert(bytes->end(), value, value + sizeof(uint64_t));
+    }
+    return true;
+  };
+  
+  // Prediction of a sample by a linear predictor of order 0 (none), 1 (previous value), or 2 (linear extrapolation). The samples before the block are considered null. The arithmetic wraps around to be defined for any quantized value.
+  static inline uint64_t _ma_io_columnar_predict(const uint64_t* values, size_t i, unsigned order)
+  {
+    const uint64_t previous = (i > 0) ? values[i-1] : 0;
+    if (order == 0)
+      return 0;
+    else if (order == 1)
+      return previous;
+    return 2 * previous - ((i > 1) ? values[i-2] : 0);
+  };
+  
+  static void _ma_io_columnar_encode_raw(const double* values, size_t num, std::vector<char>* bytes)
+  {
+    bytes->push_back(static_cast<char>(ColumnarBlock::Raw));
+    const char* data = reinterpret_cast<const char*>(values);
+    bytes->insert(bytes->end(), data, data + num * sizeof(double));
+  };
+  
+  /*
+   * Encode a block of samples. The samples are quantized with the given step, predicted with the linear predictor minimizing the residuals, and the residuals are packed by partition.
+   * If the step is not strictly positive, the samples are not quantized but their bit patterns are predicted instead (lossless coding). The trailing zeros common to all the patterns (e.g. samples converted from single precision values) are not stored.
+   * Samples which cannot be quantized (not finite or too large) are stored as is. The same is done if the coded block is larger than the raw one.
+   */
+  static void _ma_io_columnar_encode_block(const double* values, size_t num, double step, std::vector<char>* bytes)
+  {
+    if (std::all_of(values, values + num, [values](double value){return memcmp(&value, values, sizeof(double)) == 0;}))
+    {
+      bytes->push_back(static_cast<char>(ColumnarBlock::Constant));
+      const char* data = reinterpret_cast<const char*>(values);
+      bytes->insert(bytes->end(), data, data + sizeof(double));
+      return;
+    }
+    // Quantization
+    _OPENMA_CONSTEXPR double limit = 9007199254740992.0; // 2^53
+    std::vector<uint64_t> quantized(num), residuals(num);
+    unsigned shift = 0;
+    if (step > 0.0)
+    {
+      for (size_t i = 0 ; i < num ; ++i)
+      {
+        const double value = std::round(values[i] / step);
+        if (!(std::fabs(value) < limit))
+        {
+          _ma_io_columnar_encode_raw(values, num, bytes);
+          return;
+        }
+        quantized[i] = static_cast<uint64_t>(static_cast<int64_t>(value));
+      }
+    }
+    else
+    {
+      uint64_t patterns = 0;
+      for (size_t i = 0 ; i < num ; ++i)
+      {
+        memcpy(&quantized[i], values + i, sizeof(double));
+        patterns |= quantized[i];
+      }
+      while ((shift < 63) && ((patterns & (uint64_t(1) << shift)) == 0))
+        ++shift;
+      for (size_t i = 0 ; i < num ; ++i)
+        quantized[i] >>= shift;
+    }
+    // Prediction
+    unsigned order = 0;
+    double bestSum = std::numeric_limits<double>::infinity();
+    for (unsigned o = 0 ; o < 3 ; ++o)
+    {
+      double sum = 0.0;
+      for (size_t i = 0 ; i < num ; ++i)
+        sum += std::fabs(static_cast<double>(static_cast<int64_t>(quantized[i] - _ma_io_columnar_predict(quantized.data(), i, o))));
+      if (sum < bestSum)
+      {
+        order = o;
+        bestSum = sum;
+      }
+    }
+    for (size_t i = 0 ; i < num ; ++i)
+      residuals[i] = _ma_io_columnar_zigzag(quantized[i] - _ma_io_columnar_predict(quantized.data(), i, order));
+    // Coding
+    const size_t start = bytes->size();
+    if (step > 0.0)
+    {
+      bytes->push_back(static_cast<char>(ColumnarBlock::Predicted));
+      bytes->push_back(static_cast<char>(order));
+      const char* data = reinterpret_cast<const char*>(&step);
+      bytes->insert(bytes->end(), data, data + sizeof(double));
+    }
+    else
+    {
+      bytes->push_back(static_cast<char>(ColumnarBlock::Exact));
+      bytes->push_back(static_cast<char>(order));
+      bytes->push_back(static_cast<char>(shift));
+    }
+    bool packed = true;
+    for (size_t i = 0 ; packed && (i < num) ; i += _columnar_partition_samples)
+      packed = _ma_io_columnar_pack(residuals.data() + i, std::min(_columnar_partition_samples, num - i), bytes);
+    if (!packed || ((bytes->size() - start) > (1 + num * sizeof(double))))
+    {
+      bytes->resize(start);
+      _ma_io_columnar_encode_raw(values, num, bytes);
+    }
+  };
+  
+  /*
+   * Unpack groups of 8 residuals packed with the same number of bits. As the width is known at compile time, the shifts are constant and the loop can be unrolled.
+   * Each group uses exactly Width bytes but one more word can be read after it. Null residuals are not stored.
+   */
+  template <unsigned Width>
+  static void _ma_io_columnar_unpack(const char* packed, size_t groups, uint64_t* residuals)
+  {
+    if (Width == 0)
+    {
+      std::fill(residuals, residuals + groups * 8, 0);
+      return;
+    }
+    const uint64_t mask = ~uint64_t(0) >> ((64 - Width) & 63);
+    for (size_t g = 0 ; g < groups ; ++g)
+    {
+      const char* data = packed + g * Width;
+      for (unsigned k = 0 ; k < 8 ; ++k)
+      {
+        uint64_t word;
+        memcpy(&word, data + (k * Width) / 8, sizeof(word));
+        residuals[g * 8 + k] = (word >> ((k * Width) % 8)) & mask;
+      }
+    }
+  };
+  
+  typedef void (*ColumnarUnpack)(const char* , size_t , uint64_t* );
+  
+  static const ColumnarUnpack _columnar_unpack[_columnar_max_width + 1] = {
+    &_ma_io_columnar_unpack<0>,  &_ma_io_columnar_unpack<1>,  &_ma_io_columnar_unpack<2>,  &_ma_io_columnar_unpack<3>,  &_ma_io_columnar_unpack<4>,  &_ma_io_columnar_unpack<5>,  &_ma_io_columnar_unpack<6>,  &_ma_io_columnar_unpack<7>,
+    &_ma_io_columnar_unpack<8>,  &_ma_io_columnar_unpack<9>,  &_ma_io_columnar_unpack<10>, &_ma_io_columnar_unpack<11>, &_ma_io_columnar_unpack<12>, &_ma_io_columnar_unpack<13>, &_ma_io_columnar_unpack<14>, &_ma_io_columnar_unpack<15>,
+    &_ma_io_columnar_unpack<16>, &_ma_io_columnar_unpack<17>, &_ma_io_columnar_unpack<18>, &_ma_io_columnar_unpack<19>, &_ma_io_columnar_unpack<20>, &_ma_io_columnar_unpack<21>, &_ma_io_columnar_unpack<22>, &_ma_io_columnar_unpack<23>,
+    &_ma_io_columnar_unpack<24>, &_ma_io_columnar_unpack<25>, &_ma_io_columnar_unpack<26>, &_ma_io_columnar_unpack<27>, &_ma_io_columnar_unpack<28>, &_ma_io_columnar_unpack<29>, &_ma_io_columnar_unpack<30>, &_ma_io_columnar_unpack<31>,
+    &_ma_io_columnar_unpack<32>, &_ma_io_columnar_unpack<33>, &_ma_io_columnar_unpack<34>, &_ma_io_columnar_unpack<35>, &_ma_io_columnar_unpack<36>, &_ma_io_columnar_unpack<37>, &_ma_io_columnar_unpack<38>, &_ma_io_columnar_unpack<39>,
+    &_ma_io_columnar_unpack<40>, &_ma_io_columnar_unpack<41>, &_ma_io_columnar_unpack<42>, &_ma_io_columnar_unpack<43>, &_ma_io_columnar_unpack<44>, &_ma_io_columnar_unpack<45>, &_ma_io_columnar_unpack<46>, &_ma_io_columnar_unpack<47>,
+    &_ma_io_columnar_unpack<48>, &_ma_io_columnar_unpack<49>, &_ma_io_columnar_unpack<50>, &_ma_io_columnar_unpack<51>, &_ma_io_columnar_unpack<52>, &_ma_io_columnar_unpack<53>, &_ma_io_columnar_unpack<54>, &_ma_io_columnar_unpack<55>,
+    &_ma_io_columnar_unpack<56>
+  };
+  
+  /*
+   * Unpack the residuals of a block and invert the linear predictor with running sums (the samples before the block being null). Return the address following the last partition.
+   * The restored values are multiplied by the quantization step or, for a lossless block (Exact set to true), shifted back to the bit patterns of the samples.
+   * The predictor and the kind of block are template parameters to keep the decoding loop free of their selection.
+   */
+  template <unsigned Order, bool Exact>
+  static const char* _ma_io_columnar_decode_residuals(const char* data, const char* end, size_t num, double step, unsigned shift, double* values)
+  {
+    uint64_t residuals[_columnar_partition_samples];
+    uint64_t quantized = 0, difference = 0;
+    for (size_t i = 0 ; i < num ; i += _columnar_partition_samples)
+    {
+      const size_t inc = std::min(_columnar_partition_samples, num - i);
+      if ((end - data) < 2)
+        throw(FormatError("OPENMA.CTA - Corrupted block. Unexpected end of the coded samples."));
+      const unsigned width = static_cast<unsigned char>(data[0]);
+      const size_t exceptions = static_cast<unsigned char>(data[1]);
+      const size_t size = (inc * width + 7) / 8;
+      const char* packed = data + 2;
+      const char* patches = packed + size;
+      if ((width > _columnar_max_width) || (static_cast<size_t>(end - packed) < (size + exceptions * 9)))
+        throw(FormatError("OPENMA.CTA - Corrupted block. Unexpected end of the coded samples."));
+      data = patches + exceptions * 9;
+      // Groups which can be read by words without going past the packed residuals. The last residuals are extracted one by one.
+      const size_t groups = (width == 0) ? (inc / 8) : std::min(inc / 8, (size < 8) ? 0 : (size - 8) / width);
+      _columnar_unpack[width](packed, groups, residuals);
+      const uint64_t mask = (width == 0) ? 0 : (~uint64_t(0) >> (64 - width));
+      for (size_t j = groups * 8 ; j < inc ; ++j)
+        residuals[j] = (_ma_io_columnar_load(packed + (j * width) / 8, patches) >> ((j * width) % 8)) & mask;
+      for (size_t e = 0 ; e < exceptions ; ++e)
+      {
+        const size_t index = static_cast<unsigned char>(patches[e*9]);
+        if (index >= inc)
+          throw(FormatError("OPENMA.CTA - Corrupted block. The index of an exception is out of range."));
+        memcpy(residuals + index, patches + e * 9 + 1, sizeof(uint64_t));
+      }
+      for (size_t j = 0 ; j < inc ; ++j)
+      {
+        const uint64_t value = _ma_io_columnar_unzigzag(residuals[j]);
+        if (Order == 0)
+          quantized = value;
+        else if (Order == 1)
+          quantized += value;
+        else
+        {
+          difference += value;
+          quantized += difference;
+        }
+        if (Exact)
+        {
+          const uint64_t pattern = quantized << shift;
+          memcpy(values + i + j, &pattern, sizeof(double));
+        }
+        else
+          values[i+j] = static_cast<double>(static_cast<int64_t>(quantized)) * step;
+      }
+    }
+    return data;
+  };
+  
+  static void _ma_io_columnar_decode_block(const char* data, size_t size, size_t num, double* values)
+  {
+    if (size < 1)
+      throw(FormatError("OPENMA.CTA - Corrupted block. Its size is too small."));
+    switch (static_cast<ColumnarBlock>(data[0]))
+    {
+    case ColumnarBlock::Raw:
+      if (size != (1 + num * sizeof(double)))
+        throw(FormatError("OPENMA.CTA - Corrupted block. Its size does not match the number of samples."));
+      memcpy(values, data + 1, num * sizeof(double));
+      break;
+    case ColumnarBlock::Constant:
+      {
+      if (size != (1 + sizeof(double)))
+        throw(FormatError("OPENMA.CTA - Corrupted block. Its size does not match the number of samples."));
+      double value;
+      memcpy(&value, data + 1, sizeof(double));
+      std::fill(values, values + num, value);
+      break;
+      }
+    case ColumnarBlock::Predicted:
+      {
+      if (size < (2 + sizeof(double)))
+        throw(FormatError("OPENMA.CTA - Corrupted block. Its size is too small."));
+      const unsigned order = static_cast<unsigned char>(data[1]);
+      double step;
+      memcpy(&step, data + 2, sizeof(double));
+      if (order > 2)
+        throw(FormatError("OPENMA.CTA - Corrupted block. Unknown predictor."));
+      const char* end = data + size;
+      const char* last = nullptr;
+      if (order == 0)
+        last = _ma_io_columnar_decode_residuals<0,false>(data + 2 + sizeof(double), end, num, step, 0, values);
+      else if (order == 1)
+        last = _ma_io_columnar_decode_residuals<1,false>(data + 2 + sizeof(double), end, num, step, 0, values);
+      else
+        last = _ma_io_columnar_decode_residuals<2,false>(data + 2 + sizeof(double), end, num, step, 0, values);
+      if (last != end)
+        throw(FormatError("OPENMA.CTA - Corrupted block. Its size does not match the coded samples."));
+      break;
+      }
+    case ColumnarBlock::Exact:
+      {
+      if (size < 3)
+        throw(FormatError("OPENMA.CTA - Corrupted block. Its size is too small."));
+      const unsigned order = static_cast<unsigned char>(data[1]);
+      const unsigned shift = static_cast<unsigned char>(data[2]);
+      if (order > 2)
+        throw(FormatError("OPENMA.CTA - Corrupted block. Unknown predictor."));
+      if (shift > 63)
+        throw(FormatError("OPENMA.CTA - Corrupted block. Invalid shift of the bit patterns."));
+      const char* end = data + size;
+      const char* last = nullptr;
+      if (order == 0)
+        last = _ma_io_columnar_decode_residuals<0,true>(data + 3, end, num, 0.0, shift, values);
+      else if (order == 1)
+        last = _ma_io_columnar_decode_residuals<1,true>(data + 3, end, num, 0.0, shift, values);
+      else
+        last = _ma_io_columnar_decode_residuals<2,true>(data + 3, end, num, 0.0, shift, values);
+      if (last != end)
+        throw(FormatError("OPENMA.CTA - Corrupted block. Its size does not match the coded samples."));
+      break;
+      }
+    default:
+      throw(FormatError("OPENMA.CTA - Corrupted block. Unknown type of block."));
+    }
+  };
+  
+  static inline size_t _ma_io_columnar_blocks(size_t samples)
+  {
+    return (samples + _columnar_block_samples - 1) / _columnar_block_samples;
+  };
+  
+  // Return the address of @a size bytes read from the current position of the @a source. The bytes are copied in @a buffer only if the device cannot give a direct access to them.
+  // A size going past the end of the device (e.g. truncated file, corrupted index) sets the same state than a short read, without allocating the buffer.
+  static const char* _ma_io_columnar_fetch(Device* source, uint64_t size, std::vector<char>* buffer)
+  {
+    const char* data = source->consume(static_cast<Device::Size>(size));
+    if (data == nullptr)
+    {
+      const uint64_t position = static_cast<uint64_t>(source->tell()), available = static_cast<uint64_t>(source->size());
+      if ((position > available) || (size > available - position))
+        source->setState(State::End | State::Fail);
+      buffer->resize(size);
+      source->read(buffer->data(), static_cast<Device::Size>(size));
+      data = buffer->data();
+    }
+    return data;
+  };
+};
+};
+
+// -------------------------------------------------------------------------- //
+//                                 PUBLIC API                                 //
+// -------------------------------------------------------------------------- //
+
+namespace ma
+{
+namespace io
+{
+ /*
+  * The OpenMA columnar format stores a tree of nodes with compressed samples. It is designed to archive trials in a compact form while keeping a random access to the samples of each time sequence.
+  * The file starts with a header of 32 bytes (signature, version, byte order mark, size of the metadata, number of blocks) followed by the metadata of the nodes (same layout than the snapshot format), an index of the blocks, and the blocks.
+  * Each component of a time sequence is a column split in blocks of 4096 samples. The index gives the offset of each block, so that a range of frames or a single time sequence can be decoded without reading the rest of the file.
+  * In a block, the samples are predicted by a linear predictor of order 0, 1, or 2 (the one minimizing the residuals is chosen), and the residuals are bit packed by partition of 256 samples (the width of a partition is adapted to its residuals, the few larger ones being stored apart). Each residual is unpacked independently of the others which keeps the decoding fast. A constant block is stored as a single value and a block which cannot be coded in less bytes (e.g. not finite values) is stored as is.
+  * By default, the compression is lossless: the predicted values are the bit patterns of the samples. The samples are quantized only if the writing option "resolution" is given (see HandlerWriter::setOptions()). Each sample is then restored with an error up to the half of this quantization step, but the residuals are much smaller.
+  * @note The file is several times smaller than a C3D file only with the option "resolution". Without it, the file is about twice smaller than a C3D file when the samples come from single precision values (e.g. read from a C3D file), but it can be larger than a C3D file for samples using the full double precision (the C3D format stores them as float values). In both modes, the decoding time on one core is in the same range than the C3D reader.
+  * The reading supports the options channels, types, firstFrame, lastFrame, and metadata (see HandlerReader::setOptions()). Only the blocks covering the selected frames are decoded.
+  * @warning The file is written with the byte order of the processor and cannot be read by a processor using another byte order.
+  */
+
+  ColumnarHandler::ColumnarHandler()
+  : Handler()
+  {};
+  
+  ColumnarHandler::~ColumnarHandler() _OPENMA_NOEXCEPT = default;
+  
+  Signature ColumnarHandler::verifySignature(const Device* const device) _OPENMA_NOEXCEPT
+  {
+    char signature[8] = {0};
+    device->peek(signature,sizeof(signature));
+    if (memcmp(signature, _columnar_signature, sizeof(signature)) != 0)
+      return Signature::Invalid;
+    return Signature::Valid;
+  };
+  
+  Signature ColumnarHandler::verifySignature() const _OPENMA_NOEXCEPT
+  {
+    return verifySignature(this->device());
+  };
+  
+  void ColumnarHandler::readDevice(Node* output)
+  {
+    auto source = this->device();
+    source->setExceptions(State::End | State::Fail | State::Error);
+    // Header
+    char header[_columnar_header_size];
+    source->read(header, sizeof(header));
+    uint32_t version = 0, byteOrderMark = 0;
+    uint64_t metadataSize = 0, numBlocks = 0;
+    memcpy(&version, header + 8, 4);
+    memcpy(&byteOrderMark, header + 12, 4);
+    memcpy(&metadataSize, header + 16, 8);
+    memcpy(&numBlocks, header + 24, 8);
+    if (memcmp(header, _columnar_signature, sizeof(_columnar_signature)) != 0)
+      throw(FormatError("OPENMA.CTA - Invalid signature."));
+    if (byteOrderMark != _columnar_byte_order_mark)
+      throw(FormatError("OPENMA.CTA - The file was written with a different byte order and cannot be read on this processor."));
+    if (version != _columnar_version)
+      throw(FormatError("OPENMA.CTA - Unsupported version: " + std::to_string(version) + "."));
+    // The sections must be stored in the device before to allocate memory for them
+    const uint64_t deviceSize = static_cast<uint64_t>(source->size());
+    if (metadataSize > deviceSize - _columnar_header_size)
+      throw(FormatError("OPENMA.CTA - Corrupted header. The metadata exceed the end of the device."));
+    if (numBlocks >= (deviceSize - _columnar_header_size - metadataSize) / sizeof(uint64_t))
+      throw(FormatError("OPENMA.CTA - Corrupted header. The index of the blocks exceeds the end of the device."));
+    // Metadata (the samples of the time sequences cannot exceed the capacity of the blocks)
+    std::vector<char> buffer;
+    const char* metadata = _ma_io_columnar_fetch(source, metadataSize, &buffer);
+    SnapshotDecoder decoder("OPENMA.CTA", metadata, metadataSize, numBlocks * _columnar_block_samples * sizeof(double));
+    decoder.decode(output);
+    // Index
+    uint64_t expectedBlocks = 0;
+    for (const auto& sequence : decoder.Sequences)
+      expectedBlocks += sequence.Sequence->components() * _ma_io_columnar_blocks(sequence.Sequence->samples());
+    if (numBlocks != expectedBlocks)
+      throw(FormatError("OPENMA.CTA - Corrupted header. The number of blocks does not match the time sequences."));
+    std::vector<uint64_t> offsets(numBlocks + 1);
+    source->read(reinterpret_cast<char*>(offsets.data()), static_cast<Device::Size>(offsets.size() * sizeof(uint64_t)));
+    if ((offsets[0] != 0) || !std::is_sorted(offsets.cbegin(), offsets.cend()))
+      throw(FormatError("OPENMA.CTA - Corrupted index. The offsets of the blocks are not ordered."));
+    const uint64_t dataOffset = _columnar_header_size + metadataSize + offsets.size() * sizeof(uint64_t);
+    // Selection of the time sequences and of the frames (relative to the lowest sample rate)
+    const ReadSelection selection(this->options());
+    double lowestRate = 0.0;
+    size_t lowestSamples = 0;
+    std::vector<bool> selected(decoder.Sequences.size(), false);
+    for (size_t i = 0 ; i < decoder.Sequences.size() ; ++i)
+    {
+      const auto ts = decoder.Sequences[i].Sequence;
+      if (!selection.isSelected(ts->name(), ts->type()))
+        continue;
+      selected[i] = true;
+      const double rate = ts->sampleRate();
+      if ((rate > 0.0) && ((lowestRate == 0.0) || (rate < lowestRate) || ((rate == lowestRate) && (ts->samples() > lowestSamples))))
+      {
+        lowestRate = rate;
+        lowestSamples = ts->samples();
+      }
+    }
+    size_t firstFrame = 0, frames = 0;
+    selection.frames(lowestSamples, &firstFrame, &frames);
+    // Samples
+    uint64_t block = 0;
+    std::vector<double> values(_columnar_block_samples);
+    for (size_t i = 0 ; i < decoder.Sequences.size() ; ++i)
+    {
+      const auto ts = decoder.Sequences[i].Sequence;
+      const size_t samples = ts->samples(), components = ts->components(), blocks = _ma_io_columnar_blocks(samples);
+      const uint64_t firstBlock = block;
+      block += components * blocks;
+      if (!selected[i])
+      {
+        decoder.Nodes[decoder.Sequences[i].Index].reset();
+        continue;
+      }
+      const double ratio = (lowestRate > 0.0) ? (ts->sampleRate() / lowestRate) : 1.0;
+      const size_t first = std::min(samples, static_cast<size_t>(std::llround(static_cast<double>(firstFrame) * ratio)));
+      const size_t count = std::min(samples - first, static_cast<size_t>(std::llround(static_cast<double>(frames) * ratio)));
+      if (!selection.selectsAll() || (first != 0) || (count != samples) || selection.metadataOnly())
+      {
+        ts->resize(static_cast<unsigned>(count));
+        ts->setStartTime(ts->startTime() + static_cast<double>(first) / ts->sampleRate());
+        if (selection.metadataOnly())
+          ReadSelection::setStoredSamples(ts, samples);
+      }
+      if (count == 0)
+        continue;
+      const size_t b0 = first / _columnar_block_samples, b1 = (first + count - 1) / _columnar_block_samples;
+      for (size_t c = 0 ; c < components ; ++c)
+      {
+        const uint64_t begin = offsets[firstBlock + c * blocks + b0], end = offsets[firstBlock + c * blocks + b1 + 1];
+        source->seek(static_cast<Device::Offset>(dataOffset + begin), Origin::Begin);
+        const char* data = _ma_io_columnar_fetch(source, end - begin, &buffer);
+        double* column = ts->data() + c * count;
+        for (size_t b = b0 ; b <= b1 ; ++b)
+        {
+          const uint64_t offset = offsets[firstBlock + c * blocks + b] - begin;
+          const uint64_t size = offsets[firstBlock + c * blocks + b + 1] - begin - offset;
+          const size_t start = b * _columnar_block_samples, num = std::min(_columnar_block_samples, samples - start);
+          const size_t from = std::max(start, first), to = std::min(start + num, first + count);
+          // Blocks fully selected are decoded in place
+          if ((from == start) && (to == start + num))
+            _ma_io_columnar_decode_block(data + offset, size, num, column + start - first);
+          else
+          {
+            _ma_io_columnar_decode_block(data + offset, size, num, values.data());
+            std::copy(values.data() + from - start, values.data() + to - start, column + from - first);
+          }
+        }
+      }
+    }
+    decoder.link(output);
+  };
+  
+  void ColumnarHandler::writeDevice(const Node* const input)
+  {
+    auto source = this->device();
+    SnapshotEncoder encoder("OPENMA.CTA");
+    encoder.encode(input);
+    double resolution = 0.0;
+    auto it = this->options().find("resolution");
+    if ((it != this->options().cend()) && it->second.isValid())
+      resolution = it->second.cast<double>();
+    // Blocks
+    std::vector<char> data;
+    std::vector<uint64_t> offsets(1, 0);
+    for (const auto& sequence : encoder.Sequences)
+    {
+      const auto ts = sequence.first;
+      const size_t samples = ts->samples();
+      for (size_t c = 0 ; c < ts->components() ; ++c)
+      {
+        const double* column = ts->data() + c * samples;
+        for (size_t start = 0 ; start < samples ; start += _columnar_block_samples)
+        {
+          _ma_io_columnar_encode_block(column + start, std::min(_columnar_block_samples, samples - start), resolution, &data);
+          offsets.push_back(data.size());
+        }
+      }
+    }
+    // Header
+    const uint64_t metadataSize = encoder.Bytes.size();
+    const uint64_t numBlocks = offsets.size() - 1;
+    char header[_columnar_header_size];
+    memcpy(header, _columnar_signature, sizeof(_columnar_signature));
+    memcpy(header + 8, &_columnar_version, 4);
+    memcpy(header + 12, &_columnar_byte_order_mark, 4);
+    memcpy(header + 16, &metadataSize, 8);
+    memcpy(header + 24, &numBlocks, 8);
+    source->write(header, sizeof(header));
+    source->write(encoder.Bytes.data(), static_cast<Device::Size>(metadataSize));
+    source->write(reinterpret_cast<const char*>(offsets.data()), static_cast<Device::Size>(offsets.size() * sizeof(uint64_t)));
+    source->write(data.data(), static_cast<Device::Size>(data.size()));
+  };
+};
+};
@@ -34,10 +34,12 @@
 
 #include "hpfhandler.h"
 
+#include "openma/config.h" // _OPENMA_ARCH, _OPENMA_IEEE_LE
 #include "openma/io/handler_p.h"
 #include "openma/io/buffer.h"
 #include "openma/io/device.h"
 #include "openma/io/binarystream.h"
+#include "openma/io/binarystream_p.h" // ByteOrderConverter
 #include "openma/io/enums.h"
 #include "openma/io/utils.h"
 #include "openma/base/any.h"
@@ -47,9 +49,12 @@
 #include "openma/base/logger.h"
 
 #include <string>
-#include <list>
 #include <vector>
+#include <algorithm> // std::max, std::min, std::copy
+#include <limits>
 #include <cmath>
+#include <thread>
+#include <memory> // std::unique_ptr
 
 
 #include <pugixml.hpp>
@@ -69,6 +74,32 @@ namespace io
     int64_t size;
     int32_t group;
   };
+  
+  // Samples of one channel stored in a data chunk
+  struct HPFDataBlock
+  {
+    TimeSequence* timesequence;
+    size_t position; // Position of the first sample in the device
+    size_t offset; // Index of the first sample in the time sequence
+    size_t samples;
+  };
+  
+  // The samples of a block are converted by tiles with the bulk kernel of the converter, then widened into the time sequence.
+  static void _ma_io_hpf_decode_blocks(const ByteOrderConverter* converter, const char* content, const HPFDataBlock* blocks, size_t num)
+  {
+    const size_t tile = 1024;
+    float values[tile];
+    for (size_t i = 0 ; i < num ; ++i)
+    {
+      double* data = blocks[i].timesequence->data() + blocks[i].offset;
+      for (size_t first = 0 ; first < blocks[i].samples ; first += tile)
+      {
+        const size_t samples = std::min(tile, blocks[i].samples - first);
+        converter->convertFloat(samples, content + blocks[i].position + 4 * first, reinterpret_cast<char*>(values));
+        std::copy(values, values + samples, data + first);
+      }
+    }
+  };
 
 };
 };
@@ -138,30 +169,61 @@ namespace io
     //  - Data chunk: 0x3000
     const int64_t channelInfoChunkID = 0x2000;
     const int64_t dataChunkID = 0x3000;
-    std::list<HPFChunkInfo> chunks;
-    // EOF bit can be triggered by the Read* methods while FAIL can be triggered by the SeekRead method.
-    this->device()->setExceptions(State::Error);
-    do
+    std::vector<HPFChunkInfo> chunks;
+    // Zero-copy when the device gives a direct access to its content (e.g. memory mapped file).
+    // The values are then converted by the bulk kernels of the converter, which is only possible when the host architecture is IEEE little endian.
+    std::unique_ptr<ByteOrderConverter> converter(ByteOrderConverter::create(ByteOrder::IEEELittleEndian));
+#if _OPENMA_ARCH == _OPENMA_IEEE_LE
+    const char* content = this->device()->data();
+#else
+    const char* content = nullptr;
+#endif
+    const size_t contentSize = (content != nullptr) ? static_cast<size_t>(this->device()->size()) : 0;
+    if (content != nullptr)
     {
-      size_t chunkPosition = static_cast<size_t>(this->device()->tell());
-      chunkID = stream.readI64();
-      chunkSize = stream.readI64();
-      int64_t already_read = 16;
-      if ((chunkID == channelInfoChunkID) || (chunkID == dataChunkID))
+      // The headers of the chunks are decoded directly from the content in one pass
+      size_t chunkPosition = static_cast<size_t>(chunkSize);
+      while ((chunkPosition + 16) <= contentSize)
       {
-        HPFChunkInfo ci;
-        ci.position = chunkPosition;
-        ci.id = chunkID;
-        ci.size = chunkSize;
-        ci.group = stream.readI32();
-        chunks.push_back(ci);
-        already_read += 4;
+        converter->convert64(1, content + chunkPosition, reinterpret_cast<char*>(&chunkID));
+        converter->convert64(1, content + chunkPosition + 8, reinterpret_cast<char*>(&chunkSize));
+        if (chunkSize < 16)
+          throw(FormatError("Invalid chunk size in the HPF file."));
+        if (((chunkID == channelInfoChunkID) || (chunkID == dataChunkID)) && ((chunkPosition + 20) <= contentSize))
+        {
+          int32_t group = 0;
+          converter->convert32(1, content + chunkPosition + 16, reinterpret_cast<char*>(&group));
+          chunks.push_back(HPFChunkInfo{chunkPosition, chunkID, chunkSize, group});
+        }
+        chunkPosition += static_cast<size_t>(chunkSize);
       }
-      this->device()->seek(chunkSize - already_read, Origin::Current);
-    } while (!this->device()->atEnd());
+    }
+    else
+    {
+      // EOF bit can be triggered by the Read* methods while FAIL can be triggered by the SeekRead method.
+      this->device()->setExceptions(State::Error);
+      do
+      {
+        size_t chunkPosition = static_cast<size_t>(this->device()->tell());
+        chunkID = stream.readI64();
+        chunkSize = stream.readI64();
+        int64_t already_read = 16;
+        if ((chunkID == channelInfoChunkID) || (chunkID == dataChunkID))
+        {
+          HPFChunkInfo ci;
+          ci.position = chunkPosition;
+          ci.id = chunkID;
+          ci.size = chunkSize;
+          ci.group = stream.readI32();
+          chunks.push_back(ci);
+          already_read += 4;
+        }
+        this->device()->seek(chunkSize - already_read, Origin::Current);
+      } while (!this->device()->atEnd());
+    }
     // Check if only one Channel information chunk exists. Data with different time
     // increments per channel is not supported in the library Biomechanical ToolKit. 
-    HPFChunkInfo* channelInfoChunk = 0;
+    const HPFChunkInfo* channelInfoChunk = 0;
     for (auto it = chunks.begin() ; it != chunks.end() ; ++it)
     {
       if (it->id == channelInfoChunkID)
@@ -192,6 +254,10 @@ namespace io
     std::string errmsg;
     Trial* trial = new Trial(strip_path(this->device()->name()),output);
     auto tss = std::vector<TimeSequence*>(numAnalogChannels, nullptr);
+    // Selection of the samples and channels to extract (see HandlerReader::setOptions()). Unselected channels are not created.
+    const ReadSelection selection(this->options());
+    size_t firstFrame = 0, frames = 0;
+    selection.frames(std::numeric_limits<size_t>::max(), &firstFrame, &frames);
     pugi::xml_document xmlDoc;
     pugi::xml_parse_result xmlResult = xmlDoc.load_buffer_inplace(xmlBuffer, xmlBufferSize, pugi::parse_minimal, pugi::encoding_utf8);
     if (xmlResult)
@@ -235,7 +301,9 @@ namespace io
 
         }
         // Append the configured analog channel into the acquisition
-        tss[numAnalogChannelsParsed++] = new TimeSequence(label, 1, 0, requestedPerChannelSampleRate, 0.0, TimeSequence::Analog, unit, 1.0, 0.0, {{rangeMin, rangeMax}}, trial->timeSequences());
+        if (selection.isSelected(label, TimeSequence::Analog))
+          tss[numAnalogChannelsParsed] = new TimeSequence(label, 1, 0, requestedPerChannelSampleRate, static_cast<double>(firstFrame) / requestedPerChannelSampleRate, TimeSequence::Analog, unit, 1.0, 0.0, {{rangeMin, rangeMax}}, trial->timeSequences());
+        ++numAnalogChannelsParsed;
       }
     }
     else
@@ -246,6 +314,10 @@ namespace io
     if (!errmsg.empty())
       throw(FormatError(errmsg));
     // Extract the data
+    // - The configuration of each data chunk is read first to know the samples to decode and the final size of the time sequences
+    std::vector<size_t> storedSamples(numAnalogChannels, 0), requiredSamples(numAnalogChannels, 0);
+    std::vector<HPFDataBlock> blocks;
+    size_t totalSamples = 0;
     for (auto it = chunks.cbegin() ; it != chunks.cend() ; ++it)
     {
       if (it->id != dataChunkID)
@@ -263,17 +335,72 @@ namespace io
         channelDataCount = numAnalogChannels;
       std::vector<uint32_t> channelDescriptor(2*channelDataCount);
       stream.readU32(2*channelDataCount, channelDescriptor.data());
-      // Read data
-      auto itA = tss.begin();
+      // - Only the samples of the selected channels and in the selected range are read
       for (int i = 0 ; i < channelDataCount ; ++i)
       {
-        this->device()->seek(it->position + channelDescriptor[i*2], Origin::Begin);
-        unsigned samples = channelDescriptor[i*2+1] / 4;
-        (*itA)->resize(dataStartIndex+samples);
-        auto data = (*itA)->data();
-        for (size_t j = 0 ; j < samples ; ++j)
-          data[dataStartIndex+j] = stream.readFloat();
-        ++itA;
+        auto ts = tss[i];
+        storedSamples[i] = std::max<size_t>(storedSamples[i], dataStartIndex + channelDescriptor[i*2+1] / 4);
+        if (ts == nullptr)
+          continue;
+        size_t first = 0, num = 0;
+        selection.frames(dataStartIndex + channelDescriptor[i*2+1] / 4, &first, &num);
+        if ((num == 0) || ((first + num) <= static_cast<size_t>(dataStartIndex)))
+          continue;
+        const size_t begin = std::max<size_t>(first, dataStartIndex);
+        const size_t samples = first + num - begin;
+        const size_t position = it->position + channelDescriptor[i*2] + (begin - dataStartIndex) * 4;
+        if ((content != nullptr) && ((position + samples * 4) > contentSize))
+          throw(FormatError("The data of the channel '" + ts->name() + "' exceed the size of the HPF file."));
+        requiredSamples[i] = std::max(requiredSamples[i], begin - first + samples);
+        blocks.push_back(HPFDataBlock{ts, position, begin - first, samples});
+        totalSamples += samples;
+      }
+    }
+    // - The time sequences are resized only once
+    for (size_t i = 0 ; i < tss.size() ; ++i)
+    {
+      if ((tss[i] != nullptr) && (requiredSamples[i] > tss[i]->samples()))
+        tss[i]->resize(requiredSamples[i]);
+    }
+    // - Each block is decoded in bulk directly into its time sequence
+    if (content != nullptr)
+    {
+      // The blocks are independent (each one has its own location in the time sequences) and are decoded in parallel.
+      const size_t threads = HandlerPrivate::decodingThreads(this->options(), blocks.size(), blocks.empty() ? 0 : (4 * totalSamples) / blocks.size());
+      const size_t range = (blocks.size() + threads - 1) / threads;
+      std::vector<std::thread> workers;
+      try
+      {
+        for (size_t first = range ; first < blocks.size() ; first += range)
+          workers.emplace_back(&_ma_io_hpf_decode_blocks, converter.get(), content, blocks.data() + first, std::min(range, blocks.size() - first));
+      }
+      catch (...)
+      {
+        for (auto& worker : workers)
+          worker.join();
+        throw;
+      }
+      _ma_io_hpf_decode_blocks(converter.get(), content, blocks.data(), std::min(range, blocks.size()));
+      for (auto& worker : workers)
+        worker.join();
+    }
+    else
+    {
+      std::vector<float> values;
+      for (const auto& block : blocks)
+      {
+        this->device()->seek(block.position, Origin::Begin);
+        values.resize(block.samples);
+        stream.readFloat(block.samples, values.data());
+        std::copy(values.cbegin(), values.cend(), block.timesequence->data() + block.offset);
+      }
+    }
+    if (selection.metadataOnly())
+    {
+      for (size_t i = 0 ; i < tss.size() ; ++i)
+      {
+        if (tss[i] != nullptr)
+          ReadSelection::setStoredSamples(tss[i], storedSamples[i]);
       }
     }
   };
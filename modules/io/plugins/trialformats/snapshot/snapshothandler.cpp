@@ -0,0 +1,804 @@
+/* 
+ * Open Source Movement Analysis Library
+ * Copyright (C) 2016, Moveck Solution Inc., all rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 
+ *     * Redistributions of source code must retain the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer.
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials
+ *       provided with the distribution.
+ *     * Neither the name(s) of the copyright holders nor the names
+ *       of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written
+ *       permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "snapshothandler.h"
+#include "snapshothandler_p.h"
+
+#include "openma/io/snapshot.h"
+
+#include "openma/io/handler_p.h"
+#include "openma/io/device.h"
+#include "openma/io/enums.h"
+#include "openma/base/any.h"
+#include "openma/base/node.h"
+#include "openma/base/trial.h"
+#include "openma/base/subject.h"
+#include "openma/base/event.h"
+#include "openma/base/timesequence.h"
+#include "openma/base/hardware.h"
+#include "openma/base/logger.h"
+
+#include "openma/instrument/forceplatetype2.h"
+#include "openma/instrument/forceplatetype3.h"
+#include "openma/instrument/forceplatetype4.h"
+#include "openma/instrument/forceplatetype5.h"
+
+#include <array>
+#include <cstring> // memcmp
+#include <mutex>
+#include <typeindex>
+
+// -------------------------------------------------------------------------- //
+//                                 PRIVATE API                                //
+// -------------------------------------------------------------------------- //
+
+namespace ma
+{
+namespace io
+{
+  static const char _snapshot_signature[8] = {'O','M','A','S','N','A','P','\0'};
+  _OPENMA_CONSTEXPR uint32_t _snapshot_version = 1;
+  _OPENMA_CONSTEXPR uint32_t _snapshot_byte_order_mark = 0x01020304;
+  _OPENMA_CONSTEXPR uint64_t _snapshot_header_size = 32;
+  
+  // ------------------------------------------------------------------------ //
+  
+  enum class SnapshotValue : uint8_t {None, String, Bool, Int8, UInt8, Int16, UInt16, Int32, UInt32, Int64, UInt64, Float, Double};
+  
+  static SnapshotValue _ma_io_snapshot_value_type(const Any& value)
+  {
+    const auto type = value.type();
+    if (value.isString())
+      return SnapshotValue::String;
+    else if (type == static_typeid<bool>())
+      return SnapshotValue::Bool;
+    else if ((type == static_typeid<char>()) || (type == static_typeid<signed char>()))
+      return SnapshotValue::Int8;
+    else if (type == static_typeid<unsigned char>())
+      return SnapshotValue::UInt8;
+    else if (type == static_typeid<short int>())
+      return SnapshotValue::Int16;
+    else if (type == static_typeid<unsigned short int>())
+      return SnapshotValue::UInt16;
+    else if (type == static_typeid<int>())
+      return SnapshotValue::Int32;
+    else if (type == static_typeid<unsigned int>())
+      return SnapshotValue::UInt32;
+    else if ((type == static_typeid<long int>()) || (type == static_typeid<long long int>()))
+      return SnapshotValue::Int64;
+    else if ((type == static_typeid<unsigned long int>()) || (type == static_typeid<unsigned long long int>()))
+      return SnapshotValue::UInt64;
+    else if (type == static_typeid<float>())
+      return SnapshotValue::Float;
+    else if ((type == static_typeid<double>()) || (type == static_typeid<long double>()))
+      return SnapshotValue::Double;
+    return SnapshotValue::None;
+  };
+  
+  template <typename T>
+  static void _ma_io_snapshot_encode_values(const Any& value, SnapshotEncoder* encoder)
+  {
+    const auto values = value.cast<std::vector<T>>();
+    encoder->put(static_cast<uint64_t>(values.size()));
+    encoder->put(values.data(), values.size());
+  };
+  
+  static void _ma_io_snapshot_encode_value(const Any& value, SnapshotValue kind, SnapshotEncoder* encoder)
+  {
+    const auto dimensions = value.dimensions();
+    encoder->put(static_cast<uint8_t>(kind));
+    encoder->put(static_cast<uint32_t>(dimensions.size()));
+    encoder->put(dimensions.data(), dimensions.size());
+    switch (kind)
+    {
+    case SnapshotValue::String:
+      {
+      const auto values = value.cast<std::vector<std::string>>();
+      encoder->put(static_cast<uint64_t>(values.size()));
+      for (const auto& str : values)
+        encoder->put(str);
+      break;
+      }
+    case SnapshotValue::Bool:
+    case SnapshotValue::UInt8:
+      _ma_io_snapshot_encode_values<uint8_t>(value, encoder);
+      break;
+    case SnapshotValue::Int8:
+      _ma_io_snapshot_encode_values<int8_t>(value, encoder);
+      break;
+    case SnapshotValue::Int16:
+      _ma_io_snapshot_encode_values<int16_t>(value, encoder);
+      break;
+    case SnapshotValue::UInt16:
+      _ma_io_snapshot_encode_values<uint16_t>(value, encoder);
+      break;
+    case SnapshotValue::Int32:
+      _ma_io_snapshot_encode_values<int32_t>(value, encoder);
+      break;
+    case SnapshotValue::UInt32:
+      _ma_io_snapshot_encode_values<uint32_t>(value, encoder);
+      break;
+    case SnapshotValue::Int64:
+      _ma_io_snapshot_encode_values<int64_t>(value, encoder);
+      break;
+    case SnapshotValue::UInt64:
+      _ma_io_snapshot_encode_values<uint64_t>(value, encoder);
+      break;
+    case SnapshotValue::Float:
+      _ma_io_snapshot_encode_values<float>(value, encoder);
+      break;
+    case SnapshotValue::Double:
+      _ma_io_snapshot_encode_values<double>(value, encoder);
+      break;
+    case SnapshotValue::None:
+      break;
+    }
+  };
+  
+  template <typename T>
+  static std::vector<T> _ma_io_snapshot_decode_values(SnapshotDecoder* decoder)
+  {
+    const uint64_t num = decoder->get<uint64_t>();
+    decoder->require(num, sizeof(T));
+    std::vector<T> values(num);
+    decoder->get(values.data(), values.size());
+    return values;
+  };
+  
+  // A single value without dimensions is restored as a scalar and not as an array of one element.
+  template <typename T>
+  static Any _ma_io_snapshot_make_value(const std::vector<T>& values, const std::vector<unsigned>& dimensions)
+  {
+    if (dimensions.empty() && (values.size() == 1))
+      return Any(static_cast<T>(values[0]));
+    return Any(values, dimensions);
+  };
+  
+  static Any _ma_io_snapshot_decode_value(SnapshotDecoder* decoder)
+  {
+    const auto kind = static_cast<SnapshotValue>(decoder->get<uint8_t>());
+    const uint32_t numDims = decoder->get<uint32_t>();
+    decoder->require(numDims, sizeof(unsigned));
+    std::vector<unsigned> dimensions(numDims);
+    decoder->get(dimensions.data(), dimensions.size());
+    switch (kind)
+    {
+    case SnapshotValue::String:
+      {
+      const uint64_t num = decoder->get<uint64_t>();
+      decoder->require(num, sizeof(uint32_t));
+      std::vector<std::string> values(num);
+      for (auto& str : values)
+        str = decoder->getString();
+      return _ma_io_snapshot_make_value(values, dimensions);
+      }
+    case SnapshotValue::Bool:
+      {
+      const auto bytes = _ma_io_snapshot_decode_values<uint8_t>(decoder);
+      return _ma_io_snapshot_make_value(std::vector<bool>(bytes.cbegin(), bytes.cend()), dimensions);
+      }
+    case SnapshotValue::Int8:
+      return _ma_io_snapshot_make_value(_ma_io_snapshot_decode_values<int8_t>(decoder), dimensions);
+    case SnapshotValue::UInt8:
+      return _ma_io_snapshot_make_value(_ma_io_snapshot_decode_values<uint8_t>(decoder), dimensions);
+    case SnapshotValue::Int16:
+      return _ma_io_snapshot_make_value(_ma_io_snapshot_decode_values<int16_t>(decoder), dimensions);
+    case SnapshotValue::UInt16:
+      return _ma_io_snapshot_make_value(_ma_io_snapshot_decode_values<uint16_t>(decoder), dimensions);
+    case SnapshotValue::Int32:
+      return _ma_io_snapshot_make_value(_ma_io_snapshot_decode_values<int32_t>(decoder), dimensions);
+    case SnapshotValue::UInt32:
+      return _ma_io_snapshot_make_value(_ma_io_snapshot_decode_values<uint32_t>(decoder), dimensions);
+    case SnapshotValue::Int64:
+      return _ma_io_snapshot_make_value(_ma_io_snapshot_decode_values<int64_t>(decoder), dimensions);
+    case SnapshotValue::UInt64:
+      return _ma_io_snapshot_make_value(_ma_io_snapshot_decode_values<uint64_t>(decoder), dimensions);
+    case SnapshotValue::Float:
+      return _ma_io_snapshot_make_value(_ma_io_snapshot_decode_values<float>(decoder), dimensions);
+    case SnapshotValue::Double:
+      return _ma_io_snapshot_make_value(_ma_io_snapshot_decode_values<double>(decoder), dimensions);
+    case SnapshotValue::None:
+      break;
+    }
+    throw(FormatError(std::string(decoder->Format) + " - Unknown type of property."));
+  };
+  
+  static void _ma_io_snapshot_encode_properties(const Node* node, SnapshotEncoder* encoder)
+  {
+    const size_t position = encoder->Bytes.size();
+    uint32_t num = 0;
+    encoder->put(num);
+    for (const auto& property : node->dynamicProperties())
+    {
+      const auto kind = _ma_io_snapshot_value_type(property.second);
+      if (kind == SnapshotValue::None)
+        throw(FormatError(std::string(encoder->Format) + " - The type of the property '" + property.first + "' in the node '" + node->name() + "' is not supported. The node cannot be saved."));
+      encoder->put(property.first);
+      _ma_io_snapshot_encode_value(property.second, kind, encoder);
+      ++num;
+    }
+    memcpy(encoder->Bytes.data() + position, &num, sizeof(num));
+  };
+  
+  static void _ma_io_snapshot_decode_properties(Node* node, SnapshotDecoder* decoder)
+  {
+    const uint32_t num = decoder->get<uint32_t>();
+    for (uint32_t i = 0 ; i < num ; ++i)
+    {
+      const std::string key = decoder->getString();
+      node->setProperty(key, _ma_io_snapshot_decode_value(decoder));
+    }
+  };
+  
+  static void _ma_io_snapshot_encode_children(const Node* node, SnapshotEncoder* encoder)
+  {
+    const auto& children = node->children();
+    encoder->put(static_cast<uint32_t>(children.size()));
+    for (const auto& child : children)
+      encoder->put(encoder->index(child));
+  };
+  
+  static std::vector<uint32_t> _ma_io_snapshot_decode_children(SnapshotDecoder* decoder)
+  {
+    const uint32_t num = decoder->get<uint32_t>();
+    decoder->require(num, sizeof(uint32_t));
+    std::vector<uint32_t> children(num);
+    decoder->get(children.data(), children.size());
+    return children;
+  };
+  
+  // ------------------------------------------------------------------------ //
+  
+  // Node types known by the snapshot format. The tag identifies the type in the file as the value returned by static_typeid() is not stable between two executions.
+  struct SnapshotNodeType
+  {
+    std::string Tag;
+    typeid_t Id;
+    std::type_index Type;
+    SnapshotCreateFunction Create;
+    SnapshotEncodeFunction Encode;
+  };
+  
+  static Node* _ma_io_snapshot_create_node(const std::string& name, SnapshotDecoder* )
+  {
+    return new Node(name);
+  };
+  
+  static void _ma_io_snapshot_encode_node(const Node* , SnapshotEncoder* )
+  {};
+  
+  static Node* _ma_io_snapshot_create_trial(const std::string& name, SnapshotDecoder* )
+  {
+    return new Trial(name);
+  };
+  
+  static Node* _ma_io_snapshot_create_subject(const std::string& name, SnapshotDecoder* )
+  {
+    return new Subject(name);
+  };
+  
+  static Node* _ma_io_snapshot_create_event(const std::string& name, SnapshotDecoder* decoder)
+  {
+    const double time = decoder->get<double>();
+    const std::string context = decoder->getString();
+    const std::string subject = decoder->getString();
+    return new Event(name, time, context, subject);
+  };
+  
+  static void _ma_io_snapshot_encode_event(const Node* node, SnapshotEncoder* encoder)
+  {
+    auto evt = node_cast<const Event*>(node);
+    encoder->put(evt->time());
+    encoder->put(evt->context());
+    encoder->put(evt->subject());
+  };
+  
+  static Node* _ma_io_snapshot_create_timesequence(const std::string& name, SnapshotDecoder* decoder)
+  {
+    const uint32_t numDims = decoder->get<uint32_t>();
+    decoder->require(numDims, sizeof(unsigned));
+    std::vector<unsigned> components(numDims);
+    decoder->get(components.data(), components.size());
+    const uint32_t samples = decoder->get<uint32_t>();
+    const double rate = decoder->get<double>();
+    const double start = decoder->get<double>();
+    const int32_t type = decoder->get<int32_t>();
+    const std::string unit = decoder->getString();
+    const double scale = decoder->get<double>();
+    const double offset = decoder->get<double>();
+    std::array<double,2> range;
+    decoder->get(range.data(), range.size());
+    const uint64_t position = decoder->get<uint64_t>();
+    // The samples must be stored in the data section before to allocate memory for them
+    const uint64_t capacity = (position <= decoder->DataSize) ? (decoder->DataSize - position) / sizeof(double) : 0;
+    uint64_t elements = samples;
+    for (const auto& component : components)
+    {
+      if ((component != 0) && (elements > capacity / component))
+        throw(FormatError(std::string(decoder->Format) + " - Corrupted metadata. The samples of the time sequence '" + name + "' exceed the size of the data section."));
+      elements *= component;
+    }
+    if (elements > capacity)
+      throw(FormatError(std::string(decoder->Format) + " - Corrupted metadata. The samples of the time sequence '" + name + "' exceed the size of the data section."));
+    auto ts = new TimeSequence(name, components, samples, rate, start, type, unit, scale, offset, range);
+    decoder->Sequences.push_back(SnapshotSequence{ts, position, decoder->Position});
+    return ts;
+  };
+  
+  static void _ma_io_snapshot_encode_timesequence(const Node* node, SnapshotEncoder* encoder)
+  {
+    auto ts = node_cast<const TimeSequence*>(node);
+    const auto& components = ts->dimensions();
+    encoder->put(static_cast<uint32_t>(components.size()));
+    encoder->put(components.data(), components.size());
+    encoder->put(static_cast<uint32_t>(ts->samples()));
+    encoder->put(ts->sampleRate());
+    encoder->put(ts->startTime());
+    encoder->put(static_cast<int32_t>(ts->type()));
+    encoder->put(ts->unit());
+    encoder->put(ts->scale());
+    encoder->put(ts->offset());
+    encoder->put(ts->range().data(), ts->range().size());
+    encoder->put(encoder->allocate(ts));
+  };
+  
+  static void _ma_io_snapshot_decode_forceplate_extra(instrument::ForcePlate* , SnapshotDecoder* )
+  {};
+  
+  static void _ma_io_snapshot_decode_forceplate_extra(instrument::ForcePlateType3* fp, SnapshotDecoder* decoder)
+  {
+    std::array<double,2> offsets;
+    decoder->get(offsets.data(), offsets.size());
+    fp->setSensorOffsets(offsets);
+  };
+  
+  template <typename T>
+  static Node* _ma_io_snapshot_create_forceplate(const std::string& name, SnapshotDecoder* decoder)
+  {
+    std::unique_ptr<T> fp(new T(name));
+    std::array<double,3> origin;
+    std::array<double,12> corners;
+    decoder->get(origin.data(), origin.size());
+    decoder->get(corners.data(), corners.size());
+    // A force plate without geometry keeps its default reference frame
+    bool geometry = false;
+    for (const auto& value : corners)
+      geometry |= (value != 0.0);
+    if (geometry)
+    {
+      fp->setGeometry(origin,
+                      std::array<double,3>{{corners[0],corners[1],corners[2]}},
+                      std::array<double,3>{{corners[3],corners[4],corners[5]}},
+                      std::array<double,3>{{corners[6],corners[7],corners[8]}},
+                      std::array<double,3>{{corners[9],corners[10],corners[11]}});
+    }
+    const uint32_t numCal = decoder->get<uint32_t>();
+    decoder->require(numCal, sizeof(double));
+    std::vector<double> calibration(numCal);
+    decoder->get(calibration.data(), calibration.size());
+    fp->setCalibrationMatrixData(calibration);
+    fp->setSoftResetEnabled(decoder->get<uint8_t>() != 0);
+    std::array<int32_t,2> softReset;
+    decoder->get(softReset.data(), softReset.size());
+    fp->setSoftResetSamples(std::array<int,2>{{softReset[0],softReset[1]}});
+    _ma_io_snapshot_decode_forceplate_extra(fp.get(), decoder);
+    // The channels are linked once all the nodes are created
+    const uint32_t numChannels = decoder->get<uint32_t>();
+    for (uint32_t i = 0 ; i < numChannels ; ++i)
+    {
+      const uint32_t index = decoder->get<uint32_t>();
+      if ((index != _snapshot_no_node) && (i < fp->channelsNumberRequired()))
+        decoder->Channels.push_back(SnapshotChannel{decoder->Position, i, index});
+    }
+    return fp.release();
+  };
+  
+  static void _ma_io_snapshot_encode_forceplate(const Node* node, SnapshotEncoder* encoder)
+  {
+    auto fp = node_cast<const instrument::ForcePlate*>(node);
+    encoder->put(fp->relativeSurfaceOrigin().data(), fp->relativeSurfaceOrigin().size());
+    encoder->put(fp->surfaceCorners().data(), fp->surfaceCorners().size());
+    const auto& calibration = fp->calibrationMatrixData();
+    encoder->put(static_cast<uint32_t>(calibration.size()));
+    encoder->put(calibration.data(), calibration.size());
+    encoder->put(static_cast<uint8_t>(fp->isSoftResetEnabled() ? 1 : 0));
+    encoder->put(static_cast<int32_t>(fp->softResetSamples()[0]));
+    encoder->put(static_cast<int32_t>(fp->softResetSamples()[1]));
+    auto fp3 = node_cast<const instrument::ForcePlateType3*>(node);
+    if (fp3 != nullptr)
+      encoder->put(fp3->sensorOffsets().data(), fp3->sensorOffsets().size());
+    const unsigned numChannels = fp->channelsNumberRequired();
+    encoder->put(static_cast<uint32_t>(numChannels));
+    for (unsigned i = 0 ; i < numChannels ; ++i)
+      encoder->put(encoder->index(fp->channel(i)));
+  };
+  
+  // The built-in types are registered at the first use of the registry. The other modules can add their own types with the function register_snapshot_node_type().
+  struct SnapshotNodeTypeRegistry
+  {
+    std::mutex Mutex;
+    std::vector<SnapshotNodeType> Types;
+    
+    SnapshotNodeTypeRegistry()
+    : Mutex(), Types({
+        {"Node", static_typeid<Node>(), typeid(Node), &_ma_io_snapshot_create_node, &_ma_io_snapshot_encode_node},
+        {"Trial", static_typeid<Trial>(), typeid(Trial), &_ma_io_snapshot_create_trial, &_ma_io_snapshot_encode_node},
+        {"Subject", static_typeid<Subject>(), typeid(Subject), &_ma_io_snapshot_create_subject, &_ma_io_snapshot_encode_node},
+        {"Event", static_typeid<Event>(), typeid(Event), &_ma_io_snapshot_create_event, &_ma_io_snapshot_encode_event},
+        {"TimeSequence", static_typeid<TimeSequence>(), typeid(TimeSequence), &_ma_io_snapshot_create_timesequence, &_ma_io_snapshot_encode_timesequence},
+        {"ForcePlateType2", static_typeid<instrument::ForcePlateType2>(), typeid(instrument::ForcePlateType2), &_ma_io_snapshot_create_forceplate<instrument::ForcePlateType2>, &_ma_io_snapshot_encode_forceplate},
+        {"ForcePlateType3", static_typeid<instrument::ForcePlateType3>(), typeid(instrument::ForcePlateType3), &_ma_io_snapshot_create_forceplate<instrument::ForcePlateType3>, &_ma_io_snapshot_encode_forceplate},
+        {"ForcePlateType4", static_typeid<instrument::ForcePlateType4>(), typeid(instrument::ForcePlateType4), &_ma_io_snapshot_create_forceplate<instrument::ForcePlateType4>, &_ma_io_snapshot_encode_forceplate},
+        {"ForcePlateType5", static_typeid<instrument::ForcePlateType5>(), typeid(instrument::ForcePlateType5), &_ma_io_snapshot_create_forceplate<instrument::ForcePlateType5>, &_ma_io_snapshot_encode_forceplate},
+      })
+    {};
+  };
+  
+  static SnapshotNodeTypeRegistry& _ma_io_snapshot_registry()
+  {
+    static SnapshotNodeTypeRegistry registry;
+    return registry;
+  };
+  
+  // Only the exact type of the node is searched. A node deriving from a registered type would loose its own content if it was saved as its parent type.
+  static bool _ma_io_snapshot_find_type(const Node* node, SnapshotNodeType* type)
+  {
+    auto& registry = _ma_io_snapshot_registry();
+    std::lock_guard<std::mutex> lock(registry.Mutex);
+    const std::type_index index(typeid(*node));
+    for (const auto& candidate : registry.Types)
+    {
+      if (candidate.Type == index)
+      {
+        *type = candidate;
+        return true;
+      }
+    }
+    return false;
+  };
+  
+  static bool _ma_io_snapshot_find_type(const std::string& tag, SnapshotNodeType* type)
+  {
+    auto& registry = _ma_io_snapshot_registry();
+    std::lock_guard<std::mutex> lock(registry.Mutex);
+    for (const auto& candidate : registry.Types)
+    {
+      if (candidate.Tag == tag)
+      {
+        *type = candidate;
+        return true;
+      }
+    }
+    return false;
+  };
+  
+  // The nodes are indexed in depth-first order. A node with several parents is indexed only once.
+  static void _ma_io_snapshot_index_nodes(const Node* node, SnapshotEncoder* encoder, std::vector<const Node*>* nodes)
+  {
+    for (const auto& child : node->children())
+    {
+      if (encoder->Indices.emplace(child, static_cast<uint32_t>(nodes->size())).second)
+      {
+        nodes->push_back(child);
+        _ma_io_snapshot_index_nodes(child, encoder, nodes);
+      }
+    }
+  };
+  
+  // ------------------------------------------------------------------------ //
+  
+  void SnapshotEncoder::encode(const Node* root)
+  {
+    std::vector<const Node*> nodes;
+    _ma_io_snapshot_index_nodes(root, this, &nodes);
+    this->put(static_cast<uint32_t>(nodes.size()));
+    _ma_io_snapshot_encode_properties(root, this);
+    _ma_io_snapshot_encode_children(root, this);
+    SnapshotNodeType type{std::string{}, typeid_t{}, typeid(Node), nullptr, nullptr};
+    for (const auto& node : nodes)
+    {
+      if (!_ma_io_snapshot_find_type(node, &type))
+        throw(FormatError(std::string(this->Format) + " - The type of the node '" + node->name() + "' is not registered in the snapshot format. The node cannot be saved."));
+      this->put(type.Tag);
+      this->put(node->name());
+      this->put(node->description());
+      if (type.Encode != nullptr)
+        type.Encode(node, this);
+      _ma_io_snapshot_encode_properties(node, this);
+      _ma_io_snapshot_encode_children(node, this);
+    }
+  };
+  
+  uint32_t SnapshotEncoder::index(const Node* node) const
+  {
+    auto it = this->Indices.find(node);
+    return (it != this->Indices.cend()) ? it->second : _snapshot_no_node;
+  };
+  
+  // The sample buffers are stored one after the other
+  uint64_t SnapshotEncoder::allocate(const TimeSequence* ts)
+  {
+    const uint64_t offset = this->DataSize;
+    this->Sequences.emplace_back(ts, offset);
+    this->DataSize = offset + ts->elements() * sizeof(double);
+    return offset;
+  };
+  
+  // ------------------------------------------------------------------------ //
+  
+  SnapshotEncoder::SnapshotEncoder(const char* format)
+  : Format(format), Bytes(), Indices(), Sequences(), DataSize(0)
+  {};
+  
+  SnapshotEncoder::~SnapshotEncoder() _OPENMA_NOEXCEPT = default;
+  
+  // ------------------------------------------------------------------------ //
+  
+  SnapshotDecoder::SnapshotDecoder(const char* format, const char* data, size_t size, uint64_t dataSize)
+  : Format(format), Current(data), End(data + size), Position(0), Nodes(), Children(), Roots(), Sequences(), Channels(), DataSize(dataSize)
+  {};
+  
+  SnapshotDecoder::~SnapshotDecoder() _OPENMA_NOEXCEPT = default;
+  
+  // The properties of the root are directly assigned to the given node.
+  void SnapshotDecoder::decode(Node* root)
+  {
+    const uint32_t numNodes = this->get<uint32_t>();
+    this->require(numNodes, sizeof(uint32_t));
+    _ma_io_snapshot_decode_properties(root, this);
+    this->Roots = _ma_io_snapshot_decode_children(this);
+    this->Nodes.resize(numNodes);
+    this->Children.resize(numNodes);
+    SnapshotNodeType type{std::string{}, typeid_t{}, typeid(Node), nullptr, nullptr};
+    for (uint32_t i = 0 ; i < numNodes ; ++i)
+    {
+      const std::string tag = this->getString();
+      if (!_ma_io_snapshot_find_type(tag, &type))
+        throw(FormatError(std::string(this->Format) + " - Unknown type of node: '" + tag + "'."));
+      const std::string name = this->getString();
+      const std::string description = this->getString();
+      this->Position = i;
+      this->Nodes[i].reset(type.Create(name, this));
+      this->Nodes[i]->setDescription(description);
+      _ma_io_snapshot_decode_properties(this->Nodes[i].get(), this);
+      this->Children[i] = _ma_io_snapshot_decode_children(this);
+    }
+    // Verify the links between the nodes
+    std::vector<bool> linked(numNodes, false);
+    for (const auto& indices : this->Children)
+    {
+      for (const auto& index : indices)
+      {
+        if (index >= numNodes)
+          throw(FormatError(std::string(this->Format) + " - Corrupted metadata. A child index is out of range."));
+        linked[index] = true;
+      }
+    }
+    for (const auto& index : this->Roots)
+    {
+      if (index >= numNodes)
+        throw(FormatError(std::string(this->Format) + " - Corrupted metadata. A child index is out of range."));
+      linked[index] = true;
+    }
+    for (uint32_t i = 0 ; i < numNodes ; ++i)
+    {
+      if (!linked[i])
+        throw(FormatError(std::string(this->Format) + " - Corrupted metadata. The node '" + this->Nodes[i]->name() + "' has no parent."));
+    }
+    for (const auto& channel : this->Channels)
+    {
+      if ((channel.Sequence >= numNodes) || (node_cast<TimeSequence*>(this->Nodes[channel.Sequence].get()) == nullptr))
+        throw(FormatError(std::string(this->Format) + " - Corrupted metadata. The channel of the hardware '" + this->Nodes[channel.Hardware]->name() + "' is not a time sequence."));
+    }
+  };
+  
+  // The dropped nodes are ignored as well as the nodes left without parent. These last ones are deleted with the decoder.
+  void SnapshotDecoder::link(Node* root)
+  {
+    for (size_t i = 0 ; i < this->Nodes.size() ; ++i)
+    {
+      if (!this->Nodes[i])
+        continue;
+      for (const auto& index : this->Children[i])
+      {
+        if (this->Nodes[index])
+          this->Nodes[index]->addParent(this->Nodes[i].get());
+      }
+    }
+    for (const auto& index : this->Roots)
+    {
+      if (this->Nodes[index])
+        this->Nodes[index]->addParent(root);
+    }
+    for (const auto& channel : this->Channels)
+    {
+      if (!this->Nodes[channel.Hardware] || !this->Nodes[channel.Sequence])
+        continue;
+      auto hardware = node_cast<Hardware*>(this->Nodes[channel.Hardware].get());
+      auto ts = node_cast<TimeSequence*>(this->Nodes[channel.Sequence].get());
+      // The link with the node 'Channels' is restored by the hardware itself
+      ts->removeParent(hardware->channels());
+      hardware->setChannel(channel.Channel, ts);
+    }
+    for (auto& node : this->Nodes)
+    {
+      if (node && node->hasParents())
+        node.release();
+    }
+  };
+};
+};
+
+// -------------------------------------------------------------------------- //
+//                                 PUBLIC API                                 //
+// -------------------------------------------------------------------------- //
+
+namespace ma
+{
+namespace io
+{
+ /*
+  * The OpenMA snapshot format is a native binary image of a tree of nodes. It is designed to reload quickly some preprocessed data (e.g. a cache of trials) and not to exchange data between applications.
+  * The file starts with a header of 32 bytes (signature, version, byte order mark, size of the metadata, offset of the data section) followed by the metadata of each node (type, name, description, static and dynamic properties, children).
+  * The samples of the time sequences are stored contiguously as native doubles in a data section following the metadata. The reloading is copy-based: the samples of each time sequence are copied in one block without any decoding (directly from the memory when the device is memory mapped), but they are not shared with the device.
+  * A node is stored once even if it has several parents. The node types supported by default are Node, Trial, Subject, Event, TimeSequence and the force plates (type 2 to 5) with their channels. Other types can be added with the function register_snapshot_node_type(). The writing fails if a node has a type which is not registered (a node deriving from a registered type included) or if a property is neither a string, a boolean nor a number.
+  * @warning The file is written with the byte order of the processor and cannot be read by a processor using another byte order.
+  */
+
+  SnapshotHandler::SnapshotHandler()
+  : Handler()
+  {};
+  
+  SnapshotHandler::~SnapshotHandler() _OPENMA_NOEXCEPT = default;
+  
+  Signature SnapshotHandler::verifySignature(const Device* const device) _OPENMA_NOEXCEPT
+  {
+    char signature[8] = {0};
+    device->peek(signature,sizeof(signature));
+    if (memcmp(signature, _snapshot_signature, sizeof(signature)) != 0)
+      return Signature::Invalid;
+    return Signature::Valid;
+  };
+  
+  Signature SnapshotHandler::verifySignature() const _OPENMA_NOEXCEPT
+  {
+    return verifySignature(this->device());
+  };
+  
+  void SnapshotHandler::readDevice(Node* output)
+  {
+    auto source = this->device();
+    source->setExceptions(State::End | State::Fail | State::Error);
+    // Header
+    char header[_snapshot_header_size];
+    source->read(header, sizeof(header));
+    uint32_t version = 0, byteOrderMark = 0;
+    uint64_t metadataSize = 0, dataOffset = 0;
+    memcpy(&version, header + 8, 4);
+    memcpy(&byteOrderMark, header + 12, 4);
+    memcpy(&metadataSize, header + 16, 8);
+    memcpy(&dataOffset, header + 24, 8);
+    if (memcmp(header, _snapshot_signature, sizeof(_snapshot_signature)) != 0)
+      throw(FormatError("OPENMA.SNAP - Invalid signature."));
+    if (byteOrderMark != _snapshot_byte_order_mark)
+      throw(FormatError("OPENMA.SNAP - The file was written with a different byte order and cannot be read on this processor."));
+    if (version != _snapshot_version)
+      throw(FormatError("OPENMA.SNAP - Unsupported version: " + std::to_string(version) + "."));
+    if (dataOffset < (_snapshot_header_size + metadataSize))
+      throw(FormatError("OPENMA.SNAP - Corrupted header. The data section overlaps the metadata."));
+    const uint64_t deviceSize = static_cast<uint64_t>(source->size());
+    if (dataOffset > deviceSize)
+      throw(FormatError("OPENMA.SNAP - Corrupted header. The data section starts after the end of the device."));
+    // Metadata
+    std::vector<char> buffer;
+    const char* metadata = source->consume(static_cast<Device::Size>(metadataSize));
+    if (metadata == nullptr)
+    {
+      buffer.resize(metadataSize);
+      source->read(buffer.data(), static_cast<Device::Size>(metadataSize));
+      metadata = buffer.data();
+    }
+    SnapshotDecoder decoder("OPENMA.SNAP", metadata, metadataSize, deviceSize - dataOffset);
+    // Nodes are not attached to their parents until their content is loaded. In case of error, they are simply deleted.
+    decoder.decode(output);
+    // Samples (copied even if the device is memory mapped as a time sequence cannot adopt an external storage)
+    for (const auto& sequence : decoder.Sequences)
+    {
+      const auto ts = sequence.Sequence;
+      const Device::Size size = static_cast<Device::Size>(ts->elements() * sizeof(double));
+      if (size == 0)
+        continue;
+      source->seek(static_cast<Device::Offset>(dataOffset + sequence.Offset), Origin::Begin);
+      const char* data = source->consume(size);
+      if (data != nullptr)
+        memcpy(ts->data(), data, size);
+      else
+        source->read(reinterpret_cast<char*>(ts->data()), size);
+    }
+    decoder.link(output);
+  };
+  
+  void SnapshotHandler::writeDevice(const Node* const input)
+  {
+    auto source = this->device();
+    SnapshotEncoder encoder("OPENMA.SNAP");
+    encoder.encode(input);
+    // Header
+    const uint64_t metadataSize = encoder.Bytes.size();
+    const uint64_t dataOffset = _snapshot_header_size + metadataSize;
+    char header[_snapshot_header_size];
+    memcpy(header, _snapshot_signature, sizeof(_snapshot_signature));
+    memcpy(header + 8, &_snapshot_version, 4);
+    memcpy(header + 12, &_snapshot_byte_order_mark, 4);
+    memcpy(header + 16, &metadataSize, 8);
+    memcpy(header + 24, &dataOffset, 8);
+    source->write(header, sizeof(header));
+    source->write(encoder.Bytes.data(), static_cast<Device::Size>(metadataSize));
+    // Samples (in the order of their allocation)
+    for (const auto& sequence : encoder.Sequences)
+    {
+      const auto ts = sequence.first;
+      const uint64_t size = ts->elements() * sizeof(double);
+      if (size != 0)
+        source->write(reinterpret_cast<const char*>(ts->data()), static_cast<Device::Size>(size));
+    }
+  };
+  
+  /**
+   * Register a new type of node in the snapshot format.
+   * The @a tag is the name stored in the file to identify the type. The type is given by its identifier @a id and its type information @a type. This last one is used to find the exact type of each node to save.
+   * The function @a create is used during the reading to instantiate a node of this type. The data written by the function @a encode (if any) must be read back by the function @a create with the given decoder.
+   * The name, the description, the dynamic properties and the children of the node are saved by the format itself.
+   * Returns false if the tag or the type is already registered, true otherwise.
+   * @note The template version of this function deduces @a id and @a type from the given template argument.
+   * @relates SnapshotHandler
+   * @ingroup openma_io
+   */
+  bool register_snapshot_node_type(const char* tag, typeid_t id, const std::type_info& type, SnapshotCreateFunction create, SnapshotEncodeFunction encode)
+  {
+    if ((tag == nullptr) || (create == nullptr))
+      return false;
+    auto& registry = _ma_io_snapshot_registry();
+    std::lock_guard<std::mutex> lock(registry.Mutex);
+    const std::type_index index(type);
+    for (const auto& candidate : registry.Types)
+    {
+      if ((candidate.Tag.compare(tag) == 0) || (candidate.Id == id) || (candidate.Type == index))
+        return false;
+    }
+    registry.Types.push_back(SnapshotNodeType{tag, id, index, create, encode});
+    return true;
+  };
+};
+};
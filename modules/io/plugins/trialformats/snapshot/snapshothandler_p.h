@@ -0,0 +1,166 @@
+/* 
+ * Open Source Movement Analysis Library
+ * Copyright (C) 2016, Moveck Solution Inc., all rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 
+ *     * Redistributions of source code must retain the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer.
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials
+ *       provided with the distribution.
+ *     * Neither the name(s) of the copyright holders nor the names
+ *       of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written
+ *       permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __openma_io_snapshothandler_p_h
+#define __openma_io_snapshothandler_p_h
+
+/*
+ * WARNING: This file and its content are not included in the public API and 
+ * can change drastically from one release to another.
+ */
+
+#include "openma/io/handler.h" // FormatError
+#include "openma/base/macros.h" // _OPENMA_CONSTEXPR
+
+#include <string>
+#include <vector>
+#include <utility> // std::pair
+#include <memory> // std::unique_ptr
+#include <unordered_map>
+#include <cstring> // memcpy
+#include <cstdint>
+
+namespace ma
+{
+  class Node;
+  class TimeSequence;
+  
+namespace io
+{
+  _OPENMA_CONSTEXPR uint32_t _snapshot_no_node = 0xFFFFFFFF;
+  
+  // The metadata of a tree of nodes are serialized in memory to be written in one block. The sample buffers are only referenced and written afterwards by the handler.
+  struct SnapshotEncoder
+  {
+    const char* Format; // Prefix of the error messages
+    std::vector<char> Bytes;
+    std::unordered_map<const Node*, uint32_t> Indices;
+    std::vector<std::pair<const TimeSequence*, uint64_t>> Sequences; // Offset relative to the data section
+    uint64_t DataSize;
+    
+    SnapshotEncoder(const char* format);
+    ~SnapshotEncoder() _OPENMA_NOEXCEPT;
+    
+    void encode(const Node* root);
+    uint32_t index(const Node* node) const;
+    uint64_t allocate(const TimeSequence* ts);
+    
+    template <typename T> void put(const T* values, size_t num)
+    {
+      const char* bytes = reinterpret_cast<const char*>(values);
+      this->Bytes.insert(this->Bytes.end(), bytes, bytes + num * sizeof(T));
+    };
+    
+    template <typename T> void put(T value)
+    {
+      this->put(&value, 1);
+    };
+    
+    void put(const std::string& value)
+    {
+      this->put(static_cast<uint32_t>(value.size()));
+      this->put(value.data(), value.size());
+    };
+  };
+  
+  // Sample buffer to load in a time sequence created by the decoder
+  struct SnapshotSequence
+  {
+    TimeSequence* Sequence;
+    uint64_t Offset; // Relative to the data section
+    uint32_t Index; // Index of the node in the decoder
+  };
+  
+  // Channel of an hardware created by the decoder
+  struct SnapshotChannel
+  {
+    uint32_t Hardware; // Index of the hardware in the decoder
+    unsigned Channel;
+    uint32_t Sequence; // Index of the time sequence in the decoder
+  };
+  
+  // The nodes are created by the method decode() but are attached to the root only by the method link(). In between, the handler loads the samples and can drop some nodes (i.e. reset them).
+  struct SnapshotDecoder
+  {
+    const char* Format; // Prefix of the error messages
+    const char* Current;
+    const char* End;
+    uint32_t Position; // Index of the node in creation
+    std::vector<std::unique_ptr<Node>> Nodes;
+    std::vector<std::vector<uint32_t>> Children;
+    std::vector<uint32_t> Roots;
+    std::vector<SnapshotSequence> Sequences;
+    std::vector<SnapshotChannel> Channels;
+    uint64_t DataSize; // Number of bytes available in the data section
+    
+    SnapshotDecoder(const char* format, const char* data, size_t size, uint64_t dataSize);
+    ~SnapshotDecoder() _OPENMA_NOEXCEPT;
+    
+    void decode(Node* root);
+    void link(Node* root);
+    
+    // Check that the metadata contain at least @a num elements of @a size bytes before to allocate memory for them.
+    void require(uint64_t num, size_t size) const
+    {
+      if (num > static_cast<uint64_t>(this->End - this->Current) / size)
+        throw(FormatError(std::string(this->Format) + " - Unexpected end of the metadata section."));
+    };
+    
+    template <typename T> void get(T* values, size_t num)
+    {
+      this->require(num, sizeof(T));
+      memcpy(values, this->Current, num * sizeof(T));
+      this->Current += num * sizeof(T);
+    };
+    
+    template <typename T> T get()
+    {
+      T value;
+      this->get(&value, 1);
+      return value;
+    };
+    
+    std::string getString()
+    {
+      const uint32_t size = this->get<uint32_t>();
+      this->require(size, 1);
+      std::string value(this->Current, size);
+      this->Current += size;
+      return value;
+    };
+  };
+};
+};
+
+#endif // __openma_io_snapshothandler_p_h
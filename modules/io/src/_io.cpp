@@ -38,6 +38,220 @@
 #include "openma/base/logger.h"
 
 #include <string>
+#include <deque>
+#include <memory> // std::unique_ptr
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <algorithm> // std::min, std::max
+
+// -------------------------------------------------------------------------- //
+//                                 PRIVATE API                                //
+// -------------------------------------------------------------------------- //
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+
+namespace ma
+{
+namespace io
+{
+  // Files to read by one worker. Its owner takes the files from the front, while the other workers steal them from the back.
+  struct ReadManyQueue
+  {
+    std::mutex Mutex;
+    std::deque<size_t> Files;
+  };
+  
+  class ReadManyPool
+  {
+  public:
+    ReadManyPool(const std::vector<std::string>& paths, const ReadOptions& options, std::vector<ReadResult>* results);
+    ~ReadManyPool() _OPENMA_NOEXCEPT = default;
+    
+    ReadManyPool(const ReadManyPool& ) = delete;
+    ReadManyPool(ReadManyPool&& ) _OPENMA_NOEXCEPT = delete;
+    ReadManyPool& operator=(const ReadManyPool& ) = delete;
+    ReadManyPool& operator=(ReadManyPool&& ) _OPENMA_NOEXCEPT = delete;
+    
+    void run(size_t threads);
+    
+  private:
+    bool next(size_t worker, size_t* index);
+    void work(size_t worker);
+    void read(size_t index);
+    void acquire(size_t size);
+    void release(size_t size);
+    
+    const std::vector<std::string>& Paths;
+    const ReadOptions& Options;
+    std::unordered_map<std::string, Any> HandlerOptions;
+    std::vector<ReadResult>* Results;
+    std::vector<std::unique_ptr<ReadManyQueue>> Queues;
+    std::mutex BudgetMutex;
+    std::condition_variable BudgetCondition;
+    size_t InFlight;
+    std::mutex CallbackMutex;
+  };
+  
+  ReadManyPool::ReadManyPool(const std::vector<std::string>& paths, const ReadOptions& options, std::vector<ReadResult>* results)
+  : Paths(paths), Options(options), HandlerOptions(options.Options), Results(results), Queues(),
+    BudgetMutex(), BudgetCondition(), InFlight(0), CallbackMutex()
+  {
+    // The files are already read in parallel. By default, each handler uses only one thread.
+    if (this->HandlerOptions.find("threads") == this->HandlerOptions.cend())
+      this->HandlerOptions["threads"] = 1;
+  };
+  
+  void ReadManyPool::run(size_t threads)
+  {
+    // Each worker starts with a contiguous range of files.
+    for (size_t i = 0 ; i < threads ; ++i)
+      this->Queues.emplace_back(new ReadManyQueue);
+    for (size_t i = 0 ; i < this->Paths.size() ; ++i)
+      this->Queues[i * threads / this->Paths.size()]->Files.push_back(i);
+    std::vector<std::thread> workers;
+    try
+    {
+      for (size_t i = 1 ; i < threads ; ++i)
+        workers.emplace_back(&ReadManyPool::work, this, i);
+    }
+    catch (...)
+    {
+      // Not possible to create more threads. The remaining files will be stolen by the created workers.
+    }
+    this->work(0);
+    for (auto& worker : workers)
+      worker.join();
+  };
+  
+  bool ReadManyPool::next(size_t worker, size_t* index)
+  {
+    const size_t num = this->Queues.size();
+    for (size_t i = 0 ; i < num ; ++i)
+    {
+      auto queue = this->Queues[(worker + i) % num].get();
+      std::lock_guard<std::mutex> lock(queue->Mutex);
+      if (queue->Files.empty())
+        continue;
+      if (i == 0)
+      {
+        *index = queue->Files.front();
+        queue->Files.pop_front();
+      }
+      else
+      {
+        *index = queue->Files.back();
+        queue->Files.pop_back();
+      }
+      return true;
+    }
+    return false;
+  };
+  
+  void ReadManyPool::work(size_t worker)
+  {
+    size_t index = 0;
+    while (this->next(worker, &index))
+      this->read(index);
+  };
+  
+  void ReadManyPool::read(size_t index)
+  {
+    auto& result = (*this->Results)[index];
+    result.Path = this->Paths[index];
+    size_t size = 0;
+    try
+    {
+      Node temp("_TIORM"); // _TIORM: Temporary I/O Read Many
+      File file;
+      file.open(result.Path.c_str(), Mode::In);
+      if (!file.isOpen())
+      {
+        result.ErrorCode = Error::Device;
+        result.ErrorMessage = "Impossible to open the file '" + result.Path + "'";
+      }
+      else
+      {
+        size = static_cast<size_t>(file.size());
+        this->acquire(size);
+        HandlerReader reader(&file, this->Options.Format);
+        reader.setOptions(this->HandlerOptions);
+        result.Success = reader.read(&temp);
+        result.ErrorCode = reader.errorCode();
+        result.ErrorMessage = reader.errorMessage();
+        file.close();
+        // The extracted nodes are detached from the temporary root. They are attached to the final root once all the files are read.
+        auto children = temp.children();
+        for (auto child : children)
+        {
+          child->removeParent(&temp);
+          result.Nodes.push_back(child);
+        }
+      }
+    }
+    catch (std::exception& e)
+    {
+      result.Success = false;
+      result.ErrorCode = Error::Unexpected;
+      result.ErrorMessage = "Unexpected exception during the reading of the file '" + result.Path + "': " + std::string(e.what());
+    }
+    catch (...)
+    {
+      result.Success = false;
+      result.ErrorCode = Error::Unknown;
+      result.ErrorMessage = "Unknown exception during the reading of the file '" + result.Path + "'";
+    }
+    // Streaming delivery. The callbacks are called one at a time.
+    if (this->Options.Completed)
+    {
+      std::lock_guard<std::mutex> lock(this->CallbackMutex);
+      bool keep = true;
+      try
+      {
+        keep = this->Options.Completed(result);
+      }
+      catch (...)
+      {
+        error("Exception thrown by the callback for the file '%s'. The extracted nodes are kept.", result.Path.c_str());
+      }
+      if (!keep)
+      {
+        for (auto node : result.Nodes)
+          delete node;
+        result.Nodes.clear();
+      }
+    }
+    this->release(size);
+  };
+  
+  void ReadManyPool::acquire(size_t size)
+  {
+    if (this->Options.MemoryBudget == 0)
+      return;
+    std::unique_lock<std::mutex> lock(this->BudgetMutex);
+    // A file larger than the budget is read alone
+    this->BudgetCondition.wait(lock, [&](){return (this->InFlight == 0) || ((this->InFlight + size) <= this->Options.MemoryBudget);});
+    this->InFlight += size;
+  };
+  
+  void ReadManyPool::release(size_t size)
+  {
+    if ((this->Options.MemoryBudget == 0) || (size == 0))
+      return;
+    {
+      std::lock_guard<std::mutex> lock(this->BudgetMutex);
+      this->InFlight -= size;
+    }
+    this->BudgetCondition.notify_all();
+  };
+};
+};
+
+#endif
+
+// -------------------------------------------------------------------------- //
+//                                 PUBLIC API                                 //
+// -------------------------------------------------------------------------- //
 
 namespace ma
 {
@@ -50,16 +264,41 @@ namespace io
    * @ingroup openma_io
    */
   bool read(Node* root, const std::string& filepath, const std::string& format)
+  {
+    return read(root, filepath, format, {});
+  };
+  
+  /**
+   * Convenient function to read the content of a file and set it in @a root.
+   * The given @a options are passed to the reader. They can be used for example to extract only some channels or a range of frames (see HandlerReader::setOptions()).
+   * @relates HandlerReader
+   * @ingroup openma_io
+   */
+  bool read(Node* root, const std::string& filepath, const std::string& format, const std::unordered_map<std::string, Any>& options)
   {
     File file;
     file.open(filepath.c_str(), Mode::In);
     HandlerReader reader(&file, format);
+    reader.setOptions(options);
     bool result = reader.read(root);
     if (!result && (reader.errorCode() != Error::None))
       error(reader.errorMessage().c_str());
     return result;
   };
     
+  /**
+   * Convenient function to read the content of a file and set it in @a root, while the next files of a pipeline are prefetched.
+   * The @a prefetcher is advanced to @a filepath (see Prefetcher::advance()): if the file was not already prefetched, its content is loaded in background while the handler starts to decode it. Meanwhile, the next queued files are loaded.
+   * @relates HandlerReader
+   * @ingroup openma_io
+   */
+  bool read(Node* root, const std::string& filepath, const std::string& format, const std::unordered_map<std::string, Any>& options, Prefetcher* prefetcher)
+  {
+    if (prefetcher != nullptr)
+      prefetcher->advance(filepath);
+    return read(root, filepath, format, options);
+  };
+    
   /**
    * Convenient function to read the content of a file and return it in a Node object.
    * In case the result is null (@c nullptr), this certainly means that an error was thrown. Error message are sent to the logger and might help to determine the problem.
@@ -78,6 +317,120 @@ namespace io
     return root;
   };
   
+  /**
+   * Convenient function to read only the metadata of a file and set them in @a root.
+   * The data section of the file is not read: the properties, the events, the hardwares, and the time sequences are extracted, but the latter are created without samples.
+   * The number of samples stored in the file for each time sequence is given by its property "storedSamples" (unsigned integer).
+   * This function is adapted to scan quickly a large number of files (e.g. to build a catalogue of trials).
+   * @relates HandlerReader
+   * @ingroup openma_io
+   */
+  bool read_metadata(Node* root, const std::string& filepath, const std::string& format)
+  {
+    return read(root, filepath, format, {{"metadata", true}});
+  };
+  
+  /**
+   * Convenient function to read only the metadata of a file and return them in a Node object.
+   * @note The returned Node was created by the new() operator. It is the responsability of the developer to delete it.
+   * @relates HandlerReader
+   * @ingroup openma_io
+   */
+  Node* read_metadata(const std::string& filepath, const std::string& format)
+  {
+    Node* root = new Node("root");
+    if (!read_metadata(root, filepath, format))
+    {
+      delete root;
+      root = nullptr;
+    }
+    return root;
+  };
+  
+  /**
+   * @struct ReadResult openma/io.h
+   * @brief Result of the reading of one file by the function read_many().
+   * @var ReadResult::Path
+   * Path of the read file.
+   * @var ReadResult::Success
+   * True if the file was read without error.
+   * @var ReadResult::ErrorCode
+   * Code of the error which happened during the reading (Error::None if no error).
+   * @var ReadResult::ErrorMessage
+   * Message associated with the error.
+   * @var ReadResult::Nodes
+   * Nodes extracted from the file (e.g. a Trial). Once read_many() returns, these nodes are children of the given root (if any).
+   * @ingroup openma_io
+   */
+  
+  /**
+   * @struct ReadOptions openma/io.h
+   * @brief Options used by the function read_many().
+   * @var ReadOptions::Format
+   * Format of the files. By default (empty string) the format of each file is detected.
+   * @var ReadOptions::Options
+   * Options passed to the reader of each file (see HandlerReader::setOptions()). If the option "threads" is not set, each file is decoded with only one thread.
+   * @var ReadOptions::Threads
+   * Number of files read concurrently. By default (0), this number is adapted to the hardware.
+   * @var ReadOptions::MemoryBudget
+   * Maximum size (in bytes) of the files read concurrently. By default (0), no limit is set. A file larger than the budget is read alone.
+   * @var ReadOptions::Completed
+   * Function called each time a file is read (with or without success). The calls are serialized. It can return false to discard the extracted nodes (e.g. because they were processed or copied). Discarding the nodes bounds the memory used to read a large set of files.
+   * @ingroup openma_io
+   */
+  
+  /**
+   * Convenient function to read a set of files in parallel.
+   * The files are distributed between several workers. A worker having read all its files steals the remaining files of the others.
+   * The reading of a file does not stop the others if it fails. The result of each file is returned in the same order as the given @a paths.
+   * Once all the files are read, the nodes extracted (and not discarded by the callback ReadOptions::Completed) are added to @a root in the order of the @a paths. If @a root is null, the developer takes the ownership of the nodes stored in the results.
+   * @relates HandlerReader
+   * @ingroup openma_io
+   */
+  std::vector<ReadResult> read_many(const std::vector<std::string>& paths, Node* root, const ReadOptions& options)
+  {
+    std::vector<ReadResult> results(paths.size());
+    if (paths.empty())
+      return results;
+    size_t threads = (options.Threads == 0) ? std::max(1u, std::thread::hardware_concurrency()) : options.Threads;
+    threads = std::min(threads, paths.size());
+    ReadManyPool pool(paths, options, &results);
+    pool.run(threads);
+    if (root != nullptr)
+    {
+      for (auto& result : results)
+      {
+        for (auto node : result.Nodes)
+          node->addParent(root);
+      }
+    }
+    return results;
+  };
+  
+  /**
+   * Convenient function to detect the format of a set of files without reading them.
+   * The returned vector contains the detected format of each file in the same order as the given @a paths. An empty string is set for a file which cannot be opened or whose format is not supported.
+   * The detection relies on HandlerReader::canRead(). The handler detected for a file is memoized (using its extension and its first bytes) and verified first for the next ones. Classifying a large set of similar files does not require to probe all the handlers for each of them.
+   * @relates HandlerReader
+   * @ingroup openma_io
+   */
+  std::vector<std::string> detect_format(const std::vector<std::string>& paths)
+  {
+    std::vector<std::string> formats(paths.size());
+    for (size_t i = 0 ; i < paths.size() ; ++i)
+    {
+      File file;
+      file.open(paths[i].c_str(), Mode::In);
+      if (!file.isOpen())
+        continue;
+      HandlerReader reader(&file);
+      if (reader.canRead())
+        formats[i] = reader.format();
+      file.close();
+    }
+    return formats;
+  };
+  
   /**
    * Convenient function to write the content of the Node @a root into a file.
    * Internally, this function uses the class HandlerWriter.
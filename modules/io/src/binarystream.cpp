@@ -47,6 +47,90 @@
 
 #ifndef DOXYGEN_SHOULD_SKIP_THIS
 
+// Copy a block of characters. When the device gives a direct access to its content (e.g. memory mapped file), the characters are copied in one call from it.
+// NOTE: The destination is owned by the caller, so one copy is always done. To decode the content of a device without copying it, use directly Device::consume().
+void _ma_io_read_block(ma::io::Device* src, char* s, size_t n)
+{
+  if (n == 0)
+    return;
+  const char* data = src->consume(n);
+  if (data != nullptr)
+    memcpy(s, data, n);
+  else if (!src->hasFailure())
+    src->read(s, n);
+};
+
+// NOTE: The next kernels convert blocks of values from @a src to @a dst (both can be the same for an in place conversion). They are written with shifts and masks (and memcpy to respect the strict aliasing rule) to let the compiler vectorize them.
+
+void _ma_io_copy_block(size_t n, const char* src, char* dst)
+{
+  if (src != dst)
+    memcpy(dst, src, n);
+};
+
+// Bytes: 0 1 -> 1 0
+void _ma_io_swap_bytes_16(size_t n, const char* src, char* dst)
+{
+  for (size_t i = 0 ; i < n ; ++i)
+  {
+    uint16_t v; memcpy(&v, src + 2 * i, 2);
+    v = static_cast<uint16_t>((v >> 8) | (v << 8));
+    memcpy(dst + 2 * i, &v, 2);
+  }
+};
+
+// Bytes: 0 1 2 3 -> 3 2 1 0
+void _ma_io_swap_bytes_32(size_t n, const char* src, char* dst)
+{
+  for (size_t i = 0 ; i < n ; ++i)
+  {
+    uint32_t v; memcpy(&v, src + 4 * i, 4);
+    v = ((v >> 8) & 0x00FF00FFu) | ((v & 0x00FF00FFu) << 8);
+    v = (v >> 16) | (v << 16);
+    memcpy(dst + 4 * i, &v, 4);
+  }
+};
+
+// Bytes: 0 1 2 3 4 5 6 7 -> 7 6 5 4 3 2 1 0
+void _ma_io_swap_bytes_64(size_t n, const char* src, char* dst)
+{
+  for (size_t i = 0 ; i < n ; ++i)
+  {
+    uint64_t v; memcpy(&v, src + 8 * i, 8);
+    v = ((v >> 8) & 0x00FF00FF00FF00FFull) | ((v & 0x00FF00FF00FF00FFull) << 8);
+    v = ((v >> 16) & 0x0000FFFF0000FFFFull) | ((v & 0x0000FFFF0000FFFFull) << 16);
+    v = (v >> 32) | (v << 32);
+    memcpy(dst + 8 * i, &v, 8);
+  }
+};
+
+// Bytes: 0 1 2 3 -> 2 3 0 1 (the last byte is decremented if not null for the VAX floats)
+void _ma_io_swap_words_32(size_t n, const char* src, char* dst, bool vaxfloat)
+{
+  const uint32_t dec = vaxfloat ? 0x01000000u : 0u;
+  for (size_t i = 0 ; i < n ; ++i)
+  {
+    uint32_t v; memcpy(&v, src + 4 * i, 4);
+    v = (v >> 16) | (v << 16);
+    v -= ((v & 0xFF000000u) != 0u) ? dec : 0u;
+    memcpy(dst + 4 * i, &v, 4);
+  }
+};
+
+// Bytes: 0 1 2 3 4 5 6 7 -> 6 7 4 5 2 3 0 1 (the last byte is decremented if not null for the VAX floats)
+void _ma_io_swap_words_64(size_t n, const char* src, char* dst, bool vaxfloat)
+{
+  const uint64_t dec = vaxfloat ? 0x0100000000000000ull : 0ull;
+  for (size_t i = 0 ; i < n ; ++i)
+  {
+    uint64_t v; memcpy(&v, src + 8 * i, 8);
+    v = ((v >> 16) & 0x0000FFFF0000FFFFull) | ((v & 0x0000FFFF0000FFFFull) << 16);
+    v = (v >> 32) | (v << 32);
+    v -= ((v & 0xFF00000000000000ull) != 0ull) ? dec : 0ull;
+    memcpy(dst + 8 * i, &v, 8);
+  }
+};
+
 namespace ma
 {
 namespace io
@@ -72,6 +156,27 @@ namespace io
    */
   ByteOrderConverter::ByteOrderConverter()
   {}
+  
+  /**
+   * Creates a converter for the given byte @a order. The caller takes the ownership of the returned object.
+   * A null pointer is returned for ByteOrder::NotApplicable.
+   */
+  ByteOrderConverter* ByteOrderConverter::create(ByteOrder order)
+  {
+    switch (order)
+    {
+    case ByteOrder::NotApplicable:
+      return nullptr;
+    case ByteOrder::VAXLittleEndian:
+      return new VAXLittleEndianConverter;
+    case ByteOrder::IEEELittleEndian:
+      return new IEEELittleEndianConverter;
+    case ByteOrder::IEEEBigEndian:
+      return new IEEEBigEndianConverter;
+    default: // Should be impossible
+      throw(LogicError("Unknown endian format."));
+    }
+  };
     
   /**
    * @fn ByteOrderConverter::~ByteOrderConverter()
@@ -116,14 +221,108 @@ namespace io
     std::string str;
     if (len != 0)
     {
-      char* byteptr = new char[len];
-      src->read(byteptr, len);
-      str.assign(byteptr, len);
-      delete[] byteptr;
+      // No intermediate buffer is needed if the device gives a direct access to its content
+      const char* data = src->consume(len);
+      if (data != nullptr)
+        str.assign(data, len);
+      else if (!src->hasFailure())
+      {
+        char* byteptr = new char[len];
+        src->read(byteptr, len);
+        str.assign(byteptr, len);
+        delete[] byteptr;
+      }
     }
     return str;
   };
   
+  // NOTE: The next bulk methods convert the whole block of data in one pass. When the device gives a direct access to its content, the values are converted directly from it into @a values. Otherwise, the block is read and then converted in place.
+  //       This is only possible when the host architecture is IEEE little endian. Otherwise, each value is read separately.
+  
+#if _OPENMA_ARCH == _OPENMA_IEEE_LE
+  #define _OPENMA_IO_BULK_READ(sizeofvalue, convert, readvalue) \
+    if (n == 0) \
+      return; \
+    const char* data = src->consume(n * sizeofvalue); \
+    if (data != nullptr) \
+      this->convert(n, data, reinterpret_cast<char*>(values)); \
+    else if (!src->hasFailure()) \
+    { \
+      src->read(reinterpret_cast<char*>(values), n * sizeofvalue); \
+      this->convert(n, reinterpret_cast<const char*>(values), reinterpret_cast<char*>(values)); \
+    }
+#else
+  #define _OPENMA_IO_BULK_READ(sizeofvalue, convert, readvalue) \
+    for (size_t i = 0 ; i < n ; ++i) \
+      values[i] = this->readvalue(src);
+#endif
+  
+  /** 
+   * Extracts @a n signed 16-bit integers.
+   */
+  void ByteOrderConverter::readI16(size_t n, int16_t* values, Device* src) const
+  {
+    _OPENMA_IO_BULK_READ(2, convert16, readI16)
+  };
+  
+  /** 
+   * Extracts @a n unsigned 16-bit integers.
+   */
+  void ByteOrderConverter::readU16(size_t n, uint16_t* values, Device* src) const
+  {
+    _OPENMA_IO_BULK_READ(2, convert16, readU16)
+  };
+  
+  /** 
+   * Extracts @a n signed 32-bit integers.
+   */
+  void ByteOrderConverter::readI32(size_t n, int32_t* values, Device* src) const
+  {
+    _OPENMA_IO_BULK_READ(4, convert32, readI32)
+  };
+  
+  /** 
+   * Extracts @a n unsigned 32-bit integers.
+   */
+  void ByteOrderConverter::readU32(size_t n, uint32_t* values, Device* src) const
+  {
+    _OPENMA_IO_BULK_READ(4, convert32, readU32)
+  };
+  
+  /** 
+   * Extracts @a n signed 64-bit integers.
+   */
+  void ByteOrderConverter::readI64(size_t n, int64_t* values, Device* src) const
+  {
+    _OPENMA_IO_BULK_READ(8, convert64, readI64)
+  };
+  
+  /** 
+   * Extracts @a n unsigned 64-bit integers.
+   */
+  void ByteOrderConverter::readU64(size_t n, uint64_t* values, Device* src) const
+  {
+    _OPENMA_IO_BULK_READ(8, convert64, readU64)
+  };
+  
+  /** 
+   * Extracts @a n floats.
+   */
+  void ByteOrderConverter::readFloat(size_t n, float* values, Device* src) const
+  {
+    _OPENMA_IO_BULK_READ(4, convertFloat, readFloat)
+  };
+  
+  /** 
+   * Extracts @a n doubles.
+   */
+  void ByteOrderConverter::readDouble(size_t n, double* values, Device* src) const
+  {
+    _OPENMA_IO_BULK_READ(8, convertDouble, readDouble)
+  };
+  
+#undef _OPENMA_IO_BULK_READ
+  
   /** 
    * Writes the character @a val in the device.
    */  
@@ -410,6 +609,46 @@ namespace io
 #endif
   };
   
+  /**
+   * Converts @a n 16-bit integers from @a src to @a dst (both can be the same).
+   */
+  void VAXLittleEndianConverter::convert16(size_t n, const char* src, char* dst) const
+  {
+    _ma_io_copy_block(2 * n, src, dst); // No conversion needed
+  };
+  
+  /**
+   * Converts @a n 32-bit integers from @a src to @a dst (both can be the same).
+   */
+  void VAXLittleEndianConverter::convert32(size_t n, const char* src, char* dst) const
+  {
+    _ma_io_swap_words_32(n, src, dst, false);
+  };
+  
+  /**
+   * Converts @a n 64-bit integers from @a src to @a dst (both can be the same).
+   */
+  void VAXLittleEndianConverter::convert64(size_t n, const char* src, char* dst) const
+  {
+    _ma_io_swap_words_64(n, src, dst, false);
+  };
+  
+  /**
+   * Converts @a n floats from @a src to @a dst (both can be the same).
+   */
+  void VAXLittleEndianConverter::convertFloat(size_t n, const char* src, char* dst) const
+  {
+    _ma_io_swap_words_32(n, src, dst, true);
+  };
+  
+  /**
+   * Converts @a n doubles from @a src to @a dst (both can be the same).
+   */
+  void VAXLittleEndianConverter::convertDouble(size_t n, const char* src, char* dst) const
+  {
+    _ma_io_swap_words_64(n, src, dst, true);
+  };
+  
   // ----------------------------------------------------------------------- //
   
   /** 
@@ -662,6 +901,46 @@ namespace io
 #endif
   };
   
+  /**
+   * Converts @a n 16-bit integers from @a src to @a dst (both can be the same).
+   */
+  void IEEEBigEndianConverter::convert16(size_t n, const char* src, char* dst) const
+  {
+    _ma_io_swap_bytes_16(n, src, dst);
+  };
+  
+  /**
+   * Converts @a n 32-bit integers from @a src to @a dst (both can be the same).
+   */
+  void IEEEBigEndianConverter::convert32(size_t n, const char* src, char* dst) const
+  {
+    _ma_io_swap_bytes_32(n, src, dst);
+  };
+  
+  /**
+   * Converts @a n 64-bit integers from @a src to @a dst (both can be the same).
+   */
+  void IEEEBigEndianConverter::convert64(size_t n, const char* src, char* dst) const
+  {
+    _ma_io_swap_bytes_64(n, src, dst);
+  };
+  
+  /**
+   * Converts @a n floats from @a src to @a dst (both can be the same).
+   */
+  void IEEEBigEndianConverter::convertFloat(size_t n, const char* src, char* dst) const
+  {
+    _ma_io_swap_bytes_32(n, src, dst);
+  };
+  
+  /**
+   * Converts @a n doubles from @a src to @a dst (both can be the same).
+   */
+  void IEEEBigEndianConverter::convertDouble(size_t n, const char* src, char* dst) const
+  {
+    _ma_io_swap_bytes_64(n, src, dst);
+  };
+  
   // ----------------------------------------------------------------------- //
   
   /** 
@@ -913,6 +1192,46 @@ namespace io
     dest->write(byteptr, 4);
 #endif
   };
+  
+  /**
+   * Converts @a n 16-bit integers from @a src to @a dst (both can be the same).
+   */
+  void IEEELittleEndianConverter::convert16(size_t n, const char* src, char* dst) const
+  {
+    _ma_io_copy_block(2 * n, src, dst); // No conversion needed
+  };
+  
+  /**
+   * Converts @a n 32-bit integers from @a src to @a dst (both can be the same).
+   */
+  void IEEELittleEndianConverter::convert32(size_t n, const char* src, char* dst) const
+  {
+    _ma_io_copy_block(4 * n, src, dst); // No conversion needed
+  };
+  
+  /**
+   * Converts @a n 64-bit integers from @a src to @a dst (both can be the same).
+   */
+  void IEEELittleEndianConverter::convert64(size_t n, const char* src, char* dst) const
+  {
+    _ma_io_copy_block(8 * n, src, dst); // No conversion needed
+  };
+  
+  /**
+   * Converts @a n floats from @a src to @a dst (both can be the same).
+   */
+  void IEEELittleEndianConverter::convertFloat(size_t n, const char* src, char* dst) const
+  {
+    _ma_io_copy_block(4 * n, src, dst); // No conversion needed
+  };
+  
+  /**
+   * Converts @a n doubles from @a src to @a dst (both can be the same).
+   */
+  void IEEELittleEndianConverter::convertDouble(size_t n, const char* src, char* dst) const
+  {
+    _ma_io_copy_block(8 * n, src, dst); // No conversion needed
+  };
 };
 };
 
@@ -1007,23 +1326,7 @@ namespace io
         return;
       delete optr->Converter;
     }
-    switch (order)
-    {
-    case ByteOrder::NotApplicable:
-      optr->Converter = nullptr;
-      break;
-    case ByteOrder::VAXLittleEndian:
-      optr->Converter = new VAXLittleEndianConverter;
-      break;
-    case ByteOrder::IEEELittleEndian:
-      optr->Converter = new IEEELittleEndianConverter;
-      break;
-    case ByteOrder::IEEEBigEndian:
-      optr->Converter = new IEEEBigEndianConverter;
-      break;
-    default: // Should be impossible
-      throw(LogicError("Unknown endian format."));
-    }
+    optr->Converter = ByteOrderConverter::create(order);
   };
   
   /** 
@@ -1041,8 +1344,8 @@ namespace io
    */
   void BinaryStream::readChar(size_t n, char* values)
   {
-    for (size_t i = 0 ; i < n ; ++i)
-      values[i] = this->readChar();
+    auto optr = this->pimpl();
+    _ma_io_read_block(optr->Source, values, n);
   };
 
   /** 
@@ -1060,8 +1363,8 @@ namespace io
    */
   void BinaryStream::readI8(size_t n, int8_t* values)
   {
-    for (size_t i = 0 ; i < n ; ++i)
-      values[i] = this->readI8();
+    auto optr = this->pimpl();
+    _ma_io_read_block(optr->Source, reinterpret_cast<char*>(values), n);
   };
  
   /** 
@@ -1079,8 +1382,8 @@ namespace io
    */
   void BinaryStream::readU8(size_t n, uint8_t* values)
   {
-    for (size_t i = 0 ; i < n ; ++i)
-      values[i] = this->readU8();
+    auto optr = this->pimpl();
+    _ma_io_read_block(optr->Source, reinterpret_cast<char*>(values), n);
   };
   
   /** 
@@ -1098,8 +1401,8 @@ namespace io
    */
   void BinaryStream::readI16(size_t n, int16_t* values)
   {
-    for (size_t i = 0 ; i < n ; ++i)
-      values[i] = this->readI16();
+    auto optr = this->pimpl();
+    optr->Converter->readI16(n, values, optr->Source);
   };
   
   /** 
@@ -1117,8 +1420,8 @@ namespace io
    */
   void BinaryStream::readU16(size_t n, uint16_t* values)
   {
-    for (size_t i = 0 ; i < n ; ++i)
-      values[i] = this->readU16();
+    auto optr = this->pimpl();
+    optr->Converter->readU16(n, values, optr->Source);
   };
   
   /** 
@@ -1136,8 +1439,8 @@ namespace io
    */
   void BinaryStream::readI32(size_t n, int32_t* values)
   {
-    for (size_t i = 0 ; i < n ; ++i)
-      values[i] = this->readI32();
+    auto optr = this->pimpl();
+    optr->Converter->readI32(n, values, optr->Source);
   };
   
   /** 
@@ -1155,8 +1458,8 @@ namespace io
    */
   void BinaryStream::readU32(size_t n, uint32_t* values)
   {
-    for (size_t i = 0 ; i < n ; ++i)
-      values[i] = this->readU32();
+    auto optr = this->pimpl();
+    optr->Converter->readU32(n, values, optr->Source);
   };
   
   /** 
@@ -1174,8 +1477,8 @@ namespace io
    */
   void BinaryStream::readI64(size_t n, int64_t* values)
   {
-    for (size_t i = 0 ; i < n ; ++i)
-      values[i] = this->readI64();
+    auto optr = this->pimpl();
+    optr->Converter->readI64(n, values, optr->Source);
   };
   
   /** 
@@ -1193,8 +1496,8 @@ namespace io
    */
   void BinaryStream::readU64(size_t n, uint64_t* values)
   {
-    for (size_t i = 0 ; i < n ; ++i)
-      values[i] = this->readU64();
+    auto optr = this->pimpl();
+    optr->Converter->readU64(n, values, optr->Source);
   };
   
   /** 
@@ -1212,8 +1515,8 @@ namespace io
    */
   void BinaryStream::readFloat(size_t n, float* values)
   {
-    for (size_t i = 0 ; i < n ; ++i)
-      values[i] = this->readFloat();
+    auto optr = this->pimpl();
+    optr->Converter->readFloat(n, values, optr->Source);
   };
   
   /** 
@@ -1231,8 +1534,8 @@ namespace io
    */
   void BinaryStream::readDouble(size_t n, double* values)
   {
-    for (size_t i = 0 ; i < n ; ++i)
-      values[i] = this->readDouble();
+    auto optr = this->pimpl();
+    optr->Converter->readDouble(n, values, optr->Source);
   };
    
   /** 
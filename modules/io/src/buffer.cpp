@@ -36,6 +36,10 @@
 #include "openma/io/buffer_p.h"
 #include "openma/base/logger.h"
 
+#include <new> // std::nothrow
+#include <algorithm> // std::min, std::max
+#include <cstring> // memcpy, memset
+
 // -------------------------------------------------------------------------- //
 //                                 PRIVATE API                                //
 // -------------------------------------------------------------------------- //
@@ -66,6 +70,9 @@ namespace io
   : mp_Data(nullptr),
     m_DataOwned(false),
     m_DataSize(0),
+    m_Capacity(0),
+    m_Contiguous(false),
+    m_Growable(false),
     m_ChunkSize(0),
     m_ChunkOffset(-1),
     m_Offset(-1),
@@ -77,7 +84,8 @@ namespace io
    */
   
   /**
-   * Open the file with the given filename @a s and the options @a mode.
+   * Open the given @a data with the options @a mode.
+   * In case the data are owned, contiguous (only one chunk) and writable, the buffer grows automatically when data are written after its end.
    */
   ChunkBuffer* ChunkBuffer::open(char* data, size_t dataSize, const std::vector<size_t>& chunkIds, size_t chunkSize, Mode mode, bool owned) _OPENMA_NOEXCEPT
   {
@@ -87,15 +95,32 @@ namespace io
     this->mp_Data = data;
     this->m_DataOwned = owned;
     this->m_DataSize = dataSize;
+    this->m_Capacity = dataSize;
     this->m_ChunkIds = chunkIds;
     this->m_ChunkSize = chunkSize;
     this->m_ChunkOffset = (chunkIds.empty() ? -1 : chunkIds[0]*chunkSize);
     this->m_Offset = (data != 0) ? 0 : -1;
     this->m_Writing = (mode & Mode::Out) == Mode::Out;
+    this->updateLayout();
 
     return this;
   };
   
+  /**
+   * Open an empty buffer owning its data. Memory for at least @a capacity bytes is allocated and the buffer grows automatically when data are written after its end.
+   */
+  ChunkBuffer* ChunkBuffer::open(size_t capacity, Mode mode) _OPENMA_NOEXCEPT
+  {
+    if (this->isOpen())
+      return 0;
+    char* data = new(std::nothrow) char[std::max(capacity, size_t(1))];
+    if (data == nullptr)
+      return 0;
+    this->open(data, 0, std::vector<size_t>(1,0), 0, mode | Mode::Out, true);
+    this->m_Capacity = std::max(capacity, size_t(1));
+    return this;
+  };
+  
   /**
    * @fn bool ChunkBuffer::isOpen() const _OPENMA_NOEXCEPT
    * Return true if the file is opened.
@@ -113,7 +138,11 @@ namespace io
     if (this->m_DataOwned)
       delete[] this->mp_Data;
     this->mp_Data = 0;
+    this->m_DataOwned = false;
     this->m_DataSize = 0;
+    this->m_Capacity = 0;
+    this->m_Contiguous = false;
+    this->m_Growable = false;
     this->m_ChunkIds.clear();
     this->m_ChunkSize = 0;
     this->m_ChunkOffset = 0;
@@ -137,6 +166,30 @@ namespace io
    * Returns directly the content of the buffer.
    */
   
+  /**
+   * @fn Size ChunkBuffer::capacity() const  _OPENMA_NOEXCEPT
+   * Returns the number of bytes allocated for the buffer.
+   */
+  
+  /**
+   * @fn bool ChunkBuffer::isGrowable() const  _OPENMA_NOEXCEPT
+   * Returns true if the buffer is reallocated when data are written after its end.
+   */
+  
+  /**
+   * Transfers the ownership of the data to the caller and close the buffer.
+   * @return A null pointer if the buffer does not own contiguous data.
+   */
+  char* ChunkBuffer::release() _OPENMA_NOEXCEPT
+  {
+    if (!this->isOpen() || !this->m_DataOwned || !this->m_Contiguous)
+      return nullptr;
+    char* data = this->mp_Data;
+    this->m_DataOwned = false;
+    this->close();
+    return data;
+  };
+  
   /**
    * Sets internal position pointer to relative position.
    * @return The new position value of the modified position pointer. Errors are expected to be signaled by an invalid position value, like -1.
@@ -173,16 +226,7 @@ namespace io
   ChunkBuffer::Size ChunkBuffer::peek(char* s, Size n) const _OPENMA_NOEXCEPT
   {
     n = (((this->m_Offset + n) == 0) || ((this->m_Offset + n) > this->m_DataSize)) ? ((this->m_DataSize - this->m_Offset) > 0 ? this->m_DataSize - this->m_Offset : 0) : n;
-    Offset dataOffset = this->m_Offset;
-    Offset chunkOffset = this->m_ChunkOffset;
-    for (Offset i = 0 ; i < n ; ++i)
-    {
-      if (!this->updateChunkOffset(&dataOffset, &chunkOffset))
-        return i;
-      s[i] = this->mp_Data[chunkOffset];
-      dataOffset += 1;
-    }
-    return n;
+    return this->copy(s, this->m_Offset, n);
   };
   
   /**
@@ -192,35 +236,65 @@ namespace io
   ChunkBuffer::Size ChunkBuffer::read(char* s, Size n) _OPENMA_NOEXCEPT
   {
     n = (((this->m_Offset + n) == 0) || ((this->m_Offset + n) > this->m_DataSize)) ? ((this->m_DataSize - this->m_Offset) > 0 ? this->m_DataSize - this->m_Offset : 0) : n;
-    for (Offset i = 0 ; i < n ; ++i)
-    {
-      if (!this->updateChunkOffset(&(this->m_Offset), &(this->m_ChunkOffset)))
-        return i;
-      s[i] = this->mp_Data[this->m_ChunkOffset];
-      this->m_Offset += 1;
-    }
+    n = this->copy(s, this->m_Offset, n);
+    this->m_Offset += n;
+    this->updateChunkOffset(&(this->m_Offset), &(this->m_ChunkOffset));
     return n;
   };
   
+  /**
+   * Returns a pointer to the next @a n characters and modify the internal offset consequently.
+   * @return A null pointer if the @a n characters are not all available or not stored in the same chunk.
+   */
+  const char* ChunkBuffer::consume(Size n) _OPENMA_NOEXCEPT
+  {
+    if ((n <= 0) || (this->m_Offset < 0) || ((this->m_Offset + n) > this->m_DataSize))
+      return nullptr;
+    // The characters must be in the same chunk to be contiguous in memory
+    if (!this->m_Contiguous && ((this->m_Offset / this->m_ChunkSize) != ((this->m_Offset + n - 1) / this->m_ChunkSize)))
+      return nullptr;
+    Offset dataOffset = this->m_Offset, chunkOffset = this->m_ChunkOffset;
+    if (!this->updateChunkOffset(&dataOffset, &chunkOffset))
+      return nullptr;
+    this->m_Offset += n;
+    return this->mp_Data + chunkOffset;
+  };
+  
   /**
    * Write a sequence of characters
+   * In case the buffer is growable, its data are reallocated if necessary. Otherwise the characters after the end of the buffer are not written.
    * @return The number of characters written.
    */
   ChunkBuffer::Size ChunkBuffer::write(const char* s, Size n) _OPENMA_NOEXCEPT
   {
-    // TODO: Reallocate the data if necessary
+    if ((this->m_Offset < 0) || (n <= 0))
+      return 0;
     if ((this->m_Offset + n) > this->m_DataSize)
-      n = this->m_DataSize - this->m_Offset;
-    
-    for (Buffer::Offset i = 0 ; i < n ; ++i)
     {
-      if (!this->updateChunkOffset(&(this->m_Offset), &(this->m_ChunkOffset)))
-        return i;
-      this->mp_Data[this->m_ChunkOffset] = s[i];
-      this->m_Offset += 1;
+      if (this->m_Growable && this->reserve(this->m_Offset + n))
+      {
+        // The space between the end of the data and the position of the internal pointer is filled by zeros
+        if (this->m_Offset > this->m_DataSize)
+          memset(this->mp_Data + this->m_DataSize, 0, this->m_Offset - this->m_DataSize);
+        this->m_DataSize = this->m_Offset + n;
+        this->m_ChunkSize = this->m_DataSize;
+      }
+      else
+        n = std::max(Size(this->m_DataSize - this->m_Offset), Size(0));
     }
-
-    return n;
+    Size i = 0;
+    Offset chunkOffset = 0;
+    while (i < n)
+    {
+      if (!this->updateChunkOffset(&(this->m_Offset), &chunkOffset))
+        break;
+      Size len = this->m_Contiguous ? (n - i) : std::min(n - i, Size(this->m_ChunkSize - (this->m_Offset % this->m_ChunkSize)));
+      memcpy(this->mp_Data + chunkOffset, s + i, len);
+      this->m_Offset += len;
+      i += len;
+    }
+    this->updateChunkOffset(&(this->m_Offset), &(this->m_ChunkOffset));
+    return i;
   };
   
   const std::vector<size_t>& ChunkBuffer::chunkIDs() const
@@ -237,17 +311,83 @@ namespace io
   {
     this->m_ChunkIds = ids;
     this->m_ChunkSize = size;
+    this->updateLayout();
     this->seek(0,Origin::Begin);
   };
   
+  /**
+   * Update the layout flags from the chunks.
+   * The data are contiguous only if there is one chunk starting at the beginning and containing all the data. The buffer is growable if its contiguous data are also owned and writable.
+   */
+  void ChunkBuffer::updateLayout() _OPENMA_NOEXCEPT
+  {
+    this->m_Contiguous = (this->m_ChunkIds.size() == 1) && (this->m_ChunkIds[0] == 0) && (this->m_ChunkSize >= this->m_DataSize);
+    this->m_Growable = this->m_DataOwned && this->m_Contiguous && this->m_Writing;
+  };
+  
+  /**
+   * Convert the position @a dataOffset in the data to the position @a chunkOffset in the chunks.
+   * The end of the last chunk is a valid position. In case the buffer is growable, any position is valid.
+   */
   bool ChunkBuffer::updateChunkOffset(Offset* dataOffset, Offset* chunkOffset) const
   {
-    size_t idx = *dataOffset / this->m_ChunkSize;
-    if (idx > this->m_ChunkIds.size())
+    if (this->m_Contiguous)
+    {
+      *chunkOffset = *dataOffset;
+      return this->m_Growable || (*dataOffset <= this->m_DataSize);
+    }
+    if (this->m_ChunkSize == 0)
       return false;
+    size_t idx = *dataOffset / this->m_ChunkSize;
+    if (idx >= this->m_ChunkIds.size())
+    {
+      if ((idx != this->m_ChunkIds.size()) || ((*dataOffset % this->m_ChunkSize) != 0))
+        return false;
+      *chunkOffset = (idx == 0) ? 0 : (this->m_ChunkIds[idx-1] + 1) * this->m_ChunkSize;
+      return true;
+    }
     *chunkOffset = (this->m_ChunkIds[idx] * this->m_ChunkSize) + (*dataOffset % this->m_ChunkSize);
     return true;
   };
+  
+  /**
+   * Copy @a n characters stored from the position @a dataOffset into @a s. The characters are copied by span of contiguous memory (i.e. chunk by chunk).
+   * @return The number of characters copied.
+   */
+  ChunkBuffer::Size ChunkBuffer::copy(char* s, Offset dataOffset, Size n) const _OPENMA_NOEXCEPT
+  {
+    Size i = 0;
+    Offset chunkOffset = 0;
+    while (i < n)
+    {
+      if (!this->updateChunkOffset(&dataOffset, &chunkOffset))
+        break;
+      Size len = this->m_Contiguous ? (n - i) : std::min(n - i, Size(this->m_ChunkSize - (dataOffset % this->m_ChunkSize)));
+      memcpy(s + i, this->mp_Data + chunkOffset, len);
+      dataOffset += len;
+      i += len;
+    }
+    return i;
+  };
+  
+  /**
+   * Reallocate the data of a growable buffer to store at least @a size characters.
+   * The capacity is at least doubled to amortize the cost of the successive reallocations.
+   */
+  bool ChunkBuffer::reserve(Size size) _OPENMA_NOEXCEPT
+  {
+    if (size <= this->m_Capacity)
+      return true;
+    Size capacity = std::max(size, 2 * this->m_Capacity);
+    char* data = new(std::nothrow) char[capacity];
+    if (data == nullptr)
+      return false;
+    memcpy(data, this->mp_Data, this->m_DataSize);
+    delete[] this->mp_Data;
+    this->mp_Data = data;
+    this->m_Capacity = capacity;
+    return true;
+  };
 };
 };
 
@@ -267,6 +407,8 @@ namespace io
    *
    * Internally this class uses automatically a buffer mapped into computer's memory (see https://en.wikipedia.org/wiki/Memory-mapped_file).
    *
+   * The buffer can also be used to serialize data in memory without knowing their final size. In this case, the method open(Mode, size_t) allocates an empty buffer which grows automatically (its capacity is at least doubled each time) when data are written after its end. Once the writing is finished, the method release() gives the ownership of the contiguous data to the caller without copying them.
+   *
    * @warning Currently the Mode Append has no effect on this device.
    *
    * @ingroup openma_io
@@ -319,6 +461,24 @@ namespace io
     }
   };
 
+  /**
+   * Open an empty buffer owning its data. The buffer grows automatically when data are written after its end. The initial @a capacity can be set to limit the number of reallocations.
+   * The given @a mode is completed with Mode::Out.
+   */
+  void Buffer::open(Mode mode, size_t capacity)
+  {
+    mode = mode | Mode::Out;
+    if (this->verifyOpenMode(mode))
+    {
+      auto optr = this->pimpl();
+      if (!optr->Buffer->open(capacity, mode))
+        this->setState(State::Fail);
+      else
+        this->clear();
+      this->setOpenMode(mode);
+    }
+  };
+
   /**
    * Returns true if a file was successfuly opened, otherwise false.
    */
@@ -419,6 +579,48 @@ namespace io
     return optr->Buffer->dataSize();
   };
   
+  /**
+   * Returns the number of bytes allocated for the buffer. This number is greater or equal than size() for a growable buffer.
+   */
+  Buffer::Size Buffer::capacity() const _OPENMA_NOEXCEPT
+  {
+    auto optr = this->pimpl();
+    return optr->Buffer->capacity();
+  };
+  
+  /**
+   * Gives the ownership of the data to the caller and closes the buffer. No data is copied. The number of bytes stored in the returned array is set to @a size if not null.
+   * The returned array must be deleted by the caller using the operator delete[].
+   * A null pointer is returned and the State::Fail state flag is set if the buffer does not own its data or if the data are not contiguous (i.e. stored in several chunks).
+   */
+  char* Buffer::release(Size* size)
+  {
+    auto optr = this->pimpl();
+    Size dataSize = optr->Buffer->dataSize();
+    char* data = optr->Buffer->release();
+    if (data == nullptr)
+      this->setState(State::Fail);
+    else if (size != nullptr)
+      *size = dataSize;
+    return data;
+  };
+  
+  /**
+   * Returns a pointer to the next @a n bytes stored in the buffer and moves the internal pointer after them. No data is copied.
+   * A null pointer is returned and the State::Fail and State::End state flags are set if the @a n bytes are not available.
+   * @note In case the buffer is composed of several chunks, the @a n bytes must be stored in the same chunk. Otherwise, a null pointer is returned without modifying the state of the buffer and the method read() must be used.
+   */
+  const char* Buffer::consume(Size n)
+  {
+    auto optr = this->pimpl();
+    if (this->hasFailure() || (n < 0) || ((Offset(this->tell()) + n) > this->size()))
+    {
+      this->setState(State::Fail | State::End);
+      return nullptr;
+    }
+    return optr->Buffer->consume(n);
+  };
+  
   /**
    * Returns the ID associated with each chunk. This could be usefull in case the buffer is not contigous but by part.
    */
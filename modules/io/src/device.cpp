@@ -265,6 +265,33 @@ namespace io
   * @note The use of this method with a sequential device would set the flag State::Fail to true. At least the output would be equal to -1.
   */
   
+  /**
+   * Returns a pointer to the next @a n bytes stored in the device and moves the internal pointer after them.
+   * Contrary to the method read(), no data is copied. The returned pointer remains valid until the device is closed or written.
+   * If the @a n bytes are not available, the State::Fail and State::End state flags are set and a null pointer is returned.
+   * A null pointer returned without modifying the state of the device means that a direct access to the requested bytes is not possible. The method read() must be used instead.
+   *
+   * The default implementation returns always a null pointer without modifying the state of the device.
+   * An inherited class giving a direct access to its content (e.g. File, Buffer) should override this method.
+   */
+  const char* Device::consume(Size n)
+  {
+    OPENMA_UNUSED(n);
+    return nullptr;
+  };
+  
+  /**
+   * Gives a hint on the way the region starting at @a offset and containing @a n bytes will be accessed. A negative value for @a n means until the end of the device.
+   * This is only an advice. The content of the device is not modified and errors are silently ignored.
+   * The default implementation does nothing.
+   */
+  void Device::advise(Advice advice, Offset offset, Size n)
+  {
+    OPENMA_UNUSED(advice);
+    OPENMA_UNUSED(offset);
+    OPENMA_UNUSED(n);
+  };
+  
   /**
    * @fn virtual bool Device::isSequential() const = 0
    * Returns true if the device is sequential otherwise false.
@@ -37,6 +37,10 @@
 #include "openma/config.h"
 #include "openma/base/logger.h"
 
+#include <cstring> // memcpy
+#include <cstdio> // fopen, fread
+#include <algorithm> // std::min
+#include <vector>
 #include <sys/stat.h>
 #if defined(HAVE_SYS_MMAP)
   #if defined(HAVE_64_BIT_COMPILER)
@@ -300,8 +304,8 @@ namespace io
   MemoryMappedBuffer::Size MemoryMappedBuffer::peek(char* s, Size n) const _OPENMA_NOEXCEPT
   {
     n = (((this->m_Offset + n) == 0) || ((this->m_Offset + n) > this->m_DataSize)) ? ((this->m_DataSize - this->m_Offset) > 0 ? this->m_DataSize - this->m_Offset : 0) : n;
-    for (Offset i = 0 ; i < n ; ++i)
-      s[i] = this->mp_Data[this->m_Offset + i];
+    if (n > 0)
+      memcpy(s, this->mp_Data + this->m_Offset, n);
     return n;
   };
   
@@ -316,17 +320,69 @@ namespace io
     return n;
   };
   
+  /**
+   * Returns a pointer to the next @a n characters of the mapped data and modify the internal offset consequently.
+   * @return A null pointer if the @a n characters are not all available.
+   */
+  const char* MemoryMappedBuffer::consume(Size n) _OPENMA_NOEXCEPT
+  {
+    if ((n < 0) || (this->m_Offset < 0) || ((this->m_Offset + n) > this->m_DataSize))
+      return nullptr;
+    const char* s = this->mp_Data + this->m_Offset;
+    this->m_Offset += n;
+    return s;
+  };
+  
+  /**
+   * Advise the kernel on the way the mapped pages covering the region starting at @a off and containing @a n characters will be accessed.
+   * A negative value for @a n means until the end of the mapped data.
+   * @return Returns false if the region is not valid or if the advice was rejected.
+   */
+  bool MemoryMappedBuffer::advise(Advice advice, Offset off, Size n) _OPENMA_NOEXCEPT
+  {
+    if ((this->mp_Data == 0) || (off < 0) || (off >= this->m_DataSize))
+      return false;
+    if ((n < 0) || ((off + n) > this->m_DataSize))
+      n = this->m_DataSize - off;
+#if defined(HAVE_SYS_MMAP)
+    int flag = POSIX_MADV_NORMAL;
+    switch (advice)
+    {
+    case Advice::Sequential:
+      flag = POSIX_MADV_SEQUENTIAL;
+      break;
+    case Advice::Random:
+      flag = POSIX_MADV_RANDOM;
+      break;
+    case Advice::WillNeed:
+      flag = POSIX_MADV_WILLNEED;
+      break;
+    case Advice::DontNeed:
+      flag = POSIX_MADV_DONTNEED;
+      break;
+    case Advice::Normal:
+    default:
+      break;
+    }
+    // The address given to posix_madvise must be aligned on a page boundary
+    const Offset start = off - (off % MemoryMappedBuffer::granularity());
+    return (::posix_madvise(this->mp_Data + start, n + off - start, flag) == 0);
+#else
+    // NOTE: No equivalent of madvise is available for the mapped views on every supported Windows version.
+    OPENMA_UNUSED(advice);
+    return true;
+#endif
+  };
+  
   /**
    * Write a sequence of characters
    * @return The number of characters written.
    */
   MemoryMappedBuffer::Size MemoryMappedBuffer::write(const char* s, Size n) _OPENMA_NOEXCEPT
   {
-    while ((this->m_Offset + n) > this->m_DataSize) 
-    {
-      if (!this->resizeMap())
-        return 0;
-    }
+    // The map is extended once to receive all the characters
+    if (((this->m_Offset + n) > this->m_DataSize) && !this->resizeMap(this->m_Offset + n))
+      return 0;
     
     for (Offset i = 0 ; i < n ; ++i)
       this->mp_Data[this->m_Offset + i] = s[i];
@@ -366,9 +422,10 @@ namespace io
   
   /**
    * Try to resize the map to be able to extract more data from the file.
+   * The map is extended by one page or up to the given @a minimum size (rounded to the next page), whichever is larger.
    * @return Returns 0 if an error occured.
    */
-  MemoryMappedBuffer* MemoryMappedBuffer::resizeMap() _OPENMA_NOEXCEPT
+  MemoryMappedBuffer* MemoryMappedBuffer::resizeMap(Size minimum) _OPENMA_NOEXCEPT
   {
     if (!this->isOpen() || !this->m_Writing)
       return 0;
@@ -376,6 +433,8 @@ namespace io
     if (pageSize <= 0)
       return 0;
     size_t newBufferSize = this->m_DataSize + pageSize;
+    if (minimum > static_cast<Size>(newBufferSize))
+      newBufferSize = static_cast<size_t>(((minimum + pageSize - 1) / pageSize) * pageSize);
 #if !defined(HAVE_SYS_MMAP)
     if ((::UnmapViewOfFile(this->mp_Data) == 0) || (::CloseHandle(this->m_Map) == 0))
       return 0;
@@ -452,6 +511,45 @@ namespace io
     struct stat buffer;   
     return (stat(filepath, &buffer) == 0); 
   };
+  
+  /**
+   * Ask the operating system to load in its cache the content of the file specified by @a filepath.
+   * Only the @a n bytes starting at @a offset are loaded. By default (negative @a n), the file is loaded until its end.
+   * On POSIX systems, this is based on the function posix_fadvise() and the advice POSIX_FADV_WILLNEED. Otherwise, the content is read and discarded.
+   * This method can block until the content is read. It is then usually used in a background thread to prepare the next files to read (see Prefetcher).
+   * Returns false if the file cannot be opened.
+   */
+  bool File::prefetch(const char* filepath, Offset offset, Size n)
+  {
+    if ((filepath == nullptr) || (offset < 0))
+      return false;
+#if defined(HAVE_SYS_MMAP) && defined(POSIX_FADV_WILLNEED)
+    int fd = ::open(filepath, O_RDONLY);
+    if (fd == -1)
+      return false;
+    // A length of 0 means until the end of the file
+    bool res = (::posix_fadvise(fd, offset, (n < 0) ? 0 : n, POSIX_FADV_WILLNEED) == 0);
+    ::close(fd);
+    return res;
+#else
+    FILE* file = fopen(filepath, "rb");
+    if (file == nullptr)
+      return false;
+    bool res = (fseek(file, static_cast<long>(offset), SEEK_SET) == 0);
+    std::vector<char> buffer(65536);
+    while (res && (n != 0))
+    {
+      const size_t len = (n < 0) ? buffer.size() : std::min(buffer.size(), static_cast<size_t>(n));
+      const size_t num = fread(buffer.data(), 1, len, file);
+      if (num == 0)
+        break;
+      if (n > 0)
+        n -= static_cast<Size>(num);
+    }
+    fclose(file);
+    return res;
+#endif
+  };
  
   /**
    * Open the given @a filepath with the specified @a mode.
@@ -570,5 +668,30 @@ namespace io
     auto optr = this->pimpl();
     return optr->Buffer->dataSize();
   };
+  
+  /**
+   * Returns a pointer inside the memory mapped data to the next @a n bytes and moves the internal pointer after them.
+   * No data is copied. The returned pointer remains valid until the file is closed or written.
+   * The State::Fail and State::End state flags are set and a null pointer is returned if the @a n bytes are not available.
+   */
+  const char* File::consume(Size n)
+  {
+    auto optr = this->pimpl();
+    const char* s = !this->hasFailure() ? optr->Buffer->consume(n) : nullptr;
+    if (s == nullptr)
+      this->setState(State::Fail | State::End);
+    return s;
+  };
+  
+  /**
+   * Forwards the given @a advice to the system for the memory mapped pages covering the region starting at @a offset and containing @a n bytes (until the end of the file if @a n is negative).
+   * On POSIX systems, this is based on the function posix_madvise(). Large sections of data read sequentially (e.g. the frames of an acquisition) can benefit of the advices Advice::Sequential and Advice::WillNeed.
+   * Errors are silently ignored as this is only a hint.
+   */
+  void File::advise(Advice advice, Offset offset, Size n)
+  {
+    auto optr = this->pimpl();
+    optr->Buffer->advise(advice, offset, n);
+  };
 };
 };
\ No newline at end of file
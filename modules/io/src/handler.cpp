@@ -32,12 +32,21 @@
  * POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include "openma/config.h" // _OPENMA_ARCH, _OPENMA_IEEE_LE
 #include "openma/io/handler.h"
 #include "openma/io/handler_p.h"
+#include "openma/io/binarystream_p.h" // ByteOrderConverter
 #include "openma/io/device.h"
 #include "openma/io/enums.h"
 #include "openma/base/node.h"
 
+#include <algorithm> // std::find, std::min, std::max
+#include <memory> // std::unique_ptr
+#include <vector>
+#include <thread>
+#include <type_traits>
+#include <cstdint>
+
 // -------------------------------------------------------------------------- //
 //                                 PRIVATE API                                //
 // -------------------------------------------------------------------------- //
@@ -48,11 +57,200 @@ namespace ma
 {
 namespace io
 {
+#if _OPENMA_ARCH == _OPENMA_IEEE_LE
+  // The frames are processed by tiles small enough to stay in the cache. The words of a tile are converted to the native byte order by the bulk kernel of the converter, then each channel is gathered (strided copy) before to be scaled into its plane (contiguous loop).
+  static void _ma_io_decode_interleaved_i16(const char* data, ByteOrder order, size_t frames, size_t channels, double* const* planes, const double* scales)
+  {
+    std::unique_ptr<ByteOrderConverter> converter(ByteOrderConverter::create(order));
+    const size_t frameSize = channels * sizeof(int16_t);
+    const size_t tile = std::max<size_t>(1, (16 * 1024) / std::max<size_t>(1, frameSize));
+    std::vector<int16_t> words(std::min(tile, frames) * channels), column(std::min(tile, frames));
+    for (size_t first = 0 ; first < frames ; first += tile)
+    {
+      const size_t num = std::min(tile, frames - first);
+      converter->convert16(num * channels, data + first * frameSize, reinterpret_cast<char*>(words.data()));
+      for (size_t j = 0 ; j < channels ; ++j)
+      {
+        if (planes[j] == nullptr)
+          continue;
+        for (size_t i = 0 ; i < num ; ++i)
+          column[i] = words[i * channels + j];
+        double* plane = planes[j] + first;
+        const double scale = scales[j];
+        for (size_t i = 0 ; i < num ; ++i)
+          plane[i] = static_cast<double>(column[i]) * scale;
+      }
+    }
+  };
+#else
+  template <typename T, bool BigEndian>
+  static inline T _ma_io_decode_integer(const char* data)
+  {
+    // Value assembled byte by byte to not depend on the host architecture (reduced to a simple load by the compiler when the byte order is the native one)
+    using U = typename std::make_unsigned<T>::type;
+    U value = 0;
+    for (size_t i = 0 ; i < sizeof(T) ; ++i)
+      value |= static_cast<U>(static_cast<uint8_t>(data[BigEndian ? sizeof(T) - 1 - i : i])) << (8 * i);
+    return static_cast<T>(value);
+  };
+  
+  template <typename T, bool BigEndian>
+  static void _ma_io_decode_interleaved_frames(const char* data, size_t frames, size_t channels, double* const* planes, const double* scales)
+  {
+    // The frames are processed by tiles small enough to stay in the cache, while each plane is written contiguously.
+    const size_t frameSize = channels * sizeof(T);
+    const size_t tile = std::max<size_t>(1, (16 * 1024) / std::max<size_t>(1, frameSize));
+    for (size_t first = 0 ; first < frames ; first += tile)
+    {
+      const size_t num = std::min(tile, frames - first);
+      for (size_t j = 0 ; j < channels ; ++j)
+      {
+        double* plane = planes[j];
+        if (plane == nullptr)
+          continue;
+        plane += first;
+        const double scale = scales[j];
+        const char* src = data + first * frameSize + j * sizeof(T);
+        for (size_t i = 0 ; i < num ; ++i)
+          plane[i] = static_cast<double>(_ma_io_decode_integer<T,BigEndian>(src + i * frameSize)) * scale;
+      }
+    }
+  };
+#endif
+  
+  // ----------------------------------------------------------------------- //
+  
   HandlerPrivate::HandlerPrivate()
-  : Source(nullptr), ErrorCode(Error::None), ErrorMessage()
+  : Source(nullptr), ErrorCode(Error::None), ErrorMessage(), Options()
   {};
   
   HandlerPrivate::~HandlerPrivate() _OPENMA_NOEXCEPT = default; // Cannot be inlined
+  
+  /**
+   * Returns the number of threads to use to decode the given number of @a items (e.g. frames, chunks) of @a itemSize bytes.
+   * The option "threads" gives the maximum number of threads (0 or not set: adapted to the hardware).
+   * To not waste time to start threads for small data sections, each thread decodes at least 1 MB of data.
+   */
+  size_t HandlerPrivate::decodingThreads(const std::unordered_map<std::string,Any>& options, size_t items, size_t itemSize)
+  {
+    size_t threads = 0;
+    auto it = options.find("threads");
+    if (it != options.cend())
+      threads = static_cast<size_t>(std::max(0, it->second.cast<int>()));
+    if (threads == 0)
+      threads = std::max(1u, std::thread::hardware_concurrency());
+    const size_t minimumItems = std::max<size_t>(1, (1 << 20) / std::max<size_t>(1, itemSize));
+    return std::max<size_t>(1, std::min(threads, items / minimumItems));
+  };
+  
+  /**
+   * Decodes @a frames of @a channels interleaved 16-bit integers stored in @a data with the given byte @a order.
+   * The samples of each channel are multiplied by their scale factor and written contiguously in the corresponding plane. A null plane means that the channel is not decoded.
+   * On an IEEE little endian host, the words are converted by the bulk kernels of the ByteOrderConverter class. Only the scaling loop is vectorized, the gathering of each channel being a strided copy.
+   */
+  void HandlerPrivate::decodeInterleavedI16(const char* data, ByteOrder order, size_t frames, size_t channels, double* const* planes, const double* scales)
+  {
+#if _OPENMA_ARCH == _OPENMA_IEEE_LE
+    _ma_io_decode_interleaved_i16(data, order, frames, channels, planes, scales);
+#else
+    if (order == ByteOrder::IEEEBigEndian)
+      _ma_io_decode_interleaved_frames<int16_t,true>(data, frames, channels, planes, scales);
+    else
+      _ma_io_decode_interleaved_frames<int16_t,false>(data, frames, channels, planes, scales);
+#endif
+  };
+  
+  /**
+   * @class ReadSelection openma/io/handler_p.h
+   * @brief Selection of the data to extract by a reader (channels, types, frames, metadata only).
+   *
+   * When only the metadata are extracted, the time sequences are created without samples. The number of samples stored in the file for each of them is then given by their property "storedSamples".
+   * This property is always set with the method setStoredSamples(). Its type is ReadSelection::StoredSamples (i.e. unsigned) whatever the format of the file.
+   */
+  
+  /**
+   * @typedef ReadSelection::StoredSamples
+   * Type of the property "storedSamples" (unsigned integer).
+   */
+  
+  /**
+   * Sets the property "storedSamples" of the time sequence @a ts to the given number of @a samples stored in the file.
+   */
+  void ReadSelection::setStoredSamples(Node* ts, size_t samples)
+  {
+    ts->setProperty("storedSamples", static_cast<StoredSamples>(samples));
+  };
+  
+  /**
+   * Extract the selection of the data to read from the given @a options (see HandlerReader::setOptions()).
+   */
+  ReadSelection::ReadSelection(const std::unordered_map<std::string, Any>& options)
+  : Channels(), HasChannels(false), Types(-1), FirstFrame(0), LastFrame(-1), Metadata(false)
+  {
+    auto it = options.find("channels");
+    if ((it != options.cend()) && it->second.isValid())
+    {
+      this->Channels = it->second.cast<std::vector<std::string>>();
+      this->HasChannels = true;
+    }
+    if (((it = options.find("types")) != options.cend()) && it->second.isValid())
+      this->Types = it->second.cast<int>();
+    if (((it = options.find("firstFrame")) != options.cend()) && it->second.isValid())
+      this->FirstFrame = std::max(0, it->second.cast<int>());
+    if (((it = options.find("lastFrame")) != options.cend()) && it->second.isValid())
+      this->LastFrame = it->second.cast<int>();
+    if (((it = options.find("metadata")) != options.cend()) && it->second.isValid())
+      this->Metadata = it->second.cast<bool>();
+  };
+  
+  /**
+   * Returns true if the time sequence with the given @a name and @a type has to be extracted.
+   * The type is selected if all its bits are in the mask given by the option "types".
+   */
+  bool ReadSelection::isSelected(const std::string& name, int type) const _OPENMA_NOEXCEPT
+  {
+    if ((type & this->Types) != type)
+      return false;
+    if (this->HasChannels && (std::find(this->Channels.cbegin(), this->Channels.cend(), name) == this->Channels.cend()))
+      return false;
+    return true;
+  };
+  
+  /**
+   * Returns true if no filter is set on the channels (all the time sequences are extracted).
+   */
+  bool ReadSelection::selectsAll() const _OPENMA_NOEXCEPT
+  {
+    return !this->HasChannels && (this->Types == -1);
+  };
+  
+  /**
+   * Returns true if only the metadata have to be extracted (option "metadata").
+   * In this case, the time sequences are created without samples and the data section is not read.
+   */
+  bool ReadSelection::metadataOnly() const _OPENMA_NOEXCEPT
+  {
+    return this->Metadata;
+  };
+  
+  /**
+   * Compute the range of frames to extract among the @a num available frames.
+   * The index of the first frame is set to @a first and the number of frames to @a count. The range is clamped to the available frames.
+   * If only the metadata are extracted, no frame is selected.
+   */
+  void ReadSelection::frames(size_t num, size_t* first, size_t* count) const _OPENMA_NOEXCEPT
+  {
+    if (this->Metadata)
+    {
+      *first = 0;
+      *count = 0;
+      return;
+    }
+    const size_t f = std::min(static_cast<size_t>(this->FirstFrame), num);
+    const size_t l = (this->LastFrame < 0) ? num : std::min(static_cast<size_t>(this->LastFrame) + 1, num);
+    *first = f;
+    *count = (l > f) ? l - f : 0;
+  };
 };
 };
 
@@ -125,8 +323,10 @@ namespace io
       // In case the handler does not use exception but only error code/message.
       if (optr->ErrorCode == Error::None)
       {
-        for (const auto& p: temp.dynamicProperties())
+        for (const auto& p: temp.dynamicProperties(false))
           output->setProperty(p.first, p.second);
+        for (const auto& p: temp.deferredProperties())
+          output->setDeferredProperty(p.first, p.second);
         for (auto& child: temp.children())
         {
           if (child != nullptr)
@@ -222,6 +422,25 @@ namespace io
     optr->Source = device;
   };
   
+  /**
+   * Returns the options used to configure the reading/writing of the device.
+   */
+  const std::unordered_map<std::string, Any>& Handler::options() const _OPENMA_NOEXCEPT
+  {
+    auto optr = this->pimpl();
+    return optr->Options;
+  };
+  
+  /**
+   * Sets the options used to configure the reading/writing of the device.
+   * Each option is identified by its name. Options unknown by a handler are ignored. The options supported by each handler are detailed in their documentation.
+   */
+  void Handler::setOptions(const std::unordered_map<std::string, Any>& options)
+  {
+    auto optr = this->pimpl();
+    optr->Options = options;
+  };
+  
   /**
    * Returns the current error code.
    */
@@ -42,6 +42,7 @@
 // #endif
 
 #include <algorithm> // std::transform
+#include <mutex> // std::call_once
 
 namespace ma
 {
@@ -50,11 +51,13 @@ namespace io
   /**
    * Convenient method to load handler plugins.
    * Internally this method uses a static object. It will be populated the first time this function is used.
+   * This function can be called concurrently by several threads. The plugins are loaded only once.
    */
   const std::vector<HandlerPlugin*>& load_handler_plugins()
   {
     static PluginManager<HandlerPlugin> manager;
-    if (manager.plugins().empty())
+    static std::once_flag loaded;
+    std::call_once(loaded, []()
     {
 // #ifndef OPENMA_IO_STATIC_DEFINE
       // Dynamic loading
@@ -64,7 +67,7 @@ namespace io
       // Static include
       load_handler_plugins(&manager);
 // #endif
-    }
+    });
     return manager.plugins();
   };
   
@@ -133,6 +136,8 @@ namespace io
       auto len = ext.length();
       for (const auto& f: formats)
       {
+        if (f.length() < len)
+          continue;
         auto subf = f.substr(f.length()-len,len);
         std::transform(subf.begin(), subf.end(), subf.begin(), tolower);
         if (subf.compare(ext) == 0)
@@ -38,6 +38,11 @@
 #include "openma/io/enums.h"
 #include "openma/io/handler.h"
 
+#include <mutex>
+#include <algorithm> // std::transform, std::stable_partition
+#include <cctype> // tolower
+#include <cstdint>
+
 // -------------------------------------------------------------------------- //
 //                                 PRIVATE API                                //
 // -------------------------------------------------------------------------- //
@@ -59,13 +64,77 @@ namespace io
     Handler* Reader;
     Error ErrorCode;
     std::string ErrorMessage;
+    std::unordered_map<std::string, Any> Options;
   };
   
   HandlerReaderPrivate::HandlerReaderPrivate(Device* device, const std::string& format)
-  : Source(device), Format(format), Reader(nullptr), ErrorCode(Error::None), ErrorMessage()
+  : Source(device), Format(format), Reader(nullptr), ErrorCode(Error::None), ErrorMessage(), Options()
   {};
   
   HandlerReaderPrivate::~HandlerReaderPrivate() _OPENMA_NOEXCEPT = default; // Cannot be inlined
+  
+  // Memoization of the detected handlers shared by all the readers.
+  // The key is composed of the extension of the device name and of a hash of its first bytes. The stored plugin is only a hint: it is always verified against the device before being used.
+  struct HandlerDetectionCache
+  {
+    std::mutex Mutex;
+    std::unordered_map<std::string, std::pair<HandlerPlugin*, std::string>> Entries;
+  };
+  
+  static const size_t _ma_io_handler_detection_bytes = 8;
+  static const size_t _ma_io_handler_detection_capacity = 1024;
+  
+  static HandlerDetectionCache& _ma_io_handler_detection_cache()
+  {
+    static HandlerDetectionCache cache;
+    return cache;
+  };
+  
+  static std::string _ma_io_handler_detection_extension(const std::string& name)
+  {
+    auto idx = name.find_last_of('.');
+    if ((idx == std::string::npos) || (idx == (name.size()-1)) || (name.find_first_of("/\\", idx) != std::string::npos))
+      return std::string{};
+    auto ext = name.substr(idx+1);
+    std::transform(ext.begin(), ext.end(), ext.begin(), tolower);
+    return ext;
+  };
+  
+  static std::string _ma_io_handler_detection_key(const Device* device, const std::string& extension)
+  {
+    char bytes[_ma_io_handler_detection_bytes];
+    auto num = device->peek(bytes, sizeof(bytes));
+    // FNV-1a
+    uint64_t hash = 14695981039346656037ull;
+    for (Device::Size i = 0 ; i < num ; ++i)
+    {
+      hash ^= static_cast<uint8_t>(bytes[i]);
+      hash *= 1099511628211ull;
+    }
+    return extension + '\0' + std::to_string(hash);
+  };
+  
+  static bool _ma_io_handler_detection_find(const std::string& key, HandlerPlugin** plugin, std::string* format)
+  {
+    auto& cache = _ma_io_handler_detection_cache();
+    std::lock_guard<std::mutex> lock(cache.Mutex);
+    auto it = cache.Entries.find(key);
+    if (it == cache.Entries.end())
+      return false;
+    *plugin = it->second.first;
+    *format = it->second.second;
+    return true;
+  };
+  
+  static void _ma_io_handler_detection_store(const std::string& key, HandlerPlugin* plugin, const std::string& format)
+  {
+    auto& cache = _ma_io_handler_detection_cache();
+    std::lock_guard<std::mutex> lock(cache.Mutex);
+    // Simple bound: a large set of heterogeneous devices only resets the memoization.
+    if (cache.Entries.size() >= _ma_io_handler_detection_capacity)
+      cache.Entries.clear();
+    cache.Entries[key] = std::make_pair(plugin, format);
+  };
 };
 };
 
@@ -159,6 +228,33 @@ namespace io
     return optr->Format;
   };
   
+  /**
+   * Returns the options passed to the handler used to read the device.
+   */
+  const std::unordered_map<std::string, Any>& HandlerReader::options() const _OPENMA_NOEXCEPT
+  {
+    auto optr = this->pimpl();
+    return optr->Options;
+  };
+  
+  /**
+   * Sets the options passed to the handler used to read the device.
+   * Options unknown by the handler are ignored. The following options are currently supported:
+   *  - threads: integer value (number of threads used to decode the data section of a memory mapped file. Only used by the C3D and HPF formats. By default (or set to 0) this number is adapted to the hardware. Set it to 1 to disable the multithreading).
+   *  - channels: string or vector of strings (names of the time sequences to extract. By default, all the time sequences are extracted).
+   *  - types: integer value (mask of the types of the time sequences to extract, e.g. TimeSequence::Position | TimeSequence::Analog. A time sequence is extracted if all the bits of its type are in the mask).
+   *  - firstFrame: integer value (index of the first frame to extract, starting from 0. For formats mixing several sample rates (e.g. C3D), the index refers to the lowest one and analog samples are extracted accordingly).
+   *  - lastFrame: integer value (index of the last frame to extract, included. By default, or with a negative value, the frames are extracted until the end).
+   *  - metadata: boolean value (extract only the metadata. The data section is not read and the time sequences are created without samples. The number of samples stored for each of them is given by their property "storedSamples", always stored as an unsigned integer whatever the format).
+   *
+   * The options channels, types, firstFrame, lastFrame, and metadata are used by the C3D, BSF, HPF, and OpenMA columnar formats. Unselected data are skipped during the reading and only the selected time sequences are created.
+   */
+  void HandlerReader::setOptions(const std::unordered_map<std::string, Any>& options)
+  {
+    auto optr = this->pimpl();
+    optr->Options = options;
+  };
+  
   /**
    * Returns true if the signature used by the set format is found.
    * If no format was previously set (i.e. if the format is set to an empty string), this method will attempt to find the good format 
@@ -182,16 +278,35 @@ namespace io
     const auto& plugins = load_handler_plugins();
     // Format auto detection?
     bool formatAutoDetection = optr->Format.empty();
-    // In case no format is specified, it is necessary to pass through all the loaded handlers. If none of them detects a managed signature, then, a second pass is made for handler with non specific signature. These handlers rely on device name and handler format.
+    // In case no format is specified, it is necessary to pass through the loaded handlers. If none of them detects a managed signature, then, a second pass is made for handler with non specific signature. These handlers rely on device name and handler format.
+    // To limit the number of probes, the handler previously detected for a similar device (same extension and same first bytes) is verified first. Otherwise, the handlers owning the extension of the device are probed before the others.
     if (formatAutoDetection)
     {
+      const std::string name(optr->Source->name());
+      const std::string key = _ma_io_handler_detection_key(optr->Source, _ma_io_handler_detection_extension(name));
+      HandlerPlugin* cached = nullptr;
+      std::string format;
+      if (_ma_io_handler_detection_find(key, &cached, &format))
+      {
+        auto signature = cached->detectSignature(optr->Source, &format);
+        if ((signature == Signature::Valid) || ((signature == Signature::NotAvailable) && ((cached->capabilities(format) & Capability::CanRead) == Capability::CanRead)))
+        {
+          optr->Format = format;
+          optr->Reader = cached->create(optr->Source, optr->Format);
+          return (optr->Reader != nullptr);
+        }
+      }
+      std::vector<HandlerPlugin*> candidates(plugins.begin(), plugins.end());
+      std::stable_partition(candidates.begin(), candidates.end(), [&name](HandlerPlugin* plugin){return plugin->detectExtension(name);});
       std::vector<HandlerPlugin*> missingSignature, invalidSignature;
+      HandlerPlugin* detected = nullptr;
       // First pass: use handler signatures
-      for (const auto& plugin: plugins)
+      for (const auto& plugin: candidates)
       {
         auto signature = plugin->detectSignature(optr->Source, &(optr->Format));
         if (signature == Signature::Valid)
         {
+          detected = plugin;
           optr->Reader = plugin->create(optr->Source, optr->Format);
           break;
         }
@@ -208,11 +323,11 @@ namespace io
       // Maybe the name of the device will help to find the good format (extension)
       if (optr->Reader == nullptr)
       {
-        const std::string name(optr->Source->name());
         for (const auto& plugin: missingSignature)
         {
           if (plugin->detectExtension(name, &(optr->Format)) && ((plugin->capabilities(optr->Format) & Capability::CanRead) == Capability::CanRead))
           {
+            detected = plugin;
             optr->Reader = plugin->create(optr->Source, optr->Format);
             break;
           }
@@ -222,8 +337,6 @@ namespace io
       // Lets check if the extension was recognized.
       if (optr->Reader == nullptr)
       {
-        const std::string name(optr->Source->name());
-        std::string format;
         for (const auto& plugin: invalidSignature)
         {
           if (plugin->detectExtension(name, &format) && ((plugin->capabilities(format) & Capability::CanRead) == Capability::CanRead))
@@ -234,7 +347,9 @@ namespace io
         }
       }
       // Final test
-      if ((optr->Reader == nullptr) && (this->errorCode() == Error::None))
+      if (optr->Reader != nullptr)
+        _ma_io_handler_detection_store(key, detected, optr->Format);
+      else if (this->errorCode() == Error::None)
         this->setError(Error::UnsupportedFormat, "No handler found to support the given device and/or format");
     }
     // Pre-determined format?
@@ -263,6 +378,7 @@ namespace io
     if (!this->canRead())
       return false;
     auto optr = this->pimpl();
+    optr->Reader->setOptions(optr->Options);
     auto result = optr->Reader->read(root);
     this->setError(optr->Reader->errorCode(), optr->Reader->errorMessage());
     return result;
@@ -295,9 +411,10 @@ namespace io
    */
   const std::vector<std::string>& HandlerReader::availableFormats() _OPENMA_NOEXCEPT
   {
-    static std::vector<std::string> formats;
-    if (formats.empty())
-    {  
+    // The list is built only once (thread-safe initialization of the static variable)
+    static const std::vector<std::string> formats = []()
+    {
+      std::vector<std::string> formats;
       const auto& plugins = load_handler_plugins();
       for (auto plugin: plugins)
       {
@@ -310,7 +427,8 @@ namespace io
           }
         }
       }
-    }
+      return formats;
+    }();
     return formats;
   };
   
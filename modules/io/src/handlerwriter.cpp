@@ -59,10 +59,11 @@ namespace io
     Handler* Writer;
     Error ErrorCode;
     std::string ErrorMessage;
+    std::unordered_map<std::string, Any> Options;
   };
   
   HandlerWriterPrivate::HandlerWriterPrivate(Device* device, const std::string& format)
-  : Source(device), Format(format), Writer(nullptr), ErrorCode(Error::None), ErrorMessage(std::string{})
+  : Source(device), Format(format), Writer(nullptr), ErrorCode(Error::None), ErrorMessage(std::string{}), Options()
   {};
   
   HandlerWriterPrivate::~HandlerWriterPrivate() _OPENMA_NOEXCEPT = default; // Cannot be inlined
@@ -155,6 +156,29 @@ namespace io
     return optr->Format;
   };
   
+  /**
+   * Returns the options passed to the handler used to write the device.
+   */
+  const std::unordered_map<std::string, Any>& HandlerWriter::options() const _OPENMA_NOEXCEPT
+  {
+    auto optr = this->pimpl();
+    return optr->Options;
+  };
+  
+  /**
+   * Sets the options passed to the handler used to write the device.
+   * Options unknown by the handler are ignored. The following options are currently supported:
+   *  - integerFormat: boolean value (store the data as scaled 16-bit integers instead of floats. The files are twice smaller. The scale factors are computed from the range of the data. Only used by the C3D format).
+   *  - byteOrder: string value (byte order of the written file: "IEEELittleEndian", "IEEEBigEndian", "VAXLittleEndian". By default, the native byte order is used. Only used by the C3D format).
+   *  - append: boolean value (add the frames of the trial at the end of the file stored in the device, which must be open in read and write mode. The channels, rates, scales and parameters of the trial must be the same as the stored ones, and the start time of its time sequences must be the one of the file. Only the new frames and the number of frames are written. Only used by the C3D format, for files stored in the float format).
+   *  - resolution: floating point value (quantization step used to compress the samples. Each sample is restored with an error up to the half of this step. By default, the samples are not quantized and the compression is lossless, which gives larger files. Only used by the OpenMA columnar format).
+   */
+  void HandlerWriter::setOptions(const std::unordered_map<std::string, Any>& options)
+  {
+    auto optr = this->pimpl();
+    optr->Options = options;
+  };
+  
   /**
    * Returns true if the extension used by the set format is found.
    * If no format was previously set (i.e. if the format is set to an empty string), this method will attempt to find the good format 
@@ -219,6 +243,7 @@ namespace io
     if (!this->canWrite())
       return false;
     auto optr = this->pimpl();
+    optr->Writer->setOptions(optr->Options);
     auto result = optr->Writer->write(root);
     this->setError(optr->Writer->errorCode(), optr->Writer->errorMessage());
     return result;
@@ -251,9 +276,10 @@ namespace io
    */
   const std::vector<std::string>& HandlerWriter::availableFormats() _OPENMA_NOEXCEPT
   {
-    static std::vector<std::string> formats;
-    if (formats.empty())
-    {  
+    // The list is built only once (thread-safe initialization of the static variable)
+    static const std::vector<std::string> formats = []()
+    {
+      std::vector<std::string> formats;
       const auto& plugins = load_handler_plugins();
       for (auto plugin: plugins)
       {
@@ -266,7 +292,8 @@ namespace io
           }
         }
       }
-    }
+      return formats;
+    }();
     return formats;
   };
   
@@ -0,0 +1,304 @@
+/* 
+ * Open Source Movement Analysis Library
+ * Copyright (C) 2016, Moveck Solution Inc., all rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 
+ *     * Redistributions of source code must retain the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer.
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials
+ *       provided with the distribution.
+ *     * Neither the name(s) of the copyright holders nor the names
+ *       of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written
+ *       permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "openma/io/prefetcher.h"
+#include "openma/io/file.h"
+
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <algorithm> // std::min, std::find_if
+
+// -------------------------------------------------------------------------- //
+//                                 PRIVATE API                                //
+// -------------------------------------------------------------------------- //
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+
+namespace ma
+{
+namespace io
+{
+  class PrefetcherPrivate
+  {
+  public:
+    struct Entry
+    {
+      std::string Path;
+      bool Prefetched;
+    };
+    
+    PrefetcherPrivate(size_t depth);
+    ~PrefetcherPrivate() _OPENMA_NOEXCEPT;
+    
+    void start();
+    void run();
+    size_t candidate() const _OPENMA_NOEXCEPT;
+    
+    mutable std::mutex Mutex;
+    std::condition_variable Queued; // Wake up the worker
+    std::condition_variable Completed; // Wake up the threads waiting for the prefetching
+    std::deque<Entry> Queue; // The first entry is the current file if any
+    size_t Depth;
+    size_t Prefetched;
+    bool Current;
+    bool Busy;
+    bool Stop;
+    std::thread Worker;
+  };
+  
+  PrefetcherPrivate::PrefetcherPrivate(size_t depth)
+  : Mutex(), Queued(), Completed(), Queue(), Depth(depth), Prefetched(0), Current(false), Busy(false), Stop(false), Worker()
+  {};
+  
+  PrefetcherPrivate::~PrefetcherPrivate() _OPENMA_NOEXCEPT
+  {
+    {
+      std::lock_guard<std::mutex> lock(this->Mutex);
+      this->Stop = true;
+    }
+    this->Queued.notify_all();
+    if (this->Worker.joinable())
+      this->Worker.join();
+  };
+  
+  /**
+   * Start the worker if not yet done. The mutex must be locked.
+   */
+  void PrefetcherPrivate::start()
+  {
+    if (!this->Worker.joinable())
+      this->Worker = std::thread(&PrefetcherPrivate::run, this);
+  };
+  
+  void PrefetcherPrivate::run()
+  {
+    std::unique_lock<std::mutex> lock(this->Mutex);
+    while (1)
+    {
+      size_t idx = 0;
+      this->Queued.wait(lock, [&]{return this->Stop || ((idx = this->candidate()) < this->Queue.size());});
+      if (this->Stop)
+        break;
+      const std::string path = this->Queue[idx].Path;
+      this->Queue[idx].Prefetched = true;
+      this->Busy = true;
+      lock.unlock();
+      File::prefetch(path.c_str());
+      lock.lock();
+      this->Busy = false;
+      ++this->Prefetched;
+      this->Completed.notify_all();
+    }
+  };
+  
+  /**
+   * Returns the index of the next file to prefetch (the current one and the next ones up to the depth). The size of the queue is returned if none is found. The mutex must be locked.
+   */
+  size_t PrefetcherPrivate::candidate() const _OPENMA_NOEXCEPT
+  {
+    const size_t num = std::min(this->Queue.size(), this->Depth + (this->Current ? 1 : 0));
+    for (size_t i = 0 ; i < num ; ++i)
+    {
+      if (!this->Queue[i].Prefetched)
+        return i;
+    }
+    return this->Queue.size();
+  };
+};
+};
+
+#endif
+
+// ------------------------------------------------------------------------- //
+//                                 PUBLIC API                                //
+// ------------------------------------------------------------------------- //
+
+namespace ma
+{
+namespace io
+{
+  /**
+   * @class Prefetcher openma/io/prefetcher.h
+   * @brief Load in advance the next files of a sequential pipeline.
+   *
+   * When several files are read one after the other (e.g. read a trial, process it, write the results, then go to the next one), the reading of each file has to wait for its content to be loaded from the storage.
+   * This class prepares the files in a background thread: the content of the next queued files is loaded by the operating system in its cache (see File::prefetch()) while the current one is processed.
+   * To bound the memory used and to not evict the content of useful files from the cache, only the current file and the next ones up to the given depth are prefetched.
+   *
+   * @code{.unparsed}
+   * ma::io::Prefetcher prefetcher;
+   * prefetcher.enqueue(filepaths);
+   * for (const auto& filepath : filepaths)
+   * {
+   *   ma::Node root("root");
+   *   // The given prefetcher is advanced to the read file. Meanwhile, the next files are loaded.
+   *   ma::io::read(&root, filepath, "", {}, &prefetcher);
+   *   // Processing...
+   * }
+   * @endcode
+   *
+   * @ingroup openma_io
+   */
+  
+  /**
+   * Constructor.
+   * The @a depth is the number of files prefetched after the current one.
+   * The background thread is started only when a first file is given.
+   */
+  Prefetcher::Prefetcher(size_t depth)
+  : mp_Pimpl(new PrefetcherPrivate(depth))
+  {};
+  
+  /**
+   * Destructor.
+   * The background thread is stopped. The file being prefetched (if any) is completed first.
+   */
+  Prefetcher::~Prefetcher() _OPENMA_NOEXCEPT = default;
+  
+  /**
+   * Returns the number of files prefetched after the current one.
+   */
+  size_t Prefetcher::depth() const _OPENMA_NOEXCEPT
+  {
+    auto optr = this->pimpl();
+    return optr->Depth;
+  };
+  
+  /**
+   * Sets the number of files prefetched after the current one.
+   */
+  void Prefetcher::setDepth(size_t depth)
+  {
+    auto optr = this->pimpl();
+    {
+      std::lock_guard<std::mutex> lock(optr->Mutex);
+      optr->Depth = depth;
+    }
+    optr->Queued.notify_all();
+  };
+  
+  /**
+   * Adds the given @a filepath at the end of the queue.
+   */
+  void Prefetcher::enqueue(const std::string& filepath)
+  {
+    this->enqueue(std::vector<std::string>{filepath});
+  };
+  
+  /**
+   * Adds the given @a filepaths at the end of the queue (in the same order).
+   */
+  void Prefetcher::enqueue(const std::vector<std::string>& filepaths)
+  {
+    auto optr = this->pimpl();
+    {
+      std::lock_guard<std::mutex> lock(optr->Mutex);
+      for (const auto& filepath : filepaths)
+        optr->Queue.push_back(PrefetcherPrivate::Entry{filepath, false});
+      optr->start();
+    }
+    optr->Queued.notify_all();
+  };
+  
+  /**
+   * Informs that the given @a filepath is going to be read.
+   * The previous current file and the files queued before @a filepath are removed from the queue. The next files are then prefetched.
+   * If @a filepath was not queued, it is added at the beginning of the queue and is prefetched first.
+   */
+  void Prefetcher::advance(const std::string& filepath)
+  {
+    auto optr = this->pimpl();
+    {
+      std::lock_guard<std::mutex> lock(optr->Mutex);
+      if (optr->Current && !optr->Queue.empty())
+        optr->Queue.pop_front();
+      auto it = std::find_if(optr->Queue.begin(), optr->Queue.end(), [&filepath](const PrefetcherPrivate::Entry& entry){return entry.Path == filepath;});
+      if (it != optr->Queue.end())
+        optr->Queue.erase(optr->Queue.begin(), it);
+      else
+        optr->Queue.push_front(PrefetcherPrivate::Entry{filepath, false});
+      optr->Current = true;
+      optr->start();
+    }
+    optr->Queued.notify_all();
+  };
+  
+  /**
+   * Removes all the queued files. The threads blocked in wait() are woken up as nothing remains to prefetch.
+   */
+  void Prefetcher::clear()
+  {
+    auto optr = this->pimpl();
+    {
+      std::lock_guard<std::mutex> lock(optr->Mutex);
+      optr->Queue.clear();
+      optr->Current = false;
+    }
+    optr->Queued.notify_all();
+    optr->Completed.notify_all();
+  };
+  
+  /**
+   * Blocks until the current file and the next ones (up to the depth) are prefetched.
+   */
+  void Prefetcher::wait()
+  {
+    auto optr = this->pimpl();
+    std::unique_lock<std::mutex> lock(optr->Mutex);
+    optr->Completed.wait(lock, [optr]{return !optr->Busy && (optr->candidate() == optr->Queue.size());});
+  };
+  
+  /**
+   * Returns the number of queued files, including the current one.
+   */
+  size_t Prefetcher::pending() const
+  {
+    auto optr = this->pimpl();
+    std::lock_guard<std::mutex> lock(optr->Mutex);
+    return optr->Queue.size();
+  };
+  
+  /**
+   * Returns the number of files prefetched since the creation of this object.
+   */
+  size_t Prefetcher::prefetched() const
+  {
+    auto optr = this->pimpl();
+    std::lock_guard<std::mutex> lock(optr->Mutex);
+    return optr->Prefetched;
+  };
+};
+};
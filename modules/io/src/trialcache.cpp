@@ -0,0 +1,575 @@
+/* 
+ * Open Source Movement Analysis Library
+ * Copyright (C) 2016, Moveck Solution Inc., all rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 
+ *     * Redistributions of source code must retain the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer.
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials
+ *       provided with the distribution.
+ *     * Neither the name(s) of the copyright holders nor the names
+ *       of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written
+ *       permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "openma/io/trialcache.h"
+#include "openma/io/file.h"
+#include "openma/io/enums.h"
+#include "openma/io/handlerreader.h"
+#include "openma/io/handlerwriter.h"
+#include "openma/io.h"
+#include "openma/base/node.h"
+#include "openma/base/logger.h"
+
+#include <mutex>
+#include <random>
+#include <vector>
+#include <algorithm> // std::sort
+#include <cstdio> // std::rename, std::remove, std::snprintf
+#include <cstring> // memcpy
+#include <sys/stat.h>
+
+#define _OPENMA_IO_TRIALCACHE_FORMAT "openma.snap"
+
+// -------------------------------------------------------------------------- //
+//                                 PRIVATE API                                //
+// -------------------------------------------------------------------------- //
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+
+namespace ma
+{
+namespace io
+{
+  _OPENMA_CONSTEXPR uint64_t _trialcache_fnv_offset = 14695981039346656037ull;
+  _OPENMA_CONSTEXPR uint64_t _trialcache_fnv_prime = 1099511628211ull;
+  _OPENMA_CONSTEXPR uint64_t _trialcache_prime1 = 11400714785074694791ull;
+  _OPENMA_CONSTEXPR uint64_t _trialcache_prime2 = 14029467366897019727ull;
+  
+  // FNV-1a hash used to combine the small elements of a key
+  static inline uint64_t _ma_io_trialcache_hash(uint64_t hash, const void* data, size_t size)
+  {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0 ; i < size ; ++i)
+      hash = (hash ^ bytes[i]) * _trialcache_fnv_prime;
+    return hash;
+  };
+  
+  template <typename T>
+  static inline uint64_t _ma_io_trialcache_hash(uint64_t hash, T value)
+  {
+    return _ma_io_trialcache_hash(hash, &value, sizeof(T));
+  };
+  
+  static inline uint64_t _ma_io_trialcache_hash(uint64_t hash, const std::string& value)
+  {
+    hash = _ma_io_trialcache_hash(hash, static_cast<uint64_t>(value.size()));
+    return _ma_io_trialcache_hash(hash, value.data(), value.size());
+  };
+  
+  /*
+   * Hash of a set of options (or parameters) independent of the order of the keys.
+   * Only the strings and the arithmetic values (compared as double) can be hashed. False is returned for any other type of value.
+   */
+  static bool _ma_io_trialcache_hash(uint64_t* hash, const std::unordered_map<std::string,Any>& options)
+  {
+    std::vector<const std::pair<const std::string,Any>*> sorted;
+    sorted.reserve(options.size());
+    for (const auto& option : options)
+      sorted.push_back(&option);
+    std::sort(sorted.begin(), sorted.end(), [](const std::pair<const std::string,Any>* lhs, const std::pair<const std::string,Any>* rhs){return lhs->first < rhs->first;});
+    uint64_t h = _ma_io_trialcache_hash(*hash, static_cast<uint64_t>(sorted.size()));
+    for (const auto option : sorted)
+    {
+      const Any& value = option->second;
+      h = _ma_io_trialcache_hash(h, option->first);
+      if (!value.isValid())
+      {
+        h = _ma_io_trialcache_hash(h, static_cast<uint8_t>(0));
+        continue;
+      }
+      const auto dimensions = value.dimensions();
+      if (value.isString())
+      {
+        h = _ma_io_trialcache_hash(h, static_cast<uint8_t>(1));
+        for (const auto& str : value.cast<std::vector<std::string>>())
+          h = _ma_io_trialcache_hash(h, str);
+      }
+      else if (value.isArithmetic())
+      {
+        h = _ma_io_trialcache_hash(h, static_cast<uint8_t>(2));
+        const auto values = value.cast<std::vector<double>>();
+        h = _ma_io_trialcache_hash(h, static_cast<uint64_t>(values.size()));
+        h = _ma_io_trialcache_hash(h, values.data(), values.size() * sizeof(double));
+      }
+      else
+        return false;
+      h = _ma_io_trialcache_hash(h, static_cast<uint64_t>(dimensions.size()));
+      h = _ma_io_trialcache_hash(h, dimensions.data(), dimensions.size() * sizeof(unsigned));
+    }
+    *hash = h;
+    return true;
+  };
+  
+  /*
+   * Hash of the content of a file.
+   * The content is processed by words of 8 bytes in four independent lanes (using the round of the xxHash64 algorithm) to not be slower than the reading of the file. The lanes are combined at the end with the size of the content.
+   */
+  struct TrialCacheDigest
+  {
+    uint64_t Lanes[4] = {_trialcache_fnv_offset, _trialcache_fnv_offset + _trialcache_prime1, _trialcache_fnv_offset + _trialcache_prime2, _trialcache_fnv_offset - _trialcache_prime1};
+    uint64_t Size = 0;
+    
+    // The size of the given data must be a multiple of 32 bytes, except for the last call.
+    void update(const char* data, size_t size)
+    {
+      size_t i = 0;
+      for ( ; (i + 32) <= size ; i += 32)
+      {
+        for (size_t l = 0 ; l < 4 ; ++l)
+        {
+          uint64_t word;
+          memcpy(&word, data + i + 8 * l, 8);
+          const uint64_t acc = this->Lanes[l] + word * _trialcache_prime2;
+          this->Lanes[l] = ((acc << 31) | (acc >> 33)) * _trialcache_prime1;
+        }
+      }
+      this->Lanes[0] = _ma_io_trialcache_hash(this->Lanes[0], data + i, size - i);
+      this->Size += size;
+    };
+    
+    uint64_t digest() const
+    {
+      return _ma_io_trialcache_hash(_ma_io_trialcache_hash(_trialcache_fnv_offset, this->Lanes, sizeof(this->Lanes)), this->Size);
+    };
+  };
+  
+  static bool _ma_io_trialcache_hash_content(const std::string& filepath, uint64_t* hash)
+  {
+    File file;
+    file.open(filepath.c_str(), Mode::In);
+    if (!file.isOpen())
+      return false;
+    TrialCacheDigest digest;
+    const size_t size = static_cast<size_t>(file.size());
+    // Zero-copy when the file is memory mapped
+    const char* data = file.data();
+    if (data != nullptr)
+      digest.update(data, size);
+    else
+    {
+      std::vector<char> block(1 << 20);
+      for (size_t first = 0 ; first < size ; first += block.size())
+      {
+        const size_t num = std::min(block.size(), size - first);
+        file.read(block.data(), static_cast<Device::Size>(num));
+        if (file.hasFailure() || file.hasError())
+          return false;
+        digest.update(block.data(), num);
+      }
+    }
+    file.close();
+    *hash = digest.digest();
+    return true;
+  };
+  
+  class TrialCachePrivate
+  {
+  public:
+    // Key of the content of a root node and its timestamp when the key was computed
+    struct State
+    {
+      uint64_t Key;
+      unsigned long Timestamp;
+    };
+    
+    TrialCachePrivate(const std::string& directory);
+    ~TrialCachePrivate() _OPENMA_NOEXCEPT;
+    
+    bool identify(const std::string& filepath, const std::string& format, const std::unordered_map<std::string,Any>& options, uint64_t* key) const;
+    std::string entry(uint64_t key) const;
+    bool load(uint64_t key, Node* output) const;
+    bool store(uint64_t key, const Node* input) const;
+    bool state(const Node* root, uint64_t* key) const;
+    void track(const Node* root, uint64_t key);
+    void forget(const Node* root);
+    
+    mutable std::mutex Mutex;
+    std::string Directory;
+    std::unordered_map<const Node*,State> States;
+    size_t Hits;
+    size_t Misses;
+  };
+  
+  TrialCachePrivate::TrialCachePrivate(const std::string& directory)
+  : Mutex(), Directory(directory), States(), Hits(0), Misses(0)
+  {
+    if (this->Directory.empty())
+      this->Directory = ".";
+  };
+  
+  TrialCachePrivate::~TrialCachePrivate() _OPENMA_NOEXCEPT = default;
+  
+  /**
+   * Compute the key of the reading of the given file. The key is based on its path, size, modification time, and the hash of its content, as well as on the format and the options given to the reader.
+   * The content is hashed each time. The modification time has a coarse resolution and cannot guarantee alone that a file was not rewritten.
+   * Returns false if the file cannot be read or if an option cannot be hashed.
+   */
+  bool TrialCachePrivate::identify(const std::string& filepath, const std::string& format, const std::unordered_map<std::string,Any>& options, uint64_t* key) const
+  {
+    struct stat status;
+    if (stat(filepath.c_str(), &status) != 0)
+      return false;
+    const int64_t size = static_cast<int64_t>(status.st_size), time = static_cast<int64_t>(status.st_mtime);
+    uint64_t content = 0;
+    if (!_ma_io_trialcache_hash_content(filepath, &content))
+      return false;
+    uint64_t h = _ma_io_trialcache_hash(_trialcache_fnv_offset, std::string("read"));
+    h = _ma_io_trialcache_hash(h, filepath);
+    h = _ma_io_trialcache_hash(h, size);
+    h = _ma_io_trialcache_hash(h, time);
+    h = _ma_io_trialcache_hash(h, content);
+    h = _ma_io_trialcache_hash(h, format);
+    if (!_ma_io_trialcache_hash(&h, options))
+      return false;
+    *key = h;
+    return true;
+  };
+  
+  /**
+   * Returns the path of the snapshot associated with the given @a key.
+   */
+  std::string TrialCachePrivate::entry(uint64_t key) const
+  {
+    char name[24];
+    std::snprintf(name, sizeof(name), "%016llx.snap", static_cast<unsigned long long>(key));
+    return this->Directory + "/" + name;
+  };
+  
+  /**
+   * Restores the nodes stored in the snapshot associated with the given @a key.
+   * A snapshot which cannot be read is removed from the cache.
+   */
+  bool TrialCachePrivate::load(uint64_t key, Node* output) const
+  {
+    const std::string filepath = this->entry(key);
+    if (!File::exists(filepath.c_str()))
+      return false;
+    File file;
+    file.open(filepath.c_str(), Mode::In);
+    HandlerReader reader(&file, _OPENMA_IO_TRIALCACHE_FORMAT);
+    const bool result = reader.read(output);
+    file.close();
+    if (!result)
+    {
+      warning("The cached entry '%s' cannot be read and is removed: %s", filepath.c_str(), reader.errorMessage().c_str());
+      std::remove(filepath.c_str());
+    }
+    return result;
+  };
+  
+  /**
+   * Stores the content of the @a input node in the snapshot associated with the given @a key.
+   * The snapshot is first written in a temporary file renamed once complete. Then, a snapshot is never partially read, even if several processes share the same cache.
+   * Returns false if the snapshot cannot be created. This is the case when the snapshot cannot represent exactly the content of @a input (e.g. a node type not registered in the snapshot format or an unsupported property). A failure only results in a warning.
+   */
+  bool TrialCachePrivate::store(uint64_t key, const Node* input) const
+  {
+    const std::string filepath = this->entry(key);
+    const std::string temporary = filepath + "." + std::to_string(std::random_device{}()) + ".tmp";
+    File file;
+    file.open(temporary.c_str(), Mode::Out);
+    HandlerWriter writer(&file, _OPENMA_IO_TRIALCACHE_FORMAT);
+    bool result = writer.write(input);
+    file.close();
+    if (result)
+    {
+      if (std::rename(temporary.c_str(), filepath.c_str()) != 0)
+      {
+        warning("The cached entry '%s' cannot be created.", filepath.c_str());
+        std::remove(temporary.c_str());
+        result = false;
+      }
+    }
+    else
+    {
+      warning("The cached entry '%s' cannot be written: %s", filepath.c_str(), writer.errorMessage().c_str());
+      std::remove(temporary.c_str());
+    }
+    return result;
+  };
+  
+  /**
+   * Returns true if the @a root node is tracked and was not modified since. Its key is then set in @a key.
+   */
+  bool TrialCachePrivate::state(const Node* root, uint64_t* key) const
+  {
+    std::lock_guard<std::mutex> lock(this->Mutex);
+    auto it = this->States.find(root);
+    if ((it == this->States.end()) || (it->second.Timestamp != root->timestamp()))
+      return false;
+    *key = it->second.Key;
+    return true;
+  };
+  
+  void TrialCachePrivate::track(const Node* root, uint64_t key)
+  {
+    std::lock_guard<std::mutex> lock(this->Mutex);
+    this->States[root] = State{key, root->timestamp()};
+  };
+  
+  void TrialCachePrivate::forget(const Node* root)
+  {
+    std::lock_guard<std::mutex> lock(this->Mutex);
+    this->States.erase(root);
+  };
+};
+};
+
+#endif
+
+// ------------------------------------------------------------------------- //
+//                                 PUBLIC API                                //
+// ------------------------------------------------------------------------- //
+
+namespace ma
+{
+namespace io
+{
+  /**
+   * @class TrialCache openma/io/trialcache.h
+   * @brief On-disk cache of the reading and processing of trials.
+   *
+   * A batch tool often runs the same steps (reading, filtering, reconstruction, ...) on unchanged inputs. This class stores the result of each step in a directory and restores it when the same step is applied on the same input.
+   *  - The key of a read file is based on its path, size, modification time, and the hash of its content, as well as on the format and the options given to the reader.
+   *  - The key of a processing step is based on the key of its input, the name of the step and the hash of its parameters.
+   *
+   * The results are stored in the OpenMA snapshot format (format "openma.snap") which is restored without decoding.
+   * The key of the content of each root node given to the cache is tracked with the timestamp of the node (see Object::timestamp()). If the node is modified outside of the cache, its content is unknown and the next steps are run without cache, until a new file is read in an empty node.
+   *
+   * @code{.unparsed}
+   * ma::io::TrialCache cache("/tmp/openma_cache");
+   * ma::Node root("root");
+   * cache.read(&root, filepath);
+   * cache.process(&root, "lowpass", {{"cutoff", 6.0}}, [](ma::Node* root) {
+   *   // Filtering of the time sequences stored in root...
+   *   return true;
+   * });
+   * @endcode
+   *
+   * @warning The modifications made directly in the samples of a time sequence (see TimeSequence::data()) do not update its timestamp. The method Node::modified() must be called to invalidate the tracked content.
+   * @warning The directory is not created and the cached entries are never removed automatically.
+   *
+   * @ingroup openma_io
+   */
+  
+  /**
+   * Constructor.
+   * The snapshots are stored in the given @a directory. It must exist. By default (empty string), the current directory is used.
+   */
+  TrialCache::TrialCache(const std::string& directory)
+  : mp_Pimpl(new TrialCachePrivate(directory))
+  {};
+  
+  /**
+   * Destructor (default).
+   */
+  TrialCache::~TrialCache() _OPENMA_NOEXCEPT = default;
+  
+  /**
+   * Returns the directory where the snapshots are stored.
+   */
+  const std::string& TrialCache::directory() const _OPENMA_NOEXCEPT
+  {
+    auto optr = this->pimpl();
+    return optr->Directory;
+  };
+  
+  /**
+   * Reads the file @a filepath and adds its content to @a root (see ma::io::read()).
+   * If the same file (with the same @a format and @a options) was already read, its content is restored from the cache. Otherwise, the file is read and its content is stored in the cache.
+   * If @a root was empty or tracked and not modified since, its new content is tracked. Otherwise, it is not tracked anymore.
+   * If the file cannot be identified (e.g. it does not exist) or if an option is neither a string nor an arithmetic value, the file is read without cache.
+   * If its content cannot be stored exactly in a snapshot (see register_snapshot_node_type()), nothing is cached and @a root is not tracked anymore.
+   */
+  bool TrialCache::read(Node* root, const std::string& filepath, const std::string& format, const std::unordered_map<std::string, Any>& options)
+  {
+    auto optr = this->pimpl();
+    if (root == nullptr)
+      return false;
+    uint64_t key = 0;
+    if (!optr->identify(filepath, format, options, &key))
+    {
+      optr->forget(root);
+      return ma::io::read(root, filepath, format, options);
+    }
+    // Key of the content already stored in the root (if any)
+    uint64_t previous = 0;
+    const bool empty = !root->hasChildren() && root->dynamicProperties(false).empty() && root->deferredProperties().empty();
+    const bool chained = empty || optr->state(root, &previous);
+    // The content of the file is read apart to store only this one
+    Node staging("staging");
+    const bool hit = optr->load(key, &staging);
+    bool stored = hit;
+    if (!hit)
+    {
+      if (!ma::io::read(&staging, filepath, format, options))
+      {
+        optr->forget(root);
+        return false;
+      }
+      stored = optr->store(key, &staging);
+    }
+    for (auto child : std::vector<Node*>(staging.children()))
+    {
+      child->addParent(root);
+      child->removeParent(&staging);
+    }
+    {
+      std::lock_guard<std::mutex> lock(optr->Mutex);
+      ++(hit ? optr->Hits : optr->Misses);
+    }
+    if (!chained || !stored)
+      optr->forget(root);
+    else if (empty)
+      optr->track(root, key);
+    else
+      optr->track(root, _ma_io_trialcache_hash(_ma_io_trialcache_hash(_trialcache_fnv_offset, previous), key));
+    return true;
+  };
+  
+  /**
+   * Applies the processing @a step on the content of @a root using the function @a fn.
+   * If @a root is tracked and was not modified since, the key of the step is computed from the key of its content, the name of the @a step and the given @a parameters. When the same step was already applied on the same content, the content of @a root is replaced by the cached result and @a fn is not called. Otherwise, @a fn is called and the result is stored in the cache.
+   * The @a parameters must describe everything influencing the result of @a fn. They are only used to compute the key and only strings and arithmetic values can be hashed.
+   * If @a root is not tracked (or was modified) or if a parameter cannot be hashed, @a fn is called without cache and @a root is not tracked anymore.
+   * The function @a fn must return false in case of failure. In this case, nothing is cached and false is returned.
+   * If the result cannot be stored exactly in a snapshot (e.g. @a fn created a node type not registered with register_snapshot_node_type()), nothing is cached and @a root is not tracked anymore. The result of @a fn is kept and true is returned.
+   */
+  bool TrialCache::process(Node* root, const std::string& step, const std::unordered_map<std::string, Any>& parameters, const std::function<bool(Node*)>& fn)
+  {
+    auto optr = this->pimpl();
+    if ((root == nullptr) || !fn)
+      return false;
+    uint64_t input = 0;
+    const bool tracked = optr->state(root, &input);
+    uint64_t key = _ma_io_trialcache_hash(_trialcache_fnv_offset, std::string("process"));
+    key = _ma_io_trialcache_hash(key, input);
+    key = _ma_io_trialcache_hash(key, step);
+    if (!tracked || !_ma_io_trialcache_hash(&key, parameters))
+    {
+      optr->forget(root);
+      return fn(root);
+    }
+    Node staging("staging");
+    if (optr->load(key, &staging))
+    {
+      // The content of the root is replaced by the cached one
+      for (auto child : std::vector<Node*>(root->children()))
+      {
+        child->removeParent(root);
+#if defined(USE_REFCOUNT_MECHANISM)
+        if (!child->hasParents() && (child->refcount() < 1))
+#else
+        if (!child->hasParents())
+#endif
+          delete child;
+      }
+      std::vector<std::string> keys;
+      for (const auto& property : root->dynamicProperties(false))
+        keys.push_back(property.first);
+      for (const auto& property : root->deferredProperties())
+        keys.push_back(property.first);
+      for (const auto& k : keys)
+        root->setProperty(k, Any());
+      for (const auto& property : staging.dynamicProperties())
+        root->setProperty(property.first, property.second);
+      for (auto child : std::vector<Node*>(staging.children()))
+      {
+        child->addParent(root);
+        child->removeParent(&staging);
+      }
+      {
+        std::lock_guard<std::mutex> lock(optr->Mutex);
+        ++optr->Hits;
+      }
+      optr->track(root, key);
+      return true;
+    }
+    {
+      std::lock_guard<std::mutex> lock(optr->Mutex);
+      ++optr->Misses;
+    }
+    if (!fn(root))
+    {
+      optr->forget(root);
+      return false;
+    }
+    if (optr->store(key, root))
+      optr->track(root, key);
+    else
+      optr->forget(root);
+    return true;
+  };
+  
+  /**
+   * Returns true if the content of @a root is known by the cache (i.e. it was read or processed by the cache and not modified since).
+   */
+  bool TrialCache::isTracked(const Node* root) const
+  {
+    auto optr = this->pimpl();
+    uint64_t key = 0;
+    return (root != nullptr) && optr->state(root, &key);
+  };
+  
+  /**
+   * Stops to track the content of @a root.
+   * The tracked nodes are identified by their address. This method can be called before to delete a tracked node to release the memory used to track it.
+   */
+  void TrialCache::forget(const Node* root)
+  {
+    auto optr = this->pimpl();
+    optr->forget(root);
+  };
+  
+  /**
+   * Returns the number of reading and processing steps restored from the cache since the creation of this object.
+   */
+  size_t TrialCache::hits() const
+  {
+    auto optr = this->pimpl();
+    std::lock_guard<std::mutex> lock(optr->Mutex);
+    return optr->Hits;
+  };
+  
+  /**
+   * Returns the number of reading and processing steps which were not found in the cache since the creation of this object.
+   */
+  size_t TrialCache::misses() const
+  {
+    auto optr = this->pimpl();
+    std::lock_guard<std::mutex> lock(optr->Mutex);
+    return optr->Misses;
+  };
+};
+};
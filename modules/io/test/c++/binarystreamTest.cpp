@@ -3,6 +3,7 @@
 #include "binarystreamTest_def.h"
 
 #include <openma/io/binarystream.h>
+#include <openma/io/buffer.h>
 #include <openma/io/enums.h>
 
 CXXTEST_SUITE(BinaryStreamTest)
@@ -80,10 +81,54 @@ CXXTEST_SUITE(BinaryStreamTest)
     TS_ASSERT_EQUALS(bs.readU8(), (uint8_t)25);
     TS_ASSERT_EQUALS(bs.readString(25), "* Point data scale factor");
   }
+  
+  CXXTEST_TEST(readBulk)
+  {
+    char data[132] = {0};
+    for (int i = 0 ; i < 132 ; ++i)
+      data[i] = static_cast<char>((i * 37 + 11) % 256);
+    data[4] = 0x00; data[5] = 0x00; // Null bytes to test the VAX exponent adaptation
+    const ma::io::ByteOrder orders[3] = {ma::io::ByteOrder::IEEELittleEndian, ma::io::ByteOrder::IEEEBigEndian, ma::io::ByteOrder::VAXLittleEndian};
+    for (const auto order : orders)
+    {
+      // The bulk methods are tested with a device read by copy (DummyBuffer) and with a device giving a direct access to its content (Buffer)
+      for (int direct = 0 ; direct < 2 ; ++direct)
+      {
+        DummyBuffer single(data), copied(data);
+        ma::io::Buffer mapped;
+        mapped.open(data, 132);
+        ma::io::BinaryStream bss(&single, order), bsb(direct ? static_cast<ma::io::Device*>(&mapped) : static_cast<ma::io::Device*>(&copied), order);
+        int16_t i16[8]; uint16_t u16[8]; int32_t i32[4]; uint32_t u32[4]; int64_t i64[2]; uint64_t u64[2]; float f[4]; double d[2]; char c[4];
+        bsb.readI16(8, i16);
+        for (int i = 0 ; i < 8 ; ++i) TS_ASSERT_EQUALS(i16[i], bss.readI16());
+        bsb.readU16(8, u16);
+        for (int i = 0 ; i < 8 ; ++i) TS_ASSERT_EQUALS(u16[i], bss.readU16());
+        bsb.readI32(4, i32);
+        for (int i = 0 ; i < 4 ; ++i) TS_ASSERT_EQUALS(i32[i], bss.readI32());
+        bsb.readU32(4, u32);
+        for (int i = 0 ; i < 4 ; ++i) TS_ASSERT_EQUALS(u32[i], bss.readU32());
+        bsb.readI64(2, i64);
+        for (int i = 0 ; i < 2 ; ++i) TS_ASSERT_EQUALS(i64[i], bss.readI64());
+        bsb.readU64(2, u64);
+        for (int i = 0 ; i < 2 ; ++i) TS_ASSERT_EQUALS(u64[i], bss.readU64());
+        bsb.readChar(4, c);
+        for (int i = 0 ; i < 4 ; ++i) TS_ASSERT_EQUALS(c[i], bss.readChar());
+        // Floating values are compared bitwise (NaN)
+        bsb.readFloat(4, f);
+        for (int i = 0 ; i < 4 ; ++i) {float v = bss.readFloat(); TS_ASSERT_EQUALS(memcmp(&v, f + i, 4), 0);}
+        bsb.readDouble(2, d);
+        for (int i = 0 ; i < 2 ; ++i) {double v = bss.readDouble(); TS_ASSERT_EQUALS(memcmp(&v, d + i, 8), 0);}
+      }
+      // The content given to the buffer must not be modified by the conversion
+      TS_ASSERT_EQUALS(data[4], 0x00);
+      TS_ASSERT_EQUALS(data[6], static_cast<char>((6 * 37 + 11) % 256));
+    }
+  };
 };
 
 CXXTEST_SUITE_REGISTRATION(BinaryStreamTest)
 CXXTEST_TEST_REGISTRATION(BinaryStreamTest, readIeeeLittleEndian)
 CXXTEST_TEST_REGISTRATION(BinaryStreamTest, readIeeeBigEndian)
 CXXTEST_TEST_REGISTRATION(BinaryStreamTest, readVaxLittleEndian)
-CXXTEST_TEST_REGISTRATION(BinaryStreamTest, writeReadNative)
\ No newline at end of file
+CXXTEST_TEST_REGISTRATION(BinaryStreamTest, writeReadNative)
+CXXTEST_TEST_REGISTRATION(BinaryStreamTest, readBulk)
\ No newline at end of file
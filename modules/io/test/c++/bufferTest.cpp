@@ -46,6 +46,49 @@ CXXTEST_SUITE(BufferTest)
     TS_ASSERT_THROWS_EQUALS(buffer.read(test,20), const ma::io::Buffer::Failure &f, f.what(), std::string("ma::io::Device::clear"));
   };
   
+  CXXTEST_TEST(continousBufferConsume)
+  {
+    const auto array = int2char<41>({{0xFB, 0x01, 0x53, 0x43, 0x41, 0x4C, 0x45, 0x22, 0x00, 0x04, 0x00, 0xAB, 0xAA, 0xAA, 0x3D, 0x19, 0x2A, 0x20, 0x50, 0x6F, 0x69, 0x6E, 0x74, 0x20, 0x64, 0x61, 0x74, 0x61, 0x20, 0x73, 0x63, 0x61, 0x6C, 0x65, 0x20, 0x66, 0x61, 0x63, 0x74, 0x6F, 0x72}});
+    ma::io::Buffer buffer;
+    buffer.open(array.data(), array.size());
+    const char* test = buffer.consume(20);
+    TS_ASSERT_EQUALS(test, array.data());
+    TS_ASSERT_EQUALS(buffer.tell(), 20);
+    test = buffer.consume(20);
+    TS_ASSERT_EQUALS(test, array.data() + 20);
+    TS_ASSERT(buffer.isGood());
+    TS_ASSERT_EQUALS(buffer.consume(20), nullptr); // Only one element remains
+    TS_ASSERT(!buffer.hasError());
+    TS_ASSERT(buffer.hasFailure());
+    TS_ASSERT(buffer.atEnd());
+  };
+  
+  CXXTEST_TEST(chunkBufferConsume)
+  {
+    auto array = int2char<50>(
+      {{0x69, 0x6E, 0x74, 0x20, 0x64, 0x61, 0x74, 0x61, 0x20, 0x73,    // #2
+        0x72, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,    // #4
+        0xFB, 0x01, 0x53, 0x43, 0x41, 0x4C, 0x45, 0x22, 0x00, 0x04,    // #0 
+        0x63, 0x61, 0x6C, 0x65, 0x20, 0x66, 0x61, 0x63, 0x74, 0x6F,    // #3
+        0x00, 0xAB, 0xAA, 0xAA, 0x3D, 0x19, 0x2A, 0x20, 0x50, 0x6F}}); // #1
+    std::vector<size_t> chunkIds({2,4,0,3,1});
+    ma::io::Buffer buffer;
+    buffer.open(array.data(), array.size(), chunkIds, 10, ma::io::Mode::In);
+    const char* test = buffer.consume(10); // Chunk #0
+    TS_ASSERT_EQUALS(test, array.data() + 20);
+    test = buffer.consume(4); // Chunk #1
+    TS_ASSERT_EQUALS(test, array.data() + 40);
+    test = buffer.consume(10); // Across the chunks #1 and #2
+    TS_ASSERT_EQUALS(test, nullptr);
+    TS_ASSERT(buffer.isGood());
+    TS_ASSERT_EQUALS(buffer.tell(), 14);
+    char ref[10] = {0};
+    buffer.read(ref, 10);
+    TS_ASSERT_EQUALS(ref[5], 0x6F);
+    TS_ASSERT_EQUALS(ref[6], 0x69);
+    TS_ASSERT(buffer.isGood());
+  };
+  
   CXXTEST_TEST(chunkBuffer)
   {
     auto array = int2char<50>(
@@ -138,11 +181,118 @@ CXXTEST_SUITE(BufferTest)
     TS_ASSERT(!buffer.hasFailure());
     TS_ASSERT(!buffer.atEnd());
   };
+  
+  CXXTEST_TEST(chunkBufferWriteSpan)
+  {
+    char data[50] = {0};
+    std::vector<size_t> chunkIds({2,4,0,3,1});
+    ma::io::Buffer buffer;
+    buffer.open(data, 50, chunkIds, 10, ma::io::Mode::Out);
+    char values[50];
+    for (int i = 0 ; i < 50 ; ++i)
+      values[i] = static_cast<char>(i);
+    buffer.seek(5, ma::io::Origin::Begin);
+    buffer.write(values, 25); // Across the chunks #0, #1 and #2
+    TS_ASSERT_EQUALS(buffer.tell(), 30);
+    for (int i = 0 ; i < 5 ; ++i)
+      TS_ASSERT_EQUALS(data[25+i], values[i]);
+    for (int i = 0 ; i < 10 ; ++i)
+      TS_ASSERT_EQUALS(data[40+i], values[5+i]);
+    for (int i = 0 ; i < 10 ; ++i)
+      TS_ASSERT_EQUALS(data[i], values[15+i]);
+    TS_ASSERT(buffer.isGood());
+    // The buffer does not own the data and cannot grow
+    buffer.write(values, 25);
+    TS_ASSERT(buffer.hasError());
+    TS_ASSERT_EQUALS(buffer.size(), 50);
+    TS_ASSERT_EQUALS(buffer.release(), nullptr);
+  };
+  
+  CXXTEST_TEST(growableBuffer)
+  {
+    ma::io::Buffer buffer;
+    buffer.open(ma::io::Mode::In | ma::io::Mode::Out, 16);
+    TS_ASSERT_EQUALS(buffer.isOpen(), true);
+    TS_ASSERT_EQUALS(buffer.size(), 0);
+    TS_ASSERT_EQUALS(buffer.capacity(), 16);
+    std::array<char,10> values;
+    for (int i = 0 ; i < 10 ; ++i)
+      values[i] = static_cast<char>(i + 1);
+    for (int i = 0 ; i < 10 ; ++i)
+      buffer.write(values.data(), values.size());
+    TS_ASSERT(buffer.isGood());
+    TS_ASSERT_EQUALS(buffer.size(), 100);
+    TS_ASSERT_EQUALS(buffer.capacity(), 128); // Geometric growth: 16, 32, 64, 128
+    // Writing after the end fills the gap with zeros
+    buffer.seek(10, ma::io::Origin::End);
+    buffer.write(values.data(), 5);
+    TS_ASSERT_EQUALS(buffer.size(), 115);
+    // Overwriting does not modify the size
+    buffer.seek(0, ma::io::Origin::Begin);
+    char c = 42;
+    buffer.write(&c, 1);
+    TS_ASSERT_EQUALS(buffer.size(), 115);
+    char test[20] = {0};
+    buffer.seek(95, ma::io::Origin::Begin);
+    buffer.read(test, 20);
+    TS_ASSERT(buffer.isGood());
+    for (int i = 0 ; i < 5 ; ++i)
+      TS_ASSERT_EQUALS(test[i], values[5+i]);
+    for (int i = 5 ; i < 15 ; ++i)
+      TS_ASSERT_EQUALS(test[i], 0);
+    for (int i = 15 ; i < 20 ; ++i)
+      TS_ASSERT_EQUALS(test[i], values[i-15]);
+    // The final data are given without copy
+    const char* data = buffer.data();
+    ma::io::Buffer::Size size = 0;
+    char* released = buffer.release(&size);
+    TS_ASSERT_EQUALS(released, data);
+    TS_ASSERT_EQUALS(size, 115);
+    TS_ASSERT_EQUALS(released[0], 42);
+    TS_ASSERT_EQUALS(released[1], 2);
+    TS_ASSERT_EQUALS(buffer.isOpen(), false);
+    delete[] released;
+  };
+  
+  CXXTEST_TEST(rechunkBuffer)
+  {
+    ma::io::Buffer buffer;
+    buffer.open(ma::io::Mode::In | ma::io::Mode::Out, 64);
+    char values[50];
+    for (int i = 0 ; i < 50 ; ++i)
+      values[i] = static_cast<char>(i);
+    buffer.write(values, 50);
+    TS_ASSERT(buffer.isGood());
+    // The contiguous data are now read by chunks
+    std::vector<size_t> chunkIds({2,4,0,3,1});
+    buffer.setChunks(chunkIds, 10);
+    TS_ASSERT_EQUALS(buffer.tell(), 0);
+    char test[50] = {0};
+    buffer.read(test, 50);
+    TS_ASSERT(buffer.isGood());
+    for (int i = 0 ; i < 50 ; ++i)
+      TS_ASSERT_EQUALS(test[i], values[chunkIds[i / 10] * 10 + i % 10]);
+    buffer.seek(15, ma::io::Origin::Begin);
+    buffer.read(test, 10); // Across the chunks #1 and #2
+    for (int i = 0 ; i < 10 ; ++i)
+      TS_ASSERT_EQUALS(test[i], values[chunkIds[(15 + i) / 10] * 10 + (15 + i) % 10]);
+    // The chunked buffer cannot grow and its data cannot be released
+    buffer.seek(0, ma::io::Origin::End);
+    buffer.write(values, 10);
+    TS_ASSERT(buffer.hasError());
+    TS_ASSERT_EQUALS(buffer.size(), 50);
+    TS_ASSERT_EQUALS(buffer.release(), nullptr);
+  };
 };
 
 CXXTEST_SUITE_REGISTRATION(BufferTest)
 CXXTEST_TEST_REGISTRATION(BufferTest, continousBuffer)
 CXXTEST_TEST_REGISTRATION(BufferTest, continousBufferEndException)
+CXXTEST_TEST_REGISTRATION(BufferTest, continousBufferConsume)
+CXXTEST_TEST_REGISTRATION(BufferTest, chunkBufferConsume)
 CXXTEST_TEST_REGISTRATION(BufferTest, chunkBuffer)
 CXXTEST_TEST_REGISTRATION(BufferTest, chunkBufferSeek)
 CXXTEST_TEST_REGISTRATION(BufferTest, chunkBufferWrite)
+CXXTEST_TEST_REGISTRATION(BufferTest, chunkBufferWriteSpan)
+CXXTEST_TEST_REGISTRATION(BufferTest, growableBuffer)
+CXXTEST_TEST_REGISTRATION(BufferTest, rechunkBuffer)
\ No newline at end of file
@@ -208,6 +208,34 @@ CXXTEST_SUITE(FileTest)
     TS_ASSERT_EQUALS(file.hasFailure(), false);
   };
   
+  CXXTEST_TEST(consume)
+  {
+    const char* filename = OPENMA_TDD_PATH_OUT("c3d/mmfstream.c3d");
+    std::remove(filename);
+    ma::io::File file;
+    file.open(filename, ma::io::Mode::Out);
+    const char content[4] = {0x02, 0x50, 0x16, 0x17};
+    file.write(content,4);
+    file.close();
+    file.open(filename, ma::io::Mode::In);
+    file.advise(ma::io::Advice::Sequential, 0, -1);
+    const char* buf = file.consume(2);
+    TS_ASSERT_EQUALS(buf, file.data());
+    TS_ASSERT_EQUALS(file.tell(), 2);
+    buf = file.consume(2);
+    TS_ASSERT_EQUALS(buf, file.data() + 2);
+    TS_ASSERT_EQUALS(file.isGood(), true);
+    if (buf != nullptr)
+    {
+      TS_ASSERT_EQUALS(buf[0], 0x16);
+      TS_ASSERT_EQUALS(buf[1], 0x17);
+    }
+    TS_ASSERT_EQUALS(file.consume(1), nullptr);
+    TS_ASSERT_EQUALS(file.atEnd(), true);
+    TS_ASSERT_EQUALS(file.hasFailure(), true);
+    file.close();
+  };
+  
   CXXTEST_TEST(readNoFile)
   {
     ma::io::File file;
@@ -526,6 +554,7 @@ CXXTEST_TEST_REGISTRATION(FileTest, openReadModeEmptyContent)
 CXXTEST_TEST_REGISTRATION(FileTest, openWriteMode)
 CXXTEST_TEST_REGISTRATION(FileTest, openWriteModeFromExistingFile)
 CXXTEST_TEST_REGISTRATION(FileTest, read)
+CXXTEST_TEST_REGISTRATION(FileTest, consume)
 CXXTEST_TEST_REGISTRATION(FileTest, readNoFile)
 CXXTEST_TEST_REGISTRATION(FileTest, seekBegin)
 CXXTEST_TEST_REGISTRATION(FileTest, seekEnd)
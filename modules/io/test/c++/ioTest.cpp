@@ -1,10 +1,28 @@
 #include <cxxtest/TestDrive.h>
 
 #include <openma/io.h>
+#include <openma/base/trial.h>
+#include <openma/base/timesequence.h>
+
+#include <algorithm>
+#include <fstream>
+#include <memory>
 
 #include "trial/c3dhandlerTest_def.h"
 #include "test_file_path.h"
 
+// Buffer counting the signature probes (each handler peeks the first bytes of the device)
+class IoTestProbedBuffer : public ma::io::Buffer
+{
+public:
+  mutable unsigned Probes = 0;
+  virtual Size peek(char* s, Size n) const override
+  {
+    ++this->Probes;
+    return this->ma::io::Buffer::peek(s, n);
+  };
+};
+
 CXXTEST_SUITE(IoTest)
 {
   CXXTEST_TEST(readOne)
@@ -29,8 +47,130 @@ CXXTEST_SUITE(IoTest)
     TS_ASSERT_EQUALS(ma::io::read(&root, OPENMA_TDD_PATH_OUT("c3d/sample01_Eb015pi.c3d")), true);
     c3dhandlertest_read_sample01("PI", "sample01_Eb015pi.c3d", &root);
   };
+  CXXTEST_TEST(readMany)
+  {
+    std::vector<std::string> paths;
+    for (int i = 0 ; i < 6 ; ++i)
+    {
+      ma::Node root("root");
+      ma::Trial trial("trial", &root);
+      ma::TimeSequence m("m", 4, 10 * (i + 1), 100.0, 0.0, ma::TimeSequence::Position, "mm", trial.timeSequences());
+      std::fill_n(m.data(), m.elements(), static_cast<double>(i));
+      paths.push_back(OPENMA_TDD_PATH_OUT("c3d/readmany" + std::to_string(i) + ".c3d"));
+      TS_ASSERT_EQUALS(ma::io::write(&root, paths.back()), true);
+    }
+    paths.insert(paths.begin() + 3, OPENMA_TDD_PATH_OUT("c3d/readmany_missing.c3d"));
+    
+    ma::Node root("root");
+    ma::io::ReadOptions options;
+    options.Threads = 3;
+    options.MemoryBudget = 1024;
+    size_t completed = 0;
+    options.Completed = [&](ma::io::ReadResult& ) {++completed; return true;};
+    auto results = ma::io::read_many(paths, &root, options);
+    TS_ASSERT_EQUALS(completed, paths.size());
+    TS_ASSERT_EQUALS(results.size(), paths.size());
+    TS_ASSERT_EQUALS(root.children().size(), 6ul);
+    for (size_t i = 0 ; i < results.size() ; ++i)
+    {
+      TS_ASSERT_EQUALS(results[i].Path, paths[i]);
+      if (i == 3)
+      {
+        TS_ASSERT_EQUALS(results[i].Success, false);
+        TS_ASSERT_EQUALS(results[i].ErrorCode, ma::io::Error::Device);
+        TS_ASSERT_EQUALS(results[i].Nodes.size(), 0ul);
+        continue;
+      }
+      TS_ASSERT_EQUALS(results[i].Success, true);
+      TS_ASSERT_EQUALS(results[i].Nodes.size(), 1ul);
+      if (results[i].Nodes.size() != 1) continue;
+      auto m = results[i].Nodes[0]->findChild<ma::TimeSequence*>("m");
+      TS_ASSERT(m != nullptr);
+      if (m == nullptr) continue;
+      const unsigned k = (i < 3) ? i : i - 1;
+      TS_ASSERT_EQUALS(m->samples(), 10 * (k + 1));
+      TS_ASSERT_DELTA(m->data()[0], static_cast<double>(k), 1e-5);
+    }
+    
+    // Streaming delivery: the nodes are discarded once processed
+    ma::Node root2("root2");
+    options.Threads = 0;
+    options.MemoryBudget = 0;
+    unsigned samples = 0;
+    options.Completed = [&](ma::io::ReadResult& result)
+    {
+      for (auto node : result.Nodes)
+      {
+        auto m = node->findChild<ma::TimeSequence*>("m");
+        if (m != nullptr)
+          samples += m->samples();
+      }
+      return false;
+    };
+    results = ma::io::read_many(paths, &root2, options);
+    TS_ASSERT_EQUALS(root2.children().size(), 0ul);
+    TS_ASSERT_EQUALS(samples, 210u);
+  };
+  
+  CXXTEST_TEST(detectFormat)
+  {
+    ma::Node root("root");
+    ma::Trial trial("trial", &root);
+    ma::TimeSequence m("m", 4, 10, 100.0, 0.0, ma::TimeSequence::Position, "mm", trial.timeSequences());
+    std::fill_n(m.data(), m.elements(), 1.0);
+    TS_ASSERT_EQUALS(ma::io::write(&root, OPENMA_TDD_PATH_OUT("c3d/detect0.c3d")), true);
+    TS_ASSERT_EQUALS(ma::io::write(&root, OPENMA_TDD_PATH_OUT("columnar/detect1.cta"), "openma.cta"), true);
+    // Content not matching the extension
+    TS_ASSERT_EQUALS(ma::io::write(&root, OPENMA_TDD_PATH_OUT("columnar/detect2.cta"), "org.c3d"), true);
+    // Unknown content with a known extension
+    std::ofstream(OPENMA_TDD_PATH_OUT("c3d/detect3.c3d")) << "Not a C3D file";
+    const std::vector<std::string> paths{
+      OPENMA_TDD_PATH_OUT("c3d/detect0.c3d"),
+      OPENMA_TDD_PATH_OUT("columnar/detect1.cta"),
+      OPENMA_TDD_PATH_OUT("columnar/detect2.cta"),
+      OPENMA_TDD_PATH_OUT("c3d/detect3.c3d"),
+      OPENMA_TDD_PATH_OUT("c3d/detect_missing.c3d")
+    };
+    const std::vector<std::string> expected{"org.c3d", "openma.cta", "org.c3d", "", ""};
+    TS_ASSERT_EQUALS(ma::io::detect_format(paths), expected);
+    TS_ASSERT_EQUALS(ma::io::detect_format(paths), expected);
+    // The second detection relies on the memoized handler: the other handlers are not probed
+    // NOTE: The number of markers gives first bytes not seen before (the memoization is shared by all the readers), and the extension gives the priority to another handler.
+    ma::Node root3("root3");
+    ma::Trial trial3("trial", &root3);
+    for (unsigned i = 0 ; i < 7 ; ++i)
+    {
+      auto marker = new ma::TimeSequence("m" + std::to_string(i), 4, 10, 100.0, 0.0, ma::TimeSequence::Position, "mm", trial3.timeSequences());
+      std::fill_n(marker->data(), marker->elements(), 1.0);
+    }
+    ma::io::Buffer output;
+    output.open(ma::io::Mode::Out);
+    ma::io::HandlerWriter writer(&output, "org.c3d");
+    TS_ASSERT_EQUALS(writer.write(&root3), true);
+    ma::io::Buffer::Size size = 0;
+    std::unique_ptr<char[]> data(output.release(&size));
+    IoTestProbedBuffer input;
+    input.setName("probed.snap");
+    input.open(data.get(), size, ma::io::Mode::In);
+    ma::io::HandlerReader first(&input);
+    TS_ASSERT_EQUALS(first.canRead(), true);
+    TS_ASSERT_EQUALS(first.format(), "org.c3d");
+    const unsigned probes = input.Probes;
+    input.Probes = 0;
+    ma::io::HandlerReader second(&input);
+    TS_ASSERT_EQUALS(second.canRead(), true);
+    TS_ASSERT_EQUALS(second.format(), "org.c3d");
+    TS_ASSERT_LESS_THAN(input.Probes, probes);
+    TS_ASSERT_EQUALS(input.Probes, 2u); // Key of the memoization and verification of the cached handler
+    // The handler detected for the content is used to read the file
+    ma::Node root2("root2");
+    TS_ASSERT_EQUALS(ma::io::read(&root2, OPENMA_TDD_PATH_OUT("columnar/detect2.cta")), true);
+    TS_ASSERT_EQUALS(root2.findChild<ma::TimeSequence*>("m") != nullptr, true);
+  };
 };
 
 CXXTEST_SUITE_REGISTRATION(IoTest)
 CXXTEST_TEST_REGISTRATION(IoTest, readOne)
-CXXTEST_TEST_REGISTRATION(IoTest, writeOne)
\ No newline at end of file
+CXXTEST_TEST_REGISTRATION(IoTest, writeOne)
+CXXTEST_TEST_REGISTRATION(IoTest, readMany)
+CXXTEST_TEST_REGISTRATION(IoTest, detectFormat)
\ No newline at end of file
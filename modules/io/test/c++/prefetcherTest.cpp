@@ -0,0 +1,104 @@
+#include <cxxtest/TestDrive.h>
+
+#include <openma/io.h>
+#include <openma/base/trial.h>
+#include <openma/base/timesequence.h>
+
+#include <fstream>
+#include <algorithm>
+
+#include "test_file_path.h"
+
+CXXTEST_SUITE(PrefetcherTest)
+{
+  CXXTEST_TEST(prefetchFile)
+  {
+    std::ofstream(OPENMA_TDD_PATH_OUT("c3d/prefetch.txt")) << "Content to prefetch";
+    TS_ASSERT_EQUALS(ma::io::File::prefetch(OPENMA_TDD_PATH_OUT("c3d/prefetch.txt")), true);
+    TS_ASSERT_EQUALS(ma::io::File::prefetch(OPENMA_TDD_PATH_OUT("c3d/prefetch.txt"), 8, 4), true);
+    TS_ASSERT_EQUALS(ma::io::File::prefetch(OPENMA_TDD_PATH_OUT("c3d/prefetch_missing.txt")), false);
+    TS_ASSERT_EQUALS(ma::io::File::prefetch(nullptr), false);
+  };
+  
+  CXXTEST_TEST(depth)
+  {
+    ma::io::Prefetcher prefetcher;
+    TS_ASSERT_EQUALS(prefetcher.depth(), 2ul);
+    prefetcher.setDepth(4);
+    TS_ASSERT_EQUALS(prefetcher.depth(), 4ul);
+    TS_ASSERT_EQUALS(prefetcher.pending(), 0ul);
+    TS_ASSERT_EQUALS(prefetcher.prefetched(), 0ul);
+    // Nothing to wait
+    prefetcher.wait();
+  };
+  
+  CXXTEST_TEST(queue)
+  {
+    std::vector<std::string> paths;
+    for (int i = 0 ; i < 5 ; ++i)
+    {
+      paths.push_back(OPENMA_TDD_PATH_OUT("c3d/prefetch" + std::to_string(i) + ".txt"));
+      std::ofstream(paths.back()) << "Content " << i;
+    }
+    ma::io::Prefetcher prefetcher(2);
+    prefetcher.enqueue(paths);
+    TS_ASSERT_EQUALS(prefetcher.pending(), 5ul);
+    // Without current file, only the first ones (up to the depth) are prefetched
+    prefetcher.wait();
+    TS_ASSERT_EQUALS(prefetcher.prefetched(), 2ul);
+    prefetcher.advance(paths[0]);
+    prefetcher.wait();
+    TS_ASSERT_EQUALS(prefetcher.pending(), 5ul);
+    TS_ASSERT_EQUALS(prefetcher.prefetched(), 3ul);
+    // Skipped files are removed
+    prefetcher.advance(paths[2]);
+    prefetcher.wait();
+    TS_ASSERT_EQUALS(prefetcher.pending(), 3ul);
+    TS_ASSERT_EQUALS(prefetcher.prefetched(), 5ul);
+    // A file not queued becomes the current one
+    prefetcher.advance(OPENMA_TDD_PATH_OUT("c3d/prefetch.txt"));
+    prefetcher.wait();
+    TS_ASSERT_EQUALS(prefetcher.pending(), 3ul);
+    TS_ASSERT_EQUALS(prefetcher.prefetched(), 6ul);
+    prefetcher.clear();
+    TS_ASSERT_EQUALS(prefetcher.pending(), 0ul);
+    prefetcher.wait();
+    TS_ASSERT_EQUALS(prefetcher.prefetched(), 6ul);
+  };
+  
+  CXXTEST_TEST(readWithPrefetcher)
+  {
+    std::vector<std::string> paths;
+    for (int i = 0 ; i < 4 ; ++i)
+    {
+      ma::Node root("root");
+      ma::Trial trial("trial", &root);
+      ma::TimeSequence m("m", 4, 10 * (i + 1), 100.0, 0.0, ma::TimeSequence::Position, "mm", trial.timeSequences());
+      std::fill_n(m.data(), m.elements(), static_cast<double>(i));
+      paths.push_back(OPENMA_TDD_PATH_OUT("c3d/prefetch" + std::to_string(i) + ".c3d"));
+      TS_ASSERT_EQUALS(ma::io::write(&root, paths.back()), true);
+    }
+    ma::io::Prefetcher prefetcher(1);
+    prefetcher.enqueue(paths);
+    for (size_t i = 0 ; i < paths.size() ; ++i)
+    {
+      ma::Node root("root");
+      TS_ASSERT_EQUALS(ma::io::read(&root, paths[i], "", {}, &prefetcher), true);
+      TS_ASSERT_EQUALS(prefetcher.pending(), paths.size() - i);
+      auto m = root.findChild<ma::TimeSequence*>("m");
+      TS_ASSERT(m != nullptr);
+      if (m == nullptr) continue;
+      TS_ASSERT_EQUALS(m->samples(), 10 * (i + 1));
+      TS_ASSERT_DELTA(m->data()[0], static_cast<double>(i), 1e-5);
+      // Processing: the next file is ready
+      prefetcher.wait();
+    }
+    TS_ASSERT_EQUALS(prefetcher.prefetched(), paths.size());
+  };
+};
+
+CXXTEST_SUITE_REGISTRATION(PrefetcherTest)
+CXXTEST_TEST_REGISTRATION(PrefetcherTest, prefetchFile)
+CXXTEST_TEST_REGISTRATION(PrefetcherTest, depth)
+CXXTEST_TEST_REGISTRATION(PrefetcherTest, queue)
+CXXTEST_TEST_REGISTRATION(PrefetcherTest, readWithPrefetcher)
@@ -7,6 +7,15 @@
 
 #include "test_file_path.h"
 
+#include <vector>
+
+// Buffer without direct access to its content: the samples are then read by blocks.
+class BlockBuffer : public ma::io::Buffer
+{
+public:
+  virtual const char* consume(Size ) override {return nullptr;};
+};
+
 CXXTEST_SUITE(BSFReaderTest)
 {
   CXXTEST_TEST(capability)
@@ -232,6 +241,35 @@ CXXTEST_SUITE(BSFReaderTest)
       TSM_ASSERT_DELTA(msg, wrench->data()[i+800u ], fref[i+800u], 1e-10);
     };
   };
+  
+  CXXTEST_TEST(fileTrial01868Blocks)
+  {
+    ma::io::File file;
+    file.open(OPENMA_TDD_PATH_IN("bsf/Trial01868.bsf"), ma::io::Mode::In);
+    std::vector<char> content(static_cast<size_t>(file.size()));
+    file.read(content.data(), content.size());
+    file.seek(0, ma::io::Origin::Begin);
+    ma::io::HandlerReader mapped(&file, "amti.bsf");
+    ma::Node rootMapped("root");
+    TS_ASSERT_EQUALS(mapped.read(&rootMapped), true);
+    BlockBuffer buffer;
+    buffer.setName("Trial01868.bsf");
+    buffer.open(content.data(), content.size());
+    ma::io::HandlerReader blocks(&buffer, "amti.bsf");
+    ma::Node rootBlocks("root");
+    TS_ASSERT_EQUALS(blocks.read(&rootBlocks), true);
+    auto analogsMapped = rootMapped.findChildren<ma::TimeSequence*>();
+    auto analogsBlocks = rootBlocks.findChildren<ma::TimeSequence*>();
+    TS_ASSERT_EQUALS(analogsMapped.size(), 6u);
+    TS_ASSERT_EQUALS(analogsBlocks.size(), 6u);
+    for (size_t i = 0 ; i < analogsMapped.size() ; ++i)
+    {
+      TS_ASSERT_EQUALS(analogsBlocks[i]->name(), analogsMapped[i]->name());
+      TS_ASSERT_EQUALS(analogsBlocks[i]->samples(), 400u);
+      for (unsigned j = 0 ; j < 400u ; ++j)
+        TSM_ASSERT_EQUALS(std::to_string(j), analogsBlocks[i]->data()[j], analogsMapped[i]->data()[j]);
+    }
+  };
 };
 
 CXXTEST_SUITE_REGISTRATION(BSFReaderTest)
@@ -246,4 +284,5 @@ CXXTEST_TEST_REGISTRATION(BSFReaderTest, queryOkOne)
 CXXTEST_TEST_REGISTRATION(BSFReaderTest, queryOkTwo)
 CXXTEST_TEST_REGISTRATION(BSFReaderTest, queryOkThree)
 CXXTEST_TEST_REGISTRATION(BSFReaderTest, fileTrial01868)
-CXXTEST_TEST_REGISTRATION(BSFReaderTest, fileTrial03361)
\ No newline at end of file
+CXXTEST_TEST_REGISTRATION(BSFReaderTest, fileTrial03361)
+CXXTEST_TEST_REGISTRATION(BSFReaderTest, fileTrial01868Blocks)
\ No newline at end of file
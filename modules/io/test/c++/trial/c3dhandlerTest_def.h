@@ -7,11 +7,12 @@
 #include "openma/base/event.h"
 #include "openma/instrument/forceplate.h"
 
-inline bool c3dhandlertest_read(const char* msgid, const char* filepath, ma::Node* root)
+inline bool c3dhandlertest_read(const char* msgid, const char* filepath, ma::Node* root, const std::unordered_map<std::string, ma::Any>& options = std::unordered_map<std::string, ma::Any>{})
 {
   ma::io::File file;
   file.open(filepath, ma::io::Mode::In);
   ma::io::HandlerReader reader(&file, "org.c3d");
+  reader.setOptions(options);
   bool ret = reader.read(root);
   TSM_ASSERT_EQUALS(msgid, ret, true);
   TSM_ASSERT_EQUALS(msgid, reader.errorCode(), ma::io::Error::None);
@@ -19,11 +20,12 @@ inline bool c3dhandlertest_read(const char* msgid, const char* filepath, ma::Nod
   return ret;
 };
 
-inline bool c3dhandlertest_write(const char* msgid, const char* filepath, ma::Node* root)
+inline bool c3dhandlertest_write(const char* msgid, const char* filepath, ma::Node* root, const std::unordered_map<std::string, ma::Any>& options = std::unordered_map<std::string, ma::Any>{})
 {
   ma::io::File file;
   file.open(filepath, ma::io::Mode::Out);
   ma::io::HandlerWriter writer(&file, "org.c3d");
+  writer.setOptions(options);
   bool ret = writer.write(root);
   TSM_ASSERT_EQUALS(msgid, ret, true);
   TSM_ASSERT_EQUALS(msgid, writer.errorCode(), ma::io::Error::None);
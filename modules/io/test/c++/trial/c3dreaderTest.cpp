@@ -3,6 +3,12 @@
 #include <openma/io/handlerreader.h>
 #include <openma/io/file.h>
 
+#include <fstream>
+#include <iterator>
+#include <algorithm>
+#include <array>
+#include <vector>
+
 #include "c3dhandlerTest_def.h"
 #include "test_file_path.h"
 
@@ -114,7 +120,183 @@ CXXTEST_SUITE(C3DReaderTest)
     // Verify that force plate type with a calibration matrix are correctly loaded.
     ma::Node root("root");
     TS_ASSERT_EQUALS(c3dhandlertest_read("Gait 1", OPENMA_TDD_PATH_IN("c3d/other/Gait 1.c3d"), &root), true);
-  }
+  };
+  
+  CXXTEST_TEST(readSelection)
+  {
+    ma::Node rootIn("rootIn"), rootChannels("rootChannels"), rootTypes("rootTypes"), rootFrames("rootFrames");
+    ma::Trial foo("foo", &rootIn);
+    ma::TimeSequence m1("m1", 4, 50, 100.0, 0.0, ma::TimeSequence::Position, "mm", foo.timeSequences());
+    ma::TimeSequence m2("m2", 4, 50, 100.0, 0.0, ma::TimeSequence::Position, "mm", foo.timeSequences());
+    ma::TimeSequence a1("a1", 1, 200, 400.0, 0.0, ma::TimeSequence::Analog, "V", 1.0, 0.0, std::array<double,2>{{-10.0, 10.0}}, foo.timeSequences());
+    ma::TimeSequence a2("a2", 1, 200, 400.0, 0.0, ma::TimeSequence::Analog, "V", 1.0, 0.0, std::array<double,2>{{-10.0, 10.0}}, foo.timeSequences());
+    for (unsigned i = 0 ; i < 50 ; ++i)
+    {
+      for (unsigned j = 0 ; j < 3 ; ++j)
+      {
+        m1.data()[i+j*50] = 0.5 * static_cast<double>(i + j);
+        m2.data()[i+j*50] = -0.25 * static_cast<double>(i * j);
+      }
+      m1.data()[i+150] = 0.0;
+      m2.data()[i+150] = 0.0;
+    }
+    for (unsigned i = 0 ; i < 200 ; ++i)
+    {
+      a1.data()[i] = 0.01 * static_cast<double>(i);
+      a2.data()[i] = -0.02 * static_cast<double>(i);
+    }
+    if (!c3dhandlertest_write("", OPENMA_TDD_PATH_OUT("c3d/selection.c3d"), &rootIn)) return;
+    // Channel filter
+    if (!c3dhandlertest_read("", OPENMA_TDD_PATH_OUT("c3d/selection.c3d"), &rootChannels, {{"channels",std::vector<std::string>{"m2","a1"}}})) return;
+    auto tss = rootChannels.findChildren<ma::TimeSequence*>();
+    TS_ASSERT_EQUALS(tss.size(), 2ul);
+    for (const auto& ts : std::vector<ma::TimeSequence*>{{&m2, &a1}})
+    {
+      auto ts2 = rootChannels.findChild<ma::TimeSequence*>(ts->name());
+      TS_ASSERT(ts2 != nullptr);
+      if (ts2 == nullptr) continue;
+      TS_ASSERT_EQUALS(ts2->samples(), ts->samples());
+      for (unsigned i = 0 ; i < ts->elements() ; ++i)
+        TS_ASSERT_DELTA(ts2->data()[i], ts->data()[i], 1e-5);
+    }
+    // Type filter
+    if (!c3dhandlertest_read("", OPENMA_TDD_PATH_OUT("c3d/selection.c3d"), &rootTypes, {{"types",static_cast<int>(ma::TimeSequence::Analog)}})) return;
+    tss = rootTypes.findChildren<ma::TimeSequence*>();
+    TS_ASSERT_EQUALS(tss.size(), 2ul);
+    TS_ASSERT(rootTypes.findChild<ma::TimeSequence*>("a1") != nullptr);
+    TS_ASSERT(rootTypes.findChild<ma::TimeSequence*>("a2") != nullptr);
+    // Frame range
+    if (!c3dhandlertest_read("", OPENMA_TDD_PATH_OUT("c3d/selection.c3d"), &rootFrames, {{"firstFrame",10},{"lastFrame",19}})) return;
+    tss = rootFrames.findChildren<ma::TimeSequence*>();
+    TS_ASSERT_EQUALS(tss.size(), 4ul);
+    for (const auto& ts : std::vector<ma::TimeSequence*>{{&m1, &m2, &a1, &a2}})
+    {
+      auto ts2 = rootFrames.findChild<ma::TimeSequence*>(ts->name());
+      TS_ASSERT(ts2 != nullptr);
+      if (ts2 == nullptr) continue;
+      const unsigned ratio = ts->samples() / 50;
+      TS_ASSERT_EQUALS(ts2->samples(), 10 * ratio);
+      TS_ASSERT_DELTA(ts2->startTime(), 0.1, 1e-5);
+      for (unsigned c = 0 ; c < ts->components() ; ++c)
+      {
+        for (unsigned i = 0 ; i < ts2->samples() ; ++i)
+          TS_ASSERT_DELTA(ts2->data()[i + c * ts2->samples()], ts->data()[i + 10 * ratio + c * ts->samples()], 1e-5);
+      }
+    }
+  };
+  
+  CXXTEST_TEST(readMetadata)
+  {
+    ma::Node rootIn("rootIn"), rootOut("rootOut");
+    ma::Trial foo("foo", &rootIn);
+    ma::TimeSequence m1("m1", 4, 50, 100.0, 0.0, ma::TimeSequence::Position, "mm", foo.timeSequences());
+    ma::TimeSequence a1("a1", 1, 200, 400.0, 0.0, ma::TimeSequence::Analog, "V", 1.0, 0.0, std::array<double,2>{{-10.0, 10.0}}, foo.timeSequences());
+    std::fill_n(m1.data(), m1.elements(), 1.0);
+    std::fill_n(a1.data(), a1.elements(), 0.5);
+    if (!c3dhandlertest_write("", OPENMA_TDD_PATH_OUT("c3d/metadata.c3d"), &rootIn)) return;
+    if (!c3dhandlertest_read("", OPENMA_TDD_PATH_OUT("c3d/metadata.c3d"), &rootOut, {{"metadata",true}})) return;
+    auto trial = rootOut.findChild<ma::Trial*>();
+    TS_ASSERT(trial != nullptr);
+    if (trial == nullptr) return;
+    TS_ASSERT_EQUALS(trial->property("POINT:USED").cast<int>(), 1);
+    TS_ASSERT_EQUALS(trial->property("ANALOG:USED").cast<int>(), 1);
+    for (const auto& ts : std::vector<ma::TimeSequence*>{{&m1, &a1}})
+    {
+      auto ts2 = rootOut.findChild<ma::TimeSequence*>(ts->name());
+      TS_ASSERT(ts2 != nullptr);
+      if (ts2 == nullptr) continue;
+      TS_ASSERT_EQUALS(ts2->type(), ts->type());
+      TS_ASSERT_EQUALS(ts2->samples(), 0u);
+      TS_ASSERT_EQUALS(ts2->components(), ts->components());
+      TS_ASSERT_DELTA(ts2->sampleRate(), ts->sampleRate(), 1e-5);
+      TS_ASSERT_EQUALS(ts2->property("storedSamples").cast<unsigned>(), ts->samples());
+    }
+  };
+  
+  CXXTEST_TEST(readMultithreaded)
+  {
+    // More than 1 MB of data is required to decode the frames with several threads
+    ma::Node rootIn("rootIn"), rootOne("rootOne"), rootFour("rootFour");
+    ma::Trial foo("foo", &rootIn);
+    const unsigned samples = 5000;
+    for (unsigned i = 0 ; i < 40 ; ++i)
+    {
+      auto ts = new ma::TimeSequence("m" + std::to_string(i), 4, samples, 100.0, 0.0, ma::TimeSequence::Position, "mm", foo.timeSequences());
+      for (unsigned j = 0 ; j < samples ; ++j)
+      {
+        ts->data()[j] = static_cast<double>(i + j);
+        ts->data()[j+samples] = -static_cast<double>(i * j % 1000);
+        ts->data()[j+2*samples] = 0.5 * static_cast<double>(j);
+        ts->data()[j+3*samples] = (j % 7 == 0) ? -1.0 : 0.0;
+      }
+    }
+    if (!c3dhandlertest_write("", OPENMA_TDD_PATH_OUT("c3d/multithreaded.c3d"), &rootIn)) return;
+    if (!c3dhandlertest_read("", OPENMA_TDD_PATH_OUT("c3d/multithreaded.c3d"), &rootOne, {{"threads",1}})) return;
+    if (!c3dhandlertest_read("", OPENMA_TDD_PATH_OUT("c3d/multithreaded.c3d"), &rootFour, {{"threads",4}})) return;
+    
+    auto tssIn = rootIn.findChildren<ma::TimeSequence*>();
+    auto tssOne = rootOne.findChildren<ma::TimeSequence*>();
+    auto tssFour = rootFour.findChildren<ma::TimeSequence*>();
+    TS_ASSERT_EQUALS(tssOne.size(), tssIn.size());
+    TS_ASSERT_EQUALS(tssFour.size(), tssIn.size());
+    if ((tssOne.size() != tssIn.size()) || (tssFour.size() != tssIn.size())) return;
+    for (size_t i = 0 ; i < tssIn.size() ; ++i)
+    {
+      TS_ASSERT_EQUALS(tssFour[i]->name(), tssIn[i]->name());
+      TS_ASSERT_EQUALS(tssFour[i]->samples(), samples);
+      for (unsigned j = 0 ; j < tssIn[i]->elements() ; ++j)
+      {
+        TS_ASSERT_EQUALS(tssFour[i]->data()[j], tssOne[i]->data()[j]);
+        TS_ASSERT_DELTA(tssFour[i]->data()[j], tssIn[i]->data()[j], 1e-5);
+      }
+    }
+  };
+  
+  CXXTEST_TEST(readDeferredParameters)
+  {
+    ma::Node rootIn("rootIn"), rootOut("rootOut"), rootOut2("rootOut2");
+    ma::Trial foo("foo", &rootIn);
+    ma::TimeSequence m1("m1", 4, 10, 100.0, 0.0, ma::TimeSequence::Position, "mm", foo.timeSequences());
+    for (unsigned i = 0 ; i < 40 ; ++i)
+      m1.data()[i] = (i < 30) ? static_cast<double>(i) : 0.0;
+    foo.setProperty("VENDOR:VALUES", std::vector<float>{1.5f, -2.0f, 3.25f});
+    foo.setProperty("VENDOR:NAME", std::string("Foo"));
+    foo.setProperty("VENDOR:CHANNELS", std::vector<std::string>{"Left","Right"});
+    if (!c3dhandlertest_write("", OPENMA_TDD_PATH_OUT("c3d/deferred.c3d"), &rootIn)) return;
+    // The parameters are not decoded during the reading
+    if (!c3dhandlertest_read("", OPENMA_TDD_PATH_OUT("c3d/deferred.c3d"), &rootOut)) return;
+    auto trial = rootOut.findChild<ma::Trial*>();
+    TS_ASSERT(trial != nullptr);
+    if (trial == nullptr) return;
+    TS_ASSERT_EQUALS(trial->deferredProperties().count("VENDOR:VALUES"), 1ul);
+    TS_ASSERT_EQUALS(trial->deferredProperties().count("VENDOR:NAME"), 1ul);
+    TS_ASSERT_EQUALS(trial->deferredProperties().count("VENDOR:CHANNELS"), 1ul);
+    TS_ASSERT_EQUALS(trial->dynamicProperties(false).count("VENDOR:VALUES"), 0ul);
+    // Unchanged parameters are written back as is
+    if (!c3dhandlertest_write("", OPENMA_TDD_PATH_OUT("c3d/deferred_rewrited.c3d"), &rootOut)) return;
+    TS_ASSERT_EQUALS(trial->deferredProperties().count("VENDOR:VALUES"), 1ul);
+    std::ifstream ref(OPENMA_TDD_PATH_OUT("c3d/deferred.c3d"), std::ios::binary), rewrited(OPENMA_TDD_PATH_OUT("c3d/deferred_rewrited.c3d"), std::ios::binary);
+    std::vector<char> refBytes((std::istreambuf_iterator<char>(ref)), std::istreambuf_iterator<char>());
+    std::vector<char> rewritedBytes((std::istreambuf_iterator<char>(rewrited)), std::istreambuf_iterator<char>());
+    TS_ASSERT(rewritedBytes == refBytes);
+    // Decoded at the first access
+    TS_ASSERT_EQUALS(trial->property("VENDOR:VALUES").cast<std::vector<float>>(), (std::vector<float>{1.5f, -2.0f, 3.25f}));
+    TS_ASSERT_EQUALS(trial->deferredProperties().count("VENDOR:VALUES"), 0ul);
+    TS_ASSERT_EQUALS(trial->dynamicProperties(false).count("VENDOR:VALUES"), 1ul);
+    TS_ASSERT_EQUALS(trial->property("VENDOR:NAME").cast<std::string>(), "Foo");
+    // The strings of an array are padded to the same length in a C3D file
+    TS_ASSERT_EQUALS(trial->property("VENDOR:CHANNELS").cast<std::vector<std::string>>(), (std::vector<std::string>{"Left ","Right"}));
+    // Modified parameters are encoded again
+    trial->setProperty("VENDOR:NAME", std::string("Bar"));
+    if (!c3dhandlertest_write("", OPENMA_TDD_PATH_OUT("c3d/deferred_modified.c3d"), &rootOut)) return;
+    if (!c3dhandlertest_read("", OPENMA_TDD_PATH_OUT("c3d/deferred_modified.c3d"), &rootOut2)) return;
+    auto trial2 = rootOut2.findChild<ma::Trial*>();
+    TS_ASSERT(trial2 != nullptr);
+    if (trial2 == nullptr) return;
+    TS_ASSERT_EQUALS(trial2->property("VENDOR:NAME").cast<std::string>(), "Bar");
+    TS_ASSERT_EQUALS(trial2->property("VENDOR:VALUES").cast<std::vector<float>>(), (std::vector<float>{1.5f, -2.0f, 3.25f}));
+    TS_ASSERT_EQUALS(trial2->property("POINT:USED").cast<int>(), 1);
+  };
 };
 
 CXXTEST_SUITE_REGISTRATION(C3DReaderTest)
@@ -129,4 +311,8 @@ CXXTEST_TEST_REGISTRATION(C3DReaderTest, queryOkOne)
 CXXTEST_TEST_REGISTRATION(C3DReaderTest, queryOkTwo)
 CXXTEST_TEST_REGISTRATION(C3DReaderTest, queryOkThree)
 CXXTEST_TEST_REGISTRATION(C3DReaderTest, sample01)
-CXXTEST_TEST_REGISTRATION(C3DReaderTest, gait1)
\ No newline at end of file
+CXXTEST_TEST_REGISTRATION(C3DReaderTest, gait1)
+CXXTEST_TEST_REGISTRATION(C3DReaderTest, readSelection)
+CXXTEST_TEST_REGISTRATION(C3DReaderTest, readMetadata)
+CXXTEST_TEST_REGISTRATION(C3DReaderTest, readMultithreaded)
+CXXTEST_TEST_REGISTRATION(C3DReaderTest, readDeferredParameters)
\ No newline at end of file
@@ -1,11 +1,35 @@
 #include <cxxtest/TestDrive.h>
 
 #include <openma/io/handlerwriter.h>
+#include <openma/io/c3dstreamwriter.h>
 #include <openma/io/file.h>
 
+#include <fstream>
+#include <iterator>
+#include <algorithm>
+#include <cmath>
+#include <tuple>
+
 #include "c3dhandlerTest_def.h"
 #include "test_file_path.h"
 
+// Trial with one marker and one analog channel sampled 'ratio' times faster. The values start at 'offset'.
+ma::Trial* c3dwritertest_generate_trial(ma::Node* root, unsigned frames, unsigned ratio, double offset, double scale = 1.0)
+{
+  auto trial = new ma::Trial("foo", root);
+  auto m1 = new ma::TimeSequence("m1", 4, frames, 100.0, 0.0, ma::TimeSequence::Position, "mm", trial->timeSequences());
+  auto a1 = new ma::TimeSequence("a1", 1, ratio * frames, ratio * 100.0, 0.0, ma::TimeSequence::Analog, "V", scale, 0.0, std::array<double,2>{{-10.0, 10.0}}, trial->timeSequences());
+  for (unsigned i = 0 ; i < frames ; ++i)
+  {
+    for (unsigned j = 0 ; j < 3 ; ++j)
+      m1->data()[i+j*frames] = offset + static_cast<double>(i + j);
+    m1->data()[i+3*frames] = 0.0;
+  }
+  for (unsigned i = 0 ; i < ratio * frames ; ++i)
+    a1->data()[i] = offset + static_cast<double>(i) / static_cast<double>(ratio);
+  return trial;
+};
+
 CXXTEST_SUITE(C3DWriterTest)
 {
   CXXTEST_TEST(capability)
@@ -151,6 +175,475 @@ CXXTEST_SUITE(C3DWriterTest)
     TS_ASSERT_EQUALS( tss[0]->range()[0], range[0] );
     TS_ASSERT_EQUALS( tss[0]->range()[1], range[1] );
   }
+
+  CXXTEST_TEST(writePointsAndAnalogs)
+  {
+    ma::Node rootIn("rootIn"), rootOut("rootOut");
+    ma::Trial foo("foo", &rootIn);
+    ma::TimeSequence m1("m1", 4, 50, 100.0, 0.0, ma::TimeSequence::Position, "mm", foo.timeSequences());
+    ma::TimeSequence m2("m2", 4, 50, 100.0, 0.0, ma::TimeSequence::Position, "mm", foo.timeSequences());
+    ma::TimeSequence a1("a1", 1, 200, 400.0, 0.0, ma::TimeSequence::Analog, "V", 1.0, 0.0, std::array<double,2>{{-10.0, 10.0}}, foo.timeSequences());
+    ma::TimeSequence a2("a2", 1, 200, 400.0, 0.0, ma::TimeSequence::Analog, "V", 1.0, 0.0, std::array<double,2>{{-10.0, 10.0}}, foo.timeSequences());
+    for (unsigned i = 0 ; i < 50 ; ++i)
+    {
+      for (unsigned j = 0 ; j < 3 ; ++j)
+      {
+        m1.data()[i+j*50] = 0.5 * static_cast<double>(i + j);
+        m2.data()[i+j*50] = -0.25 * static_cast<double>(i * j);
+      }
+      m1.data()[i+150] = 0.0;
+      m2.data()[i+150] = (i % 5 == 0) ? -1.0 : 0.0; // Some occlusions
+    }
+    for (unsigned i = 0 ; i < 200 ; ++i)
+    {
+      a1.data()[i] = 0.01 * static_cast<double>(i);
+      a2.data()[i] = -0.02 * static_cast<double>(i);
+    }
+    if (!c3dhandlertest_write("", OPENMA_TDD_PATH_OUT("c3d/points_analogs.c3d"), &rootIn)) return;
+    if (!c3dhandlertest_read("", OPENMA_TDD_PATH_OUT("c3d/points_analogs.c3d"), &rootOut)) return;
+    
+    for (const auto& ts : std::vector<ma::TimeSequence*>{{&m1, &m2, &a1, &a2}})
+    {
+      auto ts2 = rootOut.findChild<ma::TimeSequence*>(ts->name());
+      TS_ASSERT(ts2 != nullptr);
+      if (ts2 == nullptr) continue;
+      TS_ASSERT_EQUALS(ts2->samples(), ts->samples());
+      TS_ASSERT_EQUALS(ts2->components(), ts->components());
+      for (unsigned i = 0 ; i < ts->elements() ; ++i)
+        TS_ASSERT_DELTA(ts2->data()[i], ts->data()[i], 1e-5);
+    }
+  }
+
+  CXXTEST_TEST(writeStreamed)
+  {
+    // Reference trial written at once
+    ma::Node rootIn("rootIn"), rootOut("rootOut");
+    ma::Trial foo("foo", &rootIn);
+    ma::TimeSequence m1("m1", 4, 50, 100.0, 0.0, ma::TimeSequence::Position, "mm", foo.timeSequences());
+    ma::TimeSequence m2("m2", 4, 50, 100.0, 0.0, ma::TimeSequence::Position, "mm", foo.timeSequences());
+    ma::TimeSequence a1("a1", 1, 200, 400.0, 0.0, ma::TimeSequence::Analog, "V", 1.0, 0.0, std::array<double,2>{{-10.0, 10.0}}, foo.timeSequences());
+    for (unsigned i = 0 ; i < 50 ; ++i)
+    {
+      for (unsigned j = 0 ; j < 3 ; ++j)
+      {
+        m1.data()[i+j*50] = 0.5 * static_cast<double>(i + j);
+        m2.data()[i+j*50] = -0.25 * static_cast<double>(i * j);
+      }
+      m1.data()[i+150] = 0.0;
+      m2.data()[i+150] = (i % 5 == 0) ? -1.0 : 0.0;
+    }
+    for (unsigned i = 0 ; i < 200 ; ++i)
+      a1.data()[i] = 0.01 * static_cast<double>(i);
+    if (!c3dhandlertest_write("", OPENMA_TDD_PATH_OUT("c3d/streamed_ref.c3d"), &rootIn)) return;
+    // Same content streamed by blocks of frames
+    ma::Trial schema("foo");
+    ma::TimeSequence s1("m1", 4, 0, 100.0, 0.0, ma::TimeSequence::Position, "mm", schema.timeSequences());
+    ma::TimeSequence s2("m2", 4, 0, 100.0, 0.0, ma::TimeSequence::Position, "mm", schema.timeSequences());
+    ma::TimeSequence s3("a1", 1, 0, 400.0, 0.0, ma::TimeSequence::Analog, "V", 1.0, 0.0, std::array<double,2>{{-10.0, 10.0}}, schema.timeSequences());
+    ma::io::File file;
+    file.open(OPENMA_TDD_PATH_OUT("c3d/streamed.c3d"), ma::io::Mode::Out);
+    ma::io::C3DStreamWriter writer(&file);
+    TS_ASSERT_EQUALS(writer.appendFrames(1, m1.data(), a1.data()), false);
+    TS_ASSERT_EQUALS(writer.open(&schema), true);
+    TS_ASSERT_EQUALS(writer.errorCode(), ma::io::Error::None);
+    TS_ASSERT_EQUALS(writer.pointLabels(), (std::vector<std::string>{"m1","m2"}));
+    TS_ASSERT_EQUALS(writer.analogLabels(), std::vector<std::string>{"a1"});
+    TS_ASSERT_EQUALS(writer.analogSamplesPerFrame(), 4u);
+    unsigned first = 0;
+    for (unsigned num : {7u, 20u, 23u})
+    {
+      std::vector<double> points(2 * 4 * num), analogs(4 * num);
+      for (unsigned c = 0 ; c < 4 ; ++c)
+      {
+        std::copy_n(m1.data() + c * 50 + first, num, points.data() + c * num);
+        std::copy_n(m2.data() + c * 50 + first, num, points.data() + (4 + c) * num);
+      }
+      std::copy_n(a1.data() + 4 * first, 4 * num, analogs.data());
+      TS_ASSERT_EQUALS(writer.appendFrames(num, points.data(), analogs.data()), true);
+      first += num;
+    }
+    TS_ASSERT_EQUALS(writer.frames(), 50ul);
+    TS_ASSERT_EQUALS(writer.close(), true);
+    TS_ASSERT_EQUALS(writer.isOpen(), false);
+    file.close();
+    // Both files must be identical
+    std::ifstream ref(OPENMA_TDD_PATH_OUT("c3d/streamed_ref.c3d"), std::ios::binary), streamed(OPENMA_TDD_PATH_OUT("c3d/streamed.c3d"), std::ios::binary);
+    std::vector<char> refBytes((std::istreambuf_iterator<char>(ref)), std::istreambuf_iterator<char>());
+    std::vector<char> streamedBytes((std::istreambuf_iterator<char>(streamed)), std::istreambuf_iterator<char>());
+    TS_ASSERT_EQUALS(streamedBytes.size(), refBytes.size());
+    TS_ASSERT(streamedBytes == refBytes);
+    // And the streamed file can be read back
+    if (!c3dhandlertest_read("", OPENMA_TDD_PATH_OUT("c3d/streamed.c3d"), &rootOut)) return;
+    auto trial = rootOut.findChild<ma::Trial*>();
+    TS_ASSERT(trial != nullptr);
+    if (trial == nullptr) return;
+    TS_ASSERT_EQUALS(trial->property("POINT:FRAMES").cast<int>(), 50);
+    TS_ASSERT_EQUALS(trial->property("TRIAL:ACTUAL_END_FIELD").cast<std::vector<int>>(), (std::vector<int>{50,0}));
+    for (const auto& ts : std::vector<ma::TimeSequence*>{{&m1, &m2, &a1}})
+    {
+      auto ts2 = rootOut.findChild<ma::TimeSequence*>(ts->name());
+      TS_ASSERT(ts2 != nullptr);
+      if (ts2 == nullptr) continue;
+      TS_ASSERT_EQUALS(ts2->samples(), ts->samples());
+      for (unsigned i = 0 ; i < ts->elements() ; ++i)
+        TS_ASSERT_DELTA(ts2->data()[i], ts->data()[i], 1e-5);
+    }
+  }
+  CXXTEST_TEST(writeStreamedCloseFailure)
+  {
+    ma::Node rootOut("rootOut");
+    ma::Trial schema("schema");
+    ma::TimeSequence s1("m1", 4, 0, 100.0, 0.0, ma::TimeSequence::Position, "mm", schema.timeSequences());
+    std::vector<double> points(4 * 10, 1.0);
+    ma::io::File file;
+    file.open(OPENMA_TDD_PATH_OUT("c3d/streamed_close.c3d"), ma::io::Mode::Out);
+    ma::io::C3DStreamWriter writer(&file);
+    TS_ASSERT_EQUALS(writer.open(&schema), true);
+    TS_ASSERT_EQUALS(writer.appendFrames(10, points.data(), nullptr), true);
+    // The header cannot be patched in a read-only device
+    file.close();
+    file.open(OPENMA_TDD_PATH_OUT("c3d/streamed_close.c3d"), ma::io::Mode::In);
+    TS_ASSERT_EQUALS(writer.close(), false);
+    TS_ASSERT_EQUALS(writer.errorCode(), ma::io::Error::Device);
+    TS_ASSERT_EQUALS(writer.isOpen(), true);
+    // Once the device is writable, the header can be patched
+    file.close();
+    file.open(OPENMA_TDD_PATH_OUT("c3d/streamed_close.c3d"), ma::io::Mode::In | ma::io::Mode::Out);
+    TS_ASSERT_EQUALS(writer.close(), true);
+    TS_ASSERT_EQUALS(writer.isOpen(), false);
+    file.close();
+    if (!c3dhandlertest_read("", OPENMA_TDD_PATH_OUT("c3d/streamed_close.c3d"), &rootOut)) return;
+    auto ts = rootOut.findChild<ma::TimeSequence*>("m1");
+    TS_ASSERT(ts != nullptr);
+    if (ts == nullptr) return;
+    TS_ASSERT_EQUALS(ts->samples(), 10u);
+  }
+  CXXTEST_TEST(writeIntegerFormat)
+  {
+    ma::Node rootIn("rootIn"), rootOut("rootOut");
+    ma::Trial foo("foo", &rootIn);
+    ma::TimeSequence m1("m1", 4, 100, 100.0, 0.0, ma::TimeSequence::Position, "mm", foo.timeSequences());
+    ma::TimeSequence m2("m2", 4, 100, 100.0, 0.0, ma::TimeSequence::Position, "mm", foo.timeSequences());
+    ma::TimeSequence a1("a1", 1, 200, 200.0, 0.0, ma::TimeSequence::Analog, "V", 1.0, 0.0, std::array<double,2>{{-10.0, 10.0}}, foo.timeSequences());
+    ma::TimeSequence a2("a2", 1, 200, 200.0, 0.0, ma::TimeSequence::Analog, "V", 1.0, 0.0, std::array<double,2>{{-10.0, 10.0}}, foo.timeSequences());
+    for (unsigned i = 0 ; i < 100 ; ++i)
+    {
+      for (unsigned j = 0 ; j < 3 ; ++j)
+      {
+        m1.data()[i+j*100] = 12.5 * static_cast<double>(i) - 250.0 * static_cast<double>(j);
+        m2.data()[i+j*100] = -1.75 * static_cast<double>(i * j);
+      }
+      m1.data()[i+300] = 0.5;
+      m2.data()[i+300] = (i % 10 == 0) ? -1.0 : 0.25;
+    }
+    // An occluded sample with a large coordinate must not be used to compute the scale factor
+    m2.data()[0] = 1.0e6;
+    for (unsigned i = 0 ; i < 200 ; ++i)
+    {
+      a1.data()[i] = 4.5 * std::sin(0.1 * static_cast<double>(i));
+      a2.data()[i] = 1.0e-4 * std::cos(0.1 * static_cast<double>(i)); // Very small scale factor to use ANALOG:GEN_SCALE
+    }
+    if (!c3dhandlertest_write("", OPENMA_TDD_PATH_OUT("c3d/integer_float.c3d"), &rootIn)) return;
+    if (!c3dhandlertest_write("", OPENMA_TDD_PATH_OUT("c3d/integer.c3d"), &rootIn, {{"integerFormat",true}})) return;
+    if (!c3dhandlertest_read("", OPENMA_TDD_PATH_OUT("c3d/integer.c3d"), &rootOut)) return;
+    auto trial = rootOut.findChild<ma::Trial*>();
+    TS_ASSERT(trial != nullptr);
+    if (trial == nullptr) return;
+    const double pointScale = trial->property("POINT:SCALE").cast<double>();
+    TS_ASSERT_DELTA(pointScale, 1237.5 / 32767.0, 1e-7);
+    TS_ASSERT_EQUALS(trial->property("ANALOG:FORMAT").cast<std::string>(), "SIGNED");
+    TS_ASSERT_DIFFERS(trial->property("ANALOG:GEN_SCALE").cast<double>(), 1.0);
+    for (const auto& ts : std::vector<ma::TimeSequence*>{{&m1, &m2}})
+    {
+      auto ts2 = rootOut.findChild<ma::TimeSequence*>(ts->name());
+      TS_ASSERT(ts2 != nullptr);
+      if (ts2 == nullptr) continue;
+      TS_ASSERT_EQUALS(ts2->samples(), ts->samples());
+      for (unsigned i = 0 ; i < 100 ; ++i)
+      {
+        TS_ASSERT_EQUALS(ts2->data()[i+300] < 0.0, ts->data()[i+300] < 0.0);
+        if (ts->data()[i+300] < 0.0) continue;
+        for (unsigned j = 0 ; j < 3 ; ++j)
+          TS_ASSERT_DELTA(ts2->data()[i+j*100], ts->data()[i+j*100], pointScale);
+      }
+    }
+    for (const auto& ts : std::vector<ma::TimeSequence*>{{&a1, &a2}})
+    {
+      auto ts2 = rootOut.findChild<ma::TimeSequence*>(ts->name());
+      TS_ASSERT(ts2 != nullptr);
+      if (ts2 == nullptr) continue;
+      TS_ASSERT_EQUALS(ts2->samples(), ts->samples());
+      const double maxAbsoluteValue = fabs(*std::max_element(ts->data(), ts->data() + 200, [](double lhs, double rhs){return fabs(lhs) < fabs(rhs);}));
+      for (unsigned i = 0 ; i < 200 ; ++i)
+        TS_ASSERT_DELTA(ts2->data()[i], ts->data()[i], maxAbsoluteValue / 32767.0);
+    }
+    // The data section is twice smaller
+    auto dataSectionSize = [](const char* filepath) -> long {
+      std::ifstream file(filepath, std::ios::binary);
+      uint16_t dataStartBlock = 0;
+      file.seekg(16);
+      file.read(reinterpret_cast<char*>(&dataStartBlock), 2);
+      file.seekg(0, std::ios::end);
+      return static_cast<long>(file.tellg()) - 512 * (dataStartBlock - 1);
+    };
+    TS_ASSERT_EQUALS(dataSectionSize(OPENMA_TDD_PATH_OUT("c3d/integer_float.c3d")), (2 * 4 + 2 * 2) * 100 * 4);
+    TS_ASSERT_EQUALS(dataSectionSize(OPENMA_TDD_PATH_OUT("c3d/integer.c3d")), (2 * 4 + 2 * 2) * 100 * 2);
+  }
+  
+  CXXTEST_TEST(writeEmptyStrings)
+  {
+    ma::Node rootIn("rootIn"), rootOut("rootOut");
+    ma::Trial foo("foo", &rootIn);
+    ma::TimeSequence m1("m1", 4, 10, 100.0, 0.0, ma::TimeSequence::Position, "mm", foo.timeSequences());
+    foo.setProperty("VENDOR:EMPTY", std::vector<std::string>{"",""});
+    if (!c3dhandlertest_write("", OPENMA_TDD_PATH_OUT("c3d/empty_strings.c3d"), &rootIn)) return;
+    if (!c3dhandlertest_read("", OPENMA_TDD_PATH_OUT("c3d/empty_strings.c3d"), &rootOut)) return;
+    auto trial = rootOut.findChild<ma::Trial*>();
+    TS_ASSERT(trial != nullptr);
+    if (trial == nullptr) return;
+    TS_ASSERT_EQUALS(trial->property("VENDOR:EMPTY").cast<std::vector<std::string>>(), (std::vector<std::string>{"",""}));
+  };
+  
+  CXXTEST_TEST(writeStreamedAppend)
+  {
+    // Reference trial written at once
+    ma::Node rootIn("rootIn"), rootOut("rootOut");
+    ma::Trial foo("foo", &rootIn);
+    ma::TimeSequence m1("m1", 4, 50, 100.0, 0.0, ma::TimeSequence::Position, "mm", foo.timeSequences());
+    ma::TimeSequence a1("a1", 1, 100, 200.0, 0.0, ma::TimeSequence::Analog, "V", 1.0, 0.0, std::array<double,2>{{-10.0, 10.0}}, foo.timeSequences());
+    for (unsigned i = 0 ; i < 50 ; ++i)
+    {
+      for (unsigned j = 0 ; j < 3 ; ++j)
+        m1.data()[i+j*50] = 0.5 * static_cast<double>(i + j);
+      m1.data()[i+150] = (i % 7 == 0) ? -1.0 : 0.0;
+    }
+    for (unsigned i = 0 ; i < 100 ; ++i)
+      a1.data()[i] = 0.01 * static_cast<double>(i);
+    if (!c3dhandlertest_write("", OPENMA_TDD_PATH_OUT("c3d/appended_ref.c3d"), &rootIn)) return;
+    // Same content streamed, closed, and then extended
+    ma::Trial schema("foo");
+    ma::TimeSequence s1("m1", 4, 0, 100.0, 0.0, ma::TimeSequence::Position, "mm", schema.timeSequences());
+    ma::TimeSequence s2("a1", 1, 0, 200.0, 0.0, ma::TimeSequence::Analog, "V", 1.0, 0.0, std::array<double,2>{{-10.0, 10.0}}, schema.timeSequences());
+    auto appendFrames = [&](ma::io::C3DStreamWriter& writer, unsigned first, unsigned num) {
+      std::vector<double> points(4 * num), analogs(2 * num);
+      for (unsigned c = 0 ; c < 4 ; ++c)
+        std::copy_n(m1.data() + c * 50 + first, num, points.data() + c * num);
+      std::copy_n(a1.data() + 2 * first, 2 * num, analogs.data());
+      return writer.appendFrames(num, points.data(), analogs.data());
+    };
+    ma::io::File file;
+    file.open(OPENMA_TDD_PATH_OUT("c3d/appended.c3d"), ma::io::Mode::Out);
+    ma::io::C3DStreamWriter writer(&file);
+    TS_ASSERT_EQUALS(writer.open(&schema), true);
+    TS_ASSERT_EQUALS(appendFrames(writer, 0, 20), true);
+    TS_ASSERT_EQUALS(writer.close(), true);
+    file.close();
+    // A device open only in write mode cannot be extended
+    file.open(OPENMA_TDD_PATH_OUT("c3d/appended_wo.c3d"), ma::io::Mode::Out);
+    TS_ASSERT_EQUALS(writer.append(&schema), false);
+    TS_ASSERT_EQUALS(writer.errorCode(), ma::io::Error::InvalidData);
+    file.close();
+    for (unsigned first : {20u, 35u})
+    {
+      file.open(OPENMA_TDD_PATH_OUT("c3d/appended.c3d"), ma::io::Mode::In | ma::io::Mode::Out);
+      TS_ASSERT_EQUALS(writer.append(&schema), true);
+      TS_ASSERT_EQUALS(writer.errorCode(), ma::io::Error::None);
+      TS_ASSERT_EQUALS(writer.frames(), static_cast<size_t>(first));
+      TS_ASSERT_EQUALS(writer.pointLabels(), std::vector<std::string>{"m1"});
+      TS_ASSERT_EQUALS(writer.analogLabels(), std::vector<std::string>{"a1"});
+      TS_ASSERT_EQUALS(appendFrames(writer, first, 15), true);
+      TS_ASSERT_EQUALS(writer.frames(), static_cast<size_t>(first + 15));
+      TS_ASSERT_EQUALS(writer.close(), true);
+      file.close();
+    }
+    // Both files must be identical
+    std::ifstream ref(OPENMA_TDD_PATH_OUT("c3d/appended_ref.c3d"), std::ios::binary), appended(OPENMA_TDD_PATH_OUT("c3d/appended.c3d"), std::ios::binary);
+    std::vector<char> refBytes((std::istreambuf_iterator<char>(ref)), std::istreambuf_iterator<char>());
+    std::vector<char> appendedBytes((std::istreambuf_iterator<char>(appended)), std::istreambuf_iterator<char>());
+    TS_ASSERT_EQUALS(appendedBytes.size(), refBytes.size());
+    TS_ASSERT(appendedBytes == refBytes);
+    // A different schema is rejected and the file is not modified
+    ma::Trial other("foo");
+    ma::TimeSequence o1("m2", 4, 0, 100.0, 0.0, ma::TimeSequence::Position, "mm", other.timeSequences());
+    ma::TimeSequence o2("a1", 1, 0, 200.0, 0.0, ma::TimeSequence::Analog, "V", 1.0, 0.0, std::array<double,2>{{-10.0, 10.0}}, other.timeSequences());
+    file.open(OPENMA_TDD_PATH_OUT("c3d/appended.c3d"), ma::io::Mode::In | ma::io::Mode::Out);
+    TS_ASSERT_EQUALS(writer.append(&other), false);
+    TS_ASSERT_EQUALS(writer.errorCode(), ma::io::Error::InvalidData);
+    TS_ASSERT_EQUALS(writer.isOpen(), false);
+    file.close();
+    std::ifstream rejected(OPENMA_TDD_PATH_OUT("c3d/appended.c3d"), std::ios::binary);
+    std::vector<char> rejectedBytes((std::istreambuf_iterator<char>(rejected)), std::istreambuf_iterator<char>());
+    TS_ASSERT(rejectedBytes == refBytes);
+    // The extended file can be read back
+    if (!c3dhandlertest_read("", OPENMA_TDD_PATH_OUT("c3d/appended.c3d"), &rootOut)) return;
+    auto m1r = rootOut.findChild<ma::TimeSequence*>("m1");
+    auto a1r = rootOut.findChild<ma::TimeSequence*>("a1");
+    TS_ASSERT(m1r != nullptr);
+    TS_ASSERT(a1r != nullptr);
+    if ((m1r == nullptr) || (a1r == nullptr)) return;
+    TS_ASSERT_EQUALS(m1r->samples(), 50u);
+    TS_ASSERT_EQUALS(a1r->samples(), 100u);
+    for (unsigned i = 0 ; i < m1.elements() ; ++i)
+      TS_ASSERT_DELTA(m1r->data()[i], m1.data()[i], 1e-5);
+    for (unsigned i = 0 ; i < a1.elements() ; ++i)
+      TS_ASSERT_DELTA(a1r->data()[i], a1.data()[i], 1e-5);
+  };
+  
+  CXXTEST_TEST(writeAppendOption)
+  {
+    // Two trials with the same channels and start time, but different samples
+    ma::Node first("first"), second("second"), rootOut("rootOut");
+    c3dwritertest_generate_trial(&first, 12, 4, 0.0);
+    c3dwritertest_generate_trial(&second, 8, 4, 100.0);
+    if (!c3dhandlertest_write("", OPENMA_TDD_PATH_OUT("c3d/append_option.c3d"), &first)) return;
+    ma::io::File file;
+    file.open(OPENMA_TDD_PATH_OUT("c3d/append_option.c3d"), ma::io::Mode::In | ma::io::Mode::Out);
+    ma::io::HandlerWriter writer(&file, "org.c3d");
+    writer.setOptions({{"append", true}});
+    TS_ASSERT_EQUALS(writer.write(&second), true);
+    TS_ASSERT_EQUALS(writer.errorCode(), ma::io::Error::None);
+    file.close();
+    if (!c3dhandlertest_read("", OPENMA_TDD_PATH_OUT("c3d/append_option.c3d"), &rootOut)) return;
+    auto trial = rootOut.findChild<ma::Trial*>();
+    TS_ASSERT(trial != nullptr);
+    if (trial == nullptr) return;
+    TS_ASSERT_EQUALS(trial->property("POINT:FRAMES").cast<int>(), 20);
+    auto m1 = rootOut.findChild<ma::TimeSequence*>("m1");
+    auto a1 = rootOut.findChild<ma::TimeSequence*>("a1");
+    TS_ASSERT(m1 != nullptr);
+    TS_ASSERT(a1 != nullptr);
+    if ((m1 == nullptr) || (a1 == nullptr)) return;
+    TS_ASSERT_EQUALS(m1->samples(), 20u);
+    TS_ASSERT_EQUALS(a1->samples(), 80u);
+    TS_ASSERT_DELTA(m1->data()[11], 11.0, 1e-5);
+    TS_ASSERT_DELTA(m1->data()[12], 100.0, 1e-5);
+    TS_ASSERT_DELTA(m1->data()[20+19], 108.0, 1e-5);
+    TS_ASSERT_DELTA(a1->data()[47], 11.75, 1e-5);
+    TS_ASSERT_DELTA(a1->data()[48], 100.0, 1e-5);
+    // The number of frames to append must be consistent
+    ma::Node wrong("wrong");
+    c3dwritertest_generate_trial(&wrong, 5, 4, 0.0);
+    wrong.findChild<ma::TimeSequence*>("a1")->resize(3);
+    file.open(OPENMA_TDD_PATH_OUT("c3d/append_option.c3d"), ma::io::Mode::In | ma::io::Mode::Out);
+    writer.setDevice(&file);
+    TS_ASSERT_EQUALS(writer.write(&wrong), false);
+    TS_ASSERT_EQUALS(writer.errorCode(), ma::io::Error::InvalidData);
+    file.close();
+  };
+  
+  CXXTEST_TEST(writeAppendSchema)
+  {
+    // The stored file has a description and extra parameters which enlarge its parameter section
+    ma::Node stored("stored"), appended("appended"), other("other"), rootOut("rootOut");
+    auto trial = c3dwritertest_generate_trial(&stored, 10, 2, 0.0);
+    trial->timeSequences()->findChild<ma::TimeSequence*>("m1")->setDescription("First marker");
+    trial->setProperty("VENDOR:NOTES", ma::Any(std::vector<std::string>(10, std::string(100, 'x'))));
+    if (!c3dhandlertest_write("", OPENMA_TDD_PATH_OUT("c3d/append_schema.c3d"), &stored)) return;
+    // Only the content describing the data section is compared
+    c3dwritertest_generate_trial(&appended, 5, 2, 100.0);
+    ma::io::File file;
+    file.open(OPENMA_TDD_PATH_OUT("c3d/append_schema.c3d"), ma::io::Mode::In | ma::io::Mode::Out);
+    ma::io::HandlerWriter writer(&file, "org.c3d");
+    writer.setOptions({{"append", true}});
+    TS_ASSERT_EQUALS(writer.write(&appended), true);
+    TS_ASSERT_EQUALS(writer.errorMessage(), "");
+    file.close();
+    // A different scale is rejected
+    c3dwritertest_generate_trial(&other, 5, 2, 100.0, 2.0);
+    file.open(OPENMA_TDD_PATH_OUT("c3d/append_schema.c3d"), ma::io::Mode::In | ma::io::Mode::Out);
+    writer.setDevice(&file);
+    TS_ASSERT_EQUALS(writer.write(&other), false);
+    TS_ASSERT_EQUALS(writer.errorCode(), ma::io::Error::InvalidData);
+    TS_ASSERT_DIFFERS(writer.errorMessage().find("ANALOG:SCALE"), std::string::npos);
+    file.close();
+    if (!c3dhandlertest_read("", OPENMA_TDD_PATH_OUT("c3d/append_schema.c3d"), &rootOut)) return;
+    auto trialOut = rootOut.findChild<ma::Trial*>();
+    TS_ASSERT(trialOut != nullptr);
+    if (trialOut == nullptr) return;
+    TS_ASSERT_EQUALS(trialOut->property("POINT:FRAMES").cast<int>(), 15);
+    TS_ASSERT_EQUALS(trialOut->property("VENDOR:NOTES").cast<std::vector<std::string>>().size(), 10ul);
+    auto m1 = rootOut.findChild<ma::TimeSequence*>("m1");
+    auto a1 = rootOut.findChild<ma::TimeSequence*>("a1");
+    TS_ASSERT(m1 != nullptr);
+    TS_ASSERT(a1 != nullptr);
+    if ((m1 == nullptr) || (a1 == nullptr)) return;
+    TS_ASSERT_EQUALS(m1->description(), "First marker");
+    TS_ASSERT_EQUALS(m1->samples(), 15u);
+    TS_ASSERT_EQUALS(a1->samples(), 30u);
+    TS_ASSERT_DELTA(m1->data()[9], 9.0, 1e-5);
+    TS_ASSERT_DELTA(m1->data()[10], 100.0, 1e-5);
+    TS_ASSERT_DELTA(m1->data()[15+14], 105.0, 1e-5);
+    TS_ASSERT_DELTA(a1->data()[19], 9.5, 1e-5);
+    TS_ASSERT_DELTA(a1->data()[20], 100.0, 1e-5);
+  };
+  
+  CXXTEST_TEST(writeByteOrder)
+  {
+    ma::Node rootIn("rootIn");
+    ma::Trial foo("foo", &rootIn);
+    ma::TimeSequence m1("m1", 4, 10, 100.0, 0.0, ma::TimeSequence::Position, "mm", foo.timeSequences());
+    ma::TimeSequence a1("a1", 1, 20, 200.0, 0.0, ma::TimeSequence::Analog, "V", 1.0, 0.0, std::array<double,2>{{-10.0, 10.0}}, foo.timeSequences());
+    for (unsigned i = 0 ; i < 10 ; ++i)
+    {
+      for (unsigned j = 0 ; j < 3 ; ++j)
+        m1.data()[i+j*10] = 1.5 * static_cast<double>(i) - 10.0 * static_cast<double>(j);
+      m1.data()[i+30] = 0.0;
+    }
+    for (unsigned i = 0 ; i < 20 ; ++i)
+      a1.data()[i] = 0.125 * static_cast<double>(i);
+    // Byte order, integer format, expected processor type
+    const std::vector<std::tuple<std::string,bool,int>> cases{
+      std::make_tuple("IEEELittleEndian", false, 84), std::make_tuple("VAXLittleEndian", false, 85), std::make_tuple("IEEEBigEndian", false, 86),
+      std::make_tuple("VAXLittleEndian", true, 85), std::make_tuple("IEEEBigEndian", true, 86)
+    };
+    for (const auto& c : cases)
+    {
+      const std::string filepath = OPENMA_TDD_PATH_OUT("c3d/byteorder_") + std::get<0>(c) + (std::get<1>(c) ? "_integer.c3d" : ".c3d");
+      ma::Node rootOut("rootOut");
+      if (!c3dhandlertest_write(filepath.c_str(), filepath.c_str(), &rootIn, {{"byteOrder", std::get<0>(c)}, {"integerFormat", std::get<1>(c)}})) return;
+      // Processor type stored in the parameter section
+      std::ifstream ifs(filepath, std::ios::binary);
+      ifs.seekg(512 + 3);
+      TSM_ASSERT_EQUALS(filepath, ifs.get(), std::get<2>(c));
+      ifs.close();
+      if (!c3dhandlertest_read(filepath.c_str(), filepath.c_str(), &rootOut)) return;
+      for (const auto& ts : std::vector<ma::TimeSequence*>{{&m1, &a1}})
+      {
+        auto ts2 = rootOut.findChild<ma::TimeSequence*>(ts->name());
+        TSM_ASSERT(filepath, ts2 != nullptr);
+        if (ts2 == nullptr) continue;
+        TSM_ASSERT_EQUALS(filepath, ts2->samples(), ts->samples());
+        const unsigned components = (ts->type() == ma::TimeSequence::Position) ? 3 : 1;
+        for (unsigned i = 0 ; i < ts->samples() * components ; ++i)
+          TSM_ASSERT_DELTA(filepath, ts2->data()[i], ts->data()[i], 5e-3);
+      }
+    }
+    // Frames appended in the byte order of the file
+    ma::io::File file;
+    file.open(OPENMA_TDD_PATH_OUT("c3d/byteorder_IEEEBigEndian.c3d"), ma::io::Mode::In | ma::io::Mode::Out);
+    ma::io::HandlerWriter writer(&file, "org.c3d");
+    writer.setOptions({{"append", true}, {"byteOrder", std::string("IEEEBigEndian")}});
+    TS_ASSERT_EQUALS(writer.write(&rootIn), true);
+    TS_ASSERT_EQUALS(writer.errorCode(), ma::io::Error::None);
+    file.close();
+    ma::Node rootAppend("rootAppend");
+    if (!c3dhandlertest_read("", OPENMA_TDD_PATH_OUT("c3d/byteorder_IEEEBigEndian.c3d"), &rootAppend)) return;
+    auto trial = rootAppend.findChild<ma::Trial*>();
+    TS_ASSERT(trial != nullptr);
+    if (trial == nullptr) return;
+    TS_ASSERT_EQUALS(trial->property("POINT:FRAMES").cast<int>(), 20);
+    auto m2 = rootAppend.findChild<ma::TimeSequence*>("m1");
+    TS_ASSERT(m2 != nullptr);
+    if (m2 == nullptr) return;
+    TS_ASSERT_EQUALS(m2->samples(), 20u);
+    TS_ASSERT_DELTA(m2->data()[15], m1.data()[5], 1e-5);
+    // Unknown byte order
+    file.open(OPENMA_TDD_PATH_OUT("c3d/byteorder_unknown.c3d"), ma::io::Mode::Out);
+    writer.setDevice(&file);
+    writer.setOptions({{"byteOrder", std::string("PDP")}});
+    TS_ASSERT_EQUALS(writer.write(&rootIn), false);
+    file.close();
+  };
 };
 
 CXXTEST_SUITE_REGISTRATION(C3DWriterTest)
@@ -166,4 +659,13 @@ CXXTEST_TEST_REGISTRATION(C3DWriterTest, queryOkThree)
 CXXTEST_TEST_REGISTRATION(C3DWriterTest, sample01Rewrited)
 CXXTEST_TEST_REGISTRATION(C3DWriterTest, sample09Rewrited)
 CXXTEST_TEST_REGISTRATION(C3DWriterTest, writePoint256)
-CXXTEST_TEST_REGISTRATION(C3DWriterTest, writeAnalogOnly)
\ No newline at end of file
+CXXTEST_TEST_REGISTRATION(C3DWriterTest, writeAnalogOnly)
+CXXTEST_TEST_REGISTRATION(C3DWriterTest, writePointsAndAnalogs)
+CXXTEST_TEST_REGISTRATION(C3DWriterTest, writeStreamed)
+CXXTEST_TEST_REGISTRATION(C3DWriterTest, writeStreamedCloseFailure)
+CXXTEST_TEST_REGISTRATION(C3DWriterTest, writeIntegerFormat)
+CXXTEST_TEST_REGISTRATION(C3DWriterTest, writeEmptyStrings)
+CXXTEST_TEST_REGISTRATION(C3DWriterTest, writeStreamedAppend)
+CXXTEST_TEST_REGISTRATION(C3DWriterTest, writeAppendOption)
+CXXTEST_TEST_REGISTRATION(C3DWriterTest, writeAppendSchema)
+CXXTEST_TEST_REGISTRATION(C3DWriterTest, writeByteOrder)
\ No newline at end of file
@@ -0,0 +1,302 @@
+#include <cxxtest/TestDrive.h>
+
+#include <openma/io/handlerreader.h>
+#include <openma/io/handlerwriter.h>
+#include <openma/io/file.h>
+#include <openma/io/buffer.h>
+#include <openma/base/node.h>
+#include <openma/base/trial.h>
+#include <openma/base/timesequence.h>
+#include <openma/base/event.h>
+#include <openma/instrument/forceplatetype2.h>
+
+#include <fstream>
+#include <iterator>
+#include <algorithm>
+#include <limits>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#include "test_file_path.h"
+
+// Pseudo random noise reproducible between two executions
+double columnartest_noise(unsigned i)
+{
+  return static_cast<double>((i * 2654435761u) % 1000u) / 1000.0 - 0.5;
+};
+
+void columnartest_generate_trial(ma::Node* root, unsigned frames)
+{
+  auto trial = new ma::Trial("foo", root);
+  trial->setProperty("POINT:RATE", 100.0);
+  for (unsigned m = 0 ; m < 4 ; ++m)
+  {
+    auto marker = new ma::TimeSequence("m" + std::to_string(m+1), 4, frames, 100.0, 0.0, ma::TimeSequence::Position, "mm", trial->timeSequences());
+    for (unsigned i = 0 ; i < frames ; ++i)
+    {
+      for (unsigned j = 0 ; j < 3 ; ++j)
+        marker->data()[i+j*frames] = 400.0 * std::sin(0.01 * static_cast<double>(i + 100 * j) + m) + 100.0 * j + 0.05 * columnartest_noise(i + j * frames + m);
+      marker->data()[i+3*frames] = (i % 97 == 0) ? -1.0 : 0.0;
+    }
+  }
+  auto fp = new ma::instrument::ForcePlateType2("FP1", trial->hardwares());
+  for (unsigned a = 0 ; a < 6 ; ++a)
+  {
+    auto analog = new ma::TimeSequence("a" + std::to_string(a+1), 1, 10 * frames, 1000.0, 0.0, ma::TimeSequence::Analog, "V", 1.0, 0.0, std::array<double,2>{{-10.0, 10.0}}, trial->timeSequences());
+    for (unsigned i = 0 ; i < analog->samples() ; ++i)
+      analog->data()[i] = 2.5 * std::sin(0.002 * static_cast<double>(i) + a) + 0.005 * columnartest_noise(i + a * 7919);
+    fp->setChannel(a, analog);
+  }
+  auto empty = new ma::TimeSequence("zero", 1, 10 * frames, 1000.0, 0.0, ma::TimeSequence::Analog, "V", 1.0, 0.0, std::array<double,2>{{-10.0, 10.0}}, trial->timeSequences());
+  std::fill(empty->data(), empty->data() + empty->elements(), 0.0);
+  new ma::Event("RHS", 1.25, "Right", "John", trial->events());
+};
+
+bool columnartest_write(const char* filepath, ma::Node* root, const std::string& format = "openma.cta", const std::unordered_map<std::string, ma::Any>& options = {})
+{
+  ma::io::File file;
+  file.open(filepath, ma::io::Mode::Out);
+  ma::io::HandlerWriter writer(&file, format);
+  writer.setOptions(options);
+  bool ret = writer.write(root);
+  TS_ASSERT_EQUALS(ret, true);
+  TS_ASSERT_EQUALS(writer.errorCode(), ma::io::Error::None);
+  TS_ASSERT_EQUALS(writer.errorMessage(), "");
+  return ret;
+};
+
+bool columnartest_read(const char* filepath, ma::Node* root, const std::unordered_map<std::string, ma::Any>& options = {})
+{
+  ma::io::File file;
+  file.open(filepath, ma::io::Mode::In);
+  ma::io::HandlerReader reader(&file);
+  reader.setOptions(options);
+  bool ret = reader.read(root);
+  TS_ASSERT_EQUALS(ret, true);
+  TS_ASSERT_EQUALS(reader.format(), "openma.cta");
+  TS_ASSERT_EQUALS(reader.errorMessage(), "");
+  return ret;
+};
+
+double columnartest_max_error(const ma::TimeSequence* lhs, const ma::TimeSequence* rhs, size_t offset = 0)
+{
+  double error = 0.0;
+  for (unsigned c = 0 ; c < lhs->components() ; ++c)
+  {
+    for (unsigned i = 0 ; i < lhs->samples() ; ++i)
+      error = std::max(error, std::fabs(lhs->data()[i + c * lhs->samples()] - rhs->data()[i + offset + c * rhs->samples()]));
+  }
+  return error;
+};
+
+CXXTEST_SUITE(ColumnarTest)
+{
+  CXXTEST_TEST(capability)
+  {
+    ma::io::HandlerWriter writer;
+    auto formats = writer.availableFormats();
+    TS_ASSERT_EQUALS(std::find(formats.cbegin(), formats.cend(), "openma.cta") != formats.cend(), true);
+    ma::io::HandlerReader reader;
+    formats = reader.availableFormats();
+    TS_ASSERT_EQUALS(std::find(formats.cbegin(), formats.cend(), "openma.cta") != formats.cend(), true);
+  };
+  
+  CXXTEST_TEST(detectExtension)
+  {
+    ma::io::File file;
+    file.open(OPENMA_TDD_PATH_OUT("columnar/detect.cta"), ma::io::Mode::Out);
+    ma::io::HandlerWriter writer(&file);
+    TS_ASSERT_EQUALS(writer.canWrite(), true);
+    TS_ASSERT_EQUALS(writer.format(), "openma.cta");
+  };
+  
+  CXXTEST_TEST(roundTrip)
+  {
+    ma::Node rootIn("rootIn"), rootOut("rootOut");
+    columnartest_generate_trial(&rootIn, 1000);
+    // Not finite samples are stored too
+    auto m4 = rootIn.findChild<ma::TimeSequence*>("m4");
+    m4->data()[10] = std::numeric_limits<double>::quiet_NaN();
+    m4->data()[20] = std::numeric_limits<double>::infinity();
+    if (!columnartest_write(OPENMA_TDD_PATH_OUT("columnar/roundtrip.cta"), &rootIn)) return;
+    if (!columnartest_read(OPENMA_TDD_PATH_OUT("columnar/roundtrip.cta"), &rootOut)) return;
+    auto trialOut = rootOut.findChild<ma::Trial*>();
+    TS_ASSERT(trialOut != nullptr);
+    if (trialOut == nullptr) return;
+    TS_ASSERT_EQUALS(trialOut->property("POINT:RATE").cast<double>(), 100.0);
+    auto tssIn = rootIn.findChildren<ma::TimeSequence*>();
+    auto tssOut = trialOut->timeSequences()->findChildren<ma::TimeSequence*>();
+    TS_ASSERT_EQUALS(tssOut.size(), 11ul);
+    if (tssOut.size() != tssIn.size()) return;
+    for (size_t i = 0 ; i < tssIn.size() ; ++i)
+    {
+      TS_ASSERT_EQUALS(tssOut[i]->name(), tssIn[i]->name());
+      TS_ASSERT_EQUALS(tssOut[i]->dimensions(), tssIn[i]->dimensions());
+      TS_ASSERT_EQUALS(tssOut[i]->samples(), tssIn[i]->samples());
+      TS_ASSERT_EQUALS(tssOut[i]->sampleRate(), tssIn[i]->sampleRate());
+      // By default, the samples are restored exactly (bit patterns compared to include the not finite values)
+      TS_ASSERT_EQUALS(memcmp(tssOut[i]->data(), tssIn[i]->data(), tssIn[i]->elements() * sizeof(double)), 0);
+    }
+    auto m4Out = trialOut->findChild<ma::TimeSequence*>("m4");
+    TS_ASSERT_EQUALS(std::isnan(m4Out->data()[10]), true);
+    TS_ASSERT_EQUALS(m4Out->data()[20], std::numeric_limits<double>::infinity());
+    TS_ASSERT_EQUALS(m4Out->data()[11], m4->data()[11]);
+    // Constant columns are restored exactly
+    TS_ASSERT_EQUALS(trialOut->findChild<ma::TimeSequence*>("zero")->data()[5000], 0.0);
+    // Force plate channels
+    auto fp = trialOut->hardwares()->findChild<ma::instrument::ForcePlateType2*>("FP1");
+    TS_ASSERT(fp != nullptr);
+    if (fp == nullptr) return;
+    for (unsigned i = 0 ; i < 6 ; ++i)
+      TS_ASSERT_EQUALS(fp->channel(i), tssOut[4+i]);
+    TS_ASSERT_EQUALS(trialOut->events()->findChildren<ma::Event*>().size(), 1ul);
+  };
+  
+  CXXTEST_TEST(resolution)
+  {
+    ma::Node rootIn("rootIn"), rootOut("rootOut");
+    columnartest_generate_trial(&rootIn, 500);
+    if (!columnartest_write(OPENMA_TDD_PATH_OUT("columnar/resolution.cta"), &rootIn, "openma.cta", {{"resolution", 0.01}})) return;
+    if (!columnartest_read(OPENMA_TDD_PATH_OUT("columnar/resolution.cta"), &rootOut)) return;
+    for (const auto& name : {"m1", "m2", "a1", "a6"})
+    {
+      auto tsOut = rootOut.findChild<ma::TimeSequence*>(name);
+      TS_ASSERT(tsOut != nullptr);
+      if (tsOut == nullptr) continue;
+      TS_ASSERT_LESS_THAN_EQUALS(columnartest_max_error(tsOut, rootIn.findChild<ma::TimeSequence*>(name)), 0.005 + 1e-12);
+    }
+  };
+  
+  CXXTEST_TEST(readSelection)
+  {
+    ma::Node rootIn("rootIn"), rootOut("rootOut"), rootMeta("rootMeta");
+    columnartest_generate_trial(&rootIn, 10000);
+    if (!columnartest_write(OPENMA_TDD_PATH_OUT("columnar/selection.cta"), &rootIn)) return;
+    // The frames are relative to the lowest sample rate and cover several blocks
+    if (!columnartest_read(OPENMA_TDD_PATH_OUT("columnar/selection.cta"), &rootOut, {{"channels", std::vector<std::string>{"m2","a3"}}, {"firstFrame", 5000}, {"lastFrame", 8999}})) return;
+    auto tssOut = rootOut.findChildren<ma::TimeSequence*>();
+    TS_ASSERT_EQUALS(tssOut.size(), 2ul);
+    auto m2 = rootOut.findChild<ma::TimeSequence*>("m2");
+    auto a3 = rootOut.findChild<ma::TimeSequence*>("a3");
+    TS_ASSERT(m2 != nullptr);
+    TS_ASSERT(a3 != nullptr);
+    if ((m2 == nullptr) || (a3 == nullptr)) return;
+    TS_ASSERT_EQUALS(m2->samples(), 4000u);
+    TS_ASSERT_EQUALS(a3->samples(), 40000u);
+    TS_ASSERT_DELTA(m2->startTime(), 50.0, 1e-9);
+    TS_ASSERT_DELTA(a3->startTime(), 50.0, 1e-9);
+    TS_ASSERT_EQUALS(columnartest_max_error(m2, rootIn.findChild<ma::TimeSequence*>("m2"), 5000), 0.0);
+    TS_ASSERT_EQUALS(columnartest_max_error(a3, rootIn.findChild<ma::TimeSequence*>("a3"), 50000), 0.0);
+    // The force plate keeps only its selected channel
+    auto fp = rootOut.findChild<ma::instrument::ForcePlateType2*>("FP1");
+    TS_ASSERT(fp != nullptr);
+    if (fp != nullptr)
+    {
+      TS_ASSERT_EQUALS(fp->channel(2), a3);
+      TS_ASSERT(fp->channel(0) == nullptr);
+    }
+    // Metadata only
+    if (!columnartest_read(OPENMA_TDD_PATH_OUT("columnar/selection.cta"), &rootMeta, {{"metadata", true}})) return;
+    auto a1 = rootMeta.findChild<ma::TimeSequence*>("a1");
+    TS_ASSERT(a1 != nullptr);
+    if (a1 == nullptr) return;
+    TS_ASSERT_EQUALS(a1->samples(), 0u);
+    TS_ASSERT_EQUALS(a1->property("storedSamples").cast<unsigned>(), 100000u);
+  };
+  
+  CXXTEST_TEST(compressionRatio)
+  {
+    ma::Node rootIn("rootIn");
+    columnartest_generate_trial(&rootIn, 2000);
+    if (!columnartest_write(OPENMA_TDD_PATH_OUT("columnar/ratio.cta"), &rootIn)) return;
+    if (!columnartest_write(OPENMA_TDD_PATH_OUT("columnar/ratio_quantized.cta"), &rootIn, "openma.cta", {{"resolution", 0.001}})) return;
+    if (!columnartest_write(OPENMA_TDD_PATH_OUT("columnar/ratio.c3d"), &rootIn, "org.c3d")) return;
+    std::ifstream cta(OPENMA_TDD_PATH_OUT("columnar/ratio.cta"), std::ios::binary | std::ios::ate), quantized(OPENMA_TDD_PATH_OUT("columnar/ratio_quantized.cta"), std::ios::binary | std::ios::ate), c3d(OPENMA_TDD_PATH_OUT("columnar/ratio.c3d"), std::ios::binary | std::ios::ate);
+    // Lossless: smaller than the samples stored as double
+    size_t raw = 0;
+    for (const auto& ts : rootIn.findChildren<ma::TimeSequence*>())
+      raw += ts->elements() * sizeof(double);
+    TS_ASSERT_LESS_THAN(static_cast<long>(cta.tellg()), static_cast<long>(raw));
+    // Quantized: at least twice smaller than the C3D format with float values
+    TS_ASSERT_LESS_THAN(2 * static_cast<long>(quantized.tellg()), static_cast<long>(c3d.tellg()));
+  };
+  
+  CXXTEST_TEST(losslessSize)
+  {
+    // Samples coming from single precision values (e.g. read from a C3D file)
+    ma::Node rootIn("rootIn");
+    columnartest_generate_trial(&rootIn, 10000);
+    for (auto ts : rootIn.findChildren<ma::TimeSequence*>())
+    {
+      for (unsigned i = 0 ; i < ts->elements() ; ++i)
+        ts->data()[i] = static_cast<float>(ts->data()[i]);
+    }
+    if (!columnartest_write(OPENMA_TDD_PATH_OUT("columnar/lossless.cta"), &rootIn)) return;
+    if (!columnartest_write(OPENMA_TDD_PATH_OUT("columnar/lossless.c3d"), &rootIn, "org.c3d")) return;
+    std::ifstream cta(OPENMA_TDD_PATH_OUT("columnar/lossless.cta"), std::ios::binary | std::ios::ate), c3d(OPENMA_TDD_PATH_OUT("columnar/lossless.c3d"), std::ios::binary | std::ios::ate);
+    // Default (lossless) mode: smaller than the C3D format with float values
+    // NOTE: The decoding time compared with the C3D reader is measured by the benchmark io_bench.
+    TS_ASSERT_LESS_THAN(static_cast<long>(cta.tellg()), static_cast<long>(c3d.tellg()));
+  };
+  
+  CXXTEST_TEST(truncatedFile)
+  {
+    ma::Node rootIn("rootIn"), rootOut("rootOut");
+    columnartest_generate_trial(&rootIn, 1000);
+    ma::io::Buffer buffer;
+    buffer.setName("columnar");
+    buffer.open(ma::io::Mode::Out);
+    ma::io::HandlerWriter writer(&buffer, "openma.cta");
+    TS_ASSERT_EQUALS(writer.write(&rootIn), true);
+    ma::io::Buffer::Size size = 0;
+    std::unique_ptr<char[]> data(buffer.release(&size));
+    ma::io::Buffer input;
+    input.setName("truncated");
+    input.open(data.get(), size - 100, ma::io::Mode::In);
+    ma::io::HandlerReader reader(&input, "openma.cta");
+    TS_ASSERT_EQUALS(reader.read(&rootOut), false);
+    TS_ASSERT_EQUALS(reader.errorCode(), ma::io::Error::Device);
+    TS_ASSERT_EQUALS(rootOut.hasChildren(), false);
+  };
+  
+  CXXTEST_TEST(corruptedHeader)
+  {
+    ma::Node rootIn("rootIn");
+    columnartest_generate_trial(&rootIn, 1000);
+    ma::io::Buffer buffer;
+    buffer.setName("columnar");
+    buffer.open(ma::io::Mode::Out);
+    ma::io::HandlerWriter writer(&buffer, "openma.cta");
+    TS_ASSERT_EQUALS(writer.write(&rootIn), true);
+    ma::io::Buffer::Size size = 0;
+    std::unique_ptr<char[]> data(buffer.release(&size));
+    // Size of the metadata (offset 16) and number of blocks (offset 24) larger than the file
+    for (const size_t offset : {16, 24})
+    {
+      std::vector<char> corrupted(data.get(), data.get() + size);
+      const uint64_t huge = uint64_t(1) << 60;
+      memcpy(corrupted.data() + offset, &huge, sizeof(huge));
+      ma::Node rootOut("rootOut");
+      ma::io::Buffer input;
+      input.setName("corrupted");
+      input.open(corrupted.data(), corrupted.size(), ma::io::Mode::In);
+      ma::io::HandlerReader reader(&input, "openma.cta");
+      TS_ASSERT_EQUALS(reader.read(&rootOut), false);
+      TS_ASSERT_EQUALS(reader.errorCode(), ma::io::Error::InvalidData);
+      TS_ASSERT_EQUALS(reader.errorMessage().compare(0, 10, "OPENMA.CTA"), 0);
+      TS_ASSERT_EQUALS(rootOut.hasChildren(), false);
+    }
+  };
+};
+
+CXXTEST_SUITE_REGISTRATION(ColumnarTest)
+CXXTEST_TEST_REGISTRATION(ColumnarTest, capability)
+CXXTEST_TEST_REGISTRATION(ColumnarTest, detectExtension)
+CXXTEST_TEST_REGISTRATION(ColumnarTest, roundTrip)
+CXXTEST_TEST_REGISTRATION(ColumnarTest, resolution)
+CXXTEST_TEST_REGISTRATION(ColumnarTest, readSelection)
+CXXTEST_TEST_REGISTRATION(ColumnarTest, compressionRatio)
+CXXTEST_TEST_REGISTRATION(ColumnarTest, losslessSize)
+CXXTEST_TEST_REGISTRATION(ColumnarTest, truncatedFile)
+CXXTEST_TEST_REGISTRATION(ColumnarTest, corruptedHeader)
@@ -4,6 +4,44 @@
 
 #include "test_file_path.h"
 
+#include <vector>
+
+// Buffer without direct access to its content: the chunks and the samples are then read sequentially.
+class SequentialBuffer : public ma::io::Buffer
+{
+public:
+  virtual const char* data() const _OPENMA_NOEXCEPT override {return nullptr;};
+  virtual const char* consume(Size ) override {return nullptr;};
+};
+
+void hpfreadertest_compare_mapped_and_sequential(const char* filename)
+{
+  ma::io::File file;
+  file.open(filename, ma::io::Mode::In);
+  std::vector<char> content(static_cast<size_t>(file.size()));
+  file.read(content.data(), content.size());
+  file.seek(0, ma::io::Origin::Begin);
+  ma::io::HandlerReader mapped(&file, "delsys.hpf");
+  ma::Node rootMapped("root");
+  REQUIRE( mapped.read(&rootMapped) );
+  SequentialBuffer buffer;
+  buffer.setName(filename);
+  buffer.open(content.data(), content.size());
+  ma::io::HandlerReader sequential(&buffer, "delsys.hpf");
+  ma::Node rootSequential("root");
+  REQUIRE( sequential.read(&rootSequential) );
+  auto tssMapped = rootMapped.findChildren<ma::TimeSequence*>();
+  auto tssSequential = rootSequential.findChildren<ma::TimeSequence*>();
+  REQUIRE( tssMapped.size() == tssSequential.size() );
+  for (size_t i = 0 ; i < tssMapped.size() ; ++i)
+  {
+    CHECK( tssSequential[i]->name() == tssMapped[i]->name() );
+    REQUIRE( tssSequential[i]->samples() == tssMapped[i]->samples() );
+    for (unsigned j = 0 ; j < tssMapped[i]->samples() ; ++j)
+      CHECK( tssSequential[i]->data()[j] == tssMapped[i]->data()[j] );
+  }
+};
+
 TEST_CASE("Delsys HPF format - reader", "[openma][io][format][delsys.hpf]")
 {
 
@@ -130,6 +168,21 @@ TEST_CASE("Delsys HPF format - file content", "[openma][io][format][delsys.hpf]"
 
 }
 
+TEST_CASE("Delsys HPF format - mapped and sequential reading", "[openma][io][format][delsys.hpf]")
+{
+
+  SECTION("file Run_number_34_VTT_Rep_1DOT6")
+  {
+    hpfreadertest_compare_mapped_and_sequential(OPENMA_TDD_PATH_IN("hpf/Run_number_34_VTT_Rep_1.6.hpf"));
+  }
+
+  SECTION("file Run_number_53_Plot_and_Store_Rep_1")
+  {
+    hpfreadertest_compare_mapped_and_sequential(OPENMA_TDD_PATH_IN("hpf/Run_number_53_Plot_and_Store_Rep_1.1.hpf"));
+  }
+
+}
+
 TEST_CASE("Delsys HPF format - conversion", "[openma][io][format][delsys.hpf]")
 {
   ma::Node original("original"), converted("converted");
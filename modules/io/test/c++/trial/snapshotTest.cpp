@@ -0,0 +1,366 @@
+#include <cxxtest/TestDrive.h>
+
+#include <openma/io/handlerreader.h>
+#include <openma/io/handlerwriter.h>
+#include <openma/io/file.h>
+#include <openma/io/buffer.h>
+#include <openma/io/snapshot.h>
+#include <openma/base/node.h>
+#include <openma/base/nodeid.h>
+#include <openma/base/trial.h>
+#include <openma/base/subject.h>
+#include <openma/base/timesequence.h>
+#include <openma/base/event.h>
+#include <openma/instrument/forceplatetype2.h>
+#include <openma/instrument/forceplatetype3.h>
+
+#include <fstream>
+#include <iterator>
+#include <algorithm>
+#include <memory>
+#include <cstring>
+
+#include "test_file_path.h"
+
+class SnapshotTestRegistered : public ma::Node
+{
+  OPENMA_DECLARE_NODEID(SnapshotTestRegistered, ma::Node)
+public:
+  SnapshotTestRegistered(const std::string& name, ma::Node* parent = nullptr) : ma::Node(name, parent) {};
+};
+
+class SnapshotTestUnregistered : public ma::Node
+{
+  OPENMA_DECLARE_NODEID(SnapshotTestUnregistered, ma::Node)
+public:
+  SnapshotTestUnregistered(const std::string& name, ma::Node* parent = nullptr) : ma::Node(name, parent) {};
+};
+
+class SnapshotTestTrial : public ma::Trial
+{
+  OPENMA_DECLARE_NODEID(SnapshotTestTrial, ma::Trial)
+public:
+  SnapshotTestTrial(const std::string& name, ma::Node* parent = nullptr) : ma::Trial(name, parent) {};
+};
+
+struct SnapshotTestDate
+{
+  int Year, Month, Day;
+  friend bool operator==(const SnapshotTestDate& lhs, const SnapshotTestDate& rhs) {return ((lhs.Year == rhs.Year) && (lhs.Month == rhs.Month) && (lhs.Day == rhs.Day));};
+};
+
+void snapshottest_generate_trial(ma::Node* root)
+{
+  auto trial = new ma::Trial("foo", root);
+  trial->setDescription("Snapshot test");
+  trial->setProperty("POINT:UNITS", std::string("mm"));
+  trial->setProperty("POINT:RATE", 100.0);
+  trial->setProperty("POINT:USED", 2);
+  trial->setProperty("ANALOG:USED", 8u);
+  trial->setProperty("VENDOR:ENABLED", true);
+  trial->setProperty("VENDOR:VALUES", ma::Any(std::vector<float>{1.5f, -2.0f, 3.25f, 4.0f, 5.5f, -6.0f}, std::vector<unsigned>{3,2}));
+  trial->setProperty("VENDOR:LABELS", ma::Any(std::vector<std::string>{"A","BC","DEF"}));
+  auto m1 = new ma::TimeSequence("m1", 4, 50, 100.0, 0.5, ma::TimeSequence::Position, "mm", trial->timeSequences());
+  m1->setDescription("First marker");
+  auto m2 = new ma::TimeSequence("m2", 4, 50, 100.0, 0.5, ma::TimeSequence::Position, "mm", trial->timeSequences());
+  for (unsigned i = 0 ; i < m1->elements() ; ++i)
+  {
+    m1->data()[i] = 0.5 * static_cast<double>(i);
+    m2->data()[i] = -1.25 * static_cast<double>(i);
+  }
+  auto fp = new ma::instrument::ForcePlateType3("FP1", trial->hardwares());
+  fp->setGeometry(std::array<double,3>{{0.0,0.0,-40.0}},
+                  std::array<double,3>{{500.0,1000.0,0.0}},
+                  std::array<double,3>{{0.0,1000.0,0.0}},
+                  std::array<double,3>{{0.0,400.0,0.0}},
+                  std::array<double,3>{{500.0,400.0,0.0}});
+  fp->setSensorOffsets(std::array<double,2>{{210.0,260.0}});
+  fp->setSoftResetEnabled(true);
+  fp->setSoftResetSamples(std::array<int,2>{{2,10}});
+  for (unsigned i = 0 ; i < 8 ; ++i)
+  {
+    auto a = new ma::TimeSequence("a" + std::to_string(i+1), 1, 200, 400.0, 0.5, ma::TimeSequence::Analog, "V", 0.25, 2048.0, std::array<double,2>{{-10.0, 10.0}}, trial->timeSequences());
+    for (unsigned j = 0 ; j < a->samples() ; ++j)
+      a->data()[j] = 0.001 * static_cast<double>(i * 1000 + j);
+    fp->setChannel(i, a);
+  }
+  new ma::Event("RHS", 1.25, "Right", "John", trial->events());
+  new ma::Event("LTO", 1.75, "Left", "John", trial->events());
+  new ma::Subject("John", {{"height", 1.82}, {"weight", 75.5}}, root);
+};
+
+bool snapshottest_write(const char* filepath, ma::Node* root)
+{
+  ma::io::File file;
+  file.open(filepath, ma::io::Mode::Out);
+  ma::io::HandlerWriter writer(&file, "openma.snap");
+  bool ret = writer.write(root);
+  TS_ASSERT_EQUALS(ret, true);
+  TS_ASSERT_EQUALS(writer.errorCode(), ma::io::Error::None);
+  TS_ASSERT_EQUALS(writer.errorMessage(), "");
+  return ret;
+};
+
+CXXTEST_SUITE(SnapshotTest)
+{
+  CXXTEST_TEST(capability)
+  {
+    ma::io::HandlerWriter writer;
+    auto formats = writer.availableFormats();
+    TS_ASSERT_EQUALS(std::find(formats.cbegin(), formats.cend(), "openma.snap") != formats.cend(), true);
+    ma::io::HandlerReader reader;
+    formats = reader.availableFormats();
+    TS_ASSERT_EQUALS(std::find(formats.cbegin(), formats.cend(), "openma.snap") != formats.cend(), true);
+  };
+  
+  CXXTEST_TEST(detectExtension)
+  {
+    ma::io::File file;
+    file.open(OPENMA_TDD_PATH_OUT("snapshot/detect.snap"), ma::io::Mode::Out);
+    ma::io::HandlerWriter writer(&file);
+    TS_ASSERT_EQUALS(writer.canWrite(), true);
+    TS_ASSERT_EQUALS(writer.format(), "openma.snap");
+  };
+  
+  CXXTEST_TEST(roundTrip)
+  {
+    ma::Node rootIn("rootIn"), rootOut("rootOut");
+    snapshottest_generate_trial(&rootIn);
+    if (!snapshottest_write(OPENMA_TDD_PATH_OUT("snapshot/roundtrip.snap"), &rootIn)) return;
+    // The format is detected from the signature
+    ma::io::File file;
+    file.open(OPENMA_TDD_PATH_OUT("snapshot/roundtrip.snap"), ma::io::Mode::In);
+    ma::io::HandlerReader reader(&file);
+    TS_ASSERT_EQUALS(reader.read(&rootOut), true);
+    TS_ASSERT_EQUALS(reader.format(), "openma.snap");
+    TS_ASSERT_EQUALS(reader.errorMessage(), "");
+    TS_ASSERT_EQUALS(rootOut.children().size(), 2ul);
+    auto trialIn = rootIn.findChild<ma::Trial*>();
+    auto trialOut = rootOut.findChild<ma::Trial*>();
+    TS_ASSERT(trialOut != nullptr);
+    if (trialOut == nullptr) return;
+    TS_ASSERT_EQUALS(trialOut->name(), "foo");
+    TS_ASSERT_EQUALS(trialOut->description(), "Snapshot test");
+    TS_ASSERT_EQUALS(trialOut->property("POINT:UNITS").cast<std::string>(), "mm");
+    TS_ASSERT_EQUALS(trialOut->property("POINT:RATE").cast<double>(), 100.0);
+    TS_ASSERT_EQUALS(trialOut->property("POINT:USED").cast<int>(), 2);
+    TS_ASSERT_EQUALS(trialOut->property("ANALOG:USED").cast<unsigned>(), 8u);
+    TS_ASSERT_EQUALS(trialOut->property("VENDOR:ENABLED").cast<bool>(), true);
+    TS_ASSERT_EQUALS(trialOut->property("VENDOR:VALUES").cast<std::vector<float>>(), (std::vector<float>{1.5f, -2.0f, 3.25f, 4.0f, 5.5f, -6.0f}));
+    TS_ASSERT_EQUALS(trialOut->property("VENDOR:VALUES").dimensions(), (std::vector<unsigned>{3,2}));
+    TS_ASSERT_EQUALS(trialOut->property("VENDOR:LABELS").cast<std::vector<std::string>>(), (std::vector<std::string>{"A","BC","DEF"}));
+    // Time sequences
+    auto tssIn = trialIn->timeSequences()->findChildren<ma::TimeSequence*>();
+    auto tssOut = trialOut->timeSequences()->findChildren<ma::TimeSequence*>();
+    TS_ASSERT_EQUALS(tssOut.size(), 10ul);
+    if (tssOut.size() != tssIn.size()) return;
+    for (size_t i = 0 ; i < tssIn.size() ; ++i)
+    {
+      TS_ASSERT_EQUALS(tssOut[i]->name(), tssIn[i]->name());
+      TS_ASSERT_EQUALS(tssOut[i]->description(), tssIn[i]->description());
+      TS_ASSERT_EQUALS(tssOut[i]->dimensions(), tssIn[i]->dimensions());
+      TS_ASSERT_EQUALS(tssOut[i]->samples(), tssIn[i]->samples());
+      TS_ASSERT_EQUALS(tssOut[i]->sampleRate(), tssIn[i]->sampleRate());
+      TS_ASSERT_EQUALS(tssOut[i]->startTime(), tssIn[i]->startTime());
+      TS_ASSERT_EQUALS(tssOut[i]->type(), tssIn[i]->type());
+      TS_ASSERT_EQUALS(tssOut[i]->unit(), tssIn[i]->unit());
+      TS_ASSERT_EQUALS(tssOut[i]->scale(), tssIn[i]->scale());
+      TS_ASSERT_EQUALS(tssOut[i]->offset(), tssIn[i]->offset());
+      TS_ASSERT_EQUALS(tssOut[i]->range(), tssIn[i]->range());
+      TS_ASSERT_EQUALS(std::equal(tssIn[i]->data(), tssIn[i]->data() + tssIn[i]->elements(), tssOut[i]->data()), true);
+    }
+    // Force plate and its channels
+    auto fp = trialOut->hardwares()->findChild<ma::instrument::ForcePlateType3*>("FP1");
+    auto fpIn = trialIn->hardwares()->findChild<ma::instrument::ForcePlateType3*>("FP1");
+    TS_ASSERT(fp != nullptr);
+    if (fp == nullptr) return;
+    TS_ASSERT_EQUALS(fp->type(), 3);
+    TS_ASSERT_EQUALS(fp->referenceFrame(), fpIn->referenceFrame());
+    TS_ASSERT_EQUALS(fp->surfaceCorners(), fpIn->surfaceCorners());
+    TS_ASSERT_EQUALS(fp->relativeSurfaceOrigin(), fpIn->relativeSurfaceOrigin());
+    TS_ASSERT_EQUALS(fp->sensorOffsets(), fpIn->sensorOffsets());
+    TS_ASSERT_EQUALS(fp->isSoftResetEnabled(), true);
+    TS_ASSERT_EQUALS(fp->softResetSamples(), (std::array<int,2>{{2,10}}));
+    TS_ASSERT_EQUALS(fp->calibrationMatrixData(), fpIn->calibrationMatrixData());
+    for (unsigned i = 0 ; i < 8 ; ++i)
+    {
+      auto ch = fp->channel(i);
+      TS_ASSERT(ch != nullptr);
+      if (ch == nullptr) continue;
+      TS_ASSERT_EQUALS(ch, tssOut[2+i]);
+      TS_ASSERT_EQUALS(ch->parents().size(), 2ul);
+    }
+    auto wrenches = fp->wrench(ma::instrument::Location::Origin, false);
+    auto wrenchesIn = fpIn->wrench(ma::instrument::Location::Origin, false);
+    TS_ASSERT(wrenches != nullptr);
+    TS_ASSERT(wrenchesIn != nullptr);
+    if ((wrenches != nullptr) && (wrenchesIn != nullptr))
+      TS_ASSERT_EQUALS(std::equal(wrenchesIn->data(), wrenchesIn->data() + wrenchesIn->elements(), wrenches->data()), true);
+    // Events
+    auto evts = trialOut->events()->findChildren<ma::Event*>();
+    TS_ASSERT_EQUALS(evts.size(), 2ul);
+    if (evts.size() != 2ul) return;
+    TS_ASSERT_EQUALS(evts[0]->name(), "RHS");
+    TS_ASSERT_EQUALS(evts[0]->time(), 1.25);
+    TS_ASSERT_EQUALS(evts[0]->context(), "Right");
+    TS_ASSERT_EQUALS(evts[0]->subject(), "John");
+    TS_ASSERT_EQUALS(evts[1]->name(), "LTO");
+    TS_ASSERT_EQUALS(evts[1]->time(), 1.75);
+    TS_ASSERT_EQUALS(evts[1]->context(), "Left");
+    // Subject
+    auto subject = rootOut.findChild<ma::Subject*>("John");
+    TS_ASSERT(subject != nullptr);
+    if (subject == nullptr) return;
+    TS_ASSERT_EQUALS(subject->property("height").cast<double>(), 1.82);
+    TS_ASSERT_EQUALS(subject->property("weight").cast<double>(), 75.5);
+  };
+  
+  CXXTEST_TEST(contiguousSamples)
+  {
+    ma::Node rootIn("rootIn");
+    snapshottest_generate_trial(&rootIn);
+    if (!snapshottest_write(OPENMA_TDD_PATH_OUT("snapshot/contiguous.snap"), &rootIn)) return;
+    std::ifstream ifs(OPENMA_TDD_PATH_OUT("snapshot/contiguous.snap"), std::ios::binary);
+    std::vector<char> bytes((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+    TS_ASSERT(bytes.size() > 32ul);
+    if (bytes.size() <= 32ul) return;
+    uint64_t metadataSize = 0, dataOffset = 0;
+    memcpy(&metadataSize, bytes.data() + 16, 8);
+    memcpy(&dataOffset, bytes.data() + 24, 8);
+    // The data section follows the metadata and has no padding
+    TS_ASSERT_EQUALS(dataOffset, 32ul + metadataSize);
+    uint64_t samples = 0;
+    for (const auto& ts : rootIn.findChildren<ma::TimeSequence*>())
+      samples += ts->elements() * sizeof(double);
+    TS_ASSERT_EQUALS(static_cast<uint64_t>(bytes.size()), dataOffset + samples);
+  };
+  
+  CXXTEST_TEST(unregisteredType)
+  {
+    ma::Node rootIn("rootIn");
+    snapshottest_generate_trial(&rootIn);
+    new SnapshotTestUnregistered("custom", &rootIn);
+    ma::io::Buffer buffer;
+    buffer.setName("snapshot");
+    buffer.open(ma::io::Mode::Out);
+    ma::io::HandlerWriter writer(&buffer, "openma.snap");
+    // The node is not flattened to a simple Node
+    TS_ASSERT_EQUALS(writer.write(&rootIn), false);
+    TS_ASSERT_EQUALS(writer.errorCode(), ma::io::Error::InvalidData);
+    TS_ASSERT_DIFFERS(writer.errorMessage().find("'custom' is not registered"), std::string::npos);
+  };
+  
+  CXXTEST_TEST(unregisteredDerivedType)
+  {
+    ma::Node rootIn("rootIn");
+    new SnapshotTestTrial("derived", &rootIn);
+    ma::io::Buffer buffer;
+    buffer.setName("snapshot");
+    buffer.open(ma::io::Mode::Out);
+    ma::io::HandlerWriter writer(&buffer, "openma.snap");
+    // The node is not saved as a simple Trial
+    TS_ASSERT_EQUALS(writer.write(&rootIn), false);
+    TS_ASSERT_EQUALS(writer.errorCode(), ma::io::Error::InvalidData);
+  };
+  
+  CXXTEST_TEST(unsupportedProperty)
+  {
+    ma::Node rootIn("rootIn");
+    snapshottest_generate_trial(&rootIn);
+    rootIn.findChild<ma::Trial*>("foo")->setProperty("VENDOR:DATE", SnapshotTestDate{2016,5,2});
+    ma::io::Buffer buffer;
+    buffer.setName("snapshot");
+    buffer.open(ma::io::Mode::Out);
+    ma::io::HandlerWriter writer(&buffer, "openma.snap");
+    // The property is not silently dropped
+    TS_ASSERT_EQUALS(writer.write(&rootIn), false);
+    TS_ASSERT_EQUALS(writer.errorCode(), ma::io::Error::InvalidData);
+    TS_ASSERT_DIFFERS(writer.errorMessage().find("'VENDOR:DATE'"), std::string::npos);
+  };
+  
+  CXXTEST_TEST(registeredType)
+  {
+    auto create = [](const std::string& name, ma::io::SnapshotDecoder* ) -> ma::Node* {return new SnapshotTestRegistered(name);};
+    TS_ASSERT_EQUALS(ma::io::register_snapshot_node_type<SnapshotTestRegistered>("SnapshotTestRegistered", create), true);
+    TS_ASSERT_EQUALS(ma::io::register_snapshot_node_type<SnapshotTestRegistered>("SnapshotTestRegistered", create), false);
+    TS_ASSERT_EQUALS(ma::io::register_snapshot_node_type<ma::Trial>("Trial2", create), false);
+    ma::Node rootIn("rootIn"), rootOut("rootOut");
+    auto custom = new SnapshotTestRegistered("custom", &rootIn);
+    custom->setDescription("Custom node");
+    custom->setProperty("VALUE", 42.0);
+    new ma::TimeSequence("m1", 4, 10, 100.0, 0.0, ma::TimeSequence::Position, "mm", custom);
+    ma::io::Buffer buffer;
+    buffer.setName("snapshot");
+    buffer.open(ma::io::Mode::Out);
+    ma::io::HandlerWriter writer(&buffer, "openma.snap");
+    TS_ASSERT_EQUALS(writer.write(&rootIn), true);
+    ma::io::Buffer::Size size = 0;
+    std::unique_ptr<char[]> data(buffer.release(&size));
+    ma::io::Buffer input;
+    input.setName("snapshot");
+    input.open(data.get(), size, ma::io::Mode::In);
+    ma::io::HandlerReader reader(&input, "openma.snap");
+    TS_ASSERT_EQUALS(reader.read(&rootOut), true);
+    auto node = rootOut.findChild<SnapshotTestRegistered*>("custom");
+    TS_ASSERT(node != nullptr);
+    if (node == nullptr) return;
+    TS_ASSERT_EQUALS(node->description(), "Custom node");
+    TS_ASSERT_EQUALS(node->property("VALUE").cast<double>(), 42.0);
+    TS_ASSERT(node->findChild<ma::TimeSequence*>("m1") != nullptr);
+  };
+  
+  CXXTEST_TEST(readBuffer)
+  {
+    ma::Node rootIn("rootIn"), rootOut("rootOut");
+    snapshottest_generate_trial(&rootIn);
+    ma::io::Buffer buffer;
+    buffer.setName("snapshot");
+    buffer.open(ma::io::Mode::Out);
+    ma::io::HandlerWriter writer(&buffer, "openma.snap");
+    TS_ASSERT_EQUALS(writer.write(&rootIn), true);
+    ma::io::Buffer::Size size = 0;
+    std::unique_ptr<char[]> data(buffer.release(&size));
+    TS_ASSERT_DIFFERS(size, 0);
+    ma::io::Buffer input;
+    input.setName("snapshot");
+    input.open(data.get(), size, ma::io::Mode::In);
+    ma::io::HandlerReader reader(&input, "openma.snap");
+    TS_ASSERT_EQUALS(reader.read(&rootOut), true);
+    TS_ASSERT_EQUALS(reader.errorMessage(), "");
+    auto a3 = rootOut.findChild<ma::TimeSequence*>("a3");
+    TS_ASSERT(a3 != nullptr);
+    if (a3 != nullptr)
+      TS_ASSERT_EQUALS(std::equal(a3->data(), a3->data() + a3->elements(), rootIn.findChild<ma::TimeSequence*>("a3")->data()), true);
+  };
+  
+  CXXTEST_TEST(truncatedFile)
+  {
+    ma::Node rootIn("rootIn"), rootOut("rootOut");
+    snapshottest_generate_trial(&rootIn);
+    if (!snapshottest_write(OPENMA_TDD_PATH_OUT("snapshot/truncated.snap"), &rootIn)) return;
+    std::ifstream ifs(OPENMA_TDD_PATH_OUT("snapshot/truncated.snap"), std::ios::binary);
+    std::vector<char> bytes((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+    bytes.resize(bytes.size() - 100);
+    ma::io::Buffer input;
+    input.setName("truncated");
+    input.open(bytes.data(), bytes.size(), ma::io::Mode::In);
+    ma::io::HandlerReader reader(&input, "openma.snap");
+    // The size of the samples is checked before to allocate them
+    TS_ASSERT_EQUALS(reader.read(&rootOut), false);
+    TS_ASSERT_EQUALS(reader.errorCode(), ma::io::Error::InvalidData);
+    TS_ASSERT_DIFFERS(reader.errorMessage().find("exceed the size of the data section"), std::string::npos);
+    TS_ASSERT_EQUALS(rootOut.hasChildren(), false);
+  };
+};
+
+CXXTEST_SUITE_REGISTRATION(SnapshotTest)
+CXXTEST_TEST_REGISTRATION(SnapshotTest, capability)
+CXXTEST_TEST_REGISTRATION(SnapshotTest, detectExtension)
+CXXTEST_TEST_REGISTRATION(SnapshotTest, roundTrip)
+CXXTEST_TEST_REGISTRATION(SnapshotTest, contiguousSamples)
+CXXTEST_TEST_REGISTRATION(SnapshotTest, unregisteredType)
+CXXTEST_TEST_REGISTRATION(SnapshotTest, unregisteredDerivedType)
+CXXTEST_TEST_REGISTRATION(SnapshotTest, unsupportedProperty)
+CXXTEST_TEST_REGISTRATION(SnapshotTest, registeredType)
+CXXTEST_TEST_REGISTRATION(SnapshotTest, readBuffer)
+CXXTEST_TEST_REGISTRATION(SnapshotTest, truncatedFile)
\ No newline at end of file
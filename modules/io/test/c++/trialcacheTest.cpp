@@ -0,0 +1,184 @@
+#include <cxxtest/TestDrive.h>
+
+#include <openma/io.h>
+#include <openma/base/trial.h>
+#include <openma/base/timesequence.h>
+#include <openma/base/nodeid.h>
+
+#include <random>
+
+#include "test_file_path.h"
+
+// A different content is generated at each run to not find the entries cached by a previous run
+static void trialcachetest_generate(const char* filepath, double offset)
+{
+  static const float run = static_cast<float>(std::random_device{}() % 1000000);
+  ma::Node root("root");
+  ma::Trial trial("trial", &root);
+  trial.setProperty("TEST:RUN", run);
+  ma::TimeSequence m1("m1", 4, 20, 100.0, 0.0, ma::TimeSequence::Position, "mm", trial.timeSequences());
+  for (unsigned i = 0 ; i < 20 ; ++i)
+  {
+    for (unsigned j = 0 ; j < 3 ; ++j)
+      m1.data()[i+j*20] = offset + static_cast<double>(i + j);
+    m1.data()[i+60] = 0.0;
+  }
+  TS_ASSERT_EQUALS(ma::io::write(&root, filepath), true);
+};
+
+// Type of node not registered in the snapshot format
+class TrialCacheTestNode : public ma::Node
+{
+  OPENMA_DECLARE_NODEID(TrialCacheTestNode, ma::Node)
+public:
+  TrialCacheTestNode(const std::string& name, ma::Node* parent = nullptr) : ma::Node(name, parent) {};
+};
+
+CXXTEST_SUITE(TrialCacheTest)
+{
+  CXXTEST_TEST(read)
+  {
+    trialcachetest_generate(OPENMA_TDD_PATH_OUT("cache/read.c3d"), 0.0);
+    ma::io::TrialCache cache(OPENMA_TDD_PATH_OUT("cache"));
+    TS_ASSERT_EQUALS(cache.directory(), OPENMA_TDD_PATH_OUT("cache"));
+    ma::Node first("first"), second("second");
+    TS_ASSERT_EQUALS(cache.read(&first, OPENMA_TDD_PATH_OUT("cache/read.c3d")), true);
+    TS_ASSERT_EQUALS(cache.misses(), 1ul);
+    TS_ASSERT_EQUALS(cache.hits(), 0ul);
+    TS_ASSERT_EQUALS(cache.isTracked(&first), true);
+    // Same file: restored from the cache
+    TS_ASSERT_EQUALS(cache.read(&second, OPENMA_TDD_PATH_OUT("cache/read.c3d")), true);
+    TS_ASSERT_EQUALS(cache.misses(), 1ul);
+    TS_ASSERT_EQUALS(cache.hits(), 1ul);
+    TS_ASSERT_EQUALS(cache.isTracked(&second), true);
+    auto m1 = first.findChild<ma::TimeSequence*>("m1");
+    auto m2 = second.findChild<ma::TimeSequence*>("m1");
+    TS_ASSERT(m1 != nullptr);
+    TS_ASSERT(m2 != nullptr);
+    if ((m1 == nullptr) || (m2 == nullptr)) return;
+    TS_ASSERT_EQUALS(m2->samples(), 20u);
+    for (unsigned i = 0 ; i < m1->elements() ; ++i)
+      TS_ASSERT_EQUALS(m2->data()[i], m1->data()[i]);
+    TS_ASSERT_EQUALS(second.findChild<ma::Trial*>()->property("TEST:RUN").cast<float>(), first.findChild<ma::Trial*>()->property("TEST:RUN").cast<float>());
+    // Other options
+    ma::Node third("third");
+    TS_ASSERT_EQUALS(cache.read(&third, OPENMA_TDD_PATH_OUT("cache/read.c3d"), "", {{"metadata", true}}), true);
+    TS_ASSERT_EQUALS(cache.misses(), 2ul);
+    // Modified file
+    trialcachetest_generate(OPENMA_TDD_PATH_OUT("cache/read.c3d"), 10.0);
+    ma::Node fourth("fourth");
+    TS_ASSERT_EQUALS(cache.read(&fourth, OPENMA_TDD_PATH_OUT("cache/read.c3d")), true);
+    TS_ASSERT_EQUALS(cache.misses(), 3ul);
+    TS_ASSERT_EQUALS(cache.hits(), 1ul);
+    auto m4 = fourth.findChild<ma::TimeSequence*>("m1");
+    TS_ASSERT(m4 != nullptr);
+    if (m4 == nullptr) return;
+    TS_ASSERT_EQUALS(m4->data()[0], 10.0);
+  };
+  
+  CXXTEST_TEST(readMissingFile)
+  {
+    ma::io::TrialCache cache(OPENMA_TDD_PATH_OUT("cache"));
+    ma::Node root("root");
+    TS_ASSERT_EQUALS(cache.read(&root, OPENMA_TDD_PATH_OUT("cache/missing.c3d")), false);
+    TS_ASSERT_EQUALS(cache.isTracked(&root), false);
+    TS_ASSERT_EQUALS(cache.read(nullptr, OPENMA_TDD_PATH_OUT("cache/missing.c3d")), false);
+  };
+  
+  CXXTEST_TEST(process)
+  {
+    trialcachetest_generate(OPENMA_TDD_PATH_OUT("cache/process.c3d"), 0.0);
+    ma::io::TrialCache cache(OPENMA_TDD_PATH_OUT("cache"));
+    unsigned calls = 0;
+    auto scale = [&calls](ma::Node* root, double factor) {
+      ++calls;
+      auto ts = root->findChild<ma::TimeSequence*>("m1");
+      if (ts == nullptr)
+        return false;
+      for (unsigned i = 0 ; i < 60 ; ++i)
+        ts->data()[i] *= factor;
+      ts->modified();
+      root->setProperty("scaled", factor);
+      return true;
+    };
+    ma::Node first("first"), second("second");
+    TS_ASSERT_EQUALS(cache.read(&first, OPENMA_TDD_PATH_OUT("cache/process.c3d")), true);
+    TS_ASSERT_EQUALS(cache.process(&first, "scale", {{"factor", 2.0}}, [&](ma::Node* root){return scale(root, 2.0);}), true);
+    TS_ASSERT_EQUALS(calls, 1u);
+    TS_ASSERT_EQUALS(cache.isTracked(&first), true);
+    // Same steps on the same file: the result is restored
+    TS_ASSERT_EQUALS(cache.read(&second, OPENMA_TDD_PATH_OUT("cache/process.c3d")), true);
+    TS_ASSERT_EQUALS(cache.process(&second, "scale", {{"factor", 2.0}}, [&](ma::Node* root){return scale(root, 2.0);}), true);
+    TS_ASSERT_EQUALS(calls, 1u);
+    TS_ASSERT_EQUALS(cache.hits(), 2ul);
+    TS_ASSERT_EQUALS(second.property("scaled").cast<double>(), 2.0);
+    TS_ASSERT_EQUALS(second.children().size(), 1ul);
+    auto m1 = first.findChild<ma::TimeSequence*>("m1");
+    auto m2 = second.findChild<ma::TimeSequence*>("m1");
+    TS_ASSERT(m1 != nullptr);
+    TS_ASSERT(m2 != nullptr);
+    if ((m1 == nullptr) || (m2 == nullptr)) return;
+    TS_ASSERT_EQUALS(m2->data()[1], 2.0);
+    for (unsigned i = 0 ; i < m1->elements() ; ++i)
+      TS_ASSERT_EQUALS(m2->data()[i], m1->data()[i]);
+    // Other parameters
+    ma::Node third("third");
+    TS_ASSERT_EQUALS(cache.read(&third, OPENMA_TDD_PATH_OUT("cache/process.c3d")), true);
+    TS_ASSERT_EQUALS(cache.process(&third, "scale", {{"factor", 3.0}}, [&](ma::Node* root){return scale(root, 3.0);}), true);
+    TS_ASSERT_EQUALS(calls, 2u);
+    // Chained steps
+    TS_ASSERT_EQUALS(cache.process(&second, "scale", {{"factor", 3.0}}, [&](ma::Node* root){return scale(root, 3.0);}), true);
+    TS_ASSERT_EQUALS(calls, 3u);
+    TS_ASSERT_EQUALS(m2->data()[1], 6.0);
+    // A content modified outside of the cache is not tracked anymore
+    const size_t misses = cache.misses();
+    first.setProperty("operator", std::string("foo"));
+    TS_ASSERT_EQUALS(cache.isTracked(&first), false);
+    TS_ASSERT_EQUALS(cache.process(&first, "scale", {{"factor", 3.0}}, [&](ma::Node* root){return scale(root, 3.0);}), true);
+    TS_ASSERT_EQUALS(calls, 4u);
+    TS_ASSERT_EQUALS(cache.misses(), misses);
+    TS_ASSERT_EQUALS(cache.isTracked(&first), false);
+    // A failure is not cached
+    ma::Node fourth("fourth");
+    TS_ASSERT_EQUALS(cache.read(&fourth, OPENMA_TDD_PATH_OUT("cache/process.c3d")), true);
+    TS_ASSERT_EQUALS(cache.process(&fourth, "fail", {}, [](ma::Node* ){return false;}), false);
+    TS_ASSERT_EQUALS(cache.isTracked(&fourth), false);
+    cache.forget(&second);
+    TS_ASSERT_EQUALS(cache.isTracked(&second), false);
+  };
+  
+  CXXTEST_TEST(processUnsupportedNode)
+  {
+    trialcachetest_generate(OPENMA_TDD_PATH_OUT("cache/unsupported.c3d"), 0.0);
+    ma::io::TrialCache cache(OPENMA_TDD_PATH_OUT("cache"));
+    unsigned calls = 0;
+    auto extend = [&calls](ma::Node* root) {
+      ++calls;
+      new TrialCacheTestNode("custom", root);
+      return true;
+    };
+    ma::Node first("first"), second("second");
+    TS_ASSERT_EQUALS(cache.read(&first, OPENMA_TDD_PATH_OUT("cache/unsupported.c3d")), true);
+    TS_ASSERT_EQUALS(cache.process(&first, "extend", {}, extend), true);
+    TS_ASSERT_EQUALS(calls, 1u);
+    TS_ASSERT(first.findChild<TrialCacheTestNode*>("custom") != nullptr);
+    // The result cannot be represented by a snapshot: it is neither cached nor tracked
+    TS_ASSERT_EQUALS(cache.isTracked(&first), false);
+    TS_ASSERT_EQUALS(cache.read(&second, OPENMA_TDD_PATH_OUT("cache/unsupported.c3d")), true);
+    TS_ASSERT_EQUALS(cache.hits(), 1ul);
+    TS_ASSERT_EQUALS(cache.process(&second, "extend", {}, extend), true);
+    TS_ASSERT_EQUALS(calls, 2u);
+    TS_ASSERT_EQUALS(cache.hits(), 1ul);
+    TS_ASSERT_EQUALS(cache.misses(), 3ul);
+    auto custom = second.findChild("custom");
+    TS_ASSERT(custom != nullptr);
+    if (custom == nullptr) return;
+    TS_ASSERT_EQUALS(custom->isCastable(ma::static_typeid<TrialCacheTestNode>()), true);
+  };
+};
+
+CXXTEST_SUITE_REGISTRATION(TrialCacheTest)
+CXXTEST_TEST_REGISTRATION(TrialCacheTest, read)
+CXXTEST_TEST_REGISTRATION(TrialCacheTest, readMissingFile)
+CXXTEST_TEST_REGISTRATION(TrialCacheTest, process)
+CXXTEST_TEST_REGISTRATION(TrialCacheTest, processUnsupportedNode)
@@ -0,0 +1,75 @@
+/* 
+ * Open Source Movement Analysis Library
+ * Copyright (C) 2016, Moveck Solution Inc., all rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 
+ *     * Redistributions of source code must retain the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer.
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials
+ *       provided with the distribution.
+ *     * Neither the name(s) of the copyright holders nor the names
+ *       of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written
+ *       permission.
+ *  
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <benchmark.h>
+
+#include <openma/math.h>
+#include <openma/base/node.h>
+
+int main(int argc, char* argv[])
+{
+  ma::bench::Harness harness(argc, argv);
+  const unsigned sizes[3] = {1000u, 100000u, 1000000u};
+  const double dt = 0.01;
+  for (const auto rows : sizes)
+  {
+    ma::math::Vector a(rows), b(rows), c(rows);
+    a.values().setRandom(); a.residuals().setZero();
+    b.values().setRandom(); b.residuals().setZero();
+    ma::math::Pose p(rows), q(rows);
+    p.values().setRandom(); p.residuals().setZero();
+    ma::math::Array<9> r(rows);
+    r.values().setRandom(); r.residuals().setZero();
+    ma::math::Array<3> angles(rows);
+    ma::math::Array<3> skew(rows);
+    ma::math::Vector stat(1);
+    ma::math::Scalar norm(rows);
+    ma::Node root("root");
+    auto ts = ma::math::to_timesequence(a, "Vector", 100.0, 0.0, ma::TimeSequence::Position, "mm", &root);
+    
+    harness.run("cross", rows, [&](){c = a.cross(b); ma::bench::do_not_optimize(c);});
+    harness.run("transform", rows, [&](){c = p.transform(a); ma::bench::do_not_optimize(c);});
+    harness.run("inverse", rows, [&](){q = p.inverse(); ma::bench::do_not_optimize(q);});
+    harness.run("derivative<1>", rows, [&](){c = a.derivative<1>(dt); ma::bench::do_not_optimize(c);});
+    harness.run("derivative<2>", rows, [&](){c = a.derivative<2>(dt); ma::bench::do_not_optimize(c);});
+    harness.run("eulerAngles", rows, [&](){angles = p.eulerAngles(0,1,2); ma::bench::do_not_optimize(angles);});
+    harness.run("eulerAngles.approximate", rows, [&](){angles = p.eulerAngles(0,1,2,ma::math::EulerAnglesMode::Approximate); ma::bench::do_not_optimize(angles);});
+    harness.run("mean", rows, [&](){stat = a.mean(); ma::bench::do_not_optimize(stat);});
+    harness.run("norm", rows, [&](){norm = a.norm(); ma::bench::do_not_optimize(norm);});
+    harness.run("skewRedux", rows, [&](){skew = r.skewRedux(); ma::bench::do_not_optimize(skew);});
+    harness.run("to_timesequence", rows, [&](){ma::bench::do_not_optimize(ma::math::to_timesequence(a - b, "Vector", 100.0, 0.0, ma::TimeSequence::Position, "mm", &root));});
+    harness.run("from_timesequence", rows, [&](){c = ma::math::to_vector(ts); ma::bench::do_not_optimize(c);});
+  }
+  return harness.finish();
+};
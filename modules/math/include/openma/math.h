@@ -20,6 +20,7 @@
 #include <Eigen_openma/Plugin/Functors.h>
 
 #include <utility> // std::declval
+#include <limits> // std::numeric_limits
 #define OPENMA_MATHS_DECLVAL_NESTED(xpr) \
   std::declval<const typename ma::math::Nested<xpr>::type>()
 
@@ -27,6 +28,7 @@
 
 #include "openma/math/forwarddeclarations.h"
 #include "openma/math/traits.h"    
+#include "openma/math/validity.h"
 #include "openma/math/xprbase.h"
 #include "openma/math/arraybase.h"
 #include "openma/math/array.h"
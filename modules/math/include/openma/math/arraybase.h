@@ -126,6 +126,26 @@ namespace math
      */
     bool isOccluded() const _OPENMA_NOEXCEPT {return (!this->isValid() || (this->m_Residuals < 0.0).all());};
     
+    /**
+     * Applies the given validity @a mask to this object. The residuals of the valid samples are kept (e.g. reconstruction error of a marker) only if they are already valid. Otherwise, they are set to 0. Invalid samples have their values set to 0 and their residual set to -1.
+     * This is the counterpart of the method validity() which packs the residuals of this object into a ValidityMask.
+     * @note The number of samples in the mask must be the same than the number of rows of this object.
+     */
+    void setValidity(const ValidityMask& mask)
+    {
+      assert(mask.size() == this->m_Residuals.rows());
+      for (Index i = 0 ; i < this->m_Residuals.rows() ; ++i)
+      {
+        if (!mask.test(i))
+        {
+          this->m_Residuals.coeffRef(i) = -1.0;
+          this->m_Values.row(i).setZero();
+        }
+        else if (this->m_Residuals.coeff(i) < 0.0)
+          this->m_Residuals.coeffRef(i) = 0.0;
+      }
+    };
+    
     /**
      * Cast the object to a @a Derived type reference.
      */
@@ -279,14 +299,17 @@ namespace math
       self.residuals().lazyAssign(other.residuals());
     };
     
+    // The validity of the expression is propagated as a bit mask and converted to residuals (0 or -1) only in the destination
     template <typename U, typename V>
-    static inline typename std::enable_if<Traits<V>::Processing == ValuesOnly>::type assign(ArrayBase<U>& lhs, const XprBase<V>& rhs)
+    static inline typename std::enable_if<(Traits<V>::Processing == ValuesOnly) || (Traits<V>::Processing == Masked)>::type assign(ArrayBase<U>& lhs, const XprBase<V>& rhs)
     {
       static_assert(Traits<U>::ColsAtCompileTime == Traits<V>::ColsAtCompileTime, "The number of columns is not the same.");
       auto& self = static_cast<U&>(lhs).derived();
       const auto& other = static_cast<const V&>(rhs).derived();
-      self.residuals().lazyAssign(generate_residuals(other.residuals() >= 0.0));
-      self.values().lazyAssign((self.residuals().template replicate<1,Values::ColsAtCompileTime>() >= 0.0).select(other.values(),0.0));
+      const ValidityMask mask = other.validity();
+      self.values().lazyAssign(other.values());
+      self.residuals().resize(mask.size(), Residuals::ColsAtCompileTime);
+      mask.apply(self.values(), self.residuals());
     };
     
     template <typename U, typename V>
@@ -70,6 +70,7 @@ namespace math
    * @tparam XprOne type of the left hand side operation
    * @tparam XprTwo type of the right hand side operation
    * All binary operations shall inherit of this class to correctly manage the generation of the associated residuals.
+   * The residuals of a binary operation only represent the validity of its samples. When the operation is assigned to an array, its validity is computed with the method validity() (one bit per sample) and converted to residuals only once. The method residuals() is still used when the operation is nested in an expression requiring residuals (e.g. MeanOp).
    * Inherit classes must implement also the following methods:
    *  - Index rows() const _OPENMA_NOEXCEPT
    *  - auto values() const _OPENMA_NOEXCEPT
@@ -114,6 +115,11 @@ namespace math
      */
     const Derived& derived() const _OPENMA_NOEXCEPT {return static_cast<const Derived&>(*this);};
     
+    /**
+     * Returns the word-wise conjunction of the validity masks of both expressions. No residual is evaluated.
+     */
+    ValidityMask validity() const {return this->m_Xpr1.validity() & this->m_Xpr2.validity();};
+    
     BinaryOp& operator=(const BinaryOp& ) = delete;
   };
   
@@ -124,7 +130,7 @@ namespace math
   template <typename XprOne, typename XprTwo>
   struct Traits<DifferenceOp<XprOne,XprTwo>>
   {
-    static _OPENMA_CONSTEXPR int Processing = Full;
+    static _OPENMA_CONSTEXPR int Processing = Masked;
   };
 
   // ----------------------------------------------------------------------- //
@@ -184,7 +190,7 @@ namespace math
   template <typename XprOne, typename XprTwo>
   struct Traits<SumOp<XprOne,XprTwo>>
   {
-    static _OPENMA_CONSTEXPR int Processing = Full;
+    static _OPENMA_CONSTEXPR int Processing = Masked;
   };
   
   // ----------------------------------------------------------------------- //
@@ -243,7 +249,7 @@ namespace math
   template <typename XprOne, typename XprTwo>
   struct Traits<CrossOp<XprOne,XprTwo>>
   {
-    static _OPENMA_CONSTEXPR int Processing = Full;
+    static _OPENMA_CONSTEXPR int Processing = Masked;
   };
   
   // ----------------------------------------------------------------------- //
@@ -318,7 +324,7 @@ namespace math
   template <typename XprOne, typename XprTwo>
   struct Traits<TransformOp<XprOne,XprTwo>>
   {
-    static _OPENMA_CONSTEXPR int Processing = Full;
+    static _OPENMA_CONSTEXPR int Processing = Masked;
   };
   
   // ----------------------------------------------------------------------- //
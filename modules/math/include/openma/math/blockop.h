@@ -137,6 +137,11 @@ namespace math
       return this->mr_Xpr.derived().residuals().template block<Eigen::Dynamic,1>(0,0,this->mr_Xpr.derived().residuals().rows(),1);
     };
     
+    /**
+     * Returns the validity mask of the expression. A block shares the residuals of its expression.
+     */
+    ValidityMask validity() const {return this->mr_Xpr.validity();};
+    
     /**
      * Assignment operator from another block object. This will assign the content of @a other to the expression stored in this Block object.
      */    
@@ -70,6 +70,27 @@ namespace math
   template <typename Xpr> class EulerAnglesOp;
   template <typename Xpr, unsigned U> class DerivativeOp;
   template <typename Xpr> class SkewReduxOp;
+  template <typename Xpr> class FillGapsOp;
+  
+  /**
+   * Interpolation methods available to fill the gaps of a template expression (see XprBase::fillGaps()).
+   * @ingroup openma_math
+   */
+  enum class GapFilling : int
+  {
+    Linear = 0, ///< Linear interpolation between the samples bounding the gap.
+    CubicSpline ///< Natural cubic spline passing by the valid samples around the gap.
+  };
+  
+  /**
+   * Computation modes available to extract Euler angles (see XprBase::eulerAngles()).
+   * @ingroup openma_math
+   */
+  enum class EulerAnglesMode : int
+  {
+    Exact = 0, ///< Each sample is extracted using the arctangent function of the standard library.
+    Approximate ///< All the samples are extracted at once using a vectorized polynomial approximation of the arctangent (absolute error lower than 1e-7 rad).
+  };
 };
 };
 
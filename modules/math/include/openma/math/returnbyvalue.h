@@ -40,6 +40,9 @@
 #include <type_traits>
 #include <vector>
 #include <array>
+#include <algorithm> // std::min
+#include <cmath> // std::round
+#include <utility> // std::move
 
 namespace Eigen
 {
@@ -463,6 +466,89 @@ namespace internal
     return res;
   }
   
+  // Approximation of atan2 (polynomial of Abramowitz & Stegun, 4.4.49). The absolute error is lower than 1e-7 rad.
+  // NOTE: This function is written without branch to let the compiler vectorize the loops using it.
+  template <typename Scalar>
+  inline Scalar fast_atan2(Scalar y, Scalar x)
+  {
+    const Scalar ax = std::abs(x), ay = std::abs(y);
+    const Scalar num = (ax > ay) ? ay : ax;
+    const Scalar den = (ax > ay) ? ax : ay;
+    // The denominator is never null to return 0 when x and y are null (as std::atan2)
+    const Scalar t = num / ((den > std::numeric_limits<Scalar>::min()) ? den : std::numeric_limits<Scalar>::min());
+    const Scalar t2 = t * t;
+    Scalar r = 0.0028662257;
+    r = r * t2 - 0.0161657367;
+    r = r * t2 + 0.0429096138;
+    r = r * t2 - 0.0752896400;
+    r = r * t2 + 0.1065626393;
+    r = r * t2 - 0.1420889944;
+    r = r * t2 + 0.1999355085;
+    r = r * t2 - 0.3333314528;
+    r = (r * t2 + 1.0) * t;
+    r = (ay > ax) ? Scalar(1.57079632679489661923) - r : r;
+    r = (x < Scalar(0)) ? Scalar(3.14159265358979323846) - r : r;
+    return (y < Scalar(0)) ? -r : r;
+  }
+  
+  // Batch version of rotation_matrix_to_euler_sym (ABA) and rotation_matrix_to_euler_unsym (ABC) working on all the samples (column-major rotations with 9 columns) in a single pass
+  template <typename R, typename V>
+  inline void rotation_matrix_to_euler_batch(R& result, const V& values, typename V::Index i, typename V::Index j, typename V::Index k, typename V::Scalar f, bool sym)
+  {
+    using Index = typename V::Index;
+    using Scalar = typename V::Scalar;
+    const Index rows = values.rows();
+    const Scalar eps = NumTraits<Scalar>::dummy_precision();
+    // Coefficient (r,c) of the rotation matrices
+    auto rot = [&values](Index r, Index c) -> const Scalar* {return values.data() + (r + 3 * c) * values.outerStride();};
+    const Scalar *rii = rot(i,i), *rij = rot(i,j), *rik = rot(i,k), *rji = rot(j,i), *rjj = rot(j,j), *rjk = rot(j,k), *rki = rot(k,i), *rkj = rot(k,j), *rkk = rot(k,k);
+    if (sym)
+    {
+      for (Index idx = 0 ; idx < rows ; ++idx)
+      {
+        const Scalar n = std::sqrt(rji[idx] * rji[idx] + rki[idx] * rki[idx]);
+        const bool locked = n <= eps;
+        result.coeffRef(idx,0) = locked ? Scalar(0) : f * fast_atan2(rji[idx], rki[idx]);
+        result.coeffRef(idx,1) = fast_atan2(n, rii[idx]);
+        result.coeffRef(idx,2) = locked ? ((rii[idx] > Scalar(0)) ? f : -f) * fast_atan2(-rkj[idx], rjj[idx]) : f * fast_atan2(rij[idx], -rik[idx]);
+      }
+    }
+    else
+    {
+      for (Index idx = 0 ; idx < rows ; ++idx)
+      {
+        const Scalar n = std::sqrt(rii[idx] * rii[idx] + rij[idx] * rij[idx]);
+        const bool locked = n <= eps;
+        result.coeffRef(idx,0) = locked ? Scalar(0) : f * fast_atan2(rjk[idx], rkk[idx]);
+        result.coeffRef(idx,1) = f * fast_atan2(-rik[idx], n);
+        result.coeffRef(idx,2) = locked ? ((rik[idx] > Scalar(0)) ? f : -f) * fast_atan2(-rkj[idx], rjj[idx]) : f * fast_atan2(rij[idx], rii[idx]);
+      }
+    }
+  }
+  
+  // Remove the jumps of 2*pi between consecutive samples. The invalid samples of the input (given by its validity mask) are skipped.
+  template <typename R>
+  inline void unwrap_euler_angles(R& result, const ma::math::ValidityMask& validity)
+  {
+    using Scalar = typename R::Scalar;
+    const Scalar twopi = 6.28318530717958647692;
+    bool first = true;
+    Scalar previous[3] = {0.0, 0.0, 0.0};
+    for (typename R::Index idx = 0, rows = result.rows() ; idx < rows ; ++idx)
+    {
+      if (!validity.test(idx))
+        continue;
+      for (typename R::Index c = 0 ; c < 3 ; ++c)
+      {
+        Scalar& angle = result.coeffRef(idx,c);
+        if (!first)
+          angle += twopi * std::round((previous[c] - angle) / twopi);
+        previous[c] = angle;
+      }
+      first = false;
+    }
+  }
+  
   template<typename V> struct EulerAnglesOpValues;
 
   template<typename V>
@@ -481,40 +567,53 @@ namespace internal
     const Index m_A0;
     const Index m_A1;
     const Index m_A2;
+    const ma::math::EulerAnglesMode m_Mode;
+    const bool m_Unwrap;
+    const ma::math::ValidityMask m_Validity;
   public:
-    EulerAnglesOpValues(const V& v, const unsigned& a0, const unsigned& a1, const unsigned& a2) : m_V(v), m_A0(a0), m_A1(a1), m_A2(a2) {};
+    EulerAnglesOpValues(const V& v, const unsigned& a0, const unsigned& a1, const unsigned& a2, ma::math::EulerAnglesMode mode, bool unwrap, ma::math::ValidityMask validity) : m_V(v), m_A0(a0), m_A1(a1), m_A2(a2), m_Mode(mode), m_Unwrap(unwrap), m_Validity(std::move(validity)) {};
     template <typename R> inline void evalTo(R& result) const
     {
       using MapStride = Eigen::Stride<Eigen::Dynamic,Eigen::Dynamic>;
       using MapMatrix33 = Eigen::Map<const Eigen::Matrix<double,3,3>, Eigen::Unaligned, MapStride>;
       const Index rows = this->m_V.rows();
-      const Eigen::Array<double,Eigen::Dynamic,9> values = this->m_V.block(0,0,rows,9);
+      // NOTE: The rotations are evaluated in a temporary only if the input does not give a direct access to its data.
+      const Eigen::Ref<const Eigen::Array<double,Eigen::Dynamic,Eigen::Dynamic>> values = this->m_V.block(0,0,rows,9);
       // result.resize(rows, Eigen::NoChange);
-      const MapStride stride(3*rows,rows);
-      MapMatrix33 rot(nullptr,stride);
       Index i = 0, j = 0, k = 0;
       Scalar f = Scalar(0);
       rotation_matrix_to_euler_order<R>(i,j,k,f,this->m_A0,this->m_A1);
-      // ABA
-      if (this->m_A0 == this->m_A2)
+      if (this->m_Mode == ma::math::EulerAnglesMode::Approximate)
       {
-        for (Index idx = 0 ; idx < rows ; ++idx)
-        {
-          // See http://eigen.tuxfamily.org/dox/group__TutorialMapClass.html (section Changing the mapped array) for the syntax
-          new (&rot) MapMatrix33(values.data()+idx,stride);
-          result.row(idx) = rotation_matrix_to_euler_sym(rot, i, j, k, f);
-        }
+        rotation_matrix_to_euler_batch(result, values, i, j, k, f, this->m_A0 == this->m_A2);
       }
-      // ABC
       else
       {
-        for (Index idx = 0 ; idx < rows ; ++idx)
+        const MapStride stride(3*values.outerStride(),values.outerStride());
+        MapMatrix33 rot(nullptr,stride);
+        // ABA
+        if (this->m_A0 == this->m_A2)
+        {
+          for (Index idx = 0 ; idx < rows ; ++idx)
+          {
+            // See http://eigen.tuxfamily.org/dox/group__TutorialMapClass.html (section Changing the mapped array) for the syntax
+            new (&rot) MapMatrix33(values.data()+idx,stride);
+            result.row(idx) = rotation_matrix_to_euler_sym(rot, i, j, k, f);
+          }
+        }
+        // ABC
+        else
         {
-          // See http://eigen.tuxfamily.org/dox/group__TutorialMapClass.html (section Changing the mapped array) for the syntax
-          new (&rot) MapMatrix33(values.data()+idx,stride);
-          result.row(idx) = rotation_matrix_to_euler_unsym(rot, i, j, k, f);
+          for (Index idx = 0 ; idx < rows ; ++idx)
+          {
+            // See http://eigen.tuxfamily.org/dox/group__TutorialMapClass.html (section Changing the mapped array) for the syntax
+            new (&rot) MapMatrix33(values.data()+idx,stride);
+            result.row(idx) = rotation_matrix_to_euler_unsym(rot, i, j, k, f);
+          }
         }
       }
+      if (this->m_Unwrap)
+        unwrap_euler_angles(result, this->m_Validity);
     };
     Index rows() const {return this->m_V.rows();};
     Index cols() const {return 3;};
@@ -636,6 +735,92 @@ namespace internal
     Index rows() const {return this->m_V.rows();};
     Index cols() const {return this->m_V.cols();};
   };
+  
+  // ----------------------------------------------------------------------- //
+  //                         FillGapsOp return value
+  // ----------------------------------------------------------------------- //
+  
+  // NOTE: A gap is described by 4 elements: the index of its first sample, its length, the number of valid samples before and after it.
+  
+  template <typename R>
+  inline void fill_gap(R& values, const std::array<unsigned,4>& gap, ma::math::GapFilling method)
+  {
+    using Index = typename R::Index;
+    const Index istart = gap[0], ilen = gap[1];
+    // A natural cubic spline passing by only two knots is a straight line
+    if ((method == ma::math::GapFilling::Linear) || ((gap[2] < 2) && (gap[3] < 2)))
+    {
+      for (Index i = 0 ; i < ilen ; ++i)
+      {
+        const double w = static_cast<double>(i + 1) / static_cast<double>(ilen + 1);
+        values.row(istart+i) = (1.0 - w) * values.row(istart-1) + w * values.row(istart+ilen);
+      }
+      return;
+    }
+    // Natural cubic spline computed on (at most) 4 valid samples on each side of the gap.
+    // The tridiagonal system giving the second derivatives is solved with the Thomas algorithm for all the columns at once.
+    const Index nb = std::min(gap[2], 4u), na = std::min(gap[3], 4u), n = nb + na;
+    Eigen::Array<double,Eigen::Dynamic,1> x(n), cp(n);
+    Eigen::Array<double,Eigen::Dynamic,R::ColsAtCompileTime> y(n,values.cols()), m(n,values.cols());
+    for (Index k = 0 ; k < nb ; ++k)
+    {
+      x.coeffRef(k) = static_cast<double>(istart - nb + k);
+      y.row(k) = values.row(istart - nb + k);
+    }
+    for (Index k = 0 ; k < na ; ++k)
+    {
+      x.coeffRef(nb+k) = static_cast<double>(istart + ilen + k);
+      y.row(nb+k) = values.row(istart + ilen + k);
+    }
+    m.setZero();
+    cp.setZero();
+    for (Index i = 1 ; i < n-1 ; ++i)
+    {
+      const double h0 = x.coeff(i) - x.coeff(i-1), h1 = x.coeff(i+1) - x.coeff(i);
+      const double den = 2.0 * (h0 + h1) - h0 * cp.coeff(i-1);
+      cp.coeffRef(i) = h1 / den;
+      m.row(i) = (6.0 * ((y.row(i+1) - y.row(i)) / h1 - (y.row(i) - y.row(i-1)) / h0) - h0 * m.row(i-1)) / den;
+    }
+    for (Index i = n-3 ; i > 0 ; --i)
+      m.row(i) -= cp.coeff(i) * m.row(i+1);
+    const Index k = nb - 1;
+    const double h = x.coeff(k+1) - x.coeff(k);
+    for (Index i = 0 ; i < ilen ; ++i)
+    {
+      const double a = x.coeff(k+1) - static_cast<double>(istart + i), b = static_cast<double>(istart + i) - x.coeff(k);
+      values.row(istart+i) = m.row(k) * (a * a * a / (6.0 * h)) + m.row(k+1) * (b * b * b / (6.0 * h))
+                           + (y.row(k) / h - m.row(k) * h / 6.0) * a + (y.row(k+1) / h - m.row(k+1) * h / 6.0) * b;
+    }
+  };
+  
+  template<typename V> struct FillGapsOpValues;
+
+  template<typename V>
+  struct traits<FillGapsOpValues<V>>
+  {
+    using ReturnType = typename ma::math::Traits<ma::math::Array<std::decay<V>::type::ColsAtCompileTime>>::Values;
+  };
+  
+  template<typename V>
+  struct FillGapsOpValues : public Eigen::ReturnByValue<FillGapsOpValues<V>>
+  {
+    using InputType = typename std::decay<V>::type;
+    using Index = typename InputType::Index;
+    typename InputType::Nested m_V;
+    const std::vector<std::array<unsigned,4>>& m_G;
+    ma::math::GapFilling m_M;
+    
+  public:
+    FillGapsOpValues(const V& v, const std::vector<std::array<unsigned,4>>& g, ma::math::GapFilling m) : m_V(v), m_G(g), m_M(m) {};
+    template <typename R> inline void evalTo(R& result) const
+    {
+      result = this->m_V;
+      for (const auto& gap : this->m_G)
+        fill_gap(result, gap, this->m_M);
+    };
+    Index rows() const {return this->m_V.rows();};
+    Index cols() const {return this->m_V.cols();};
+  };
 };
 };
 
@@ -48,7 +48,9 @@ namespace math
     // Only the values were processed. The generation of the residuals as well as the regeneration of the values for negative residuals must be done
     ValuesOnly = 0x01, 
     // The values and residuals were computed. Still, the regeneration of the values for negative residuals must be done
-    Full = 0x02
+    Full = 0x02,
+    // Only the values were processed. The residuals only represent the validity of the samples and are generated from a ValidityMask (see XprBase::validity()) during the assignment. The regeneration of the values for invalid samples must be done
+    Masked = 0x04
   };
   
   template <typename T> struct Traits {};
@@ -111,6 +111,12 @@ namespace math
      */
     const Derived& derived() const _OPENMA_NOEXCEPT {return static_cast<const Derived&>(*this);};
     
+    /**
+     * Returns the validity mask of the input expression. No residual is evaluated.
+     * @note Operations which do not keep the same samples than their input (e.g. MeanOp, DerivativeOp) must reimplement this method.
+     */
+    ValidityMask validity() const {return this->m_Xpr.validity();};
+    
     UnaryOp& operator=(const UnaryOp& ) = delete;
   };
   
@@ -243,6 +249,11 @@ namespace math
     {
       return Traits<UnaryOp<MeanOp<Xpr>,Xpr>>::Residuals::Constant(1, (this->m_Xpr.residuals() >= 0.0).any() ? 0.0 : -1.0);
     };
+    
+    /**
+     * Returns the validity mask of this operation. The single sample is valid if at least one sample of the input is valid.
+     */
+    ValidityMask validity() const {return ValidityMask(1, this->m_Xpr.validity().any());};
   };
   
   // Defined here due to the declaration order of the classes. The associated documentation is in the header of the XprBase class.
@@ -428,6 +439,11 @@ namespace math
     {
       return this->m_Xpr.residuals().replicate(this->m_Rows,1);
     };
+    
+    /**
+     * Returns the validity mask of this operation. As the samples are not the same than the input, the mask is generated from the computed residuals.
+     */
+    ValidityMask validity() const {return ValidityMask::fromResiduals(this->residuals());};
   };
   
   // Defined here due to the declaration order of the classes. The associated documentation is in the header of the XprBase class.
@@ -627,6 +643,11 @@ namespace math
       using R = decltype(this->m_Xpr.residuals());
       return Eigen::internal::DownsampleOpValues<R>(this->m_Xpr.residuals(),this->m_Factor);
     };
+    
+    /**
+     * Returns the validity mask of this operation. As the samples are not the same than the input, the mask is generated from the computed residuals.
+     */
+    ValidityMask validity() const {return ValidityMask::fromResiduals(this->residuals());};
   };
   
   // Defined here due to the declaration order of the classes. The associated documentation is in the header of the XprBase class.
@@ -690,6 +711,11 @@ namespace math
     {
       return Traits<UnaryOp<MinOp<Xpr>,Xpr>>::Residuals::Constant(1, (this->m_Xpr.residuals() >= 0.0).any() ? 0.0 : -1.0);
     };
+    
+    /**
+     * Returns the validity mask of this operation. The single sample is valid if at least one sample of the input is valid.
+     */
+    ValidityMask validity() const {return ValidityMask(1, this->m_Xpr.validity().any());};
   };
   
   // Defined here due to the declaration order of the classes. The associated documentation is in the header of the XprBase class.
@@ -752,6 +778,11 @@ namespace math
     {
       return Traits<UnaryOp<MaxOp<Xpr>,Xpr>>::Residuals::Constant(1, (this->m_Xpr.residuals() >= 0.0).any() ? 0.0 : -1.0);
     };
+    
+    /**
+     * Returns the validity mask of this operation. The single sample is valid if at least one sample of the input is valid.
+     */
+    ValidityMask validity() const {return ValidityMask(1, this->m_Xpr.validity().any());};
   };
   
   // Defined here due to the declaration order of the classes. The associated documentation is in the header of the XprBase class.
@@ -802,6 +833,8 @@ namespace math
     Index m_Axis0;
     Index m_Axis1;
     Index m_Axis2;
+    EulerAnglesMode m_Mode;
+    bool m_Unwrap;
     
   public:
     /**
@@ -813,10 +846,12 @@ namespace math
      * auto eao1 = EulerAnglesOp(pose,0,1,2); // Extract eurler angles using axes X, Y', and Z".
      * auto eao2 = EulerAnglesOp(pose,2,0,1); // Extract eurler angles using axes Z, X', and Y".
      * @endcode
+     * The computation @a mode let you choose between the exact extraction (default) and a faster approximated one computing all the samples at once.
+     * If @a unwrap is set to true, the jumps of 2*pi between consecutive valid samples are removed.
      */
-    EulerAnglesOp(const XprBase<Xpr>& x, Index a0, Index a1, Index a2)
+    EulerAnglesOp(const XprBase<Xpr>& x, Index a0, Index a1, Index a2, EulerAnglesMode mode = EulerAnglesMode::Exact, bool unwrap = false)
     : UnaryOp<EulerAnglesOp<Xpr>,Xpr>(x),
-      m_Axis0(a0), m_Axis1(a1), m_Axis2(a2)
+      m_Axis0(a0), m_Axis1(a1), m_Axis2(a2), m_Mode(mode), m_Unwrap(unwrap)
     {};
       
     /**
@@ -830,7 +865,8 @@ namespace math
     auto values() const _OPENMA_NOEXCEPT -> Eigen::internal::EulerAnglesOpValues<decltype(OPENMA_MATHS_DECLVAL_NESTED(Xpr).values())>
     {
       using V = decltype(this->m_Xpr.values());
-      return Eigen::internal::EulerAnglesOpValues<V>(this->m_Xpr.values(), this->m_Axis0, this->m_Axis1, this->m_Axis2);
+      // The validity of the input is only required to skip its invalid samples during the unwrapping.
+      return Eigen::internal::EulerAnglesOpValues<V>(this->m_Xpr.values(), this->m_Axis0, this->m_Axis1, this->m_Axis2, this->m_Mode, this->m_Unwrap, this->m_Unwrap ? this->m_Xpr.validity() : ValidityMask());
     };
 
     /**
@@ -844,9 +880,9 @@ namespace math
   
   // Defined here due to the declaration order of the classes. The associated documentation is in the header of the XprBase class.
   template <typename Derived>
-  inline const EulerAnglesOp<Derived> XprBase<Derived>::eulerAngles(Index a0, Index a1, Index a2) const _OPENMA_NOEXCEPT
+  inline const EulerAnglesOp<Derived> XprBase<Derived>::eulerAngles(Index a0, Index a1, Index a2, EulerAnglesMode mode, bool unwrap) const _OPENMA_NOEXCEPT
   {
-    return EulerAnglesOp<Derived>(*this,a0,a1,a2);
+    return EulerAnglesOp<Derived>(*this,a0,a1,a2,mode,unwrap);
   };
 
   // ----------------------------------------------------------------------- //
@@ -913,6 +949,11 @@ namespace math
       prepare_window_processing(this->m_Residuals, this->m_Windows, this->m_Xpr.residuals(), Eigen::internal::FiniteDifferenceCoefficents<Order>::minimum_window_length());
       return this->m_Residuals;
     };
+    
+    /**
+     * Returns the validity mask of this operation. As the samples are not the same than the input, the mask is generated from the computed residuals.
+     */
+    ValidityMask validity() const {return ValidityMask::fromResiduals(this->residuals());};
   };
   
   // Defined here due to the declaration order of the classes. The associated documentation is in the header of the XprBase class.
@@ -998,6 +1039,84 @@ namespace math
   {
     return SkewReduxOp<Derived>(*this);
   };
+  
+  // ----------------------------------------------------------------------- //
+  //                               FILLGAPSOP
+  // ----------------------------------------------------------------------- //
+  
+  template <typename Xpr>
+  struct Traits<FillGapsOp<Xpr>>
+  {
+    static _OPENMA_CONSTEXPR int Processing = Full;
+  };
+  
+  // ----------------------------------------------------------------------- //
+  
+  /**
+   * @class FillGapsOp openma/math/unaryop.h
+   * @brief Interpolate the gaps of an expression
+   * @tparam Xpr Type of the expression to transform
+   * Template expression to fill the gaps (i.e. consecutive invalid samples surrounded by valid ones) of each column.
+   * The gaps are processed one by one and the interpolation is realized for all the columns at once.
+   * The residuals of the filled samples are set to 0. Gaps longer than the maximum length given to the constructor are kept as is.
+   *
+   * @ingroup openma_math
+   */
+  template <typename Xpr>
+  class FillGapsOp : public UnaryOp<FillGapsOp<Xpr>,Xpr>
+  {
+    using Index = typename Traits<UnaryOp<FillGapsOp<Xpr>, Xpr>>::Index; ///< Type used to access elements in Values or Residuals.
+    using Residuals = typename Traits<Array<FillGapsOp::ColsAtCompileTime>>::Residuals; ///< Type used to store the generated residuals
+    
+    mutable std::vector<std::array<unsigned,4>> m_Gaps; ///< Store the gaps to fill.
+    mutable Residuals m_Residuals; ///< Store the residual generated for the filled expression.
+    GapFilling m_Method; ///< Interpolation method.
+    unsigned m_MaximumGap; ///< Maximum number of samples in a gap to fill it.
+    
+  public:
+    /**
+     * Constructor
+     */
+    FillGapsOp(const XprBase<Xpr>& x, GapFilling method, unsigned maxGap)
+    : UnaryOp<FillGapsOp<Xpr>,Xpr>(x), m_Gaps(), m_Residuals(), m_Method(method), m_MaximumGap(maxGap)
+    {};
+    
+    /**
+     * Returns the number of rows that shall have the result of this operation. Internaly, this method relies on the number of rows of the given expresion.
+     */
+    Index rows() const _OPENMA_NOEXCEPT {return this->m_Xpr.rows();};
+
+    /**
+     * Returns a template expression corresponding to the calculation of this operation.
+     */
+    auto values() const _OPENMA_NOEXCEPT -> Eigen::internal::FillGapsOpValues<decltype(OPENMA_MATHS_DECLVAL_NESTED(Xpr).values())>
+    {
+      prepare_gap_processing(this->m_Residuals, this->m_Gaps, this->m_Xpr.residuals(), this->m_MaximumGap);
+      using V = decltype(this->m_Xpr.values());
+      return Eigen::internal::FillGapsOpValues<V>(this->m_Xpr.values(), this->m_Gaps, this->m_Method);
+    };
+
+    /**
+     * Returns the residuals associated with this operation. The residuals of the filled samples are set to 0, the other ones are the same than the input.
+     */
+    const Residuals& residuals() const _OPENMA_NOEXCEPT
+    {
+      prepare_gap_processing(this->m_Residuals, this->m_Gaps, this->m_Xpr.residuals(), this->m_MaximumGap);
+      return this->m_Residuals;
+    };
+    
+    /**
+     * Returns the validity mask of this operation. As filled samples become valid, the mask is generated from the computed residuals.
+     */
+    ValidityMask validity() const {return ValidityMask::fromResiduals(this->residuals());};
+  };
+  
+  // Defined here due to the declaration order of the classes. The associated documentation is in the header of the XprBase class.
+  template <typename Derived>
+  inline const FillGapsOp<Derived> XprBase<Derived>::fillGaps(GapFilling method, unsigned maxGap) const _OPENMA_NOEXCEPT
+  {
+    return FillGapsOp<Derived>(*this,method,maxGap);
+  };
 
 };
 };
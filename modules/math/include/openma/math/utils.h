@@ -37,6 +37,7 @@
 
 #include "openma/math_export.h"
 #include "openma/base/timesequence.h"
+#include "openma/base/logger.h"
 
 OPENMA_MATHS_EXPORT bool _ma_math_verify_timesequence(const ma::TimeSequence* ts, int type, unsigned components, unsigned offset);
 
@@ -225,19 +226,53 @@ namespace math
     * Export raw arrays to a time sequence.
     * The behaviour of this function is the following:
     *  - First, look for an existing time sequence with the given name and type.
-    *  - If a time sequence is found, its content is replaced by the given one
+    *  - If a time sequence is found, its content is replaced by the given one (its data are reallocated only if the number of samples changed)
     *  - Otherwise, a new time sequence is created
+    * If the found time sequence has not the requested number of @a components, an error is emitted and nullptr is returned.
     * @warning The @a components must contains the number of columns of the @a values plus one (column of the @a residuals).
     */
   OPENMA_MATHS_EXPORT TimeSequence* to_timesequence(unsigned components, unsigned samples, const double* values, const double* residuals, const std::string& name, double rate, double start, int type, const std::string& unit, Node* parent);
   
   /**
-   * Convenient method to transform math array object (and derived) to a time sequence.
+   * Evaluate the template expression @a source directly into the data of the time sequence @a ts.
+   * The values are written in the first components and the residuals in the last one. No intermediate array is created.
+   * Returns false (and nothing is assigned) if the number of samples of @a ts is not the same than the number of rows of @a source or if its number of components is not equal to the number of columns of @a source plus one. In this case, an error is emitted.
+   * @warning The expression @a source must not read the data stored in @a ts (aliasing).
    */
   template <typename T>
-  inline TimeSequence* to_timesequence(const ArrayBase<T>& source, const std::string& name, double rate, double start, int type, const std::string& unit, Node* parent)
+  inline bool assign_to(const XprBase<T>& source, TimeSequence* ts)
   {
-    return to_timesequence(source.cols()+1, source.rows(), source.values().data(), source.residuals().data(), name, rate, start, type, unit, parent);
+    using Result = Array<XprBase<T>::ColsAtCompileTime>;
+    if (ts == nullptr)
+      return false;
+    const auto rows = static_cast<const T&>(source).derived().rows();
+    if (ts->samples() != static_cast<unsigned>(rows))
+    {
+      error("The time sequence '%s' has %i samples while the expression to assign has %i rows. Assignment aborted.", ts->name().c_str(), ts->samples(), static_cast<int>(rows));
+      return false;
+    }
+    if (ts->components() != static_cast<unsigned>(Result::ColsAtCompileTime + 1))
+    {
+      error("The time sequence '%s' has %i components while the expression to assign requires %i. Assignment aborted.", ts->name().c_str(), ts->components(), static_cast<int>(Result::ColsAtCompileTime + 1));
+      return false;
+    }
+    const unsigned samples = ts->samples();
+    Map<Result> target(samples, ts->data(), ts->data() + Result::ColsAtCompileTime * samples);
+    target = source;
+    return true;
+  };
+  
+  /**
+   * Convenient method to transform math array object (and derived) or any template expression to a time sequence.
+   * If the time sequence already exists (see the raw version of this function), its data are reused and the expression is evaluated directly into them (see assign_to()).
+   */
+  template <typename T>
+  inline TimeSequence* to_timesequence(const XprBase<T>& source, const std::string& name, double rate, double start, int type, const std::string& unit, Node* parent)
+  {
+    const auto& xpr = static_cast<const T&>(source).derived();
+    auto ts = to_timesequence(XprBase<T>::ColsAtCompileTime+1, xpr.rows(), nullptr, nullptr, name, rate, start, type, unit, parent);
+    assign_to(source, ts);
+    return ts;
   };
   
   /**
@@ -254,13 +289,15 @@ namespace math
     assert(v.rows() == w.rows());
     assert(w.rows() == o.rows());
     auto ts = to_timesequence(13, u.rows(), nullptr, nullptr, name, rate, start, TimeSequence::Pose, "", parent);
-    const Pose::Residuals residuals = generate_residuals((u.residuals() >= 0) && (v.residuals() >= 0) && (w.residuals() >= 0) && (o.residuals() >= 0));
-    const unsigned samples = 3 * residuals.rows();
+    if (ts == nullptr)
+      return nullptr;
+    const unsigned samples = 3 * u.rows();
     std::copy_n(u.values().data(), samples, ts->data());
     std::copy_n(v.values().data(), samples, ts->data() + samples);
     std::copy_n(w.values().data(), samples, ts->data() + 2 * samples);
     std::copy_n(o.values().data(), samples, ts->data() + 3 * samples);
-    std::copy_n(residuals.data(), residuals.rows(), ts->data() + 4 * samples);
+    Eigen::Map<Pose::Residuals> residuals(ts->data() + 4 * samples, u.rows());
+    residuals.lazyAssign(generate_residuals((u.residuals() >= 0) && (v.residuals() >= 0) && (w.residuals() >= 0) && (o.residuals() >= 0)));
     return ts;
   };
   
@@ -276,15 +313,69 @@ namespace math
     assert(f.rows() == m.rows());
     assert(m.rows() == p.rows());
     auto ts = to_timesequence(10, f.rows(), nullptr, nullptr, name, rate, start, TimeSequence::Wrench, "", parent);
-    const Pose::Residuals residuals = generate_residuals((f.residuals() >= 0) && (m.residuals() >= 0) && (p.residuals() >= 0));
-    const unsigned samples = 3 * residuals.rows();
+    if (ts == nullptr)
+      return nullptr;
+    const unsigned samples = 3 * f.rows();
     std::copy_n(f.values().data(), samples, ts->data());
     std::copy_n(m.values().data(), samples, ts->data() + samples);
     std::copy_n(p.values().data(), samples, ts->data() + 2 * samples);
-    std::copy_n(residuals.data(), residuals.rows(), ts->data() + 3 * samples);
+    Eigen::Map<Wrench::Residuals> residuals(ts->data() + 3 * samples, f.rows());
+    residuals.lazyAssign(generate_residuals((f.residuals() >= 0) && (m.residuals() >= 0) && (p.residuals() >= 0)));
     return ts;
   };
   
+  // ======================================================================= //
+  //                               GAP FILLING
+  // ======================================================================= //
+  
+  /**
+   * Fill in place the gaps of the time sequence @a ts using the given interpolation @a method. Gaps longer than @a maxGap samples are not filled.
+   * The time sequence must be a reconstructed one (i.e. the last component contains the residuals). The residuals of the filled samples are set to 0.
+   * Returns the number of filled samples.
+   * @note Each gap is interpolated for all the components at once.
+   * @sa XprBase::fillGaps()
+   * @ingroup openma_math
+   */
+  OPENMA_MATHS_EXPORT unsigned fill_gaps(TimeSequence* ts, GapFilling method, unsigned maxGap = std::numeric_limits<unsigned>::max());
+  
+  /**
+   * Fill in place the gaps of a marker trajectory (@a samples rows, 3 columns stored in @a values, residuals stored in @a residuals) using a rigid body assumption with the markers of the given cluster.
+   * For each sample of a gap, the rigid transformation between the cluster at the last valid sample before the gap (resp. the first one after the gap) and the cluster at the current sample is estimated using least squares (SVD).
+   * The transformed positions obtained from each side of the gap are then linearly blended. A side is used only if at least 3 markers of the cluster are valid for both samples.
+   * The residuals of the filled samples are set to 0. Gaps longer than @a maxGap samples are not filled.
+   * Returns the number of filled samples.
+   * @ingroup openma_math
+   */
+  OPENMA_MATHS_EXPORT unsigned fill_gaps(unsigned samples, double* values, double* residuals, const std::vector<const double*>& clusterValues, const std::vector<const double*>& clusterResiduals, unsigned maxGap);
+  
+  /**
+   * Convenient function to fill the gaps of the marker trajectory @a ts using the rigid body assumption with the given @a cluster of markers.
+   * Markers of the cluster which are not a position or do not have the same number of samples are ignored.
+   * Returns the number of filled samples.
+   * @ingroup openma_math
+   */
+  OPENMA_MATHS_EXPORT unsigned fill_gaps(TimeSequence* ts, const std::vector<const TimeSequence*>& cluster, unsigned maxGap = std::numeric_limits<unsigned>::max());
+  
+  /**
+   * Convenient function to fill the gaps of the array @a target (3 columns) using the rigid body assumption with the given @a cluster of arrays (3 columns each).
+   * Returns the number of filled samples.
+   * @ingroup openma_math
+   */
+  template <typename T, typename U>
+  inline unsigned fill_gaps(ArrayBase<T>& target, const std::vector<U>& cluster, unsigned maxGap = std::numeric_limits<unsigned>::max())
+  {
+    static_assert(T::ColsAtCompileTime == 3, "Only data with 3 columns (e.g to represent a marker) can be used with this function.");
+    static_assert(U::ColsAtCompileTime == 3, "Only data with 3 columns (e.g to represent a marker) can be used with this function.");
+    std::vector<const double*> values, residuals;
+    for (const auto& marker : cluster)
+    {
+      assert(marker.rows() == target.rows());
+      values.push_back(marker.values().data());
+      residuals.push_back(marker.residuals().data());
+    }
+    return fill_gaps(target.rows(), target.values().data(), target.residuals().data(), values, residuals, maxGap);
+  };
+  
   // ----------------------------------------------------------------------- //
   
   template <typename Out, typename In>
@@ -321,6 +412,45 @@ namespace math
     }
   };
   
+  // ----------------------------------------------------------------------- //
+  
+  template <typename Out, typename In>
+  inline void prepare_gap_processing(Out& resout, std::vector<std::array<unsigned,4>>& gaps, const In& resin, unsigned maxGap)
+  {
+    if (resout.size() != 0)
+      return;
+    resout = resin;
+    unsigned i = 0, len = resout.rows();
+    // Invalid samples at the beginning cannot be interpolated
+    while ((i < len) && (resout.coeff(i) < 0.))
+      ++i;
+    while (i < len)
+    {
+      // Valid samples before the gap
+      unsigned istart = i;
+      while ((i < len) && (resout.coeff(i) >= 0.))
+        ++i;
+      const unsigned before = i - istart;
+      // The gap itself
+      istart = i;
+      while ((i < len) && (resout.coeff(i) < 0.))
+        ++i;
+      // Invalid samples at the end cannot be interpolated
+      if (i >= len)
+        break;
+      const unsigned ilen = i - istart;
+      // Valid samples after the gap
+      unsigned iafter = i;
+      while ((iafter < len) && (resout.coeff(iafter) >= 0.))
+        ++iafter;
+      if (ilen <= maxGap)
+      {
+        gaps.push_back({{istart,ilen,before,iafter-i}});
+        resout.segment(istart,ilen).setZero();
+      }
+    }
+  };
+  
 };
 };
 
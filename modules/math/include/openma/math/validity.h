@@ -0,0 +1,312 @@
+/* 
+ * Open Source Movement Analysis Library
+ * Copyright (C) 2016, Moveck Solution Inc., all rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 
+ *     * Redistributions of source code must retain the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer.
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials
+ *       provided with the distribution.
+ *     * Neither the name(s) of the copyright holders nor the names
+ *       of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written
+ *       permission.
+ *  
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef __openma_math_validity_h
+#define __openma_math_validity_h
+
+#include <vector>
+#include <bitset>
+#include <cstdint>
+
+namespace ma
+{
+namespace math
+{
+  /**
+   * @class ValidityMask openma/math/validity.h
+   * @brief Compact representation of the validity of each sample of a template expression.
+   *
+   * The residuals stored in an Array use 8 bytes per sample even if most of the operations need only to know if a sample is valid (residual >= 0) or not (residual < 0).
+   * This class packs this information into 1 bit per sample (64 samples per word). The combination of several masks is realized word-wise (see operator&=() and operator|=()).
+   *
+   * A mask can be extracted from any template expression using the method XprBase::validity(). Element-wise unary and binary operations propagate directly the mask of their input(s) without evaluating any residual. This is useful to query the validity of an expression (e.g. to know if all its samples are valid) without evaluating it.
+   * Finally, the method ArrayBase::setValidity() applies a mask on an array. In this case, the real residuals already stored in the array (e.g. reconstruction error of a marker) are kept for valid samples.
+   *
+   * The assignment of an element-wise operation (e.g. a - b, a.norm()) to an Array or a Map (e.g. a TimeSequence) uses this class: the masks of the inputs are combined and converted to residuals (0 or -1) only in the destination (see apply()).
+   * The other operations (e.g. derivative, gap filling) still compute their residuals as double as they can keep real residuals or change the samples' validity based on their neighbours.
+   *
+   * @code{.unparsed}
+   * ma::math::Position a(100), b(100);
+   * // ...
+   * ma::math::ValidityMask mask = a.validity() & b.validity();
+   * if (mask.all())
+   *   // ...
+   * @endcode
+   *
+   * @ingroup openma_math
+   */
+  class ValidityMask
+  {
+  public:
+    using Word = uint64_t; ///< Storage type used to pack the validity of 64 samples.
+    using Index = Eigen::DenseIndex; ///< Type used to access samples.
+    
+    static _OPENMA_CONSTEXPR Index WordBits = 64; ///< Number of samples packed in one word.
+    
+    /**
+     * Returns the number of words required to store @a size samples.
+     */
+    static Index words(Index size) _OPENMA_NOEXCEPT {return (size + WordBits - 1) / WordBits;};
+    
+    /**
+     * Create a mask from the given @a residuals. A sample is valid if its residual is null or positive.
+     */
+    template <typename R>
+    static ValidityMask fromResiduals(const Eigen::DenseBase<R>& residuals)
+    {
+      // Expressions evaluated by value (e.g. ReturnByValue) are computed once, other ones are accessed directly.
+      typename Eigen::internal::nested<R>::type res(residuals.derived());
+      ValidityMask mask(res.rows(), false);
+      const Index numFull = res.rows() / WordBits;
+      for (Index w = 0 ; w < numFull ; ++w)
+      {
+        Word word = 0;
+        const Index offset = w * WordBits;
+        for (Index j = 0 ; j < WordBits ; ++j)
+          word |= Word(res.coeff(offset+j,0) >= 0.0) << j;
+        mask.m_Words[w] = word;
+      }
+      if (numFull * WordBits != res.rows())
+      {
+        Word word = 0;
+        const Index offset = numFull * WordBits;
+        for (Index j = 0 ; j < res.rows() - offset ; ++j)
+          word |= Word(res.coeff(offset+j,0) >= 0.0) << j;
+        mask.m_Words[numFull] = word;
+      }
+      return mask;
+    };
+    
+    /**
+     * Constructor. Create an empty mask.
+     */
+    ValidityMask() _OPENMA_NOEXCEPT
+    : m_Size(0), m_Words()
+    {};
+    
+    /**
+     * Constructor. Create a mask with @a size samples all set to @a valid.
+     */
+    explicit ValidityMask(Index size, bool valid = true)
+    : m_Size(size), m_Words(words(size), valid ? ~Word(0) : Word(0))
+    {
+      this->clearTail();
+    };
+    
+    /**
+     * Returns the number of samples represented by this mask.
+     */
+    Index size() const _OPENMA_NOEXCEPT {return this->m_Size;};
+    
+    /**
+     * Returns the internal storage. The bits after the last sample are always null.
+     */
+    const std::vector<Word>& data() const _OPENMA_NOEXCEPT {return this->m_Words;};
+    
+    /**
+     * Returns true if the sample @a index is valid.
+     */
+    bool test(Index index) const _OPENMA_NOEXCEPT
+    {
+      assert((index >= 0) && (index < this->m_Size));
+      return (this->m_Words[index / WordBits] >> (index % WordBits)) & Word(1);
+    };
+    
+    /**
+     * Sets the validity of the sample @a index.
+     */
+    void set(Index index, bool valid) _OPENMA_NOEXCEPT
+    {
+      assert((index >= 0) && (index < this->m_Size));
+      const Word bit = Word(1) << (index % WordBits);
+      if (valid)
+        this->m_Words[index / WordBits] |= bit;
+      else
+        this->m_Words[index / WordBits] &= ~bit;
+    };
+    
+    /**
+     * Returns the number of valid samples.
+     */
+    Index count() const _OPENMA_NOEXCEPT
+    {
+      Index num = 0;
+      for (const auto& word : this->m_Words)
+        num += static_cast<Index>(std::bitset<WordBits>(word).count());
+      return num;
+    };
+    
+    /**
+     * Returns true if all the samples are valid. An empty mask is considered as not valid.
+     * The words are compared one by one and the comparison stops at the first one with an invalid sample.
+     */
+    bool all() const _OPENMA_NOEXCEPT
+    {
+      if (this->m_Size == 0)
+        return false;
+      const size_t last = this->m_Words.size() - 1;
+      for (size_t w = 0 ; w < last ; ++w)
+      {
+        if (this->m_Words[w] != ~Word(0))
+          return false;
+      }
+      const Index tail = this->m_Size - static_cast<Index>(last) * WordBits;
+      return this->m_Words[last] == ((tail == WordBits) ? ~Word(0) : ((Word(1) << tail) - 1));
+    };
+    
+    /**
+     * Returns true if at least one sample is valid.
+     */
+    bool any() const _OPENMA_NOEXCEPT
+    {
+      for (const auto& word : this->m_Words)
+      {
+        if (word != 0)
+          return true;
+      }
+      return false;
+    };
+    
+    /**
+     * Converts this mask to residuals. Valid samples are set to 0 and invalid samples to -1.
+     */
+    Eigen::Array<double,Eigen::Dynamic,1> toResiduals() const
+    {
+      Eigen::Array<double,Eigen::Dynamic,1> residuals(this->m_Size);
+      for (Index i = 0 ; i < this->m_Size ; ++i)
+        residuals.coeffRef(i) = this->test(i) ? 0.0 : -1.0;
+      return residuals;
+    };
+    
+    /**
+     * Writes this mask in the given @a residuals and resets the @a values of the invalid samples. Valid samples get a null residual, invalid samples a residual set to -1 and their values set to 0.
+     * The words with all their samples valid are written in one block.
+     * @note The number of rows of @a values and @a residuals must be the same than the number of samples in this mask.
+     */
+    template <typename V, typename R>
+    void apply(Eigen::DenseBase<V>& values, Eigen::DenseBase<R>& residuals) const
+    {
+      assert(values.rows() == this->m_Size);
+      assert(residuals.rows() == this->m_Size);
+      for (size_t w = 0 ; w < this->m_Words.size() ; ++w)
+      {
+        const Index offset = static_cast<Index>(w) * WordBits;
+        const Index num = ((this->m_Size - offset) < WordBits) ? (this->m_Size - offset) : WordBits;
+        const Word word = this->m_Words[w];
+        if (word == ((num == WordBits) ? ~Word(0) : ((Word(1) << num) - 1)))
+        {
+          residuals.derived().segment(offset, num).setZero();
+          continue;
+        }
+        for (Index j = 0 ; j < num ; ++j)
+        {
+          if ((word >> j) & Word(1))
+            residuals.coeffRef(offset+j) = 0.0;
+          else
+          {
+            residuals.coeffRef(offset+j) = -1.0;
+            values.derived().row(offset+j).setZero();
+          }
+        }
+      }
+    };
+    
+    /**
+     * Word-wise conjunction. A sample is valid only if it is valid in both masks.
+     * @note Both masks must have the same number of samples.
+     */
+    ValidityMask& operator&=(const ValidityMask& other) _OPENMA_NOEXCEPT
+    {
+      assert(this->m_Size == other.m_Size);
+      for (size_t i = 0 ; i < this->m_Words.size() ; ++i)
+        this->m_Words[i] &= other.m_Words[i];
+      return *this;
+    };
+    
+    /**
+     * Word-wise disjunction. A sample is valid if it is valid in one of the masks.
+     * @note Both masks must have the same number of samples.
+     */
+    ValidityMask& operator|=(const ValidityMask& other) _OPENMA_NOEXCEPT
+    {
+      assert(this->m_Size == other.m_Size);
+      for (size_t i = 0 ; i < this->m_Words.size() ; ++i)
+        this->m_Words[i] |= other.m_Words[i];
+      return *this;
+    };
+    
+    /**
+     * Returns true if both masks have the same size and the same validity for each sample.
+     */
+    bool operator==(const ValidityMask& other) const _OPENMA_NOEXCEPT {return (this->m_Size == other.m_Size) && (this->m_Words == other.m_Words);};
+    
+    /**
+     * Returns true if the masks are not equal.
+     */
+    bool operator!=(const ValidityMask& other) const _OPENMA_NOEXCEPT {return !(*this == other);};
+    
+  private:
+    void clearTail() _OPENMA_NOEXCEPT
+    {
+      const Index rem = this->m_Size % WordBits;
+      if (rem != 0)
+        this->m_Words.back() &= (Word(1) << rem) - 1;
+    };
+    
+    Index m_Size;
+    std::vector<Word> m_Words;
+  };
+  
+  /**
+   * Returns the word-wise conjunction of @a lhs and @a rhs.
+   * @relates ValidityMask
+   */
+  inline ValidityMask operator&(ValidityMask lhs, const ValidityMask& rhs)
+  {
+    lhs &= rhs;
+    return lhs;
+  };
+  
+  /**
+   * Returns the word-wise disjunction of @a lhs and @a rhs.
+   * @relates ValidityMask
+   */
+  inline ValidityMask operator|(ValidityMask lhs, const ValidityMask& rhs)
+  {
+    lhs |= rhs;
+    return lhs;
+  };
+};
+};
+
+#endif // __openma_math_validity_h
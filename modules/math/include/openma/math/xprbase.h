@@ -77,6 +77,13 @@ namespace math
      */
     operator double () const _OPENMA_NOEXCEPT {return (static_cast<const Derived&>(*this).derived().residuals().eval().coeff(0) >= 0.0) ? static_cast<const Derived&>(*this).derived().values().eval().coeff(0) : 0.0;};
     
+    /**
+     * Returns a bit-packed version of the residuals' sign (i.e. 1 bit per sample, set if the sample is valid).
+     * By default, the residuals are evaluated and packed. Element-wise operations (e.g. UnaryOp, BinaryOp, BlockOp) reimplement this method to propagate directly the mask(s) of their input(s).
+     * This method is used by the assignment of the element-wise operations to generate their residuals only once, in the destination.
+     */
+    ValidityMask validity() const {return ValidityMask::fromResiduals(static_cast<const Derived&>(*this).derived().residuals());};
+    
     // Next methods are defined after the declaration of the class BlockOp
     
     /**
@@ -191,8 +198,19 @@ namespace math
   
     /**
      * Returns an object representing an euler angles operation using the given order @a a0, @a a1, @a a2 for the sequence order.
+     * By default, the angles are extracted exactly for each sample. The @a mode EulerAnglesMode::Approximate extracts all the samples at once using a vectorized approximation.
+     * Set @a unwrap to true to remove the jumps of 2*pi between consecutive samples.
+     */
+    const EulerAnglesOp<Derived> eulerAngles(Index a0, Index a1, Index a2, EulerAnglesMode mode = EulerAnglesMode::Exact, bool unwrap = false) const _OPENMA_NOEXCEPT;
+    
+    // Next method is defined after the declaration of the class FillGapsOp
+    
+    /**
+     * Returns an object representing this template expression where the gaps (i.e. consecutive invalid samples surrounded by valid ones) are interpolated using the given @a method.
+     * Gaps longer than @a maxGap samples, as well as the invalid samples at the beginning and the end, are not filled.
+     * Filled samples have their residual set to 0.
      */
-    const EulerAnglesOp<Derived> eulerAngles(Index a0, Index a1, Index a2) const _OPENMA_NOEXCEPT;
+    const FillGapsOp<Derived> fillGaps(GapFilling method, unsigned maxGap = std::numeric_limits<unsigned>::max()) const _OPENMA_NOEXCEPT;
   };
   
   // ----------------------------------------------------------------------- //
@@ -33,6 +33,10 @@
  */
 
 #include "openma/math.h"
+#include "openma/base/logger.h"
+
+#include <Eigen/SVD> // Eigen::JacobiSVD
+#include <Eigen/LU> // MatrixBase::determinant
 
 bool _ma_math_verify_timesequence(const ma::TimeSequence* ts, int type, unsigned components, unsigned offset)
 {
@@ -60,7 +64,11 @@ namespace math
     auto ts = parent->findChild<TimeSequence*>(name,{{"type",type}},false);
     if (ts != nullptr)
     {
-      assert(ts->components() == components);
+      if (ts->components() != components)
+      {
+        error("The time sequence '%s' already exists but has %i components instead of %i. Export aborted.", name.c_str(), ts->components(), components);
+        return nullptr;
+      }
       ts->resize(samples); // Grow / shrink the data (if necessary)
       ts->setSampleRate(rate); // Assign possibly a new rate
       ts->setStartTime(start); // Same for the start time
@@ -79,5 +87,104 @@ namespace math
     }
     return ts;
   };
+  
+  unsigned fill_gaps(TimeSequence* ts, GapFilling method, unsigned maxGap)
+  {
+    if (!_ma_math_verify_timesequence(ts, -1, 2, 0))
+      return 0;
+    const unsigned samples = ts->samples(), components = ts->components() - 1;
+    Eigen::Map<Eigen::Array<double,Eigen::Dynamic,Eigen::Dynamic>> values(ts->data(), samples, components);
+    Eigen::Map<Eigen::Array<double,Eigen::Dynamic,1>> residuals(ts->data() + samples * components, samples);
+    Eigen::Array<double,Eigen::Dynamic,1> resout;
+    std::vector<std::array<unsigned,4>> gaps;
+    prepare_gap_processing(resout, gaps, residuals, maxGap);
+    unsigned filled = 0;
+    for (const auto& gap : gaps)
+    {
+      Eigen::internal::fill_gap(values, gap, method);
+      filled += gap[1];
+    }
+    residuals = resout;
+    return filled;
+  };
+  
+  unsigned fill_gaps(unsigned samples, double* values, double* residuals, const std::vector<const double*>& clusterValues, const std::vector<const double*>& clusterResiduals, unsigned maxGap)
+  {
+    assert(clusterValues.size() == clusterResiduals.size());
+    Eigen::Map<Eigen::Array<double,Eigen::Dynamic,3>> target(values, samples, 3);
+    Eigen::Map<Eigen::Array<double,Eigen::Dynamic,1>> res(residuals, samples);
+    Eigen::Array<double,Eigen::Dynamic,1> resout;
+    std::vector<std::array<unsigned,4>> gaps;
+    prepare_gap_processing(resout, gaps, res, maxGap);
+    // Least squares estimation of the position of the target at the sample 'cur' from its position at the reference sample 'ref'
+    const size_t num = clusterValues.size();
+    Eigen::Matrix<double,3,Eigen::Dynamic> from(3,num), to(3,num);
+    auto estimate = [&](unsigned ref, unsigned cur, Eigen::Vector3d* pos) -> bool
+    {
+      Eigen::DenseIndex inc = 0;
+      for (size_t m = 0 ; m < num ; ++m)
+      {
+        if ((clusterResiduals[m][ref] < 0.0) || (clusterResiduals[m][cur] < 0.0))
+          continue;
+        for (unsigned j = 0 ; j < 3 ; ++j)
+        {
+          from.coeffRef(j,inc) = clusterValues[m][ref + j * samples];
+          to.coeffRef(j,inc) = clusterValues[m][cur + j * samples];
+        }
+        ++inc;
+      }
+      if (inc < 3)
+        return false;
+      const Eigen::Vector3d cfrom = from.leftCols(inc).rowwise().mean(), cto = to.leftCols(inc).rowwise().mean();
+      const Eigen::Matrix3d cov = (from.leftCols(inc).colwise() - cfrom) * (to.leftCols(inc).colwise() - cto).transpose();
+      Eigen::JacobiSVD<Eigen::Matrix3d> svd(cov, Eigen::ComputeFullU | Eigen::ComputeFullV);
+      Eigen::Matrix3d corr = Eigen::Matrix3d::Identity();
+      corr.coeffRef(2,2) = (svd.matrixV() * svd.matrixU().transpose()).determinant() < 0.0 ? -1.0 : 1.0;
+      const Eigen::Matrix3d rot = svd.matrixV() * corr * svd.matrixU().transpose();
+      *pos = rot * (target.row(ref).matrix().transpose() - cfrom) + cto;
+      return true;
+    };
+    unsigned filled = 0;
+    for (const auto& gap : gaps)
+    {
+      const unsigned ibefore = gap[0] - 1, iafter = gap[0] + gap[1];
+      for (unsigned i = gap[0] ; i < iafter ; ++i)
+      {
+        Eigen::Vector3d before, after;
+        const bool hasBefore = estimate(ibefore, i, &before), hasAfter = estimate(iafter, i, &after);
+        if (!hasBefore && !hasAfter)
+          continue;
+        const double w = static_cast<double>(i - ibefore) / static_cast<double>(iafter - ibefore);
+        if (hasBefore && hasAfter)
+          target.row(i) = ((1.0 - w) * before + w * after).transpose().array();
+        else
+          target.row(i) = (hasBefore ? before : after).transpose().array();
+        res.coeffRef(i) = 0.0;
+        ++filled;
+      }
+    }
+    return filled;
+  };
+  
+  unsigned fill_gaps(TimeSequence* ts, const std::vector<const TimeSequence*>& cluster, unsigned maxGap)
+  {
+    if (!_ma_math_verify_timesequence(ts, TimeSequence::Position, 3, 0))
+    {
+      error("The time sequence to fill is not a marker trajectory. Gap filling aborted.");
+      return 0;
+    }
+    std::vector<const double*> values, residuals;
+    for (const auto& marker : cluster)
+    {
+      if ((marker == ts) || !_ma_math_verify_timesequence(marker, TimeSequence::Position, 3, 0) || (marker->samples() != ts->samples()))
+      {
+        warning("The time sequence '%s' cannot be used in the cluster to fill the gaps of '%s'. It is ignored.", marker ? marker->name().c_str() : "", ts->name().c_str());
+        continue;
+      }
+      values.push_back(marker->data());
+      residuals.push_back(marker->data() + 3 * marker->samples());
+    }
+    return fill_gaps(ts->samples(), ts->data(), ts->data() + 3 * ts->samples(), values, residuals, maxGap);
+  };
 };
 };
\ No newline at end of file
@@ -0,0 +1,143 @@
+#include <cxxtest/TestDrive.h>
+
+#include <openma/math.h>
+#include <Eigen/Geometry> // Eigen::AngleAxisd
+
+#include <cmath>
+
+CXXTEST_SUITE(GapFillingTest)
+{
+  CXXTEST_TEST(linear)
+  {
+    ma::math::Vector a(12);
+    for (int i = 0 ; i < 12 ; ++i)
+      a.values().row(i) << 1.0 * i, 2.0 * i, -3.0 * i;
+    a.residuals().setConstant(0.5);
+    a.residuals().coeffRef(0) = -1.0; // Beginning: not filled
+    a.residuals().segment(3,3).setConstant(-1.0); // Gap of 3 samples
+    a.residuals().segment(7,2).setConstant(-1.0); // Gap of 2 samples
+    a.residuals().coeffRef(11) = -1.0; // End: not filled
+    a.values().row(4).setZero();
+    ma::math::Vector b = a.fillGaps(ma::math::GapFilling::Linear);
+    TS_ASSERT_EQUALS(b.residuals().coeff(0), -1.0);
+    TS_ASSERT_EQUALS(b.residuals().coeff(1), 0.5);
+    TS_ASSERT_EQUALS(b.residuals().coeff(3), 0.0);
+    TS_ASSERT_EQUALS(b.residuals().coeff(4), 0.0);
+    TS_ASSERT_EQUALS(b.residuals().coeff(5), 0.0);
+    TS_ASSERT_EQUALS(b.residuals().coeff(7), 0.0);
+    TS_ASSERT_EQUALS(b.residuals().coeff(8), 0.0);
+    TS_ASSERT_EQUALS(b.residuals().coeff(11), -1.0);
+    for (int i = 1 ; i < 11 ; ++i)
+    {
+      TS_ASSERT_DELTA(b.values().coeff(i,0), 1.0 * i, 1e-12);
+      TS_ASSERT_DELTA(b.values().coeff(i,1), 2.0 * i, 1e-12);
+      TS_ASSERT_DELTA(b.values().coeff(i,2), -3.0 * i, 1e-12);
+    }
+    TS_ASSERT_EQUALS(b.values().row(0).sum(), 0.0);
+    TS_ASSERT_EQUALS(b.values().row(11).sum(), 0.0);
+  };
+  
+  CXXTEST_TEST(maximumGap)
+  {
+    ma::math::Scalar a(12);
+    a.values().setLinSpaced(12,0.0,11.0);
+    a.residuals().setZero();
+    a.residuals().segment(2,4).setConstant(-1.0);
+    a.residuals().segment(8,2).setConstant(-1.0);
+    ma::math::Scalar b = a.fillGaps(ma::math::GapFilling::Linear, 3);
+    TS_ASSERT_EQUALS((b.residuals().segment(2,4) < 0.0).all(), true);
+    TS_ASSERT_EQUALS((b.residuals().segment(8,2) >= 0.0).all(), true);
+    TS_ASSERT_DELTA(b.values().coeff(8), 8.0, 1e-12);
+    TS_ASSERT_DELTA(b.values().coeff(9), 9.0, 1e-12);
+    TS_ASSERT_EQUALS(a.fillGaps(ma::math::GapFilling::Linear, 3).validity().count(), 8);
+  };
+  
+  CXXTEST_TEST(cubicSpline)
+  {
+    const int num = 60;
+    ma::math::Array<2> a(num);
+    for (int i = 0 ; i < num ; ++i)
+      a.values().row(i) << std::sin(0.1 * i), std::cos(0.1 * i);
+    a.residuals().setZero();
+    a.residuals().segment(20,6).setConstant(-1.0);
+    ma::math::Array<2> ref = a;
+    ma::math::Array<2> lin = a.fillGaps(ma::math::GapFilling::Linear);
+    ma::math::Array<2> cub = a.fillGaps(ma::math::GapFilling::CubicSpline);
+    TS_ASSERT_EQUALS((cub.residuals() >= 0.0).all(), true);
+    double errlin = 0.0, errcub = 0.0;
+    for (int i = 20 ; i < 26 ; ++i)
+    {
+      errlin = std::max(errlin, (lin.values().row(i) - ref.values().row(i)).abs().maxCoeff());
+      errcub = std::max(errcub, (cub.values().row(i) - ref.values().row(i)).abs().maxCoeff());
+    }
+    TS_ASSERT_LESS_THAN(errcub, 1e-2);
+    TS_ASSERT_LESS_THAN(errcub, errlin);
+    // Linear data are exactly recovered by a natural cubic spline
+    ma::math::Scalar b(20);
+    b.values().setLinSpaced(20,-5.0,14.0);
+    b.residuals().setZero();
+    b.residuals().segment(7,5).setConstant(-1.0);
+    ma::math::Scalar c = b.fillGaps(ma::math::GapFilling::CubicSpline);
+    for (int i = 7 ; i < 12 ; ++i)
+      TS_ASSERT_DELTA(c.values().coeff(i), i - 5.0, 1e-12);
+  };
+  
+  CXXTEST_TEST(timesequence)
+  {
+    ma::TimeSequence marker("MARKER",4,10,100.0,0.0,ma::TimeSequence::Position,"mm");
+    for (unsigned i = 0 ; i < 10 ; ++i)
+    {
+      marker.data()[i] = 1.0 * i;
+      marker.data()[i+10] = 10.0;
+      marker.data()[i+20] = -1.0 * i;
+      marker.data()[i+30] = 0.1;
+    }
+    marker.data()[34] = -1.0;
+    marker.data()[35] = -1.0;
+    TS_ASSERT_EQUALS(ma::math::fill_gaps(&marker, ma::math::GapFilling::CubicSpline), 2u);
+    TS_ASSERT_DELTA(marker.data()[4], 4.0, 1e-12);
+    TS_ASSERT_DELTA(marker.data()[15], 10.0, 1e-12);
+    TS_ASSERT_DELTA(marker.data()[25], -5.0, 1e-12);
+    TS_ASSERT_EQUALS(marker.data()[34], 0.0);
+    TS_ASSERT_EQUALS(marker.data()[35], 0.0);
+    TS_ASSERT_EQUALS(ma::math::fill_gaps(&marker, ma::math::GapFilling::CubicSpline), 0u);
+  };
+  
+  CXXTEST_TEST(rigidBody)
+  {
+    const int num = 30;
+    const Eigen::Vector3d local[4] = {{0.,0.,0.},{100.,0.,0.},{0.,80.,0.},{30.,40.,50.}};
+    ma::math::Position m1(num), m2(num), m3(num), target(num);
+    ma::math::Position* markers[4] = {&m1, &m2, &m3, &target};
+    for (int i = 0 ; i < num ; ++i)
+    {
+      const Eigen::Matrix3d rot = (Eigen::AngleAxisd(0.05 * i, Eigen::Vector3d::UnitZ()) * Eigen::AngleAxisd(0.02 * i, Eigen::Vector3d::UnitX())).toRotationMatrix();
+      const Eigen::Vector3d origin(2.0 * i, -1.0 * i, 500.0);
+      for (int j = 0 ; j < 4 ; ++j)
+        markers[j]->values().row(i) = (rot * local[j] + origin).transpose().array();
+    }
+    for (int j = 0 ; j < 4 ; ++j)
+      markers[j]->residuals().setConstant(0.25);
+    ma::math::Position ref = target;
+    target.residuals().segment(10,8).setConstant(-1.0);
+    target.values().middleRows(10,8).setZero();
+    m2.residuals().coeffRef(12) = -1.0; // Only 2 valid markers in the cluster
+    std::vector<ma::math::Position> cluster{m1, m2, m3};
+    TS_ASSERT_EQUALS(ma::math::fill_gaps(target, cluster), 7u);
+    TS_ASSERT_EQUALS(target.residuals().coeff(12), -1.0);
+    for (int i = 10 ; i < 18 ; ++i)
+    {
+      if (i == 12)
+        continue;
+      TS_ASSERT_EQUALS(target.residuals().coeff(i), 0.0);
+      TS_ASSERT_DELTA((target.values().row(i) - ref.values().row(i)).abs().maxCoeff(), 0.0, 1e-9);
+    }
+  };
+};
+
+CXXTEST_SUITE_REGISTRATION(GapFillingTest)
+CXXTEST_TEST_REGISTRATION(GapFillingTest, linear)
+CXXTEST_TEST_REGISTRATION(GapFillingTest, maximumGap)
+CXXTEST_TEST_REGISTRATION(GapFillingTest, cubicSpline)
+CXXTEST_TEST_REGISTRATION(GapFillingTest, timesequence)
+CXXTEST_TEST_REGISTRATION(GapFillingTest, rigidBody)
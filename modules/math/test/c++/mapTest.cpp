@@ -100,10 +100,56 @@ CXXTEST_SUITE(MapTest)
       TS_ASSERT_DELTA(ddsr.coeff(i,0), dr[i*3],    1e-15);
     }
   };
+  
+  CXXTEST_TEST(assignToTimeSequence)
+  {
+    ma::Node root("root");
+    ma::math::Vector a(10), b(10);
+    a.values().setRandom();
+    a.residuals().setZero();
+    a.residuals().coeffRef(2) = -1.0;
+    b.values().setRandom();
+    b.residuals().setZero();
+    auto ts = ma::math::to_timesequence(a + b, "Sum", 100.0, 0.0, ma::TimeSequence::Position, "mm", &root);
+    TS_ASSERT_EQUALS(ts->samples(), 10u);
+    TS_ASSERT_EQUALS(ts->components(), 4u);
+    const double* data = ts->data();
+    for (unsigned i = 0 ; i < 10 ; ++i)
+    {
+      if (i == 2)
+      {
+        TS_ASSERT_EQUALS(data[i], 0.0);
+        TS_ASSERT_EQUALS(data[i+30], -1.0);
+        continue;
+      }
+      TS_ASSERT_EQUALS(data[i],    a.values().coeff(i,0) + b.values().coeff(i,0));
+      TS_ASSERT_EQUALS(data[i+10], a.values().coeff(i,1) + b.values().coeff(i,1));
+      TS_ASSERT_EQUALS(data[i+20], a.values().coeff(i,2) + b.values().coeff(i,2));
+      TS_ASSERT_EQUALS(data[i+30], 0.0);
+    }
+    // Second export: the time sequence and its buffer must be reused
+    auto ts2 = ma::math::to_timesequence(a - b, "Sum", 100.0, 0.0, ma::TimeSequence::Position, "mm", &root);
+    TS_ASSERT_EQUALS(ts2, ts);
+    TS_ASSERT_EQUALS(ts2->data(), data);
+    TS_ASSERT_EQUALS(root.children().size(), 1u);
+    TS_ASSERT_EQUALS(data[5], a.values().coeff(5,0) - b.values().coeff(5,0));
+    // Shape mismatch
+    ma::math::Vector c(5);
+    TS_ASSERT_EQUALS(ma::math::assign_to(c, ts), false);
+    ma::math::Scalar d(10);
+    TS_ASSERT_EQUALS(ma::math::assign_to(d, ts), false);
+    TS_ASSERT_EQUALS(ma::math::assign_to(2.0 * a, ts), true);
+    TS_ASSERT_EQUALS(data[5], 2.0 * a.values().coeff(5,0));
+    // Existing time sequence with another number of components
+    TS_ASSERT_EQUALS(ma::math::to_timesequence(d, "Sum", 100.0, 0.0, ma::TimeSequence::Position, "", &root), nullptr);
+    TS_ASSERT_EQUALS(ts->components(), 4u);
+    TS_ASSERT_EQUALS(root.children().size(), 1u);
+  };
 };
 
 CXXTEST_SUITE_REGISTRATION(MapTest)
 CXXTEST_TEST_REGISTRATION(MapTest, scaledDifference)
 CXXTEST_TEST_REGISTRATION(MapTest, null)
 CXXTEST_TEST_REGISTRATION(MapTest, nonConstToConstAssignment)
-CXXTEST_TEST_REGISTRATION(MapTest, downsample)
\ No newline at end of file
+CXXTEST_TEST_REGISTRATION(MapTest, downsample)
+CXXTEST_TEST_REGISTRATION(MapTest, assignToTimeSequence)
\ No newline at end of file
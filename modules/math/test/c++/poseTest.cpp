@@ -1,6 +1,7 @@
 #include <cxxtest/TestDrive.h>
 
 #include <openma/math.h>
+#include <Eigen/Geometry> // Eigen::AngleAxisd
 
 #include <cmath> // M_PI
 
@@ -297,6 +298,82 @@ CXXTEST_SUITE(PoseTest)
     TS_ASSERT_DELTA(meanbis.values().coeff(0, 1), 0.541052068118242, 1e-5);
     TS_ASSERT_DELTA(meanbis.values().coeff(0, 2), 1.225221134900019, 1e-5);
   };
+  
+  CXXTEST_TEST(eulerAnglesApproximate)
+  {
+    const int rows = 101;
+    ma::math::Pose motion(rows);
+    motion.values().setZero();
+    motion.residuals().setZero();
+    for (int i = 0 ; i < rows - 1 ; ++i)
+    {
+      Eigen::Matrix3d R = (Eigen::AngleAxisd(0.071 * i - 3.0, Eigen::Vector3d::UnitZ())
+                         * Eigen::AngleAxisd(0.053 * i - 2.0, Eigen::Vector3d::UnitX())
+                         * Eigen::AngleAxisd(0.029 * i + 1.0, Eigen::Vector3d::UnitY())).toRotationMatrix();
+      motion.values().row(i).head<9>() = Eigen::Map<const Eigen::Matrix<double,1,9>>(R.data());
+    }
+    // Gimbal lock
+    motion.values().row(rows-1).head<9>() << 0.0, 0.0, 1.0, -1.0, 0.0, 0.0, 0.0, -1.0, 0.0;
+    const unsigned sequences[12][3] = {{0,1,2},{0,2,1},{1,0,2},{1,2,0},{2,0,1},{2,1,0},
+                                       {0,1,0},{0,2,0},{1,0,1},{1,2,1},{2,0,2},{2,1,2}};
+    for (const auto& seq : sequences)
+    {
+      ma::math::Array<3> exact = motion.eulerAngles(seq[0],seq[1],seq[2]);
+      ma::math::Array<3> approx = motion.eulerAngles(seq[0],seq[1],seq[2],ma::math::EulerAnglesMode::Approximate);
+      TS_ASSERT_EQUALS(approx.rows(), rows);
+      for (int i = 0 ; i < rows ; ++i)
+      {
+        for (int j = 0 ; j < 3 ; ++j)
+        {
+          // Angles close to +/-pi can be returned on both sides
+          const double diff = std::fabs(exact.values().coeff(i,j) - approx.values().coeff(i,j));
+          TS_ASSERT_DELTA(std::min(diff, std::fabs(diff - 2.0 * M_PI)), 0.0, 1e-7);
+        }
+      }
+    }
+  };
+  
+  CXXTEST_TEST(eulerAnglesUnwrap)
+  {
+    const int rows = 50;
+    ma::math::Pose motion(rows);
+    motion.values().setZero();
+    motion.residuals().setZero();
+    for (int i = 0 ; i < rows ; ++i)
+    {
+      Eigen::Matrix3d R = Eigen::AngleAxisd(0.25 * i, Eigen::Vector3d::UnitX()).toRotationMatrix();
+      motion.values().row(i).head<9>() = Eigen::Map<const Eigen::Matrix<double,1,9>>(R.data());
+    }
+    motion.residuals().coeffRef(20) = -1.0;
+    motion.values().row(20).setZero();
+    // Invalid sample with a rotation far from its neighbours: it must not be used as the reference of the next sample
+    Eigen::Matrix3d R30 = Eigen::AngleAxisd(0.25 * 30 - 3.0, Eigen::Vector3d::UnitX()).toRotationMatrix();
+    motion.values().row(30).head<9>() = Eigen::Map<const Eigen::Matrix<double,1,9>>(R30.data());
+    motion.residuals().coeffRef(30) = -1.0;
+    ma::math::Array<3> wrapped = motion.eulerAngles(0,1,2);
+    ma::math::Array<3> exact = motion.eulerAngles(0,1,2,ma::math::EulerAnglesMode::Exact,true);
+    ma::math::Array<3> approx = motion.eulerAngles(0,1,2,ma::math::EulerAnglesMode::Approximate,true);
+    TS_ASSERT_DELTA(wrapped.values().coeff(49,0), 0.25 * 49 - 4.0 * M_PI, 1e-10);
+    for (int i = 0 ; i < rows ; ++i)
+    {
+      if (i == 20)
+      {
+        TS_ASSERT_EQUALS(exact.residuals().coeff(i), -1.0);
+        TS_ASSERT_EQUALS(exact.values().coeff(i,0), 0.0);
+        continue;
+      }
+      else if (i == 30)
+      {
+        TS_ASSERT_EQUALS(exact.residuals().coeff(i), -1.0);
+        TS_ASSERT_EQUALS(approx.residuals().coeff(i), -1.0);
+        continue;
+      }
+      TS_ASSERT_DELTA(exact.values().coeff(i,0), 0.25 * i, 1e-10);
+      TS_ASSERT_DELTA(approx.values().coeff(i,0), 0.25 * i, 1e-7);
+      TS_ASSERT_DELTA(exact.values().coeff(i,1), 0.0, 1e-10);
+      TS_ASSERT_DELTA(exact.values().coeff(i,2), 0.0, 1e-10);
+    }
+  };
 };
 
 CXXTEST_SUITE_REGISTRATION(PoseTest)
@@ -306,3 +383,5 @@ CXXTEST_TEST_REGISTRATION(PoseTest, transformPose)
 CXXTEST_TEST_REGISTRATION(PoseTest, transformPosition)
 CXXTEST_TEST_REGISTRATION(PoseTest, transformPositionBis)
 CXXTEST_TEST_REGISTRATION(PoseTest, eulerAngles)
+CXXTEST_TEST_REGISTRATION(PoseTest, eulerAnglesApproximate)
+CXXTEST_TEST_REGISTRATION(PoseTest, eulerAnglesUnwrap)
\ No newline at end of file
@@ -0,0 +1,155 @@
+#include <cxxtest/TestDrive.h>
+
+#include <openma/math.h>
+
+#include <vector>
+
+CXXTEST_SUITE(ValidityTest)
+{
+  CXXTEST_TEST(constructor)
+  {
+    ma::math::ValidityMask a;
+    TS_ASSERT_EQUALS(a.size(), 0);
+    TS_ASSERT_EQUALS(a.any(), false);
+    TS_ASSERT_EQUALS(a.all(), false);
+    ma::math::ValidityMask b(130);
+    TS_ASSERT_EQUALS(b.size(), 130);
+    TS_ASSERT_EQUALS(b.data().size(), 3ul);
+    TS_ASSERT_EQUALS(b.count(), 130);
+    TS_ASSERT_EQUALS(b.all(), true);
+    ma::math::ValidityMask c(130, false);
+    TS_ASSERT_EQUALS(c.count(), 0);
+    TS_ASSERT_EQUALS(c.any(), false);
+    c.set(129, true);
+    TS_ASSERT_EQUALS(c.test(129), true);
+    TS_ASSERT_EQUALS(c.test(128), false);
+    TS_ASSERT_EQUALS(c.count(), 1);
+    // The comparison of the words must handle a full last word and stop on any invalid sample
+    ma::math::ValidityMask d(128);
+    TS_ASSERT_EQUALS(d.all(), true);
+    d.set(3, false);
+    TS_ASSERT_EQUALS(d.all(), false);
+    TS_ASSERT_EQUALS(d.count(), 127);
+    b.set(129, false);
+    TS_ASSERT_EQUALS(b.all(), false);
+    TS_ASSERT_EQUALS(b.count(), 129);
+  };
+  
+  CXXTEST_TEST(fromResiduals)
+  {
+    ma::math::Scalar a(70);
+    a.values().setRandom();
+    a.residuals().setZero();
+    a.residuals().coeffRef(0) = -1.0;
+    a.residuals().coeffRef(5) = 0.5;
+    a.residuals().coeffRef(64) = -1.0;
+    a.residuals().coeffRef(69) = -1.0;
+    ma::math::ValidityMask mask = a.validity();
+    TS_ASSERT_EQUALS(mask.size(), 70);
+    TS_ASSERT_EQUALS(mask.count(), 67);
+    for (int i = 0 ; i < 70 ; ++i)
+      TS_ASSERT_EQUALS(mask.test(i), a.residuals().coeff(i) >= 0.0);
+    auto res = mask.toResiduals();
+    for (int i = 0 ; i < 70 ; ++i)
+      TS_ASSERT_EQUALS(res.coeff(i), a.residuals().coeff(i) >= 0.0 ? 0.0 : -1.0);
+  };
+  
+  CXXTEST_TEST(wordWise)
+  {
+    ma::math::ValidityMask a(100), b(100);
+    a.set(3, false);
+    a.set(70, false);
+    b.set(70, false);
+    b.set(99, false);
+    auto c = a & b;
+    TS_ASSERT_EQUALS(c.count(), 97);
+    TS_ASSERT_EQUALS(c.test(3), false);
+    TS_ASSERT_EQUALS(c.test(70), false);
+    TS_ASSERT_EQUALS(c.test(99), false);
+    auto d = a | b;
+    TS_ASSERT_EQUALS(d.count(), 99);
+    TS_ASSERT_EQUALS(d.test(70), false);
+    TS_ASSERT_EQUALS(d == (b | a), true);
+    TS_ASSERT_EQUALS(d != c, true);
+  };
+  
+  CXXTEST_TEST(propagation)
+  {
+    ma::math::Position a(80), b(80);
+    a.values().setRandom();
+    b.values().setRandom();
+    a.residuals().setZero();
+    b.residuals().setZero();
+    a.residuals().coeffRef(2) = -1.0;
+    b.residuals().coeffRef(65) = -1.0;
+    auto xpr = (a - b).cross(a + b).normalized();
+    ma::math::ValidityMask mask = xpr.validity();
+    TS_ASSERT_EQUALS(mask.count(), 78);
+    TS_ASSERT_EQUALS(mask.test(2), false);
+    TS_ASSERT_EQUALS(mask.test(65), false);
+    TS_ASSERT_EQUALS(mask == ma::math::ValidityMask::fromResiduals(xpr.residuals()), true);
+    TS_ASSERT_EQUALS(a.x().validity() == a.validity(), true);
+    TS_ASSERT_EQUALS(a.norm().mean().validity().count(), 1);
+    a.residuals().setConstant(-1.0);
+    TS_ASSERT_EQUALS(a.norm().mean().validity().count(), 0);
+  };
+  
+  CXXTEST_TEST(setValidity)
+  {
+    ma::math::Position a(4);
+    a.values().setOnes();
+    a.residuals() << 0.5, -1.0, 0.25, 0.0;
+    ma::math::ValidityMask mask(4);
+    mask.set(2, false);
+    a.setValidity(mask);
+    TS_ASSERT_EQUALS(a.residuals().coeff(0), 0.5);
+    TS_ASSERT_EQUALS(a.residuals().coeff(1), 0.0);
+    TS_ASSERT_EQUALS(a.residuals().coeff(2), -1.0);
+    TS_ASSERT_EQUALS(a.residuals().coeff(3), 0.0);
+    TS_ASSERT_EQUALS(a.values().row(2).sum(), 0.0);
+    TS_ASSERT_EQUALS(a.values().row(3).sum(), 3.0);
+  };
+  
+  CXXTEST_TEST(assignment)
+  {
+    // Real residuals (e.g. reconstruction error) and several words (last one partially used)
+    ma::math::Position a(150), b(150);
+    a.values().setRandom();
+    b.values().setRandom();
+    a.residuals().setConstant(0.5);
+    b.residuals().setConstant(0.25);
+    for (int i = 3 ; i < 150 ; i += 7)
+      a.residuals().coeffRef(i) = -1.0;
+    for (int i = 60 ; i < 140 ; ++i)
+      b.residuals().coeffRef(i) = -1.0;
+    // Residuals and values generated like the assignment without mask
+    const Eigen::Array<double,Eigen::Dynamic,1> expected = ma::math::generate_residuals((a.residuals() >= 0.0) && (b.residuals() >= 0.0));
+    const ma::math::Position::Values cross = (expected.replicate<1,3>() >= 0.0).select((a - b).cross(a + b).values(), 0.0);
+    const ma::math::Scalar::Values norm = (expected >= 0.0).select((a - b).norm().values(), 0.0);
+    // Array
+    ma::math::Position c = (a - b).cross(a + b);
+    TS_ASSERT_EQUALS(c.rows(), 150);
+    TS_ASSERT_EQUALS((c.residuals() == expected).all(), true);
+    TS_ASSERT_EQUALS((c.values() == cross).all(), true);
+    ma::math::Scalar n = (a - b).norm();
+    TS_ASSERT_EQUALS((n.residuals() == expected).all(), true);
+    TS_ASSERT_EQUALS((n.values() == norm).all(), true);
+    // Map (e.g. time sequence of a marker)
+    std::vector<double> values(150*3, 1.0), residuals(150, 0.75);
+    ma::math::Map<ma::math::Position> m(150, values.data(), residuals.data());
+    m = (a - b).cross(a + b);
+    TS_ASSERT_EQUALS((m.residuals() == expected).all(), true);
+    TS_ASSERT_EQUALS((m.values() == cross).all(), true);
+    // A copy keeps the real residuals
+    ma::math::Position d = a;
+    TS_ASSERT_EQUALS((d.residuals() == a.residuals()).all(), true);
+  };
+};
+
+CXXTEST_SUITE_REGISTRATION(ValidityTest)
+CXXTEST_TEST_REGISTRATION(ValidityTest, constructor)
+CXXTEST_TEST_REGISTRATION(ValidityTest, fromResiduals)
+CXXTEST_TEST_REGISTRATION(ValidityTest, wordWise)
+CXXTEST_TEST_REGISTRATION(ValidityTest, propagation)
+CXXTEST_TEST_REGISTRATION(ValidityTest, setValidity)
+CXXTEST_TEST_REGISTRATION(ValidityTest, assignment)